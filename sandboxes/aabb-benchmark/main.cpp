@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/AABBTreeIndirect.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+// Compares the serial and the parallel build of the AABB tree and the throughput of the single ray
+// and the ray packet queries on a large mesh.
+// Usage: aabb-benchmark [stlfilename.stl]
+// A finely tessellated sphere is used if no mesh is given.
+
+using namespace Slic3r;
+
+static constexpr const size_t NumRuns       = 5;
+static constexpr const size_t NumSamples    = 20000;
+static constexpr const size_t RaysPerSample = 64;
+
+template<typename Fn>
+static double measure(Fn &&fn)
+{
+    Benchmark b;
+    double    elapsed = 0.;
+    for (size_t i = 0; i < NumRuns; ++ i) {
+        b.start();
+        fn();
+        b.stop();
+        elapsed += b.getElapsedSec();
+    }
+    return elapsed / NumRuns;
+}
+
+static void profile(const indexed_triangle_set &its)
+{
+    std::cout << "Triangles: " << its.indices.size() << std::endl;
+
+    AABBTreeIndirect::Tree3f tree;
+    const double build_serial = measure([&its, &tree]() {
+        tbb::task_arena(1).execute([&its, &tree]() { tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices); });
+    });
+    const double build_parallel = measure([&its, &tree]() { tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices); });
+    std::cout << "Build serial [s]:     " << build_serial << std::endl;
+    std::cout << "Build parallel [s]:   " << build_parallel << std::endl;
+
+    // Rays cast from the mesh vertices in random directions, the rays of a sample share the origin as in the seam placer.
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+    std::uniform_int_distribution<size_t>  dist_vertex(0, its.vertices.size() - 1);
+    std::vector<Vec3d> sample_origins;
+    for (size_t i = 0; i < NumSamples; ++ i)
+        sample_origins.emplace_back(its.vertices[dist_vertex(rng)].cast<double>());
+    std::vector<Vec3d> dirs;
+    for (size_t i = 0; i < RaysPerSample; ++ i)
+        dirs.emplace_back(Vec3d(dist(rng), dist(rng), dist(rng)).normalized());
+
+    std::vector<size_t> num_hits_single(NumSamples, 0);
+    const double query_single = measure([&]() {
+        tbb::parallel_for(size_t(0), NumSamples, [&](size_t sample_idx) {
+            size_t num_hits = 0;
+            for (const Vec3d &dir : dirs) {
+                igl::Hit hit;
+                if (AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, Vec3d(sample_origins[sample_idx] + 1e-4 * dir), dir, hit))
+                    ++ num_hits;
+            }
+            num_hits_single[sample_idx] = num_hits;
+        }); // end of parallel_for
+    });
+
+    std::vector<size_t> num_hits_packet(NumSamples, 0);
+    const double query_packet = measure([&]() {
+        tbb::parallel_for(size_t(0), NumSamples, [&](size_t sample_idx) {
+            std::vector<Vec3d>    origins;
+            std::vector<igl::Hit> hits;
+            for (const Vec3d &dir : dirs)
+                origins.emplace_back(sample_origins[sample_idx] + 1e-4 * dir);
+            AABBTreeIndirect::intersect_rays_first_hit(its.vertices, its.indices, tree, origins, dirs, hits);
+            num_hits_packet[sample_idx] = std::count_if(hits.begin(), hits.end(), [](const igl::Hit &hit) { return hit.id != -1; });
+        }); // end of parallel_for
+    });
+
+    const double num_rays = double(NumSamples * RaysPerSample);
+    std::cout << "Single rays [Mray/s]: " << num_rays / query_single * 1e-6 << std::endl;
+    std::cout << "Ray packets [Mray/s]: " << num_rays / query_packet * 1e-6 << std::endl;
+    if (num_hits_single != num_hits_packet)
+        std::cerr << "The single ray and the ray packet queries differ!" << std::endl;
+}
+
+int main(const int argc, const char *argv[])
+{
+    TriangleMesh mesh;
+    if (argc > 1) {
+        if (! mesh.ReadSTLFile(argv[1])) {
+            std::cerr << "Error loading " << argv[1] << std::endl;
+            return -1;
+        }
+    } else
+        mesh = TriangleMesh(its_make_sphere(10., 2. * PI / 1000.));
+
+    if (mesh.empty()) {
+        std::cerr << "The mesh is empty." << std::endl;
+        return -1;
+    }
+
+    profile(mesh.its);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <tbb/task_arena.h>
+
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/MultiMaterialSegmentation.hpp>
+#include <libslic3r/TriangleSelector.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+// Measures the segmentation of a multi-material painted object on a single thread and on all the threads.
+// The object is a finely tessellated sphere painted in stripes and sectors, so that most of the layers
+// contain several colors and the segmentation of most of the layers constructs a Voronoi diagram.
+// Usage: mmu-segmentation-benchmark [sphere_radius_mm] [number_of_filaments]
+
+using namespace Slic3r;
+
+static constexpr const size_t NumRuns = 3;
+
+static void paint(ModelVolume &volume, double radius, size_t num_filaments)
+{
+    const indexed_triangle_set &its = volume.mesh().its;
+    TriangleSelector selector(volume.mesh());
+    for (size_t facet_idx = 0; facet_idx < its.indices.size(); ++ facet_idx) {
+        const stl_triangle_vertex_indices &f = its.indices[facet_idx];
+        const Vec3f  c      = (its.vertices[f(0)] + its.vertices[f(1)] + its.vertices[f(2)]) / 3.f;
+        const int    sector = int((std::atan2(c.y(), c.x()) + PI) / (2. * PI) * 6.);
+        const int    stripe = int((c.z() + radius) / 3.);
+        selector.set_facet(int(facet_idx), EnforcerBlockerType(1 + (sector + stripe) % int(num_filaments)));
+    }
+    volume.mmu_segmentation_facets.set(selector);
+}
+
+template<typename Fn>
+static double measure(Fn &&fn)
+{
+    Benchmark b;
+    double    elapsed = 0.;
+    for (size_t i = 0; i < NumRuns; ++ i) {
+        b.start();
+        fn();
+        b.stop();
+        elapsed += b.getElapsedSec();
+    }
+    return elapsed / NumRuns;
+}
+
+int main(const int argc, const char *argv[])
+{
+    const double radius        = argc > 1 ? std::max(1., atof(argv[1])) : 40.;
+    const size_t num_filaments = argc > 2 ? size_t(std::max(2, atoi(argv[2]))) : 4;
+
+    Model        model;
+    ModelObject *object = model.add_object();
+    ModelVolume *volume = object->add_volume(make_sphere(radius, 2. * PI / 720.));
+    object->add_instance();
+    object->ensure_on_bed();
+    paint(*volume, radius, num_filaments);
+
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.option<ConfigOptionStrings>("filament_colour", true)->values.assign(num_filaments, "#FFFFFF");
+    config.option<ConfigOptionFloats>("filament_diameter", true)->values.assign(num_filaments, 1.75);
+
+    Print print;
+    print.apply(model, config);
+    print.set_status_silent();
+    PrintObject *print_object = print.get_object(0);
+    // Slices the object, the segmentation is then repeated on the sliced layers.
+    print_object->slice();
+
+    size_t num_regions = 0;
+    auto   segment     = [print_object, &num_regions]() {
+        std::vector<std::vector<ExPolygons>> segmentation = multi_material_segmentation_by_painting(*print_object, []() {});
+        num_regions = 0;
+        for (const std::vector<ExPolygons> &layer : segmentation)
+            for (const ExPolygons &expolygons : layer)
+                num_regions += expolygons.size();
+    };
+
+    tbb::task_arena single_thread(1);
+    const double    time_serial   = measure([&single_thread, &segment]() { single_thread.execute(segment); });
+    const double    time_parallel = measure(segment);
+
+    std::cout << "Layers:            " << print_object->layer_count() << std::endl;
+    std::cout << "Triangles:         " << volume->mesh().its.indices.size() << std::endl;
+    std::cout << "Filaments:         " << num_filaments << std::endl;
+    std::cout << "Segmented regions: " << num_regions << std::endl;
+    std::cout << "Threads:           " << tbb::this_task_arena::max_concurrency() << std::endl;
+    std::cout << "Time 1 thread [s]: " << time_serial << std::endl;
+    std::cout << "Time [s]:          " << time_parallel << std::endl;
+    std::cout << "Speedup:           " << time_serial / time_parallel << std::endl;
+
+    return EXIT_SUCCESS;
+}
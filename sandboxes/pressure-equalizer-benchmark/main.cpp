@@ -0,0 +1,111 @@
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <libslic3r/GCode.hpp>
+#include <libslic3r/GCode/PressureEqualizer.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+// Measures the throughput of the pressure equalizer on a synthetic G-code with the extrusion role and speed markers
+// emitted by GCode::process_layer(), which are not present in the exported G-code.
+// Usage: pressure-equalizer-benchmark [number_of_layers] [extrusions_per_layer]
+
+using namespace Slic3r;
+
+static constexpr const size_t NumRuns = 3;
+
+// Layers of short extrusions of random roles and flow rates, separated by short and long travels, retracts and tool changes.
+static std::vector<std::string> generate_layers(size_t num_layers, size_t num_extrusions)
+{
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int>    dist_role { int(erPerimeter), int(erCustom) };
+    std::uniform_int_distribution<int>    dist_feedrate(600, 12000);
+    std::uniform_real_distribution<float> dist_step(-10.f, 10.f);
+    std::uniform_real_distribution<float> dist_flow(0.02f, 0.07f);
+    std::uniform_int_distribution<int>    dist_event(0, 9);
+
+    std::vector<std::string> layers(num_layers);
+    char buf[256];
+    for (size_t layer_id = 0; layer_id < num_layers; ++ layer_id) {
+        std::string &gcode = layers[layer_id];
+        float x = 100.f, y = 100.f;
+        sprintf(buf, "G1 Z%.3f\n", 0.2 * double(layer_id + 1));
+        gcode += buf;
+        for (size_t extrusions = 0; extrusions < num_extrusions;) {
+            const int role = dist_role(rng);
+            sprintf(buf, ";_EXTRUSION_ROLE:%d\n", role);
+            gcode += buf;
+            const int event = dist_event(rng);
+            if (event < 2) {
+                x += dist_step(rng) * 2.f;
+                y += dist_step(rng) * 2.f;
+                sprintf(buf, "G1 E-0.8 F2100\nG1 X%.3f Y%.3f F12000\nG1 E0.8 F2100\n", x, y);
+                gcode += buf;
+            } else if (event < 4) {
+                x += 0.5f;
+                sprintf(buf, "G1 X%.3f Y%.3f F12000\n", x, y);
+                gcode += buf;
+            } else if (event == 4)
+                gcode += (layer_id & 1) ? "T1\n" : "T0\n";
+            sprintf(buf, "G1 F%d;_EXTRUDE_SET_SPEED%s\n", dist_feedrate(rng), role == int(erExternalPerimeter) ? ";_EXTERNAL_PERIMETER" : "");
+            gcode += buf;
+            const float flow = dist_flow(rng);
+            for (int i = 0; i < 40; ++ i, ++ extrusions) {
+                const float dx = dist_step(rng);
+                const float dy = dist_step(rng);
+                x += dx;
+                y += dy;
+                sprintf(buf, "G1 X%.3f Y%.3f E%.5f\n", x, y, std::sqrt(dx * dx + dy * dy) * flow);
+                gcode += buf;
+            }
+            gcode += ";_EXTRUDE_END\n";
+        }
+    }
+    return layers;
+}
+
+int main(const int argc, const char *argv[])
+{
+    const size_t num_layers     = argc > 1 ? size_t(std::max(1, atoi(argv[1]))) : 200;
+    const size_t num_extrusions = argc > 2 ? size_t(std::max(1, atoi(argv[2]))) : 5000;
+
+    GCodeConfig config;
+    config.use_relative_e_distances.value                           = true;
+    config.filament_diameter.values                                 = { 1.75, 1.75 };
+    config.max_volumetric_extrusion_rate_slope.value                = 2.;
+    config.max_volumetric_extrusion_rate_slope_segment_length.value = 1.;
+
+    const std::vector<std::string> layers = generate_layers(num_layers, num_extrusions);
+    size_t input_size = 0;
+    for (const std::string &gcode : layers)
+        input_size += gcode.size();
+
+    Benchmark b;
+    double    elapsed     = 0.;
+    size_t    output_size = 0;
+    for (size_t run = 0; run < NumRuns; ++ run) {
+        PressureEqualizer equalizer(config);
+        output_size = 0;
+        b.start();
+        for (size_t layer_id = 0; layer_id <= layers.size(); ++ layer_id) {
+            LayerResult in = layer_id < layers.size() ? LayerResult{ layers[layer_id], layer_id } : LayerResult::make_nop_layer_result();
+            output_size += equalizer.process_layer(std::move(in)).gcode.size();
+        }
+        b.stop();
+        elapsed += b.getElapsedSec();
+    }
+    elapsed /= NumRuns;
+
+    std::cout << "Layers:               " << num_layers << std::endl;
+    std::cout << "Extrusions:           " << num_layers * num_extrusions << std::endl;
+    std::cout << "Input [MB]:           " << double(input_size) * 1e-6 << std::endl;
+    std::cout << "Output [MB]:          " << double(output_size) * 1e-6 << std::endl;
+    std::cout << "Time [s]:             " << elapsed << std::endl;
+    std::cout << "Throughput [Mline/s]: " << double(num_layers * num_extrusions) / elapsed * 1e-6 << std::endl;
+
+    return EXIT_SUCCESS;
+}
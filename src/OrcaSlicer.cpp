@@ -23,14 +23,23 @@
 #include <iostream>
 #include <math.h>
 
-#if defined(__linux__) || defined(__LINUX__)
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <boost/thread.hpp>
 //add json logic
 #include "nlohmann/json.hpp"
 
 using namespace nlohmann;
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
 #endif
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -47,7 +56,9 @@ using namespace nlohmann;
 
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Config.hpp"
+#include "libslic3r/Execution/ExecutionContext.hpp"
 #include "libslic3r/Geometry.hpp"
+#include "libslic3r/GCode.hpp"
 #include "libslic3r/GCode/PostProcessor.hpp"
 #include "libslic3r/Model.hpp"
 #include "libslic3r/ModelArrange.hpp"
@@ -143,7 +154,8 @@ std::map<int, std::string> cli_errors = {
     {CLI_OBJECT_COLLISION_IN_LAYER_PRINT, "Object conflicts were detected. Please verify the slicing of all plates in Orca Slicer before uploading."},
     {CLI_SPIRAL_MODE_INVALID_PARAMS, "Some slicing parameters cannot work with Spiral Vase mode. Please solve the issue in Orca Slicer before uploading."},
     {CLI_SLICING_ERROR, "Failed slicing the model. Please verify the slicing of all plates on Orca Slicer before uploading."},
-    {CLI_GCODE_PATH_CONFLICTS, " G-code conflicts detected after slicing. Please make sure the 3mf file can be successfully sliced in the latest Orca Slicer."}
+    {CLI_GCODE_PATH_CONFLICTS, " G-code conflicts detected after slicing. Please make sure the 3mf file can be successfully sliced in the latest Orca Slicer."},
+    {CLI_SLICING_CANCELED, "Slicing was canceled."}
 };
 
 typedef struct  _sliced_plate_info{
@@ -166,6 +178,35 @@ typedef struct _sliced_info {
 }sliced_info_t;
 std::vector<PrintBase::SlicingStatus> g_slicing_warnings;
 
+//BBS: daemon mode, see CLI::run_daemon()
+static bool                     g_cli_daemon_mode { false };
+// Set by the daemon to cancel the running job, the prints being processed are canceled as well.
+static std::atomic<bool>        g_cli_cancel_requested { false };
+static std::mutex               g_cli_active_prints_mutex;
+static std::vector<PrintBase*>  g_cli_active_prints;
+// Limits of the parallelism given to the daemon, the defaults of its jobs.
+static ExecutionParams          g_cli_execution_params;
+
+static bool cli_job_canceled() { return g_cli_cancel_requested.load(); }
+
+static void cli_cancel_running_job()
+{
+    std::lock_guard<std::mutex> lock(g_cli_active_prints_mutex);
+    g_cli_cancel_requested = true;
+    for (PrintBase *print : g_cli_active_prints)
+        print->cancel();
+}
+
+// Setting files parsed by the daemon, reused by the next jobs until the file is modified.
+struct CLICachedConfigFile {
+    std::time_t                         last_write_time { 0 };
+    DynamicPrintConfig                  config;
+    ConfigSubstitutions                 substitutions;
+    std::map<std::string, std::string>  key_values;
+    std::string                         reason;
+};
+static std::map<std::string, CLICachedConfigFile> g_cli_config_cache;
+
 #if defined(__linux__) || defined(__LINUX__)
 #define PIPE_BUFFER_SIZE 512
 
@@ -344,6 +385,13 @@ typedef struct _cli_callback_mgr {
             close(m_pipe_fd);
             m_pipe_fd = -1;
         }
+        // Ready to be started again by the next job of the daemon.
+        lck.lock();
+        m_started = false;
+        m_exit = false;
+        m_data_ready = false;
+        m_plate_count = m_plate_index = m_progress = m_total_progress = 0;
+        lck.unlock();
         BOOST_LOG_TRIVIAL(info) << "cli_callback_mgr_t::stop successfully.";
     }
 }cli_callback_mgr_t;
@@ -398,6 +446,12 @@ static PrinterTechnology get_printer_technology(const DynamicConfig &config)
     return(ret);}
 #endif
 
+//BBS: daemon mode, stop a canceled job between its phases, before its prints are created
+#define exit_if_canceled(phase) if (cli_job_canceled()) {\
+    BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << ": job canceled " << phase;\
+    record_exit_reson(outfile_dir, CLI_SLICING_CANCELED, 0, cli_errors[CLI_SLICING_CANCELED], sliced_info);\
+    flush_and_exit(CLI_SLICING_CANCELED);}
+
 void record_exit_reson(std::string outputdir, int code, int plate_id, std::string error_message, sliced_info_t& sliced_info, std::map<std::string, std::string> key_values = std::map<std::string, std::string>())
 {
 #if defined(__linux__) || defined(__LINUX__)
@@ -1121,6 +1175,10 @@ int CLI::run(int argc, char **argv)
         downward_check = downward_check_option->value;
 
     bool start_gui = m_actions.empty() && !downward_check;
+    if (start_gui && g_cli_daemon_mode) {
+        boost::nowide::cerr << "no action for the daemon job" << std::endl;
+        return CLI_INVALID_PARAMS;
+    }
     if (start_gui) {
         BOOST_LOG_TRIVIAL(info) << "no action, start gui directly" << std::endl;
 #ifdef SLIC3R_GUI
@@ -1182,6 +1240,29 @@ int CLI::run(int argc, char **argv)
             set_logging_level(2);
         }
     }
+    // BBS: limits of the parallelism and of the memory of this job, the processing and the export of its prints run in their own TBB arena.
+    // The limits given to the daemon are the defaults of its jobs, the limits of a job do not stay in force for the next jobs.
+    ExecutionParams execution_params = g_cli_execution_params;
+    if (const ConfigOptionInt *opt = m_config.opt<ConfigOptionInt>("threads"); opt)
+        execution_params.threads = std::max(opt->value, 0);
+    if (const ConfigOptionInt *opt = m_config.opt<ConfigOptionInt>("numa_node"); opt)
+        execution_params.numa_node = std::max(opt->value, -1);
+    if (const ConfigOptionInt *opt = m_config.opt<ConfigOptionInt>("gcode_pipeline_tokens"); opt)
+        execution_params.gcode_pipeline_tokens = size_t(std::max(opt->value, 0));
+    if (const ConfigOptionInt *opt = m_config.opt<ConfigOptionInt>("gcode_memory_limit"); opt)
+        execution_params.gcode_memory_limit = size_t(std::max(opt->value, 0)) * 1024 * 1024;
+    if (const ConfigOptionInt *opt = m_config.opt<ConfigOptionInt>("max_extruders_exact"); opt)
+        execution_params.max_extruders_exact = size_t(std::max(opt->value, 0));
+
+    const ConfigOptionString *opt_daemon = m_config.opt<ConfigOptionString>("daemon");
+    if (opt_daemon && !opt_daemon->value.empty()) {
+        if (g_cli_daemon_mode) {
+            boost::nowide::cerr << "daemon can not be started by a daemon job" << std::endl;
+            return CLI_INVALID_PARAMS;
+        }
+        g_cli_execution_params = execution_params;
+        return run_daemon(argv[0], opt_daemon->value);
+    }
 
     global_begin_time = (long long)Slic3r::Utils::get_current_time_utc();
     BOOST_LOG_TRIVIAL(warning) << boost::format("cli mode, Current OrcaSlicer Version %1%")%SoftFever_VERSION;
@@ -1353,6 +1434,7 @@ int CLI::run(int argc, char **argv)
     }
     if (load_assemble_list.empty()) {
         for (const std::string& file : m_input_files) {
+            exit_if_canceled("while loading the model files");
             if (!boost::filesystem::exists(file)) {
                 boost::nowide::cerr << "No such file: " << file << std::endl;
                 record_exit_reson(outfile_dir, CLI_FILE_NOTFOUND, 0, cli_errors[CLI_FILE_NOTFOUND], sliced_info);
@@ -1678,7 +1760,25 @@ int CLI::run(int argc, char **argv)
             std::map<std::string, std::string> key_values;
             std::string reason;
 
-            config_substitutions = config.load_from_json(file, config_substitution_rule, key_values, reason);
+            if (g_cli_daemon_mode) {
+                // The daemon keeps the parsed setting files, most of the jobs load the same system presets.
+                std::time_t last_write_time = boost::filesystem::last_write_time(file);
+                auto it = g_cli_config_cache.find(file);
+                if (it == g_cli_config_cache.end() || it->second.last_write_time != last_write_time) {
+                    CLICachedConfigFile cached;
+                    cached.last_write_time = last_write_time;
+                    cached.substitutions = cached.config.load_from_json(file, config_substitution_rule, cached.key_values, cached.reason);
+                    it = g_cli_config_cache.insert_or_assign(file, std::move(cached)).first;
+                }
+                else
+                    BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< ":reuse the setting file "<< file << " loaded by a previous job";
+                config.apply(it->second.config);
+                config_substitutions = it->second.substitutions;
+                key_values = it->second.key_values;
+                reason = it->second.reason;
+            }
+            else
+                config_substitutions = config.load_from_json(file, config_substitution_rule, key_values, reason);
             if (!reason.empty()) {
                 BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<<  ":Can not load config from file "<<file<<"\n";
                 return CLI_CONFIG_FILE_ERROR;
@@ -1734,6 +1834,7 @@ int CLI::run(int argc, char **argv)
         }
         return 0;
     };
+    exit_if_canceled("before loading the setting files");
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< ":before load settings, file count="<< load_configs.size() << std::endl;
     //std::vector<std::string> filament_compatible_printers;
     // load config files supplied via --load
@@ -2941,6 +3042,7 @@ int CLI::run(int argc, char **argv)
         }
     }
 
+    exit_if_canceled("before applying the configuration");
     // Apply command line options to a more specific DynamicPrintConfig which provides normalize()
     // (command line options override --load files)
     m_print_config.apply(m_extra_config, true);
@@ -3394,6 +3496,7 @@ int CLI::run(int argc, char **argv)
     bool user_center_specified = false;
     Points beds = get_bed_shape(m_print_config);
     ArrangeParams arrange_cfg;
+    arrange_cfg.stopcondition = cli_job_canceled;
 
     BOOST_LOG_TRIVIAL(info) << "will start transforms, commands count " << m_transforms.size() << "\n";
 #if defined(__linux__) || defined(__LINUX__)
@@ -3404,6 +3507,7 @@ int CLI::run(int argc, char **argv)
 #endif
 
     for (auto const &opt_key : m_transforms) {
+        exit_if_canceled("before the transform " << opt_key);
         BOOST_LOG_TRIVIAL(info) << "process transform " << opt_key << "\n";
         if (opt_key == "assemble") {
             if (clone_objects.size() > 0) {
@@ -3936,6 +4040,7 @@ int CLI::run(int argc, char **argv)
                 arrange_cfg.progressind = [](unsigned st, std::string str = "") {
                     //boost::nowide::cout << "st=" << st << ", " << str << std::endl;
                 };
+                arrange_cfg.stopcondition = cli_job_canceled;
 
                 //Step-3:do the arrange
                 BOOST_LOG_TRIVIAL(info) << boost::format("start plate %1%'s arranging...") % (i + 1);
@@ -4339,6 +4444,7 @@ int CLI::run(int argc, char **argv)
                 arrange_cfg.progressind= [](unsigned st, std::string str = "") {
                     //boost::nowide::cout << "st=" << st << ", " << str << std::endl;
                 };
+                arrange_cfg.stopcondition = cli_job_canceled;
 
                 //Step-3:do the arrange
                 BOOST_LOG_TRIVIAL(info) << boost::format("start %1% th arranging...")%arrange_count;
@@ -4627,6 +4733,8 @@ int CLI::run(int argc, char **argv)
     sliced_info.prepare_time = (size_t) (global_current_time - global_begin_time);
     global_begin_time = global_current_time;
 
+    // The arrangement stops early once the job is canceled, the result must not be sliced.
+    exit_if_canceled("before slicing");
     for (auto const &opt_key : m_actions) {
         if (opt_key == "help") {
             this->print_help();
@@ -4741,6 +4849,24 @@ int CLI::run(int argc, char **argv)
                 cli_status_callback(slicing_status);
             }
 #endif
+            // BBS: number of plates sliced at the same time when slicing all plates.
+            int parallel_plates = 1;
+            if (const ConfigOptionInt *opt = m_config.opt<ConfigOptionInt>("parallel_plates");
+                opt != nullptr && opt->value > 1 && plate_to_slice == 0 && partplate_list.get_plate_count() > 1) {
+#if defined(__linux__) || defined(__LINUX__)
+                // The pipe reports the progress of a single plate at a time.
+                if (g_cli_callback_mgr.is_started())
+                    BOOST_LOG_TRIVIAL(warning) << "parallel_plates is ignored when reporting the progress through a pipe.";
+                else
+#endif
+                    parallel_plates = opt->value;
+            }
+            // Shared by the prints of all the plates, the plates sliced in parallel share the threads of its arena.
+            // No stage of their G-code export pipelines waits for another pipeline, see GCodePipelineMemory,
+            // thus the plates may outnumber the threads of the arena.
+            ExecutionContextPtr execution_context;
+            if (! execution_params.is_default())
+                execution_context = std::make_shared<ExecutionContext>(execution_params);
             // Make a copy of the model if the current action is not the last action, as the model may be
             // modified by the centering and such.
             Model model_copy;
@@ -4753,10 +4879,200 @@ int CLI::run(int argc, char **argv)
                 // honored when printing (they will be only centered, unless --dont-arrange
                 // is supplied); if any object has no instances, it will get a default one
                 // and all instances will be rearranged (unless --dont-arrange is supplied).
-                std::string outfile;
                 //Print       fff_print;
                 std::vector<size_t> plate_triangle_counts(partplate_list.get_plate_count(), 0);
 
+                // BBS: a plate is sliced by its own Print. With --parallel_plates > 1 the plates are applied and validated
+                // one by one, then processed and exported by several plates at the same time, and the results are reported
+                // in the plate order.
+                struct PlateSliceJob {
+                    int                                     index { 0 };
+                    Slic3r::GUI::PartPlate                 *part_plate { nullptr };
+                    PrintBase                              *print { nullptr };
+                    Print                                  *print_fff { nullptr };
+                    Slic3r::GUI::GCodeResult               *gcode_result { nullptr };
+                    sliced_plate_info_t                     sliced_plate_info;
+                    long long                               start_time { 0 };
+                    long long                               prepare_time { 0 };
+                    long long                               time_using_cache { 0 };
+                    std::vector<PrintBase::SlicingStatus>   warnings;
+                    // CLI error code, reported by finish_plate().
+                    int                                     error { 0 };
+                    std::string                             error_message;
+                    bool                                    report_plate_info { false };
+                    bool                                    export_slicedata_failed { false };
+                };
+                std::vector<PlateSliceJob> plate_jobs;
+
+                // Process and export one plate. Thread safe for different plates, the errors are stored into the job.
+                auto slice_plate = [&](PlateSliceJob &job) {
+                    const int index = job.index;
+                    PrintBase *print = job.print;
+                    sliced_plate_info_t &sliced_plate_info = job.sliced_plate_info;
+                    long long temp_time = 0, end_time = 0;
+                    // Let the daemon cancel the print while being processed.
+                    {
+                        std::lock_guard<std::mutex> lock(g_cli_active_prints_mutex);
+                        if (g_cli_cancel_requested)
+                            print->cancel();
+                        g_cli_active_prints.push_back(print);
+                    }
+                    ScopeGuard unregister_print([print]() {
+                        std::lock_guard<std::mutex> lock(g_cli_active_prints_mutex);
+                        g_cli_active_prints.erase(std::remove(g_cli_active_prints.begin(), g_cli_active_prints.end(), print), g_cli_active_prints.end());
+                    });
+                    try {
+                        if (load_slicedata) {
+                            std::string plate_dir = load_slice_data_dir+"/"+std::to_string(index+1);
+                            int ret = print->load_cached_data(plate_dir);
+                            if (ret) {
+                                BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": load Slicing data error, ret=" << ret;
+                                BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": switch normal slicing";
+                                print->process();
+                            }
+                            else {
+                                BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": load cached data success, go on.";
+#if defined(__linux__) || defined(__LINUX__)
+                                if (g_cli_callback_mgr.is_started()) {
+                                    PrintBase::SlicingStatus slicing_status{69, "Cache data loaded"};
+                                    cli_status_callback(slicing_status);
+                                }
+#endif
+                                print->process(nullptr, true);
+                                BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": finished print::process.";
+                            }
+                        }
+                        else {
+                            print->process(&job.time_using_cache);
+                            BOOST_LOG_TRIVIAL(info) << "print::process: first time_using_cache is " << job.time_using_cache << " secs.";
+                        }
+                        if (printer_technology == ptFFF) {
+                            std::string conflict_result = job.print_fff->get_conflict_string();
+                            if (!conflict_result.empty()) {
+                               BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": found slicing result conflict!"<< std::endl;
+                               job.error = CLI_GCODE_PATH_CONFLICTS;
+                               return;
+                            }
+
+                            //check the warnings
+                            if (parallel_plates <= 1) {
+                                job.warnings = std::move(g_slicing_warnings);
+                                g_slicing_warnings.clear();
+                            }
+                            for (const PrintBase::SlicingStatus &status : job.warnings)
+                            {
+                                if ((status.warning_step != -1) && (status.message_type != PrintStateBase::SlicingDefaultNotification))
+                                {
+                                    sliced_plate_info.warning_message = status.text;
+
+                                    if (status.warning_level == PrintStateBase::WarningLevel::NON_CRITICAL) {
+                                        BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": found NON_CRITICAL slicing warnings: "<<status.text <<std::endl;
+                                    }
+                                    else {
+                                        BOOST_LOG_TRIVIAL(warning) << boost::format("plate %1%: found slicing warnings: %2%, no_check=%3%")%(index+1) %status.text %no_check;
+                                        if (!no_check) {
+                                            //only following message will be reported under import mode
+                                            if (status.message_type == PrintStateBase::SlicingEmptyGcodeLayers
+                                                || status.message_type == PrintStateBase::SlicingGcodeOverlap)
+                                            {
+                                                job.report_plate_info = true;
+                                                job.error = CLI_SLICING_ERROR;
+                                                return;
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                            job.warnings.clear();
+                            sliced_plate_info.triangle_count = plate_triangle_counts[index];
+
+                            // The outfile is processed by a PlaceholderParser.
+                            std::string outfile;
+                            if (outfile_dir.empty()) {
+                                outfile = job.part_plate->get_tmp_gcode_path();
+                            }
+                            else {
+                                outfile = outfile_dir + "/plate_" + std::to_string(index + 1) + ".gcode";
+                                job.part_plate->set_tmp_gcode_path(outfile);
+                            }
+                            BOOST_LOG_TRIVIAL(info) << "process finished, will export gcode temporily to " << outfile << std::endl;
+                            temp_time = (long long)Slic3r::Utils::get_current_time_utc();
+                            outfile = job.print_fff->export_gcode(outfile, job.gcode_result, nullptr);
+                            job.time_using_cache = job.time_using_cache + ((long long)Slic3r::Utils::get_current_time_utc() - temp_time);
+                            BOOST_LOG_TRIVIAL(info) << "export_gcode finished: time_using_cache update to " << job.time_using_cache << " secs.";
+                            BOOST_LOG_TRIVIAL(info) << "Slicing result exported to " << outfile << std::endl;
+                            if (!outfile_dir.empty()) {
+                                // The ASCII G-code is kept, it is stored into the 3mf and referenced by the G-code result.
+                                std::string binary_path = outfile;
+                                std::string binary_name = outfile;
+                                if (gcode_convert_to_binary(binary_path, true, binary_name, job.print_fff->full_print_config(), job.print_fff->print_statistics().config())) {
+                                    fs::rename(binary_path, binary_name);
+                                    BOOST_LOG_TRIVIAL(info) << "Binary G-code exported to " << binary_name << std::endl;
+                                }
+                            }
+                        }
+                        job.part_plate->update_slice_result_valid_state(true);
+#if defined(__linux__) || defined(__LINUX__)
+                        if (g_cli_callback_mgr.is_started()) {
+                            PrintBase::SlicingStatus slicing_status{100, "Slicing finished"};
+                            cli_status_callback(slicing_status);
+                        }
+#endif
+                        if (export_slicedata) {
+                            BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ":will export Slicing data to " << export_slice_data_dir;
+                            std::string plate_dir = export_slice_data_dir+"/"+std::to_string(index+1);
+                            bool with_space = (get_logging_level() >= 4)?true:false;
+                            int ret = print->export_cached_data(plate_dir, with_space);
+                            if (ret) {
+                                BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": export Slicing data error, ret=" << ret;
+                                if (fs::exists(plate_dir))
+                                    fs::remove_all(plate_dir);
+                                job.export_slicedata_failed = true;
+                                job.error = ret;
+                                return;
+                            }
+                        }
+                        end_time = (long long)Slic3r::Utils::get_current_time_utc();
+                        sliced_plate_info.sliced_time = end_time - job.start_time;
+                        sliced_plate_info.sliced_time_with_cache = job.time_using_cache;
+                    } catch (const CanceledException &) {
+                        BOOST_LOG_TRIVIAL(warning) << "slicing of partplate "<<index+1<<" canceled" << std::endl;
+                        job.error = CLI_SLICING_CANCELED;
+                    } catch (const std::exception &ex) {
+                        BOOST_LOG_TRIVIAL(error) << "found slicing or export error for partplate "<<index+1 << std::endl;
+                        job.error = CLI_SLICING_ERROR;
+                        job.error_message = ex.what();
+                    }
+                };
+
+                // Report the result of a plate sliced by slice_plate(), returns the CLI error code, 0 on success.
+                auto finish_plate = [&](PlateSliceJob &job) -> int {
+                    const int index = job.index;
+                    sliced_plate_info_t &sliced_plate_info = job.sliced_plate_info;
+                    if (job.error != 0) {
+                        if (!job.error_message.empty())
+                            boost::nowide::cerr << job.error_message << std::endl;
+                        if (job.report_plate_info)
+                            sliced_info.sliced_plates.push_back(sliced_plate_info);
+                        if (job.export_slicedata_failed)
+                            export_slicedata_error = true;
+                        record_exit_reson(outfile_dir, job.error, index+1, cli_errors[job.error], sliced_info);
+                        return job.error;
+                    }
+                    if (max_slicing_time_per_plate != 0) {
+                        long long time_cost = sliced_plate_info.sliced_time;
+                        if (time_cost > max_slicing_time_per_plate) {
+                            sliced_plate_info.warning_message = (boost::format("plate %1%'s slice time %2% exceeds the limit %3%, return error.")%(index+1) %time_cost %max_slicing_time_per_plate).str();
+                            BOOST_LOG_TRIVIAL(error) << sliced_plate_info.warning_message;
+                            sliced_info.sliced_plates.push_back(sliced_plate_info);
+                            record_exit_reson(outfile_dir, CLI_SLICING_TIME_EXCEEDS_LIMIT, index+1, cli_errors[CLI_SLICING_TIME_EXCEEDS_LIMIT], sliced_info);
+                            return CLI_SLICING_TIME_EXCEEDS_LIMIT;
+                        }
+                    }
+                    sliced_info.sliced_plates.push_back(sliced_plate_info);
+                    return 0;
+                };
+
                 while(!finished)
                 {
                     //BBS: slice every partplate one by one
@@ -4776,13 +5092,15 @@ int CLI::run(int argc, char **argv)
 
                         model.curr_plate_index = index;
                         BOOST_LOG_TRIVIAL(info) << boost::format("Plate %1%: pre_check %2%, start")%(index+1)%pre_check;
-                        long long start_time = 0, end_time = 0, temp_time = 0, time_using_cache = 0;
+                        long long start_time = 0;
                         start_time = (long long)Slic3r::Utils::get_current_time_utc();
                         //get the current partplate
                         Slic3r::GUI::PartPlate* part_plate = partplate_list.get_plate(index);
                         part_plate->get_print(&print, &gcode_result, &print_index);
 
                         print_fff = dynamic_cast<Print *>(print);
+                        if (print_fff)
+                            print_fff->set_execution_context(execution_context);
                         /*if (outfile_config.empty())
                         {
                             outfile = "plate_" + std::to_string(index + 1) + ".gcode";
@@ -4944,12 +5262,19 @@ int CLI::run(int argc, char **argv)
                         else {
                             if (pre_check && (partplate_list.get_plate_count() > 1)) //continue to next plate directly
                                 continue;
+                            PlateSliceJob job;
+                            job.index        = index;
+                            job.part_plate   = part_plate;
+                            job.print        = print;
+                            job.print_fff    = print_fff;
+                            job.gcode_result = gcode_result;
+                            job.sliced_plate_info = sliced_plate_info;
+                            job.start_time   = start_time;
                             try {
-                                std::string outfile_final;
                                 BOOST_LOG_TRIVIAL(info) << "start Print::process for partplate "<<index+1 << std::endl;
 #if defined(__linux__) || defined(__LINUX__)
-                                BOOST_LOG_TRIVIAL(info) << "cli callback mgr started:  "<<g_cli_callback_mgr.m_started << std::endl;
-                                if (g_cli_callback_mgr.is_started()) {
+                                if (parallel_plates <= 1 && g_cli_callback_mgr.is_started()) {
+                                    BOOST_LOG_TRIVIAL(info) << "cli callback mgr started:  "<<g_cli_callback_mgr.m_started << std::endl;
                                     BOOST_LOG_TRIVIAL(info) << "set print's callback to cli_status_callback.";
                                     print->set_status_callback(cli_status_callback);
                                     g_cli_callback_mgr.set_plate_info(index+1, (plate_to_slice== 0)?partplate_list.get_plate_count():1);
@@ -4962,14 +5287,13 @@ int CLI::run(int argc, char **argv)
                                         cli_status_callback(slicing_status);
                                     }
                                 }
-                                else {
+                                else
+#endif
+                                // With parallel plates, the status callback referencing the job is installed once the job is picked up by a worker.
+                                if (parallel_plates <= 1) {
                                     BOOST_LOG_TRIVIAL(info) << "set print's callback to default_status_callback.";
                                     print->set_status_callback(default_status_callback);
                                 }
-#else
-                                BOOST_LOG_TRIVIAL(info) << "set print's callback to default_status_callback.";
-                                print->set_status_callback(default_status_callback);
-#endif
                                 //check whether it is bbl printer
                                 std::string& printer_model_string = new_print_config.opt_string("printer_model", true);
                                 bool is_bbl_vendor_preset = false;
@@ -4988,150 +5312,24 @@ int CLI::run(int argc, char **argv)
                                 (dynamic_cast<Print*>(print))->is_BBL_printer() = is_bbl_vendor_preset;
 
                                 //update information for brim
+                                //the tables are shared by all the plates, they only depend on the project and printer settings.
                                 const PrintConfig& print_config = print_fff->config();
                                 Model::setExtruderParams(m_print_config, filament_count);
                                 Model::setPrintSpeedTable(m_print_config, print_config);
-                                if (load_slicedata) {
-                                    std::string plate_dir = load_slice_data_dir+"/"+std::to_string(index+1);
-                                    int ret = print->load_cached_data(plate_dir);
-                                    if (ret) {
-                                        BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": load Slicing data error, ret=" << ret;
-                                        BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": switch normal slicing";
-                                        print->process();
-                                    }
-                                    else {
-                                        BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": load cached data success, go on.";
-#if defined(__linux__) || defined(__LINUX__)
-                                        if (g_cli_callback_mgr.is_started()) {
-                                            PrintBase::SlicingStatus slicing_status{69, "Cache data loaded"};
-                                            cli_status_callback(slicing_status);
-                                        }
-#endif
-                                        print->process(nullptr, true);
-                                        BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": finished print::process.";
-                                    }
-                                }
-                                else {
-                                    print->process(&time_using_cache);
-                                    BOOST_LOG_TRIVIAL(info) << "print::process: first time_using_cache is " << time_using_cache << " secs.";
-                                }
-                                if (printer_technology == ptFFF) {
-                                    std::string conflict_result = print_fff->get_conflict_string();
-                                    if (!conflict_result.empty()) {
-                                       BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": found slicing result conflict!"<< std::endl;
-                                       record_exit_reson(outfile_dir, CLI_GCODE_PATH_CONFLICTS, index+1, cli_errors[CLI_GCODE_PATH_CONFLICTS], sliced_info);
-                                       flush_and_exit(CLI_GCODE_PATH_CONFLICTS);
-                                    }
-
-                                    //check the warnings
-                                    if (!g_slicing_warnings.empty())
-                                    {
-                                        for (unsigned int i = 0; i < g_slicing_warnings.size(); i++)
-                                        {
-                                            PrintBase::SlicingStatus& status = g_slicing_warnings[i];
-                                            if ((status.warning_step != -1) && (status.message_type != PrintStateBase::SlicingDefaultNotification))
-                                            {
-                                                sliced_plate_info.warning_message = status.text;
-
-                                                if (status.warning_level == PrintStateBase::WarningLevel::NON_CRITICAL) {
-                                                    BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": found NON_CRITICAL slicing warnings: "<<status.text <<std::endl;
-                                                }
-                                                else {
-                                                    BOOST_LOG_TRIVIAL(warning) << boost::format("plate %1%: found slicing warnings: %2%, no_check=%3%")%(index+1) %status.text %no_check;
-                                                    if (!no_check) {
-                                                        //only following message will be reported under import mode
-                                                        if (status.message_type == PrintStateBase::SlicingEmptyGcodeLayers
-                                                            || status.message_type == PrintStateBase::SlicingGcodeOverlap)
-                                                        {
-                                                            sliced_info.sliced_plates.push_back(sliced_plate_info);
-                                                            record_exit_reson(outfile_dir, CLI_SLICING_ERROR, index+1, cli_errors[CLI_SLICING_ERROR], sliced_info);
-                                                            flush_and_exit(CLI_SLICING_ERROR);
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        g_slicing_warnings.clear();
-                                    }
-                                    sliced_plate_info.triangle_count = plate_triangle_counts[index];
-
-                                    // The outfile is processed by a PlaceholderParser.
-                                    //outfile = part_plate->get_tmp_gcode_path();
-                                    if (outfile_dir.empty()) {
-                                        outfile = part_plate->get_tmp_gcode_path();
-                                    }
-                                    else {
-                                        outfile = outfile_dir + "/plate_" + std::to_string(index + 1) + ".gcode";
-                                        part_plate->set_tmp_gcode_path(outfile);
-                                    }
-                                    BOOST_LOG_TRIVIAL(info) << "process finished, will export gcode temporily to " << outfile << std::endl;
-                                    temp_time = (long long)Slic3r::Utils::get_current_time_utc();
-                                    outfile = print_fff->export_gcode(outfile, gcode_result, nullptr);
-                                    time_using_cache = time_using_cache + ((long long)Slic3r::Utils::get_current_time_utc() - temp_time);
-                                    BOOST_LOG_TRIVIAL(info) << "export_gcode finished: time_using_cache update to " << time_using_cache << " secs.";
-
-                                    //outfile_final = (dynamic_cast<Print*>(print))->print_statistics().finalize_output_path(outfile);
-                                    //m_fff_print->export_gcode(m_temp_output_path, m_gcode_result, [this](const ThumbnailsParams& params) { return this->render_thumbnails(params); });
-                                }/* else {
-                                    outfile = sla_print.output_filepath(outfile);
-                                    // We need to finalize the filename beforehand because the export function sets the filename inside the zip metadata
-                                    outfile_final = sla_print.print_statistics().finalize_output_path(outfile);
-                                    sla_archive.export_print(outfile_final, sla_print);
-                                }*/
-                                /*if (outfile != outfile_final) {
-                                    if (Slic3r::rename_file(outfile, outfile_final)) {
-                                        boost::nowide::cerr << "Renaming file " << outfile << " to " << outfile_final << " failed" << std::endl;
-                                        record_exit_reson(outfile_dir, 1, index+1, cli_errors[1], sliced_info);
-                                        flush_and_exit(1);
-                                    }
-                                    outfile = outfile_final;
-                                }*/
-                                // Run the post-processing scripts if defined.
-                                //run_post_process_scripts(outfile, print->full_print_config());
-                                BOOST_LOG_TRIVIAL(info) << "Slicing result exported to " << outfile << std::endl;
-                                part_plate->update_slice_result_valid_state(true);
-#if defined(__linux__) || defined(__LINUX__)
-                                if (g_cli_callback_mgr.is_started()) {
-                                    PrintBase::SlicingStatus slicing_status{100, "Slicing finished"};
-                                    cli_status_callback(slicing_status);
-                                }
-#endif
-                                if (export_slicedata) {
-                                    BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ":will export Slicing data to " << export_slice_data_dir;
-                                    std::string plate_dir = export_slice_data_dir+"/"+std::to_string(index+1);
-                                    bool with_space = (get_logging_level() >= 4)?true:false;
-                                    int ret = print->export_cached_data(plate_dir, with_space);
-                                    if (ret) {
-                                        BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": export Slicing data error, ret=" << ret;
-                                        export_slicedata_error = true;
-                                        if (fs::exists(plate_dir))
-                                            fs::remove_all(plate_dir);
-                                        record_exit_reson(outfile_dir, ret, index+1, cli_errors[ret], sliced_info);
-                                        flush_and_exit(ret);
-                                    }
-                                }
-                                end_time = (long long)Slic3r::Utils::get_current_time_utc();
-                                sliced_plate_info.sliced_time = end_time - start_time;
-                                sliced_plate_info.sliced_time_with_cache = time_using_cache;
-
-                                if (max_slicing_time_per_plate != 0) {
-                                    long long time_cost = end_time - start_time;
-                                    if (time_cost > max_slicing_time_per_plate) {
-                                        sliced_plate_info.warning_message = (boost::format("plate %1%'s slice time %2% exceeds the limit %3%, return error.")%(index+1) %time_cost %max_slicing_time_per_plate).str();
-                                        BOOST_LOG_TRIVIAL(error) << sliced_plate_info.warning_message;
-                                        sliced_info.sliced_plates.push_back(sliced_plate_info);
-                                        record_exit_reson(outfile_dir, CLI_SLICING_TIME_EXCEEDS_LIMIT, index+1, cli_errors[CLI_SLICING_TIME_EXCEEDS_LIMIT], sliced_info);
-                                        flush_and_exit(CLI_SLICING_TIME_EXCEEDS_LIMIT);
-                                    }
-                                }
-                                sliced_info.sliced_plates.push_back(sliced_plate_info);
                             } catch (const std::exception &ex) {
                                 BOOST_LOG_TRIVIAL(error) << "found slicing or export error for partplate "<<index+1 << std::endl;
                                 boost::nowide::cerr << ex.what() << std::endl;
-                                //continue;
                                 record_exit_reson(outfile_dir, CLI_SLICING_ERROR, index+1, cli_errors[CLI_SLICING_ERROR], sliced_info);
                                 flush_and_exit(CLI_SLICING_ERROR);
                             }
+                            if (parallel_plates > 1) {
+                                job.prepare_time = (long long)Slic3r::Utils::get_current_time_utc() - start_time;
+                                plate_jobs.emplace_back(std::move(job));
+                                continue;
+                            }
+                            slice_plate(job);
+                            if (int ret = finish_plate(job))
+                                flush_and_exit(ret);
                         }
                     }
                     if (pre_check&& (partplate_list.get_plate_count() > 1))
@@ -5140,6 +5338,37 @@ int CLI::run(int argc, char **argv)
                         finished = true;
                 }//end for partplate
 
+                if (!plate_jobs.empty()) {
+                    // Slice the prepared plates, parallel_plates of them at a time. Each Print::process() still runs
+                    // its own steps in parallel on the shared TBB thread pool.
+                    const size_t num_workers = std::min<size_t>(parallel_plates, plate_jobs.size());
+                    BOOST_LOG_TRIVIAL(info) << boost::format("slicing %1% plates, %2% at a time")%plate_jobs.size() %num_workers;
+                    std::atomic<size_t> next_job { 0 };
+                    auto worker = [&]() {
+                        for (size_t i = next_job ++; i < plate_jobs.size(); i = next_job ++) {
+                            PlateSliceJob &job = plate_jobs[i];
+                            // Don't count the time the plate was waiting for a worker.
+                            job.start_time = (long long)Slic3r::Utils::get_current_time_utc() - job.prepare_time;
+                            job.print->set_status_callback([&job](const PrintBase::SlicingStatus &slicing_status) {
+                                if (slicing_status.warning_step != -1)
+                                    job.warnings.push_back(slicing_status);
+                                BOOST_LOG_TRIVIAL(debug) << boost::format("plate %1%: percent=%2%, warning_step=%3%, message=%4%")%(job.index+1) %slicing_status.percent %slicing_status.warning_step %slicing_status.text;
+                            });
+                            slice_plate(job);
+                        }
+                    };
+                    std::vector<boost::thread> workers;
+                    workers.reserve(num_workers);
+                    for (size_t i = 0; i < num_workers; ++ i)
+                        workers.emplace_back(create_thread(worker));
+                    for (boost::thread &t : workers)
+                        t.join();
+                    for (PlateSliceJob &job : plate_jobs)
+                        if (int ret = finish_plate(job))
+                            flush_and_exit(ret);
+                    plate_jobs.clear();
+                }
+
 #if defined(__linux__) || defined(__LINUX__)
                 if (g_cli_callback_mgr.is_started()) {
                     int plate_count = (plate_to_slice== 0)?partplate_list.get_plate_count():1;
@@ -5941,6 +6170,318 @@ int CLI::run(int argc, char **argv)
     return 0;
 }
 
+//BBS: daemon mode. The jobs are sliced one by one by the same process, which keeps the TBB thread pool
+// and the parsed setting files (see g_cli_config_cache) between the jobs.
+// Requests are JSON lines: {"id": ..., "args": ["--slice", "0", ...]} submits a job with the same arguments
+// as the command line, {"cancel": id} cancels a job, {"exit": true} stops the daemon.
+// Each job is answered by {"id": ..., "return_code": ..., "error_string": ...}.
+struct CLIDaemonJob {
+    json                        id;
+    std::vector<std::string>    args;
+};
+
+// Returns false and fills in error if the request does not submit a job.
+static bool daemon_parse_job(const json &request, CLIDaemonJob &job, std::string &error)
+{
+    auto it = request.find("args");
+    if (it == request.end() || !it->is_array()) {
+        error = "invalid request";
+        return false;
+    }
+    job.id = request.value("id", json());
+    job.args.clear();
+    for (const json &arg : *it) {
+        if (!arg.is_string()) {
+            error = "the job arguments have to be strings";
+            return false;
+        }
+        job.args.emplace_back(arg.get<std::string>());
+    }
+    return true;
+}
+
+static json daemon_job_result(const json &id, int ret)
+{
+    json j;
+    j["id"] = id;
+    j["return_code"] = ret;
+    auto it = cli_errors.find(ret);
+    j["error_string"] = (it == cli_errors.end()) ? std::string() : it->second;
+    return j;
+}
+
+// Clear what the previous job left in the globals of the CLI. The parsed setting files (g_cli_config_cache) are kept,
+// the models and the presets are loaded again by every job.
+static void daemon_reset_job_state()
+{
+    g_slicing_warnings.clear();
+    {
+        std::lock_guard<std::mutex> lock(g_cli_active_prints_mutex);
+        g_cli_active_prints.clear();
+    }
+}
+
+static int daemon_run_job(const std::string &argv0, const CLIDaemonJob &job)
+{
+    std::vector<std::string> argv_strings;
+    argv_strings.reserve(job.args.size() + 1);
+    argv_strings.emplace_back(argv0);
+    argv_strings.insert(argv_strings.end(), job.args.begin(), job.args.end());
+    std::vector<char*> argv_ptrs;
+    for (std::string &arg : argv_strings)
+        argv_ptrs.emplace_back(arg.data());
+    argv_ptrs.emplace_back(nullptr);
+
+    BOOST_LOG_TRIVIAL(info) << "daemon: start job " << job.id.dump();
+    daemon_reset_job_state();
+    int ret = CLI_SLICING_ERROR;
+    try {
+        ret = CLI().run(int(argv_strings.size()), argv_ptrs.data());
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "daemon: job " << job.id.dump() << " failed: " << ex.what();
+    }
+    if (g_cli_cancel_requested && ret != CLI_SUCCESS)
+        ret = CLI_SLICING_CANCELED;
+    BOOST_LOG_TRIVIAL(info) << "daemon: job " << job.id.dump() << " finished, return " << ret;
+    return ret;
+}
+
+// Jobs are read from stdin and queued, the replies are written to stdout.
+static int daemon_run_stdio(const std::string &argv0)
+{
+    // stdout carries the replies only, the output of the jobs is redirected to stderr.
+    std::ostream     replies(boost::nowide::cout.rdbuf());
+    std::streambuf  *cout_buf = boost::nowide::cout.rdbuf(boost::nowide::cerr.rdbuf());
+    std::mutex       replies_mutex;
+    auto reply = [&replies, &replies_mutex](const json &j) {
+        std::lock_guard<std::mutex> lock(replies_mutex);
+        replies << j.dump() << std::endl;
+    };
+
+    std::mutex                  mutex;
+    std::condition_variable     condition;
+    std::deque<CLIDaemonJob>    queue;
+    json                        running_id;
+    bool                        running = false;
+    bool                        input_closed = false;
+
+    boost::thread reader = create_thread([&]() {
+        std::string line;
+        while (std::getline(boost::nowide::cin, line)) {
+            if (line.empty())
+                continue;
+            json request = json::parse(line, nullptr, false);
+            if (request.is_discarded() || !request.is_object()) {
+                reply(json{ { "error", "invalid request" } });
+                continue;
+            }
+            if (request.value("exit", false))
+                break;
+            std::unique_lock<std::mutex> lock(mutex);
+            if (auto it_cancel = request.find("cancel"); it_cancel != request.end()) {
+                if (running && running_id == *it_cancel) {
+                    BOOST_LOG_TRIVIAL(info) << "daemon: cancel the running job " << it_cancel->dump();
+                    cli_cancel_running_job();
+                } else if (auto it = std::find_if(queue.begin(), queue.end(), [&it_cancel](const CLIDaemonJob &job){ return job.id == *it_cancel; });
+                           it != queue.end()) {
+                    json id = std::move(it->id);
+                    queue.erase(it);
+                    lock.unlock();
+                    reply(daemon_job_result(id, CLI_SLICING_CANCELED));
+                }
+                continue;
+            }
+            CLIDaemonJob job;
+            std::string  error;
+            if (daemon_parse_job(request, job, error)) {
+                queue.emplace_back(std::move(job));
+                condition.notify_one();
+            } else {
+                lock.unlock();
+                reply(json{ { "id", request.value("id", json()) }, { "error", error } });
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        input_closed = true;
+        condition.notify_one();
+    });
+
+    for (;;) {
+        CLIDaemonJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&queue, &input_closed]() { return !queue.empty() || input_closed; });
+            if (queue.empty())
+                break;
+            job = std::move(queue.front());
+            queue.pop_front();
+            running    = true;
+            running_id = job.id;
+            g_cli_cancel_requested = false;
+        }
+        int ret = daemon_run_job(argv0, job);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        reply(daemon_job_result(job.id, ret));
+    }
+    reader.join();
+    boost::nowide::cout.rdbuf(cout_buf);
+    return CLI_SUCCESS;
+}
+
+#ifndef _WIN32
+// Read a line from a socket. Returns false at the end of stream or on error.
+static bool daemon_read_line(int fd, std::string &buffer, std::string &line)
+{
+    for (;;) {
+        if (size_t pos = buffer.find('\n'); pos != std::string::npos) {
+            line = buffer.substr(0, pos);
+            buffer.erase(0, pos + 1);
+            return true;
+        }
+        char    data[4096];
+        ssize_t n = ::recv(fd, data, sizeof(data), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buffer.append(data, size_t(n));
+    }
+}
+
+static void daemon_write_line(int fd, const std::string &line)
+{
+    std::string data = line + "\n";
+    for (size_t written = 0; written < data.size();) {
+        ssize_t n = ::send(fd, data.data() + written, data.size() - written, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            BOOST_LOG_TRIVIAL(warning) << "daemon: failed to send the reply, errno " << errno;
+            return;
+        }
+        written += size_t(n);
+    }
+}
+
+// Remove a stale socket left at the path by a previous daemon. Anything else at the path is not touched.
+// Returns false if the path exists and it is not a socket.
+static bool daemon_remove_socket(const std::string &socket_path)
+{
+    struct stat st;
+    if (::lstat(socket_path.c_str(), &st) != 0)
+        return errno == ENOENT;
+    if (! S_ISSOCK(st.st_mode))
+        return false;
+    ::unlink(socket_path.c_str());
+    return true;
+}
+
+// Each connection submits a single job and waits for its reply. {"cancel": id} received through the connection
+// while the job is running or closing the connection cancels the job.
+static int daemon_run_socket(const std::string &argv0, const std::string &socket_path)
+{
+    // A client closing the connection early shall not kill the daemon.
+    ::signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        boost::nowide::cerr << "daemon: socket path too long: " << socket_path << std::endl;
+        return CLI_INVALID_PARAMS;
+    }
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    if (! daemon_remove_socket(socket_path)) {
+        boost::nowide::cerr << "daemon: " << socket_path << " exists and it is not a socket" << std::endl;
+        return CLI_ENVIRONMENT_ERROR;
+    }
+    int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0 || ::bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(server, 16) < 0) {
+        boost::nowide::cerr << "daemon: can not listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        if (server >= 0)
+            ::close(server);
+        return CLI_ENVIRONMENT_ERROR;
+    }
+    BOOST_LOG_TRIVIAL(warning) << "daemon: listening on " << socket_path;
+
+    for (bool exit_requested = false; ! exit_requested;) {
+        int client = ::accept(server, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR)
+                continue;
+            BOOST_LOG_TRIVIAL(error) << "daemon: accept failed, errno " << errno;
+            break;
+        }
+        std::string buffer, line;
+        json        request;
+        if (daemon_read_line(client, buffer, line))
+            request = json::parse(line, nullptr, false);
+        CLIDaemonJob job;
+        std::string  error;
+        if (request.is_object() && request.value("exit", false))
+            exit_requested = true;
+        else if (! request.is_object() || ! daemon_parse_job(request, job, error))
+            daemon_write_line(client, json{ { "error", error.empty() ? std::string("invalid request") : error } }.dump());
+        else {
+            g_cli_cancel_requested = false;
+            std::mutex job_mutex;
+            bool       job_done = false;
+            // Watch the connection for a cancellation while the job is running.
+            boost::thread watcher = create_thread([client, &buffer, &job, &job_mutex, &job_done]() {
+                std::string line;
+                while (daemon_read_line(client, buffer, line)) {
+                    json request = json::parse(line, nullptr, false);
+                    if (request.is_object() && request.contains("cancel") && request["cancel"] == job.id)
+                        break;
+                }
+                // Canceled or the client disconnected.
+                std::lock_guard<std::mutex> lock(job_mutex);
+                if (! job_done) {
+                    BOOST_LOG_TRIVIAL(info) << "daemon: cancel the running job " << job.id.dump();
+                    cli_cancel_running_job();
+                }
+            });
+            int ret = daemon_run_job(argv0, job);
+            {
+                std::lock_guard<std::mutex> lock(job_mutex);
+                job_done = true;
+            }
+            // Wake up the watcher.
+            ::shutdown(client, SHUT_RD);
+            watcher.join();
+            daemon_write_line(client, daemon_job_result(job.id, ret).dump());
+        }
+        ::close(client);
+    }
+    ::close(server);
+    daemon_remove_socket(socket_path);
+    return CLI_SUCCESS;
+}
+#endif // _WIN32
+
+int CLI::run_daemon(const std::string &argv0, const std::string &endpoint)
+{
+    BOOST_LOG_TRIVIAL(warning) << "daemon mode on " << endpoint;
+    g_cli_daemon_mode = true;
+    int ret = CLI_SUCCESS;
+    if (endpoint == "-")
+        ret = daemon_run_stdio(argv0);
+    else {
+#ifdef _WIN32
+        boost::nowide::cerr << "daemon: UNIX sockets are not supported on this platform, use \"-\" for stdin / stdout" << std::endl;
+        ret = CLI_INVALID_PARAMS;
+#else
+        ret = daemon_run_socket(argv0, endpoint);
+#endif
+    }
+    g_cli_daemon_mode = false;
+    g_cli_config_cache.clear();
+    return ret;
+}
+
 bool CLI::setup(int argc, char **argv)
 {
     // Detect the operating system flavor after SLIC3R_LOGLEVEL is set.
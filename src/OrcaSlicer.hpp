@@ -112,6 +112,9 @@ private:
 
     bool setup(int argc, char **argv);
 
+    /// Keeps running and slices the jobs received from endpoint: "-" for stdin / stdout, otherwise the path of a UNIX socket.
+    static int run_daemon(const std::string &argv0, const std::string &endpoint);
+
     /// Prints usage of the CLI.
     void print_help(bool include_print_options = false, PrinterTechnology printer_technology = ptAny) const;
 
@@ -7,12 +7,15 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <iterator>
 #include <limits>
 #include <type_traits>
 #include <vector>
 
 #include <Eigen/Geometry>
 
+#include <tbb/parallel_invoke.h>
+
 #include "BoundingBox.hpp"
 #include "Utils.hpp" // for next_highest_power_of_2()
 
@@ -145,10 +148,21 @@ private:
 		// Insert an inner node into the tree. Inner node does not reference any input entity (triangle, line segment etc).
 		m_nodes[node].idx  = inner;
 		m_nodes[node].bbox = bbox;
-        build_recursive(input, node * 2 + 1, left, center);
-		build_recursive(input, node * 2 + 2, center + 1, right);
+		if (right - left >= parallel_build_threshold)
+			// The subtrees reference disjoint ranges of the input and of the nodes, build them in parallel.
+			// The partitioning does not depend on the order of execution, thus the tree is the same as if built serially.
+			tbb::parallel_invoke(
+				[this, &input, node, left, center]() { build_recursive(input, node * 2 + 1, left, center); },
+				[this, &input, node, center, right]() { build_recursive(input, node * 2 + 2, center + 1, right); });
+		else {
+			build_recursive(input, node * 2 + 1, left, center);
+			build_recursive(input, node * 2 + 2, center + 1, right);
+		}
 	}
 
+	// Subtrees over fewer input entities are built serially.
+	static constexpr const size_t parallel_build_threshold = 16384;
+
 	// Partition the input m_nodes <left, right> at "k" and "dimension" using the QuickSelect method:
 	// https://en.wikipedia.org/wiki/Quickselect
 	// Items left of the k'th item are lower than the k'th item in the "dimension", 
@@ -470,6 +484,138 @@ namespace detail {
 		}
 	}
 
+    // Number of rays traversing the tree together in intersect_rays_first_hit().
+    static constexpr const size_t RayPacketSize = 4;
+
+    // Rays stored as structure of arrays, so that a bounding box is tested against all the rays of a packet at once.
+    template<typename Scalar>
+    struct RayPacket {
+        using Lanes = Eigen::Array<Scalar, RayPacketSize, 1>;
+        Lanes origin[3];
+        Lanes invdir[3];
+        // Parameter of the closest hit found so far, -infinity for the unused lanes.
+        Lanes min_t;
+    };
+
+    // Slab test of a bounding box against all the rays of a packet, the vectorized ray_box_intersect_invdir() with t0 = 0 and t1 = min_t.
+    // A box entered exactly at min_t passes, it may contain a hit of the same parameter to be preferred, see intersect_ray_packet_first_hit().
+    // Returns the parameters the rays enter the box at.
+    template<typename Scalar, typename BoundingBox>
+    inline Eigen::Array<bool, RayPacketSize, 1> ray_packet_box_intersect(const RayPacket<Scalar> &packet, const BoundingBox &box, typename RayPacket<Scalar>::Lanes &tmin)
+    {
+        using Lanes = typename RayPacket<Scalar>::Lanes;
+        tmin = Lanes::Constant(-std::numeric_limits<Scalar>::infinity());
+        Lanes tmax = Lanes::Constant(std::numeric_limits<Scalar>::infinity());
+        for (int axis = 0; axis < 3; ++ axis) {
+            const Lanes t1 = (Scalar(box.min()(axis)) - packet.origin[axis]) * packet.invdir[axis];
+            const Lanes t2 = (Scalar(box.max()(axis)) - packet.origin[axis]) * packet.invdir[axis];
+            tmin = tmin.max(t1.min(t2));
+            tmax = tmax.min(t1.max(t2));
+        }
+        return tmin <= tmax && tmin <= packet.min_t && tmax > Scalar(0);
+    }
+
+    // Order of the nodes of the implicit tree in a depth first traversal visiting the left child first.
+    inline bool precedes_depth_first(size_t lhs, size_t rhs)
+    {
+        // Align both nodes to the same level by descending to their leftmost descendants,
+        // the nodes of a level are numbered from left to right.
+        auto level = [](size_t idx) { int l = 0; for (++ idx; idx > 1; idx >>= 1) ++ l; return l; };
+        const int level_lhs = level(lhs);
+        const int level_rhs = level(rhs);
+        ++ lhs;
+        ++ rhs;
+        if (level_lhs < level_rhs)
+            lhs <<= level_rhs - level_lhs;
+        else
+            rhs <<= level_lhs - level_rhs;
+        return lhs < rhs;
+    }
+
+    // Traverse the tree once for up to RayPacketSize rays, returning the same hits as intersect_ray_recursive_first_hit() does.
+    // A node is skipped only if none of the rays of the packet intersects its bounding box. The closer child is visited first,
+    // so that the farther one is likely to be skipped. Of the hits with the same parameter, the one found first by
+    // intersect_ray_recursive_first_hit() is kept.
+    template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+    inline void intersect_ray_packet_first_hit(
+        const std::vector<VertexType>       &vertices,
+        const std::vector<IndexedFaceType>  &faces,
+        const TreeType                      &tree,
+        const std::vector<VectorType>       &origins,
+        const std::vector<VectorType>       &dirs,
+        // Indices of the rays of this packet into origins and dirs.
+        const size_t                        *ray_ids,
+        size_t                               num_rays,
+        std::vector<igl::Hit>               &hits,
+        double                               eps)
+    {
+        using Scalar = typename VectorType::Scalar;
+        using Lanes  = typename RayPacket<Scalar>::Lanes;
+        using Mask   = Eigen::Array<bool, RayPacketSize, 1>;
+        assert(num_rays > 0 && num_rays <= RayPacketSize);
+
+        RayPacket<Scalar> packet;
+        packet.min_t = Lanes::Constant(-std::numeric_limits<Scalar>::infinity());
+        for (size_t lane = 0; lane < RayPacketSize; ++ lane) {
+            // Unused lanes replicate the first ray, they never pass the box test due to their min_t.
+            const size_t     ray    = ray_ids[lane < num_rays ? lane : 0];
+            const VectorType invdir = dirs[ray].cwiseInverse();
+            for (int axis = 0; axis < 3; ++ axis) {
+                packet.origin[axis](lane) = origins[ray](axis);
+                packet.invdir[axis](lane) = invdir(axis);
+            }
+            if (lane < num_rays)
+                packet.min_t(lane) = std::numeric_limits<Scalar>::infinity();
+        }
+        // Tree node of the hit of each lane.
+        size_t hit_node[RayPacketSize];
+
+        // The implicit tree is balanced, thus its depth is logarithmic.
+        size_t stack[128];
+        size_t stack_size = 0;
+        Lanes  tmin;
+        if (ray_packet_box_intersect(packet, tree.node(0).bbox, tmin).any())
+            stack[stack_size ++] = 0;
+        while (stack_size > 0) {
+            const size_t node_idx = stack[-- stack_size];
+            const auto  &node     = tree.node(node_idx);
+            assert(node.is_valid());
+            if (node.is_leaf()) {
+                // Test the box again, min_t may have decreased since the node was pushed.
+                const Mask mask = ray_packet_box_intersect(packet, node.bbox, tmin);
+                const auto face = faces[node.idx];
+                for (size_t lane = 0; lane < num_rays; ++ lane)
+                    if (double t, u, v; mask(lane) &&
+                        intersect_triangle(origins[ray_ids[lane]], dirs[ray_ids[lane]], vertices[face(0)], vertices[face(1)], vertices[face(2)], t, u, v, eps) &&
+                        t > 0. && (float(t) < packet.min_t(lane) || (float(t) == packet.min_t(lane) && precedes_depth_first(node_idx, hit_node[lane])))) {
+                        igl::Hit &hit = hits[ray_ids[lane]];
+                        hit = igl::Hit { int(node.idx), -1, float(u), float(v), float(t) };
+                        packet.min_t(lane) = Scalar(hit.t);
+                        hit_node[lane]     = node_idx;
+                    }
+            } else {
+                const size_t left  = node_idx * 2 + 1;
+                const size_t right = left + 1;
+                Lanes        tmin_left, tmin_right;
+                const Mask   mask_left  = ray_packet_box_intersect(packet, tree.node(left).bbox, tmin_left);
+                const Mask   mask_right = ray_packet_box_intersect(packet, tree.node(right).bbox, tmin_right);
+                const bool   visit_left  = mask_left.any();
+                const bool   visit_right = mask_right.any();
+                assert(stack_size + 2 <= std::size(stack));
+                if (visit_left && visit_right) {
+                    // Visit first the child entered first by the majority of the rays entering both children.
+                    const Mask both       = mask_left && mask_right;
+                    const bool left_first = 2 * (both && tmin_left <= tmin_right).count() >= both.count();
+                    stack[stack_size ++] = left_first ? right : left;
+                    stack[stack_size ++] = left_first ? left : right;
+                } else if (visit_left)
+                    stack[stack_size ++] = left;
+                else if (visit_right)
+                    stack[stack_size ++] = right;
+            }
+        }
+    }
+
     // Real-time collision detection, Ericson, Chapter 5
     template<typename Vector>
     static inline Vector closest_point_to_triangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
@@ -746,6 +892,47 @@ inline bool intersect_ray_first_hit(
         ray_intersector, size_t(0), std::numeric_limits<Scalar>::infinity(), hit);
 }
 
+// Find the first intersections of a batch of rays with indexed triangle set, the same hits as intersect_ray_first_hit() returns for each ray.
+// The rays are traversed in packets of detail::RayPacketSize sharing a single traversal of the tree, which pays off
+// for coherent rays, for example rays cast from a common origin. The rays are processed serially, the caller is
+// expected to process the batches in parallel.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline void intersect_rays_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const std::vector<VectorType>		&origins,
+	// Directions of the rays.
+	const std::vector<VectorType>		&dirs,
+	// First intersection of each ray with the indexed triangle set, hit.id is -1 if the ray does not intersect it.
+	std::vector<igl::Hit> 				&hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+	assert(origins.size() == dirs.size());
+	hits.assign(origins.size(), igl::Hit { -1, -1, 0.f, 0.f, 0.f });
+	if (tree.empty())
+		return;
+	// Rays heading into the same octant are packed together, they are more likely to traverse the same nodes.
+	size_t packets[8][detail::RayPacketSize];
+	size_t packet_sizes[8] = { 0 };
+	for (size_t i = 0; i < dirs.size(); ++ i) {
+		const int octant = (dirs[i].x() < 0) + 2 * (dirs[i].y() < 0) + 4 * (dirs[i].z() < 0);
+		packets[octant][packet_sizes[octant] ++] = i;
+		if (packet_sizes[octant] == detail::RayPacketSize) {
+			detail::intersect_ray_packet_first_hit(vertices, faces, tree, origins, dirs, packets[octant], detail::RayPacketSize, hits, eps);
+			packet_sizes[octant] = 0;
+		}
+	}
+	for (int octant = 0; octant < 8; ++ octant)
+		if (packet_sizes[octant] > 0)
+			detail::intersect_ray_packet_first_hit(vertices, faces, tree, origins, dirs, packets[octant], packet_sizes[octant], hits, eps);
+}
+
 // Find all intersections of a ray with indexed triangle set.
 // Intersection test is calculated with the accuracy of VectorType::Scalar
 // even if the triangle mesh and the AABB Tree are built with floats.
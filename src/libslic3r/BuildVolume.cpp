@@ -328,8 +328,16 @@ BuildVolume::ObjectState BuildVolume::volume_state_bbox(const BoundingBoxf3& vol
 
 bool BuildVolume::all_paths_inside(const GCodeProcessorResult& paths, const BoundingBoxf3& paths_bbox, bool ignore_bottom) const
 {
-    auto move_valid = [](const GCodeProcessorResult::MoveVertex &move) {
-        return move.type == EMoveType::Extrude && move.extrusion_role != erCustom && move.width != 0.f && move.height != 0.f;
+    // Only the columns of the moves needed for the test are read.
+    const GCodeProcessorResult::MoveVertexStore &moves = paths.moves;
+    auto move_valid = [&moves](size_t i) {
+        return moves.type[i] == EMoveType::Extrude && moves.extrusion_role[i] != erCustom && moves.width[i] != 0.f && moves.height[i] != 0.f;
+    };
+    auto all_moves = [&moves](auto pred) {
+        for (size_t i = 0; i < moves.size(); ++ i)
+            if (! pred(i))
+                return false;
+        return true;
     };
     static constexpr const double epsilon = BedEpsilon;
 
@@ -349,19 +357,19 @@ bool BuildVolume::all_paths_inside(const GCodeProcessorResult& paths, const Boun
         const float r = unscaled<double>(m_circle.radius) + epsilon;
         const float r2 = sqr(r);
         return m_max_print_height == 0.0 ? 
-            std::all_of(paths.moves.begin(), paths.moves.end(), [move_valid, c, r2](const GCodeProcessorResult::MoveVertex &move)
-                { return ! move_valid(move) || (to_2d(move.position) - c).squaredNorm() <= r2; }) :
-            std::all_of(paths.moves.begin(), paths.moves.end(), [move_valid, c, r2, z = m_max_print_height + epsilon](const GCodeProcessorResult::MoveVertex& move)
-                { return ! move_valid(move) || ((to_2d(move.position) - c).squaredNorm() <= r2 && move.position.z() <= z); });
+            all_moves([&moves, move_valid, c, r2](size_t i)
+                { return ! move_valid(i) || (to_2d(moves.position[i]) - c).squaredNorm() <= r2; }) :
+            all_moves([&moves, move_valid, c, r2, z = m_max_print_height + epsilon](size_t i)
+                { return ! move_valid(i) || ((to_2d(moves.position[i]) - c).squaredNorm() <= r2 && moves.position[i].z() <= z); });
     }
     case BuildVolume_Type::Convex:
     //FIXME doing test on convex hull until we learn to do test on non-convex polygons efficiently.
     case BuildVolume_Type::Custom:
         return m_max_print_height == 0.0 ?
-            std::all_of(paths.moves.begin(), paths.moves.end(), [move_valid, this](const GCodeProcessorResult::MoveVertex &move) 
-                { return ! move_valid(move) || Geometry::inside_convex_polygon(m_top_bottom_convex_hull_decomposition_bed, to_2d(move.position).cast<double>()); }) :
-            std::all_of(paths.moves.begin(), paths.moves.end(), [move_valid, this, z = m_max_print_height + epsilon](const GCodeProcessorResult::MoveVertex &move)
-                { return ! move_valid(move) || (Geometry::inside_convex_polygon(m_top_bottom_convex_hull_decomposition_bed, to_2d(move.position).cast<double>()) && move.position.z() <= z); });
+            all_moves([&moves, move_valid, this](size_t i)
+                { return ! move_valid(i) || Geometry::inside_convex_polygon(m_top_bottom_convex_hull_decomposition_bed, to_2d(moves.position[i]).cast<double>()); }) :
+            all_moves([&moves, move_valid, this, z = m_max_print_height + epsilon](size_t i)
+                { return ! move_valid(i) || (Geometry::inside_convex_polygon(m_top_bottom_convex_hull_decomposition_bed, to_2d(moves.position[i]).cast<double>()) && moves.position[i].z() <= z); });
     default:
         return true;
     }
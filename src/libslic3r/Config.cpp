@@ -3,7 +3,9 @@
 #include "Utils.hpp"
 #include "LocalesUtils.hpp"
 #include "Preset.hpp"
+#include "GCode/BinaryGCode.hpp"
 
+#include <algorithm>
 #include <assert.h>
 #include <fstream>
 #include <iostream>
@@ -1273,6 +1275,32 @@ private:
 // Load the config keys from the tail of a G-code file.
 ConfigSubstitutions ConfigBase::load_from_gcode_file(const std::string &file, ForwardCompatibilitySubstitutionRule compatibility_rule)
 {
+    if (BinaryGCode::is_binary_gcode_file(file)) {
+        // The configuration of a binary G-code is stored into its slicer metadata block.
+        BinaryGCode::Metadata file_metadata, config_metadata;
+        if (! BinaryGCode::read_metadata(file, BinaryGCode::EBlockType::FileMetadata, file_metadata) ||
+            std::none_of(file_metadata.begin(), file_metadata.end(), [](const auto &kv) { return kv.first == "Producer" && boost::starts_with(kv.second, SLIC3R_APP_NAME); })) {
+            std::string error_message = std::string("Not a gcode file generated by ") + SLIC3R_APP_FULL_NAME + ".";
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << error_message;
+            throw Slic3r::RuntimeError(error_message.c_str());
+        }
+        if (! BinaryGCode::read_metadata(file, BinaryGCode::EBlockType::SlicerMetadata, config_metadata))
+            throw Slic3r::RuntimeError(format("Slicer metadata not found in %1%", file));
+        ConfigSubstitutionContext substitutions_ctxt(compatibility_rule);
+        size_t                    key_value_pairs = 0;
+        for (const auto &[key, value] : config_metadata)
+            try {
+                this->set_deserialize(key, value, substitutions_ctxt);
+                ++ key_value_pairs;
+            } catch (UnknownOptionException & /* e */) {
+                // ignore
+            }
+        if (key_value_pairs < 80)
+            throw Slic3r::RuntimeError(format("Suspiciously low number of configuration values extracted from %1%: %2%", file, key_value_pairs));
+        this->handle_legacy_composite();
+        return std::move(substitutions_ctxt.substitutions);
+    }
+
     // Read a 64k block from the end of the G-code.
 	boost::nowide::ifstream ifs(file);
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before parse_file %1%") % file.c_str();
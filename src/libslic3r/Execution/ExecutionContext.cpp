@@ -0,0 +1,55 @@
+#include "ExecutionContext.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <tbb/version.h>
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/info.h>
+#endif
+
+#include <boost/log/trivial.hpp>
+
+namespace Slic3r {
+
+ExecutionContext::ExecutionContext(const ExecutionParams &params) : m_params(params)
+{
+    if (m_params.is_default_arena())
+        return;
+
+#if TBB_VERSION_MAJOR >= 2021
+    tbb::task_arena::constraints constraints;
+    if (m_params.numa_node >= 0) {
+        // Without the hwloc binding library TBB reports a single node with index -1.
+        std::vector<tbb::numa_node_id> nodes = tbb::info::numa_nodes();
+        if (std::find(nodes.begin(), nodes.end(), m_params.numa_node) != nodes.end())
+            constraints.set_numa_id(m_params.numa_node);
+        else {
+            BOOST_LOG_TRIVIAL(warning) << "ExecutionContext: NUMA node " << m_params.numa_node << " is not available, the NUMA node preference is ignored.";
+            m_params.numa_node = -1;
+        }
+    }
+    if (m_params.threads > 0)
+        constraints.set_max_concurrency(std::min(m_params.threads, tbb::info::default_concurrency(constraints.numa_id)));
+    if (constraints.numa_id >= 0 || constraints.max_concurrency > 0)
+        m_arena = std::make_unique<tbb::task_arena>(constraints);
+#else
+    // The old TBB does not know about the NUMA nodes.
+    if (m_params.numa_node >= 0) {
+        BOOST_LOG_TRIVIAL(warning) << "ExecutionContext: NUMA node preference is not supported by this TBB version, ignored.";
+        m_params.numa_node = -1;
+    }
+    if (m_params.threads > 0)
+        m_arena = std::make_unique<tbb::task_arena>(std::min(m_params.threads, int(tbb::this_task_arena::max_concurrency())));
+#endif
+    if (m_arena)
+        BOOST_LOG_TRIVIAL(info) << "ExecutionContext: created arena with " << m_arena->max_concurrency() << " threads, NUMA node " << m_params.numa_node
+                                << ", " << this->gcode_pipeline_tokens() << " G-code pipeline tokens";
+}
+
+int ExecutionContext::max_concurrency() const
+{
+    return m_arena ? m_arena->max_concurrency() : tbb::this_task_arena::max_concurrency();
+}
+
+} // namespace Slic3r
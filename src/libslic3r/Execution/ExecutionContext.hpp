@@ -0,0 +1,70 @@
+#ifndef slic3r_ExecutionContext_hpp_
+#define slic3r_ExecutionContext_hpp_
+
+#include <cstddef>
+#include <memory>
+
+#include <tbb/task_arena.h>
+
+namespace Slic3r {
+
+// Limits of the parallelism and of the resources of a slicing job.
+struct ExecutionParams
+{
+    // Maximum number of threads working on the job, including the calling thread. 0 for no limit.
+    int     threads { 0 };
+    // Run the job on the threads of this NUMA node, -1 for no preference.
+    // Ignored if TBB was built without the hwloc binding library or the node does not exist.
+    int     numa_node { -1 };
+    // Maximum number of layers in flight in the G-code export pipeline, 0 for the default.
+    size_t  gcode_pipeline_tokens { 0 };
+    // Limit of the G-code held in flight by the export pipeline (generated, but not yet written into the output file) in bytes.
+    // Once reached, the G-code generator pauses until the output catches up. 0 for no limit besides the number of layers in flight.
+    size_t  gcode_memory_limit { 0 };
+    // Maximum number of extruders of a layer ordered exactly to minimize the flush volume, more are ordered by a heuristic. 0 for the default.
+    size_t  max_extruders_exact { 0 };
+
+    // The job runs in the global TBB arena.
+    bool    is_default_arena() const { return threads <= 0 && numa_node < 0; }
+    // Nothing to limit.
+    bool    is_default() const { return this->is_default_arena() && gcode_pipeline_tokens == 0 && gcode_memory_limit == 0 && max_extruders_exact == 0; }
+};
+
+// Execution context of a Print: process() and export_gcode() of a Print with an execution context run inside
+// its own TBB arena, so that several prints sliced by the same process (the parallel plates or the jobs of
+// the daemon) do not compete for all the threads of the global TBB scheduler.
+// An ExecutionContext may be shared by several prints, which then share the threads of its arena.
+class ExecutionContext
+{
+public:
+    // Layers in flight in the G-code export pipeline if not configured.
+    static constexpr const size_t DefaultGCodePipelineTokens = 12;
+
+    explicit ExecutionContext(const ExecutionParams &params);
+    ExecutionContext(const ExecutionContext &) = delete;
+    ExecutionContext& operator=(const ExecutionContext &) = delete;
+
+    const ExecutionParams&  params() const { return m_params; }
+    // Number of threads of the arena, or of the global arena if the parallelism is not limited.
+    int                     max_concurrency() const;
+    size_t                  gcode_pipeline_tokens() const { return m_params.gcode_pipeline_tokens > 0 ? m_params.gcode_pipeline_tokens : DefaultGCodePipelineTokens; }
+
+    // Run fn inside the arena, returns its result. Exceptions thrown by fn are passed to the caller.
+    template<typename Fn>
+    auto                    execute(Fn &&fn) { return m_arena ? m_arena->execute(std::forward<Fn>(fn)) : fn(); }
+
+private:
+    ExecutionParams                     m_params;
+    // Null if the job runs in the global arena.
+    std::unique_ptr<tbb::task_arena>    m_arena;
+};
+
+using ExecutionContextPtr = std::shared_ptr<ExecutionContext>;
+
+// Run fn inside the arena of the context, or directly if there is no context.
+template<typename Fn>
+inline auto execute_in_context(ExecutionContext *context, Fn &&fn) { return context ? context->execute(std::forward<Fn>(fn)) : fn(); }
+
+} // namespace Slic3r
+
+#endif // slic3r_ExecutionContext_hpp_
@@ -470,7 +470,10 @@ std::unique_ptr<sla::RasterBase> SL1Archive::create_raster() const
 
     double gamma = m_cfg.gamma_correction.getFloat();
 
-    return sla::create_raster_grayscale_aa(res, pxdim, gamma, tr);
+    // Most of the display area is empty, the sparse raster keeps the memory
+    // footprint of the layers rasterized in parallel proportional to the
+    // printed area.
+    return sla::create_raster_grayscale_aa_sparse(res, pxdim, gamma, tr);
 }
 
 sla::RasterEncoder SL1Archive::get_encoder() const
@@ -506,7 +509,11 @@ void SL1Archive::export_print(Zipper& zipper,
             std::string imgname = project + string_printf("%.5d", i++) + "." +
                                   rst.extension();
             
-            zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
+            // The layer images are already deflated by the PNG encoder (in
+            // parallel, see SLAArchive::draw_layers). Compressing them again
+            // here would only add serial work without reducing the size.
+            zipper.add_entry(imgname.c_str(), rst.data(), rst.size(),
+                             Zipper::NO_COMPRESSION);
         }
     } catch(std::exception& e) {
         BOOST_LOG_TRIVIAL(error) << e.what();
@@ -8,6 +8,7 @@
 #include "Exception.hpp"
 #include "ExtrusionEntity.hpp"
 #include "EdgeGrid.hpp"
+#include "Execution/ExecutionContext.hpp"
 #include "Geometry/ConvexHull.hpp"
 #include "GCode/PrintExtents.hpp"
 #include "GCode/Thumbnails.hpp"
@@ -25,8 +26,10 @@
 #include <cmath>
 #include <cstdlib>
 #include <chrono>
+#include <deque>
 #include <iostream>
 #include <math.h>
+#include <mutex>
 #include <stdlib.h>
 #include <string>
 #include <utility>
@@ -2368,9 +2371,9 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
     std::string machine_start_gcode = this->placeholder_parser_process("machine_start_gcode", print.config().machine_start_gcode.value, initial_extruder_id);
     if (print.config().gcode_flavor != gcfKlipper) {
         // Set bed temperature if the start G-code does not contain any bed temp control G-codes.
-        this->_print_first_layer_bed_temperature(file, print, machine_start_gcode, initial_extruder_id, true);
+        file.write(this->_print_first_layer_bed_temperature(print, machine_start_gcode, initial_extruder_id, true));
         // Set extruder(s) temperature before and after start G-code.
-        this->_print_first_layer_extruder_temperatures(file, print, machine_start_gcode, initial_extruder_id, false);
+        file.write(this->_print_first_layer_extruder_temperatures(print, machine_start_gcode, initial_extruder_id, false));
     }
 
     // adds tag for processor
@@ -2401,7 +2404,7 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
     }
 */
     if (is_bbl_printers) {
-        this->_print_first_layer_extruder_temperatures(file, print, machine_start_gcode, initial_extruder_id, true);
+        file.write(this->_print_first_layer_extruder_temperatures(print, machine_start_gcode, initial_extruder_id, true));
     }
     // Orca: when activate_air_filtration is set on any extruder, find and set the highest during_print_exhaust_fan_speed
     bool activate_air_filtration        = false;
@@ -2491,75 +2494,10 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
 
         // Do all objects for each layer.
         if (print.config().print_sequence == PrintSequence::ByObject && !has_wipe_tower) {
-            size_t finished_objects = 0;
-            const PrintObject *prev_object = (*print_object_instance_sequential_active)->print_object;
-            for (; print_object_instance_sequential_active != print_object_instances_ordering.end(); ++ print_object_instance_sequential_active) {
-                const PrintObject &object = *(*print_object_instance_sequential_active)->print_object;
-                if (&object != prev_object || tool_ordering.first_extruder() != final_extruder_id) {
-                    tool_ordering = ToolOrdering(object, final_extruder_id);
-                    unsigned int new_extruder_id = tool_ordering.first_extruder();
-                    if (new_extruder_id == (unsigned int)-1)
-                        // Skip this object.
-                        continue;
-                    initial_extruder_id = new_extruder_id;
-                    final_extruder_id   = tool_ordering.last_extruder();
-                    assert(final_extruder_id != (unsigned int)-1);
-                }
-                print.throw_if_canceled();
-                this->set_origin(unscale((*print_object_instance_sequential_active)->shift));
-
-                // BBS: prime extruder if extruder change happens before this object instance
-                bool prime_extruder = false;
-                if (finished_objects > 0) {
-                    // Move to the origin position for the copy we're going to print.
-                    // This happens before Z goes down to layer 0 again, so that no collision happens hopefully.
-                    m_enable_cooling_markers = false; // we're not filtering these moves through CoolingBuffer
-                    m_avoid_crossing_perimeters.use_external_mp_once();
-                    // BBS. change tool before moving to origin point.
-                    if (m_writer.need_toolchange(initial_extruder_id)) {
-                        const PrintObjectConfig& object_config = object.config();
-                        coordf_t initial_layer_print_height = print.config().initial_layer_print_height.value;
-                        file.write(this->set_extruder(initial_extruder_id, initial_layer_print_height, true));
-                        prime_extruder = true;
-                    }
-                    else {
-                        file.write(this->retract());
-                    }
-                    file.write(m_writer.travel_to_z(m_max_layer_z));
-                    file.write(this->travel_to(Point(0, 0), erNone, "move to origin position for next object"));
-                    m_enable_cooling_markers = true;
-                    // Disable motion planner when traveling to first object point.
-                    m_avoid_crossing_perimeters.disable_once();
-                    // Ff we are printing the bottom layer of an object, and we have already finished
-                    // another one, set first layer temperatures. This happens before the Z move
-                    // is triggered, so machine has more time to reach such temperatures.
-                    this->placeholder_parser().set("current_object_idx", int(finished_objects));
-                    std::string printing_by_object_gcode = this->placeholder_parser_process("printing_by_object_gcode", print.config().printing_by_object_gcode.value, initial_extruder_id);
-                    // Set first layer bed and extruder temperatures, don't wait for it to reach the temperature.
-                    this->_print_first_layer_bed_temperature(file, print, printing_by_object_gcode, initial_extruder_id, false);
-                    this->_print_first_layer_extruder_temperatures(file, print, printing_by_object_gcode, initial_extruder_id, false);
-                    file.writeln(printing_by_object_gcode);
-                }
-                // Reset the cooling buffer internal state (the current position, feed rate, accelerations).
-                m_cooling_buffer->reset(this->writer().get_position());
-                m_cooling_buffer->set_current_extruder(initial_extruder_id);
-                // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
-                // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
-                // and export G-code into file.
-                this->process_layers(print, tool_ordering, collect_layers_to_print(object), *print_object_instance_sequential_active - object.instances().data(), file, prime_extruder);
-                //BBS: close powerlost recovery
-                {
-                    if (is_bbl_printers && m_second_layer_things_done) {
-                        file.write("; close powerlost recovery\n");
-                        file.write("M1003 S0\n");
-                    }
-                }
-                ++ finished_objects;
-                // Flag indicating whether the nozzle temperature changes from 1st to 2nd layer were performed.
-                // Reset it when starting another object from 1st layer.
-                m_second_layer_things_done = false;
-                prev_object = &object;
-            }
+            // Process all object instances (sequential mode) with a single parallel pipeline, so that the filters
+            // and the G-code export of one object instance overlap the G-code generation of the next one.
+            this->process_layers(print, tool_ordering, print_object_instance_sequential_active, print_object_instances_ordering.cend(),
+                initial_extruder_id, final_extruder_id, file);
         } else {
             // Sort layers by Z.
             // All extrusion moves with the same top layer height are extruded uninterrupted.
@@ -2748,6 +2686,95 @@ void GCode::check_placeholder_parser_failed()
     }
 }
 
+// Maximum number of layers in flight in the G-code export pipeline.
+static size_t gcode_pipeline_max_tokens(const Print &print)
+{
+    const ExecutionContext *context = print.execution_context();
+    return context ? context->gcode_pipeline_tokens() : ExecutionContext::DefaultGCodePipelineTokens;
+}
+// Maximum size of the G-code in flight in the G-code export pipeline in bytes, zero for no limit.
+static size_t gcode_pipeline_memory_limit(const Print &print)
+{
+    const ExecutionContext *context = print.execution_context();
+    return context ? context->params().gcode_memory_limit : 0;
+}
+// Number of layers (print_z) of which the avoid crossing perimeters boundaries are precomputed at once, in parallel.
+static constexpr const size_t g_avoid_crossing_perimeters_precompute_layers = 32;
+
+// Bookkeeping of the G-code held in flight by the export pipeline. The layers are accounted for by the generator
+// and released by the output stage in the same order, as all the pipeline stages are serial_in_order and each
+// of them passes exactly one LayerResult / string per input.
+// Once the memory limit is reached, the generator stops the pipeline instead of waiting for the output stage:
+// A pipeline filter blocking its TBB worker may leave no thread to the other stages, for example if several plates
+// share a task arena. The stopped pipeline drains the G-code in flight, then run() starts a new pipeline continuing
+// with the next layer. The state of the stages lives outside of the pipeline, thus it survives the restart.
+class GCodePipelineMemory
+{
+public:
+    explicit GCodePipelineMemory(size_t limit) : m_limit(limit) {}
+
+    // Run the pipeline by run_pipeline() until the generator finishes without being paused.
+    template<typename RunPipeline>
+    void run(RunPipeline &&run_pipeline) {
+        do {
+            m_paused    = false;
+            m_generated = 0;
+            run_pipeline();
+        } while (m_paused);
+    }
+    // Called by the generator before generating another layer. If true is returned, the generator shall stop
+    // the pipeline, run() resumes it at the same layer. Each pipeline generates at least one layer,
+    // so that a single layer larger than the limit does not stall the export.
+    bool pause() {
+        if (m_limit == 0 || m_generated == 0)
+            return false;
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            if (m_in_flight < m_limit)
+                return false;
+        }
+        m_paused = true;
+        ++ m_num_pauses;
+        return true;
+    }
+    // Called by the generator with the size of the G-code of a generated layer.
+    void acquire(size_t bytes) {
+        ++ m_generated;
+        std::lock_guard<std::mutex> lck(m_mutex);
+        m_sizes.push_back(bytes);
+        m_in_flight += bytes;
+        m_peak_in_flight = std::max(m_peak_in_flight, m_in_flight);
+        m_peak_layer     = std::max(m_peak_layer, bytes);
+    }
+    // Called by the output stage after a layer was written.
+    void release() {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        assert(! m_sizes.empty());
+        m_in_flight -= m_sizes.front();
+        m_sizes.pop_front();
+    }
+
+    void log_statistics() const {
+        BOOST_LOG_TRIVIAL(info) << "G-code export pipeline: peak G-code in flight " << format_memsize_MB(m_peak_in_flight)
+                                << ", largest layer " << format_memsize_MB(m_peak_layer)
+                                << (m_limit > 0 ? ", limit " + format_memsize_MB(m_limit) + ", paused " + std::to_string(m_num_pauses) + " times" : std::string())
+                                << log_memory_info();
+    }
+
+private:
+    const size_t            m_limit;
+    // Accessed by the generator stage only, or between the pipeline runs.
+    bool                    m_paused         { false };
+    size_t                  m_generated      { 0 };
+    size_t                  m_num_pauses     { 0 };
+    // Shared by the generator and by the output stage.
+    std::mutex              m_mutex;
+    std::deque<size_t>      m_sizes;
+    size_t                  m_in_flight      { 0 };
+    size_t                  m_peak_in_flight { 0 };
+    size_t                  m_peak_layer     { 0 };
+};
+
 // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
 // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
 // and export G-code into file.
@@ -2758,10 +2785,11 @@ void GCode::process_layers(
     const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
     GCodeOutputStream                                                   &output_stream)
 {
+    GCodePipelineMemory pipeline_memory(gcode_pipeline_memory_limit(print));
     // The pipeline is variable: The vase mode filter is optional.
     size_t layer_to_print_idx = 0;
     const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> LayerResult {
+        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx, &pipeline_memory](tbb::flow_control& fc) -> LayerResult {
             if (layer_to_print_idx >= layers_to_print.size()) {
                 if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
                     fc.stop();
@@ -2770,9 +2798,24 @@ void GCode::process_layers(
                     // Pressure equalizer need insert empty input. Because it returns one layer back.
                     // Insert NOP (no operation) layer;
                     ++layer_to_print_idx;
+                    pipeline_memory.acquire(0);
                     return LayerResult::make_nop_layer_result();
                 }
             } else {
+                if (pipeline_memory.pause()) {
+                    // Let the other stages drain the G-code in flight, the pipeline is restarted at this layer.
+                    fc.stop();
+                    return {};
+                }
+                if (m_config.reduce_crossing_wall && layer_to_print_idx % g_avoid_crossing_perimeters_precompute_layers == 0) {
+                    // Precompute the boundaries of the next layers in parallel, not on the thread generating the G-code.
+                    std::vector<const Layer*> layers;
+                    for (size_t i = layer_to_print_idx; i < std::min(layers_to_print.size(), layer_to_print_idx + g_avoid_crossing_perimeters_precompute_layers); ++ i)
+                        for (const LayerToPrint &layer_to_print : layers_to_print[i].second)
+                            if (const Layer *layer = layer_to_print.layer(); layer != nullptr)
+                                layers.emplace_back(layer);
+                    m_avoid_crossing_perimeters.precompute_layers(layers);
+                }
                 const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
                 const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
                 print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
@@ -2781,7 +2824,9 @@ void GCode::process_layers(
                 //BBS
                 check_placeholder_parser_failed();
                 print.throw_if_canceled();
-                return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
+                LayerResult result = this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
+                pipeline_memory.acquire(result.gcode.size());
+                return result;
             }
         });
     if (m_spiral_vase) {
@@ -2815,7 +2860,10 @@ void GCode::process_layers(
         );
     
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+        [&output_stream, &pipeline_memory](std::string s) {
+            output_stream.write(s);
+            pipeline_memory.release();
+        }
     );
 
     const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
@@ -2839,50 +2887,183 @@ void GCode::process_layers(
     });
 
     // The pipeline elements are joined using const references, thus no copying is performed.
-    if (m_spiral_vase && m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
-    else if (m_spiral_vase)
-    	tbb::parallel_pipeline(12, generator & spiral_mode & cooling & fan_mover & output);
-    else if	(m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
-    else
-    	tbb::parallel_pipeline(12, generator & cooling & fan_mover & pa_processor_filter & output);
+    pipeline_memory.run([&]() {
+        if (m_spiral_vase && m_pressure_equalizer)
+            tbb::parallel_pipeline(gcode_pipeline_max_tokens(print), generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
+        else if (m_spiral_vase)
+            tbb::parallel_pipeline(gcode_pipeline_max_tokens(print), generator & spiral_mode & cooling & fan_mover & output);
+        else if (m_pressure_equalizer)
+            tbb::parallel_pipeline(gcode_pipeline_max_tokens(print), generator & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
+        else
+            tbb::parallel_pipeline(gcode_pipeline_max_tokens(print), generator & cooling & fan_mover & pa_processor_filter & output);
+    });
+    pipeline_memory.log_statistics();
 }
 
-// Process all layers of a single object instance (sequential mode) with a parallel pipeline:
+// Process all layers of all object instances (sequential mode) with a single parallel pipeline:
 // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
 // and export G-code into file.
+// The object instances used to be processed by a pipeline each, which was drained before the next object instance
+// was started, thus the filters and the G-code export of one object instance never overlapped with the G-code
+// generation of the next one. With many small objects the pipeline was mostly filling up and draining.
+// Now the generator stage walks all the object instances in print order. The travel to the next object instance
+// is generated at the point of the stream where it was generated before and it is carried with the first layer
+// of the next object instance (LayerResult::object_start_gcode), to be exported verbatim bypassing the filters.
 void GCode::process_layers(
-    const Print                             &print,
-    const ToolOrdering                      &tool_ordering,
-    std::vector<LayerToPrint>                layers_to_print,
-    const size_t                             single_object_idx,
-    GCodeOutputStream                       &output_stream,
-    // BBS
-    const bool                               prime_extruder)
+    const Print                                             &print,
+    ToolOrdering                                            &tool_ordering,
+    std::vector<const PrintInstance*>::const_iterator        instance_begin,
+    std::vector<const PrintInstance*>::const_iterator        instance_end,
+    unsigned int                                            &initial_extruder_id,
+    unsigned int                                            &final_extruder_id,
+    GCodeOutputStream                                       &output_stream)
 {
-    // The pipeline is variable: The vase mode filter is optional.
-    size_t layer_to_print_idx = 0;
+    if (instance_begin == instance_end)
+        return;
+
+    const bool                 is_bbl_printers    = print.is_BBL_printer();
+    // State of the generator, only accessed by the generator stage.
+    std::vector<const PrintInstance*>::const_iterator instance_it = instance_begin;
+    const PrintObject         *prev_object        = (*instance_begin)->print_object;
+    const PrintObject         *active_object      = nullptr;
+    size_t                     finished_objects   = 0;
+    size_t                     single_object_idx  = 0;
+    bool                       prime_extruder     = false;
+    bool                       first_object_layer = false;
+    Vec3d                      cooling_buffer_reset_position = Vec3d::Zero();
+    std::vector<LayerToPrint>  layers_to_print;
+    size_t                     layer_to_print_idx = 0;
+    // G-code to be exported in front of the next layer: Closing of the previous object instance and travel to the next one.
+    std::string                object_start_gcode;
+    GCodePipelineMemory        pipeline_memory(gcode_pipeline_memory_limit(print));
+
+    // Prepare printing of the object instance at instance_it. Returns false if the object instance is skipped.
+    auto start_object = [this, &print, &tool_ordering, &initial_extruder_id, &final_extruder_id, &instance_it, &prev_object, &finished_objects,
+                         &single_object_idx, &prime_extruder, &object_start_gcode, &cooling_buffer_reset_position]() -> bool {
+        const PrintObject &object = *(*instance_it)->print_object;
+        if (&object != prev_object || tool_ordering.first_extruder() != final_extruder_id) {
+            tool_ordering = ToolOrdering(object, final_extruder_id);
+            unsigned int new_extruder_id = tool_ordering.first_extruder();
+            if (new_extruder_id == (unsigned int)-1)
+                // Skip this object.
+                return false;
+            initial_extruder_id = new_extruder_id;
+            final_extruder_id   = tool_ordering.last_extruder();
+            assert(final_extruder_id != (unsigned int)-1);
+        }
+        print.throw_if_canceled();
+        this->set_origin(unscale((*instance_it)->shift));
+
+        // BBS: prime extruder if extruder change happens before this object instance
+        prime_extruder = false;
+        if (finished_objects > 0) {
+            // Move to the origin position for the copy we're going to print.
+            // This happens before Z goes down to layer 0 again, so that no collision happens hopefully.
+            m_enable_cooling_markers = false; // we're not filtering these moves through CoolingBuffer
+            m_avoid_crossing_perimeters.use_external_mp_once();
+            // BBS. change tool before moving to origin point.
+            if (m_writer.need_toolchange(initial_extruder_id)) {
+                coordf_t initial_layer_print_height = print.config().initial_layer_print_height.value;
+                object_start_gcode += this->set_extruder(initial_extruder_id, initial_layer_print_height, true);
+                prime_extruder = true;
+            }
+            else {
+                object_start_gcode += this->retract();
+            }
+            object_start_gcode += m_writer.travel_to_z(m_max_layer_z);
+            object_start_gcode += this->travel_to(Point(0, 0), erNone, "move to origin position for next object");
+            m_enable_cooling_markers = true;
+            // Disable motion planner when traveling to first object point.
+            m_avoid_crossing_perimeters.disable_once();
+            // Ff we are printing the bottom layer of an object, and we have already finished
+            // another one, set first layer temperatures. This happens before the Z move
+            // is triggered, so machine has more time to reach such temperatures.
+            this->placeholder_parser().set("current_object_idx", int(finished_objects));
+            std::string printing_by_object_gcode = this->placeholder_parser_process("printing_by_object_gcode", print.config().printing_by_object_gcode.value, initial_extruder_id);
+            // Set first layer bed and extruder temperatures, don't wait for it to reach the temperature.
+            object_start_gcode += this->_print_first_layer_bed_temperature(print, printing_by_object_gcode, initial_extruder_id, false);
+            object_start_gcode += this->_print_first_layer_extruder_temperatures(print, printing_by_object_gcode, initial_extruder_id, false);
+            if (! printing_by_object_gcode.empty()) {
+                object_start_gcode += printing_by_object_gcode;
+                if (printing_by_object_gcode.back() != '\n')
+                    object_start_gcode += '\n';
+            }
+        }
+        single_object_idx             = *instance_it - object.instances().data();
+        cooling_buffer_reset_position = this->writer().get_position();
+        return true;
+    };
+
     const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, single_object_idx, prime_extruder](tbb::flow_control& fc) -> LayerResult {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
+        [this, &print, &tool_ordering, &initial_extruder_id, is_bbl_printers, instance_end, &instance_it, &prev_object, &active_object, &finished_objects,
+         &single_object_idx, &prime_extruder, &first_object_layer, &layers_to_print, &layer_to_print_idx, &object_start_gcode, &cooling_buffer_reset_position, &start_object, &pipeline_memory]
+        (tbb::flow_control& fc) -> LayerResult {
+            while (layer_to_print_idx == layers_to_print.size()) {
+                if (active_object != nullptr) {
+                    // All layers of the active object instance were generated.
+                    //BBS: close powerlost recovery
+                    if (is_bbl_printers && m_second_layer_things_done) {
+                        object_start_gcode += "; close powerlost recovery\n";
+                        object_start_gcode += "M1003 S0\n";
+                    }
+                    ++ finished_objects;
+                    // Flag indicating whether the nozzle temperature changes from 1st to 2nd layer were performed.
+                    // Reset it when starting another object from 1st layer.
+                    m_second_layer_things_done = false;
+                    prev_object   = active_object;
+                    active_object = nullptr;
+                    if (m_pressure_equalizer) {
+                        // Pressure equalizer need insert empty input. Because it returns one layer back.
+                        // Insert NOP (no operation) layer to flush the last layer of the object instance.
+                        pipeline_memory.acquire(0);
+                        return LayerResult::make_nop_layer_result();
+                    }
+                }
+                if (instance_it == instance_end) {
                     fc.stop();
                     return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    ++layer_to_print_idx;
-                    return LayerResult::make_nop_layer_result();
                 }
-            } else {
-                LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
-                //BBS
-                check_placeholder_parser_failed();
-                print.throw_if_canceled();
-                return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, single_object_idx, prime_extruder);
+                if (start_object()) {
+                    active_object      = (*instance_it)->print_object;
+                    layers_to_print    = collect_layers_to_print(*active_object);
+                    layer_to_print_idx = 0;
+                    first_object_layer = true;
+                }
+                ++ instance_it;
+            }
+            if (pipeline_memory.pause()) {
+                // Let the other stages drain the G-code in flight, the pipeline is restarted at this layer.
+                fc.stop();
+                return {};
             }
+            if (m_config.reduce_crossing_wall && layer_to_print_idx % g_avoid_crossing_perimeters_precompute_layers == 0) {
+                // Precompute the boundaries of the next layers in parallel, not on the thread generating the G-code.
+                std::vector<const Layer*> layers;
+                for (size_t i = layer_to_print_idx; i < std::min(layers_to_print.size(), layer_to_print_idx + g_avoid_crossing_perimeters_precompute_layers); ++ i)
+                    if (const Layer *layer = layers_to_print[i].layer(); layer != nullptr)
+                        layers.emplace_back(layer);
+                m_avoid_crossing_perimeters.precompute_layers(layers);
+            }
+            LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
+            print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
+            //BBS
+            check_placeholder_parser_failed();
+            print.throw_if_canceled();
+            const bool  last_layer = &layer == &layers_to_print.back();
+            LayerResult result     = this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), last_layer, nullptr, single_object_idx, prime_extruder);
+            result.last_object_layer = last_layer;
+            if (first_object_layer) {
+                first_object_layer = false;
+                // Reset the cooling buffer internal state (the current position, feed rate, accelerations)
+                // to the state at the end of object_start_gcode, which is not filtered through the cooling buffer.
+                result.object_start_gcode            = std::move(object_start_gcode);
+                result.cooling_buffer_reset          = true;
+                result.cooling_buffer_reset_position = cooling_buffer_reset_position;
+                result.cooling_buffer_reset_extruder = initial_extruder_id;
+                object_start_gcode.clear();
+            }
+            pipeline_memory.acquire(result.gcode.size() + result.object_start_gcode.size());
+            return result;
         });
     if (m_spiral_vase) {
         float nozzle_diameter  = EXTRUDER_CONFIG(nozzle_diameter);
@@ -2890,35 +3071,47 @@ void GCode::process_layers(
         this->m_spiral_vase->set_max_xy_smoothing(max_xy_smoothing);
     }
     const auto spiral_mode = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in)->LayerResult {
+        [&spiral_mode = *this->m_spiral_vase.get()](LayerResult in)->LayerResult {
             if (in.nop_layer_result)
                 return in;
             spiral_mode.enable(in.spiral_vase_enable);
-            bool last_layer = in.layer_id == layers_to_print.size() - 1;
-            return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush };
+            in.gcode = spiral_mode.process_layer(std::move(in.gcode), in.last_object_layer);
+            return in;
         });
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
              return pressure_equalizer->process_layer(std::move(in));
         });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in)->std::string {
+    const auto cooling = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in)->LayerResult {
             if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+                return in;
+            if (in.cooling_buffer_reset) {
+                cooling_buffer.reset(in.cooling_buffer_reset_position);
+                cooling_buffer.set_current_extruder(in.cooling_buffer_reset_extruder);
+            }
+            in.gcode = cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+            return in;
         });
-    const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
-            return pa_processor.process_layer(std::move(in));
+    const auto pa_processor_filter = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [&pa_processor = *this->m_pa_processor](LayerResult in) -> LayerResult {
+            in.gcode = pa_processor.process_layer(std::move(in.gcode));
+            return in;
         }
     );
     
-    const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+    const auto output = tbb::make_filter<LayerResult, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&output_stream, &pipeline_memory](LayerResult in) {
+            // G-code of the travel to this object instance was not filtered, it is exported in front of the first layer.
+            if (! in.object_start_gcode.empty())
+                output_stream.write(in.object_start_gcode);
+            output_stream.write(in.gcode);
+            pipeline_memory.release();
+        }
     );
 
-    const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](std::string in)->std::string {
+    const auto fan_mover = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](LayerResult in)->LayerResult {
 
         if (config.fan_speedup_time.value != 0 || config.fan_kickstart.value > 0) {
             if (fan_mover.get() == nullptr)
@@ -2930,20 +3123,26 @@ void GCode::process_layers(
                     config.fan_speedup_overhangs.value,
                     (float)config.fan_kickstart.value));
             //flush as it's a whole layer
-            return fan_mover->process_gcode(in, true);
+            in.gcode = fan_mover->process_gcode(in.gcode, true);
         }
         return in;
     });
 
     // The pipeline elements are joined using const references, thus no copying is performed.
-    if (m_spiral_vase && m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
-    else if (m_spiral_vase)
-    	tbb::parallel_pipeline(12, generator & spiral_mode & cooling & fan_mover & output);
-    else if	(m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
-    else
-    	tbb::parallel_pipeline(12, generator & cooling & fan_mover & pa_processor_filter & output);
+    pipeline_memory.run([&]() {
+        if (m_spiral_vase && m_pressure_equalizer)
+            tbb::parallel_pipeline(gcode_pipeline_max_tokens(print), generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
+        else if (m_spiral_vase)
+            tbb::parallel_pipeline(gcode_pipeline_max_tokens(print), generator & spiral_mode & cooling & fan_mover & output);
+        else if (m_pressure_equalizer)
+            tbb::parallel_pipeline(gcode_pipeline_max_tokens(print), generator & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
+        else
+            tbb::parallel_pipeline(gcode_pipeline_max_tokens(print), generator & cooling & fan_mover & pa_processor_filter & output);
+    });
+    pipeline_memory.log_statistics();
+
+    // Closing of the last object instance.
+    output_stream.write(object_start_gcode);
 }
 
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override)
@@ -3154,11 +3353,11 @@ int GCode::get_bed_temperature(const int extruder_id, const bool is_first_layer,
 }
 
 
-// Write 1st layer bed temperatures into the G-code.
+// Return G-code setting the 1st layer bed temperatures.
 // Only do that if the start G-code does not already contain any M-code controlling an extruder temperature.
 // M140 - Set Extruder Temperature
 // M190 - Set Extruder Temperature and Wait
-void GCode::_print_first_layer_bed_temperature(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
+std::string GCode::_print_first_layer_bed_temperature(const Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
 {
     // Initial bed temperature based on the first extruder.
     // BBS
@@ -3177,17 +3376,17 @@ void GCode::_print_first_layer_bed_temperature(GCodeOutputStream &file, Print &p
     // Always call m_writer.set_bed_temperature() so it will set the internal "current" state of the bed temp as if
     // the custom start G-code emited these.
     std::string set_temp_gcode = m_writer.set_bed_temperature(bed_temp, wait);
-    if (! temp_set_by_gcode)
-        file.write(set_temp_gcode);
+    return temp_set_by_gcode ? std::string() : set_temp_gcode;
 }
 
-// Write 1st layer extruder temperatures into the G-code.
+// Return G-code setting the 1st layer extruder temperatures.
 // Only do that if the start G-code does not already contain any M-code controlling an extruder temperature.
 // M104 - Set Extruder Temperature
 // M109 - Set Extruder Temperature and Wait
 // RepRapFirmware: G10 Sxx
-void GCode::_print_first_layer_extruder_temperatures(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
+std::string GCode::_print_first_layer_extruder_temperatures(const Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
 {
+    std::string out;
     // Is the bed temperature set by the provided custom G-code?
     int  temp_by_gcode = -1;
     bool include_g10   = print.config().gcode_flavor == gcfRepRapFirmware;
@@ -3203,7 +3402,7 @@ void GCode::_print_first_layer_extruder_temperatures(GCodeOutputStream &file, Pr
             // Set temperature of the first printing extruder only.
             int temp = print.config().nozzle_temperature_initial_layer.get_at(first_printing_extruder_id);
             if (temp > 0)
-                file.write(m_writer.set_temperature(temp, wait, first_printing_extruder_id));
+                out += m_writer.set_temperature(temp, wait, first_printing_extruder_id);
         } else {
             // Set temperatures of all the printing extruders.
             for (unsigned int tool_id : print.extruders()) {
@@ -3215,10 +3414,11 @@ void GCode::_print_first_layer_extruder_temperatures(GCodeOutputStream &file, Pr
                         temp = print.config().idle_temperature.get_at(tool_id);
                 }
                 if (temp > 0)
-                    file.write(m_writer.set_temperature(temp, wait, tool_id));
+                    out += m_writer.set_temperature(temp, wait, tool_id);
             }
         }
     }
+    return out;
 }
 
 inline GCode::ObjectByExtruder& object_by_extruder(
@@ -5105,6 +5305,14 @@ void GCode::GCodeOutputStream::write(const char *what)
     }
 }
 
+void GCode::GCodeOutputStream::write(const std::string &what)
+{
+    // writes string to file
+    fwrite(what.data(), 1, what.size(), this->f);
+    // Layers of G-code may be several megabytes long, don't copy them.
+    m_processor.process_buffer(what);
+}
+
 void GCode::GCodeOutputStream::writeln(const std::string &what)
 {
     if (! what.empty())
@@ -27,6 +27,7 @@
 // ORCA: post processor below used for Dynamic Pressure advance
 #include "GCode/AdaptivePAProcessor.hpp"
 
+#include <atomic>
 #include <memory>
 #include <map>
 #include <set>
@@ -156,6 +157,18 @@ struct LayerResult {
     // It is used for the pressure equalizer because it needs to buffer one layer back.
     bool        nop_layer_result { false };
 
+    // Sequential printing only: G-code finishing the previous object instance and moving to this one (retract, travel,
+    // first layer temperatures, printing_by_object_gcode). Exported verbatim in front of the first layer of an object
+    // instance, bypassing the filters.
+    std::string  object_start_gcode;
+    // Sequential printing only: the cooling buffer is reset to this position and extruder before processing
+    // the first layer of an object instance.
+    bool         cooling_buffer_reset { false };
+    Vec3d        cooling_buffer_reset_position { Vec3d::Zero() };
+    unsigned int cooling_buffer_reset_extruder { 0 };
+    // Sequential printing only: last layer of an object instance, the spiral vase filter finishes the spiral there.
+    bool         last_object_layer { false };
+
     static LayerResult make_nop_layer_result() { return {"", std::numeric_limits<coord_t>::max(), false, false, true}; }
 };
 
@@ -288,7 +301,7 @@ private:
         void close();
 
         // Write a string into a file.
-        void write(const std::string& what) { this->write(what.c_str()); }
+        void write(const std::string& what);
         void write(const char* what);
 
         // Write a string into a file.
@@ -338,17 +351,19 @@ private:
         const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
         const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
         GCodeOutputStream                                                   &output_stream);
-    // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
+    // Process all layers of all object instances (sequential mode) with a single parallel pipeline:
     // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
-    // and export G-code into file.
+    // and export G-code into file. The travel between the object instances is generated in print order
+    // and it is stitched in front of the first layer of the next object instance.
+    // initial_extruder_id / final_extruder_id are updated the same way as by a serial loop over the instances.
     void process_layers(
-        const Print                             &print,
-        const ToolOrdering                      &tool_ordering,
-        std::vector<LayerToPrint>                layers_to_print,
-        const size_t                             single_object_idx,
-        GCodeOutputStream                       &output_stream,
-        // BBS
-        const bool                               prime_extruder = false);
+        const Print                                             &print,
+        ToolOrdering                                            &tool_ordering,
+        std::vector<const PrintInstance*>::const_iterator        instance_begin,
+        std::vector<const PrintInstance*>::const_iterator        instance_end,
+        unsigned int                                            &initial_extruder_id,
+        unsigned int                                            &final_extruder_id,
+        GCodeOutputStream                                       &output_stream);
 
     //BBS
     void check_placeholder_parser_failed();
@@ -576,6 +591,7 @@ private:
     bool                                m_brim_done;
     // Flag indicating whether the nozzle temperature changes from 1st to 2nd layer were performed.
     bool                                m_second_layer_things_done;
+
     // Index of a last object copy extruded.
     std::pair<const PrintObject*, Point> m_last_obj_copy;
 
@@ -604,8 +620,8 @@ private:
     std::string _extrude(const ExtrusionPath &path, std::string description = "", double speed = -1);
     double get_overhang_degree_corr_speed(float speed, double path_degree);
     void print_machine_envelope(GCodeOutputStream &file, Print &print);
-    void _print_first_layer_bed_temperature(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
-    void _print_first_layer_extruder_temperatures(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
+    std::string _print_first_layer_bed_temperature(const Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
+    std::string _print_first_layer_extruder_temperatures(const Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
     // On the first printing layer. This flag triggers first layer speeds.
     //BBS
     bool    on_first_layer() const { return m_layer != nullptr && m_layer->id() == 0 && abs(m_layer->bottom_z()) < EPSILON; }
@@ -13,6 +13,9 @@
 #include <unordered_set>
 #include <boost/range/adaptor/reversed.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 //#define AVOID_CROSSING_PERIMETERS_DEBUG_OUTPUT
 
 namespace Slic3r {
@@ -24,6 +27,8 @@ struct TravelPoint
     int   border_idx;
     // simplify_travel() doesn't remove this point.
     bool  do_not_remove = false;
+    // Index of the vertex of Boundary::boundaries_offset this point was taken from, -1 otherwise.
+    int   vertex_idx    = -1;
 };
 
 struct Intersection
@@ -422,9 +427,28 @@ static Direction get_shortest_direction(const AvoidCrossingPerimeters::Boundary
 }
 
 // Straighten the travel path as long as it does not collide with the contours stored in edge_grid.
-static std::vector<TravelPoint> simplify_travel(const AvoidCrossingPerimeters::Boundary &boundary, const std::vector<TravelPoint> &travel)
+static std::vector<TravelPoint> simplify_travel(AvoidCrossingPerimeters::Boundary &boundary, const std::vector<TravelPoint> &travel)
 {
     FirstIntersectionVisitor visitor(boundary.grid);
+    // Does the segment between the two points cross any boundary? The answers for pairs of boundary vertices are stored
+    // into the visibility graph of the boundary, where they are reused by the following travels over the same layer.
+    auto intersects = [&boundary, &visitor](const TravelPoint &current, const TravelPoint &next) {
+        visitor.pt_current = &current.point;
+        visitor.pt_next    = &next.point;
+        visitor.intersect  = false;
+        if (current.vertex_idx < 0 || next.vertex_idx < 0) {
+            boundary.grid.visit_cells_intersecting_line(*visitor.pt_current, *visitor.pt_next, visitor);
+            return visitor.intersect;
+        }
+        const uint64_t key = (uint64_t(current.vertex_idx) << 32) | uint64_t(next.vertex_idx);
+        if (auto it = boundary.visibility_graph.find(key); it != boundary.visibility_graph.end())
+            return ! it->second;
+        boundary.grid.visit_cells_intersecting_line(*visitor.pt_current, *visitor.pt_next, visitor);
+        // Bound the memory held by the visibility graph of a single layer.
+        if (boundary.visibility_graph.size() < (size_t(1) << 18))
+            boundary.visibility_graph.emplace(key, ! visitor.intersect);
+        return visitor.intersect;
+    };
     std::vector<TravelPoint> simplified_path;
     simplified_path.reserve(travel.size());
     simplified_path.emplace_back(travel.front());
@@ -433,10 +457,9 @@ static std::vector<TravelPoint> simplify_travel(const AvoidCrossingPerimeters::B
     //FIXME maybe use a binary search to trim the line?
     //FIXME how about searching tangent point at long segments? 
     for (size_t point_idx = 1; point_idx < travel.size(); ++point_idx) {
-        const Point &current_point = travel[point_idx - 1].point;
-        TravelPoint  next          = travel[point_idx];
-
-        visitor.pt_current = &current_point;
+        const TravelPoint &current       = travel[point_idx - 1];
+        const Point       &current_point = current.point;
+        TravelPoint        next          = travel[point_idx];
 
         if (!next.do_not_remove)
             for (size_t point_idx_2 = point_idx + 1; point_idx_2 < travel.size(); ++point_idx_2) {
@@ -454,10 +477,8 @@ static std::vector<TravelPoint> simplify_travel(const AvoidCrossingPerimeters::B
                     continue;
                 }
 
-                visitor.pt_next = &travel[point_idx_2].point;
-                boundary.grid.visit_cells_intersecting_line(*visitor.pt_current, *visitor.pt_next, visitor);
                 // Check if deleting point causes crossing a boundary
-                if (!visitor.intersect) {
+                if (!intersects(current, travel[point_idx_2])) {
                     next      = travel[point_idx_2];
                     point_idx = point_idx_2;
                 }
@@ -541,7 +562,7 @@ static float get_external_perimeter_width(const Layer &layer)
 }
 
 // Called by avoid_perimeters() and by simplify_travel_heuristics().
-static size_t avoid_perimeters_inner(const AvoidCrossingPerimeters::Boundary &boundary,
+static size_t avoid_perimeters_inner(AvoidCrossingPerimeters::Boundary       &boundary,
                                      const Point                             &start,
                                      const Point                             &end,
                                      const Layer                             &layer,
@@ -609,16 +630,20 @@ static size_t avoid_perimeters_inner(const AvoidCrossingPerimeters::Boundary &bo
             const Intersection &intersection_second = *it_second;
             Direction           shortest_direction  = get_shortest_direction(boundary, intersection_first, intersection_second,
                                                                              boundary.boundaries_params[intersection_first.border_idx].back());
-            // Append the path around the border into the path
+            // Append the path around the border into the path, through the vertices offset by init_boundary().
+            const size_t  border_idx       = intersection_first.border_idx;
+            const Points &vertices_offset  = boundary.boundaries_offset[border_idx];
+            const int     first_vertex_idx = int(boundary.boundaries_offset_first_vertex[border_idx]);
             if (shortest_direction == Direction::Forward)
                 for (int line_idx = int(intersection_first.line_idx); line_idx != int(intersection_second.line_idx);
-                    line_idx      = line_idx + 1 < int(boundaries[intersection_first.border_idx].size()) ? line_idx + 1 : 0)
-                    result.push_back({get_polygon_vertex_offset(boundaries[intersection_first.border_idx],
-                                                                (line_idx + 1 == int(boundaries[intersection_first.border_idx].points.size())) ? 0 : (line_idx + 1), coord_t(SCALED_EPSILON)), int(intersection_first.border_idx)});
+                    line_idx      = line_idx + 1 < int(boundaries[border_idx].size()) ? line_idx + 1 : 0) {
+                    const int point_idx = (line_idx + 1 == int(boundaries[border_idx].points.size())) ? 0 : (line_idx + 1);
+                    result.push_back({vertices_offset[point_idx], int(border_idx), false, first_vertex_idx + point_idx});
+                }
             else
                 for (int line_idx = int(intersection_first.line_idx); line_idx != int(intersection_second.line_idx);
-                    line_idx      = line_idx - 1 >= 0 ? line_idx - 1 : int(boundaries[intersection_first.border_idx].size()) - 1)
-                    result.push_back({get_polygon_vertex_offset(boundaries[intersection_second.border_idx], line_idx + 0, coord_t(SCALED_EPSILON)), int(intersection_first.border_idx)});
+                    line_idx      = line_idx - 1 >= 0 ? line_idx - 1 : int(boundaries[border_idx].size()) - 1)
+                    result.push_back({vertices_offset[line_idx], int(border_idx), false, first_vertex_idx + line_idx});
 
             // Append the farthest intersection into the path
             left_idx  = intersection_second.line_idx;
@@ -654,7 +679,7 @@ static size_t avoid_perimeters_inner(const AvoidCrossingPerimeters::Boundary &bo
 }
 
 // Called by AvoidCrossingPerimeters::travel_to()
-static size_t avoid_perimeters(const AvoidCrossingPerimeters::Boundary &boundary,
+static size_t avoid_perimeters(AvoidCrossingPerimeters::Boundary       &boundary,
                                const Point                             &start,
                                const Point                             &end,
                                const Layer                             &layer,
@@ -675,6 +700,29 @@ static size_t avoid_perimeters(const AvoidCrossingPerimeters::Boundary &boundary
     return num_intersections;
 }
 
+// Returns the travel planned by avoid_perimeters() over the same boundary before, or plans it and stores it for the later travels.
+// Called by AvoidCrossingPerimeters::travel_to()
+static size_t avoid_perimeters_cached(AvoidCrossingPerimeters::Boundary &boundary,
+                                      const Point                       &start,
+                                      const Point                       &end,
+                                      const Layer                       &layer,
+                                      size_t                             max_planned_travels,
+                                      Polyline                          &result_out)
+{
+    auto [it, inserted] = boundary.planned_travels.try_emplace({ start, end });
+    if (! inserted) {
+        result_out = it->second.first;
+        return it->second.second;
+    }
+    size_t num_intersections = avoid_perimeters(boundary, start, end, layer, result_out);
+    // Bound the memory held by the planned travels of a single layer.
+    if (boundary.planned_travels.size() > max_planned_travels)
+        boundary.planned_travels.erase(it);
+    else
+        it->second = { result_out, num_intersections };
+    return num_intersections;
+}
+
 // Check if anyone of ExPolygons contains whole travel.
 // called by need_wipe() and AvoidCrossingPerimeters::travel_to()
 // FIXME Lukas H.: Maybe similar approach could also be used for ExPolygon::contains()
@@ -1152,6 +1200,26 @@ static void init_boundary_distances(AvoidCrossingPerimeters::Boundary *boundary)
         precompute_polygon_distances(boundary->boundaries[poly_idx], boundary->boundaries_params[poly_idx]);
 }
 
+// Offset all the vertices of the boundaries inwards, the travels are routed around the boundaries through them.
+static void init_boundary_offset_vertices(AvoidCrossingPerimeters::Boundary *boundary)
+{
+    boundary->boundaries_offset.assign(boundary->boundaries.size(), Points());
+    boundary->boundaries_offset_first_vertex.assign(boundary->boundaries.size(), 0);
+    uint32_t num_vertices = 0;
+    for (size_t poly_idx = 0; poly_idx < boundary->boundaries.size(); ++poly_idx) {
+        const Polygon &polygon        = boundary->boundaries[poly_idx];
+        Points        &polygon_offset = boundary->boundaries_offset[poly_idx];
+        boundary->boundaries_offset_first_vertex[poly_idx] = num_vertices;
+        num_vertices += uint32_t(polygon.size());
+        polygon_offset.reserve(polygon.size());
+        // A polygon without three different vertices has no inward normal, it is never walked around by a travel.
+        const bool degenerate = polygon.size() < 3 ||
+            std::all_of(polygon.points.begin(), polygon.points.end(), [&polygon](const Point &pt) { return pt == polygon.points.front(); });
+        for (size_t point_idx = 0; point_idx < polygon.size(); ++point_idx)
+            polygon_offset.emplace_back(degenerate ? polygon.points[point_idx] : get_polygon_vertex_offset(polygon, point_idx, coord_t(SCALED_EPSILON)));
+    }
+}
+
 static void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons &&boundary_polygons)
 {
     boundary->clear();
@@ -1164,54 +1232,67 @@ static void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons
     // FIXME 1mm grid?
     boundary->grid.create(boundary->boundaries, coord_t(scale_(1.)));
     init_boundary_distances(boundary);
+    init_boundary_offset_vertices(boundary);
 }
 
-// Plan travel, which avoids perimeter crossings by following the boundaries of the layer.
-Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &point, bool *could_be_wipe_disabled)
+size_t AvoidCrossingPerimeters::plan_travel(const Layer &layer, const Point &start, const Point &end, bool use_external, Polyline &result_out)
 {
-    // If use_external, then perform the path planning in the world coordinate system (correcting for the gcodegen offset).
-    // Otherwise perform the path planning in the coordinate system of the active object.
-    bool        use_external  = m_use_external_mp || m_use_external_mp_once;
-    Point       scaled_origin = use_external ? Point::new_scale(gcodegen.origin()(0), gcodegen.origin()(1)) : Point(0, 0);
-    const Point start         = gcodegen.last_pos() + scaled_origin;
-    const Point end           = point + scaled_origin;
-    const Line  travel(start, end);
-
-    Polyline result_pl;
-    size_t   travel_intersection_count = 0;
-    Vec2d startf = start.cast<double>();
-    Vec2d endf   = end  .cast<double>();
-
-    bool is_support_layer = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel)))) {
-        // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty())
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer())));
+    const Line travel(start, end);
+    size_t     travel_intersection_count = 0;
+    Vec2d      startf = start.cast<double>();
+    Vec2d      endf   = end  .cast<double>();
+
+    LayerBoundaries &layer_boundaries = this->layer_boundaries();
+    Boundary        &internal         = layer_boundaries.internal;
+    Boundary        &external         = layer_boundaries.external;
+    bool is_support_layer = dynamic_cast<const SupportLayer *>(&layer) != nullptr;
+    result_out.clear();
+    if (!use_external && (is_support_layer || (!layer_boundaries.lslices_offset.empty() &&
+        !any_expolygon_contains(layer_boundaries.lslices_offset, layer_boundaries.lslices_offset_bboxes, layer_boundaries.grid_lslices_offset, travel)))) {
+        // Initialize internal only when it is necessary.
+        if (internal.boundaries.empty())
+            init_boundary(&internal, to_polygons(get_boundary(layer)));
 
         // Trim the travel line by the bounding box.
-        if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
-            result_pl.points.front()  = start;
-            result_pl.points.back()   = end;
+        if (!internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, internal.bbox)) {
+            travel_intersection_count = avoid_perimeters_cached(internal, startf.cast<coord_t>(), endf.cast<coord_t>(), layer, m_max_planned_travels, result_out);
+            result_out.points.front() = start;
+            result_out.points.back()  = end;
         }
     } else if(use_external) {
-        // Initialize m_external only when exist any external travel for the current layer.
-        if (m_external.boundaries.empty())
-            init_boundary(&m_external, get_boundary_external(*gcodegen.layer()));
+        // Initialize external only when exist any external travel for the current layer.
+        if (external.boundaries.empty())
+            init_boundary(&external, get_boundary_external(layer));
 
         // Trim the travel line by the bounding box.
-        if (!m_external.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_external.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_external, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
-            result_pl.points.front()  = start;
-            result_pl.points.back()   = end;
+        if (!external.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, external.bbox)) {
+            travel_intersection_count = avoid_perimeters_cached(external, startf.cast<coord_t>(), endf.cast<coord_t>(), layer, m_max_planned_travels, result_out);
+            result_out.points.front() = start;
+            result_out.points.back()  = end;
         }
     }
 
-    if(result_pl.empty()) {
+    if(result_out.empty()) {
         // Travel line is completely outside the bounding box.
-        result_pl                 = {start, end};
+        result_out                = {start, end};
         travel_intersection_count = 0;
     }
+    return travel_intersection_count;
+}
+
+// Plan travel, which avoids perimeter crossings by following the boundaries of the layer.
+Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &point, bool *could_be_wipe_disabled)
+{
+    // If use_external, then perform the path planning in the world coordinate system (correcting for the gcodegen offset).
+    // Otherwise perform the path planning in the coordinate system of the active object.
+    bool        use_external  = m_use_external_mp || m_use_external_mp_once;
+    Point       scaled_origin = use_external ? Point::new_scale(gcodegen.origin()(0), gcodegen.origin()(1)) : Point(0, 0);
+    const Point start         = gcodegen.last_pos() + scaled_origin;
+    const Point end           = point + scaled_origin;
+    const Line  travel(start, end);
+
+    Polyline result_pl;
+    size_t   travel_intersection_count = this->plan_travel(*gcodegen.layer(), start, end, use_external, result_pl);
 
     const ConfigOptionFloatOrPercent &opt_max_detour             = gcodegen.config().max_travel_detour_distance;
     bool                              max_detour_length_exceeded = false;
@@ -1232,33 +1313,76 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
         *could_be_wipe_disabled = false;
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
-    } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel, result_pl, travel_intersection_count);
+    } else {
+        const LayerBoundaries &layer_boundaries = this->layer_boundaries();
+        *could_be_wipe_disabled = !need_wipe(gcodegen, layer_boundaries.lslices_offset, layer_boundaries.lslices_offset_bboxes, layer_boundaries.grid_lslices_offset,
+                                             travel, result_pl, travel_intersection_count);
+    }
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+static void init_lslices_offset(const Layer &layer, AvoidCrossingPerimeters::LayerBoundaries *layer_boundaries)
 {
-    m_internal.clear();
-    m_external.clear();
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
+    layer_boundaries->internal.clear();
+    layer_boundaries->external.clear();
+    layer_boundaries->lslices_offset.clear();
+    layer_boundaries->lslices_offset_bboxes.clear();
 
-    float perimeter_offset = -get_external_perimeter_width(layer) / float(2.);
-    m_lslices_offset        = offset_ex(layer.lslices, perimeter_offset);
+    float perimeter_offset           = -get_external_perimeter_width(layer) / float(2.);
+    layer_boundaries->lslices_offset = offset_ex(layer.lslices, perimeter_offset);
 
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const ExPolygon &ex_poly : m_lslices_offset)
-        m_lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
+    layer_boundaries->lslices_offset_bboxes.reserve(layer_boundaries->lslices_offset.size());
+    for (const ExPolygon &ex_poly : layer_boundaries->lslices_offset)
+        layer_boundaries->lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
 
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslices_offset.set_bbox(bbox_slice);
-    m_grid_lslices_offset.create(m_lslices_offset, coord_t(scale_(1.)));
+    layer_boundaries->grid_lslices_offset.set_bbox(bbox_slice);
+    layer_boundaries->grid_lslices_offset.create(layer_boundaries->lslices_offset, coord_t(scale_(1.)));
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+{
+    if (auto it = m_precomputed.find(&layer); it != m_precomputed.end()) {
+        m_precomputed_layer = it->second.get();
+        return;
+    }
+    m_precomputed_layer = nullptr;
+    init_lslices_offset(layer, &m_layer);
+}
+
+void AvoidCrossingPerimeters::precompute_layers(const std::vector<const Layer*> &layers)
+{
+    if (m_precomputed_layer != nullptr) {
+        // The boundaries of the current layer may still be used by travel_to() until the next init_layer(),
+        // keep them. The EdgeGrids stay valid, the moved polygons keep their buffers.
+        m_layer             = std::move(*m_precomputed_layer);
+        m_precomputed_layer = nullptr;
+    }
+    m_precomputed.clear();
+
+    std::vector<std::pair<const Layer*, LayerBoundaries*>> layers_boundaries;
+    layers_boundaries.reserve(layers.size());
+    for (const Layer *layer : layers)
+        if (auto [it, inserted] = m_precomputed.emplace(layer, nullptr); inserted) {
+            it->second = std::make_unique<LayerBoundaries>();
+            layers_boundaries.emplace_back(layer, it->second.get());
+        }
+
+    // The boundaries of a layer only depend on the layer, while computing them is the most expensive part of init_layer()
+    // and of the first travel_to() inside the layer.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers_boundaries.size()), [&layers_boundaries](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            const Layer     &layer            = *layers_boundaries[layer_idx].first;
+            LayerBoundaries *layer_boundaries = layers_boundaries[layer_idx].second;
+            init_lslices_offset(layer, layer_boundaries);
+            init_boundary(&layer_boundaries->internal, to_polygons(get_boundary(layer)));
+        }
+    }); // end of parallel_for
 }
 
 #if 0
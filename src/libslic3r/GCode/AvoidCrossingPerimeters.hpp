@@ -5,6 +5,10 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <map>
+#include <memory>
+#include <unordered_map>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -22,8 +26,13 @@ public:
     void        disable_once()          { m_disabled_once = true; }
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
+    // Bound the memory held by the travels planned over a single boundary. To be lowered by unit tests only.
+    void        set_max_planned_travels(size_t max_planned_travels) { m_max_planned_travels = max_planned_travels; }
 
     void        init_layer(const Layer &layer);
+    // Compute the boundaries of the layers in parallel ahead of init_layer(), which then uses them instead of computing them
+    // on the G-code export thread. The boundaries precomputed by the previous call are released.
+    void        precompute_layers(const std::vector<const Layer*> &layers);
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
     {
@@ -32,6 +41,10 @@ public:
     }
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point, bool* could_be_wipe_disabled);
+    // Route the travel from start to end around the boundaries of the layer set by init_layer(), in the world coordinate system
+    // if use_external, otherwise in the coordinate system of the object. Returns the number of the intersections of the straight
+    // travel with the boundaries. Called by travel_to(), which limits the detour and decides on the wipe.
+    size_t      plan_travel(const Layer &layer, const Point &start, const Point &end, bool use_external, Polyline &result_out);
 
     struct Boundary {
         // Collection of boundaries used for detection of crossing perimeters for travels
@@ -42,31 +55,74 @@ public:
         std::vector<std::vector<float>> boundaries_params;
         // Used for detection of intersection between line and any polygon from boundaries
         EdgeGrid::Grid                  grid;
+        // Vertices of boundaries offset inwards by SCALED_EPSILON, the travels are routed around the boundaries through them.
+        std::vector<Points>             boundaries_offset;
+        // Index of the first vertex of each polygon in the vertices of all the polygons of boundaries_offset.
+        std::vector<uint32_t>           boundaries_offset_first_vertex;
+
+        // Navigation data shared by all the travels planned over the boundary, built lazily by travel_to().
+        // Visibility graph between the vertices of boundaries_offset: Key is (from_vertex << 32 | to_vertex),
+        // value is true if the segment between them does not cross any boundary.
+        std::unordered_map<uint64_t, bool>  visibility_graph;
+        // Planned travels: The same travels are planned for each instance of an object, and again when a travel is re-planned.
+        struct TravelHash {
+            size_t operator()(const std::pair<Point, Point> &travel) const noexcept { return PointHash{}(travel.first) * 31 + PointHash{}(travel.second); }
+        };
+        std::unordered_map<std::pair<Point, Point>, std::pair<Polyline, size_t>, TravelHash> planned_travels;
 
         void clear()
         {
             boundaries.clear();
             boundaries_params.clear();
+            boundaries_offset.clear();
+            boundaries_offset_first_vertex.clear();
+            visibility_graph.clear();
+            planned_travels.clear();
         }
     };
 
+    // All the boundaries of a single layer.
+    // The EdgeGrids point to the polygons they were created from, thus LayerBoundaries may be moved, but not copied.
+    struct LayerBoundaries {
+        // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid           grid_lslices_offset;
+        // Store all needed data for travels inside object
+        Boundary                 internal;
+        // Store all needed data for travels outside object
+        Boundary                 external;
+
+        LayerBoundaries() = default;
+        LayerBoundaries(LayerBoundaries &&) = default;
+        LayerBoundaries& operator=(LayerBoundaries &&) = default;
+        LayerBoundaries(const LayerBoundaries &) = delete;
+        LayerBoundaries& operator=(const LayerBoundaries &) = delete;
+    };
+
+    // Boundaries of the layer set by init_layer(), either precomputed or computed by init_layer() and travel_to().
+    const LayerBoundaries& current_layer_boundaries() const { return m_precomputed_layer ? *m_precomputed_layer : m_layer; }
+
 private:
+    LayerBoundaries& layer_boundaries() { return m_precomputed_layer ? *m_precomputed_layer : m_layer; }
+
+
     bool           m_use_external_mp { false };
     // just for the next travel move
     bool           m_use_external_mp_once { false };
     // this flag disables reduce_crossing_wall just for the next travel move
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
+    // The travels planned over a boundary are not stored anymore once there are this many of them.
+    size_t         m_max_planned_travels { 65536 };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid           m_grid_lslices_offset;
-    // Store all needed data for travels inside object
-    Boundary m_internal;
-    // Store all needed data for travels outside object
-    Boundary m_external;
+    // Boundaries of the current layer computed by init_layer().
+    LayerBoundaries          m_layer;
+    // Boundaries of the current layer owned by m_precomputed, if init_layer() found them there.
+    // The internal and external boundaries are computed on demand by travel_to() and kept there for the other instances of the object.
+    LayerBoundaries         *m_precomputed_layer { nullptr };
+    std::map<const Layer*, std::unique_ptr<LayerBoundaries>> m_precomputed;
 };
 
 } // namespace Slic3r
@@ -0,0 +1,446 @@
+#include "BinaryGCode.hpp"
+
+#include "../Exception.hpp"
+#include "../Utils.hpp"
+#include "libslic3r_version.h"
+
+#include <cassert>
+#include <cstring>
+#include <initializer_list>
+#include <string_view>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/beast/core/detail/base64.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <miniz.h>
+
+namespace Slic3r {
+namespace BinaryGCode {
+
+static constexpr const char Magic[4] = { 'G', 'C', 'D', 'E' };
+static constexpr uint32_t   Version  = 1;
+// Length of the ASCII G-code stored into a single G-code block.
+static constexpr size_t     GCodeBlockSize = 65536;
+// Payloads shorter than this are not worth compressing.
+static constexpr size_t     MinCompressedSize = 64;
+
+static void append_u16(std::string &out, uint16_t v)
+{
+    out += char(v & 0xff);
+    out += char(v >> 8);
+}
+
+static void append_u32(std::string &out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++ i)
+        out += char((v >> (8 * i)) & 0xff);
+}
+
+static uint16_t get_u16(const unsigned char *p) { return uint16_t(p[0] | (p[1] << 8)); }
+static uint32_t get_u32(const unsigned char *p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24); }
+
+static mz_ulong crc32_append(mz_ulong crc, const void *data, size_t size)
+{
+    // mz_crc32() restarts the checksum when passed a null pointer.
+    return size == 0 ? crc : mz_crc32(crc, reinterpret_cast<const mz_uint8*>(data), size);
+}
+
+static size_t block_params_size(EBlockType type) { return type == EBlockType::Thumbnail ? 6 : 2; }
+
+bool is_binary_gcode_file(const std::string &path)
+{
+    FILE *f = boost::nowide::fopen(path.c_str(), "rb");
+    if (f == nullptr)
+        return false;
+    char magic[sizeof(Magic)];
+    bool out = ::fread(magic, 1, sizeof(Magic), f) == sizeof(Magic) && ::memcmp(magic, Magic, sizeof(Magic)) == 0;
+    ::fclose(f);
+    return out;
+}
+
+Writer::Writer(const std::string &path) : m_path(path)
+{
+    m_file = boost::nowide::fopen(path.c_str(), "wb");
+    if (m_file == nullptr)
+        throw Slic3r::RuntimeError(std::string("Cannot create binary G-code file ") + path);
+    std::string header(Magic, sizeof(Magic));
+    append_u32(header, Version);
+    append_u16(header, uint16_t(EChecksum::CRC32));
+    if (::fwrite(header.data(), 1, header.size(), m_file) != header.size()) {
+        ::fclose(m_file);
+        throw Slic3r::RuntimeError(std::string("Failed writing binary G-code file ") + m_path);
+    }
+}
+
+Writer::~Writer()
+{
+    if (m_file != nullptr)
+        ::fclose(m_file);
+}
+
+void Writer::write_block(EBlockType type, const std::string &params, const std::string &payload)
+{
+    assert(params.size() == block_params_size(type));
+    std::string compressed;
+    if (payload.size() >= MinCompressedSize) {
+        mz_ulong compressed_size = mz_compressBound(mz_ulong(payload.size()));
+        compressed.resize(compressed_size);
+        if (mz_compress2(reinterpret_cast<unsigned char*>(compressed.data()), &compressed_size,
+                reinterpret_cast<const unsigned char*>(payload.data()), mz_ulong(payload.size()), MZ_DEFAULT_LEVEL) == MZ_OK &&
+            compressed_size < payload.size())
+            compressed.resize(compressed_size);
+        else
+            // Store incompressible data as is.
+            compressed.clear();
+    }
+    const std::string &data = compressed.empty() ? payload : compressed;
+
+    std::string header;
+    append_u16(header, uint16_t(type));
+    append_u16(header, uint16_t(compressed.empty() ? ECompression::None : ECompression::Deflate));
+    append_u32(header, uint32_t(payload.size()));
+    if (! compressed.empty())
+        append_u32(header, uint32_t(compressed.size()));
+
+    mz_ulong crc = MZ_CRC32_INIT;
+    crc = crc32_append(crc, header.data(), header.size());
+    crc = crc32_append(crc, params.data(), params.size());
+    crc = crc32_append(crc, data.data(), data.size());
+    std::string checksum;
+    append_u32(checksum, uint32_t(crc));
+
+    for (const std::string *chunk : std::initializer_list<const std::string*>{ &header, &params, &data, &checksum })
+        if (::fwrite(chunk->data(), 1, chunk->size(), m_file) != chunk->size())
+            throw Slic3r::RuntimeError(std::string("Failed writing binary G-code file ") + m_path);
+}
+
+void Writer::write_metadata(EBlockType type, const Metadata &metadata)
+{
+    assert(type != EBlockType::GCode && type != EBlockType::Thumbnail);
+    std::string params;
+    // Encoding: "key = value" lines.
+    append_u16(params, 0);
+    std::string payload;
+    for (const auto &[key, value] : metadata)
+        payload += key + " = " + value + "\n";
+    this->write_block(type, params, payload);
+}
+
+void Writer::write_thumbnail(EThumbnailFormat format, uint16_t width, uint16_t height, const std::string &data)
+{
+    std::string params;
+    append_u16(params, uint16_t(format));
+    append_u16(params, width);
+    append_u16(params, height);
+    this->write_block(EBlockType::Thumbnail, params, data);
+}
+
+void Writer::append_gcode(const char *data, size_t size)
+{
+    m_gcode.append(data, size);
+    if (m_gcode.size() >= GCodeBlockSize)
+        this->flush_gcode(false);
+}
+
+void Writer::flush_gcode(bool all)
+{
+    std::string params;
+    // Encoding: plain ASCII.
+    append_u16(params, 0);
+    size_t begin = 0;
+    while (m_gcode.size() - begin >= GCodeBlockSize || (all && begin < m_gcode.size())) {
+        size_t end = m_gcode.size();
+        if (end - begin > GCodeBlockSize) {
+            // Split at a line end if possible.
+            size_t eol = m_gcode.rfind('\n', begin + GCodeBlockSize - 1);
+            end = eol == std::string::npos || eol < begin ? begin + GCodeBlockSize : eol + 1;
+        }
+        this->write_block(EBlockType::GCode, params, m_gcode.substr(begin, end - begin));
+        begin = end;
+    }
+    m_gcode.erase(0, begin);
+}
+
+void Writer::close()
+{
+    if (m_file == nullptr)
+        return;
+    this->flush_gcode(true);
+    bool failed = ::fflush(m_file) != 0 || ::ferror(m_file) != 0;
+    failed |= ::fclose(m_file) != 0;
+    m_file = nullptr;
+    if (failed)
+        throw Slic3r::RuntimeError(std::string("Failed writing binary G-code file ") + m_path);
+}
+
+Reader::Reader(const std::string &path) : m_path(path)
+{
+    m_file = boost::nowide::fopen(path.c_str(), "rb");
+    if (m_file == nullptr)
+        throw Slic3r::RuntimeError(std::string("Cannot open binary G-code file ") + path);
+    unsigned char header[10];
+    std::string   error;
+    if (::fread(header, 1, sizeof(header), m_file) != sizeof(header) || ::memcmp(header, Magic, sizeof(Magic)) != 0)
+        error = path + " is not a binary G-code file";
+    else if (get_u32(header + 4) != Version)
+        error = std::string("Unsupported version of binary G-code file ") + path;
+    else if (m_checksum = EChecksum(get_u16(header + 8)); m_checksum != EChecksum::None && m_checksum != EChecksum::CRC32)
+        error = std::string("Unsupported checksum of binary G-code file ") + path;
+    if (! error.empty()) {
+        ::fclose(m_file);
+        throw Slic3r::RuntimeError(error);
+    }
+}
+
+Reader::~Reader()
+{
+    if (m_file != nullptr)
+        ::fclose(m_file);
+}
+
+bool Reader::next_block(Block &block)
+{
+    auto corrupted = [this]() { return Slic3r::RuntimeError(std::string("Binary G-code file ") + m_path + " is corrupted"); };
+
+    unsigned char header[12];
+    size_t        header_size = ::fread(header, 1, 8, m_file);
+    if (header_size == 0 && ::feof(m_file))
+        return false;
+    if (header_size != 8)
+        throw corrupted();
+    const auto     type             = EBlockType(get_u16(header));
+    const auto     compression      = ECompression(get_u16(header + 2));
+    const uint32_t uncompressed_size = get_u32(header + 4);
+    uint32_t       stored_size       = uncompressed_size;
+    if (compression != ECompression::None) {
+        if (compression != ECompression::Deflate)
+            throw Slic3r::RuntimeError(std::string("Unsupported compression in binary G-code file ") + m_path);
+        if (::fread(header + 8, 1, 4, m_file) != 4)
+            throw corrupted();
+        header_size += 4;
+        stored_size  = get_u32(header + 8);
+    }
+
+    block.type = type;
+    block.params.assign(block_params_size(type), 0);
+    std::string payload(stored_size, 0);
+    if (::fread(block.params.data(), 1, block.params.size(), m_file) != block.params.size() ||
+        ::fread(payload.data(), 1, payload.size(), m_file) != payload.size())
+        throw corrupted();
+
+    if (m_checksum == EChecksum::CRC32) {
+        unsigned char checksum[4];
+        if (::fread(checksum, 1, 4, m_file) != 4)
+            throw corrupted();
+        mz_ulong crc = MZ_CRC32_INIT;
+        crc = crc32_append(crc, header, header_size);
+        crc = crc32_append(crc, block.params.data(), block.params.size());
+        crc = crc32_append(crc, payload.data(), payload.size());
+        if (uint32_t(crc) != get_u32(checksum))
+            throw corrupted();
+    }
+
+    if (compression == ECompression::Deflate) {
+        block.data.assign(uncompressed_size, 0);
+        mz_ulong size = uncompressed_size;
+        if (mz_uncompress(reinterpret_cast<unsigned char*>(block.data.data()), &size,
+                reinterpret_cast<const unsigned char*>(payload.data()), mz_ulong(payload.size())) != MZ_OK ||
+            size != uncompressed_size)
+            throw corrupted();
+    } else
+        block.data = std::move(payload);
+    return true;
+}
+
+bool Reader::next_gcode(std::string &gcode)
+{
+    Block block;
+    while (this->next_block(block))
+        if (block.type == EBlockType::GCode) {
+            gcode = std::move(block.data);
+            return true;
+        }
+    return false;
+}
+
+Metadata parse_metadata(const std::string &data)
+{
+    Metadata out;
+    size_t   begin = 0;
+    while (begin < data.size()) {
+        size_t end = data.find('\n', begin);
+        if (end == std::string::npos)
+            end = data.size();
+        size_t eq = data.find('=', begin);
+        if (eq < end) {
+            std::string key   = data.substr(begin, eq - begin);
+            std::string value = data.substr(eq + 1, end - eq - 1);
+            boost::trim(key);
+            boost::trim(value);
+            out.emplace_back(std::move(key), std::move(value));
+        }
+        begin = end + 1;
+    }
+    return out;
+}
+
+bool read_metadata(const std::string &path, EBlockType type, Metadata &metadata)
+{
+    Reader         reader(path);
+    Reader::Block  block;
+    // All the metadata blocks precede the G-code blocks.
+    while (reader.next_block(block) && block.type != EBlockType::GCode)
+        if (block.type == type) {
+            metadata = parse_metadata(block.data);
+            return true;
+        }
+    return false;
+}
+
+struct Thumbnail
+{
+    EThumbnailFormat format;
+    uint16_t         width;
+    uint16_t         height;
+    std::string      data;
+};
+
+// Collect the thumbnails and the configuration block stored as comments into the ASCII G-code.
+static void scan_ascii_gcode(const std::string &path, std::vector<Thumbnail> &thumbnails, Metadata &config)
+{
+    boost::nowide::ifstream ifs(path, std::ios::binary);
+    if (! ifs)
+        throw Slic3r::RuntimeError(std::string("Cannot open G-code file ") + path);
+
+    std::string line;
+    // Tag ("thumbnail", "thumbnail_JPG", "thumbnail_QOI") of the thumbnail being read, empty if none.
+    std::string thumbnail_tag;
+    std::string thumbnail_base64;
+    Thumbnail   thumbnail;
+    bool        in_config = false;
+    while (std::getline(ifs, line)) {
+        if (! line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.size() < 2 || line[0] != ';' || line[1] != ' ')
+            continue;
+        std::string_view comment = std::string_view(line).substr(2);
+        if (! thumbnail_tag.empty()) {
+            if (comment == thumbnail_tag + " end") {
+                thumbnail.data.resize(boost::beast::detail::base64::decoded_size(thumbnail_base64.size()));
+                thumbnail.data.resize(boost::beast::detail::base64::decode(thumbnail.data.data(), thumbnail_base64.data(), thumbnail_base64.size()).first);
+                thumbnails.emplace_back(std::move(thumbnail));
+                thumbnail_tag.clear();
+                thumbnail_base64.clear();
+            } else
+                thumbnail_base64 += comment;
+        } else if (in_config) {
+            if (boost::starts_with(comment, "CONFIG_BLOCK_END"))
+                in_config = false;
+            else if (size_t eq = comment.find('='); eq != std::string_view::npos) {
+                std::string key(comment.substr(0, eq));
+                std::string value(comment.substr(eq + 1));
+                boost::trim(key);
+                boost::trim(value);
+                config.emplace_back(std::move(key), std::move(value));
+            }
+        } else if (boost::starts_with(comment, "CONFIG_BLOCK_START")) {
+            in_config = true;
+        } else if (boost::starts_with(comment, "thumbnail")) {
+            // "; thumbnail begin 300x300 12345"
+            std::string tag;
+            unsigned    width = 0, height = 0;
+            size_t      begin = comment.find(" begin ");
+            if (begin == std::string_view::npos || sscanf(std::string(comment.substr(begin + 7)).c_str(), "%ux%u", &width, &height) != 2)
+                continue;
+            tag = std::string(comment.substr(0, begin));
+            if (tag == "thumbnail")
+                thumbnail.format = EThumbnailFormat::PNG;
+            else if (tag == "thumbnail_JPG")
+                thumbnail.format = EThumbnailFormat::JPG;
+            else if (tag == "thumbnail_QOI")
+                thumbnail.format = EThumbnailFormat::QOI;
+            else
+                continue;
+            thumbnail.width  = uint16_t(width);
+            thumbnail.height = uint16_t(height);
+            thumbnail_tag    = std::move(tag);
+        }
+    }
+}
+
+// Write into a temporary file next to dst, then replace dst, so that src and dst may be the same file.
+template<typename WriteFn>
+static void write_replacing(const std::string &dst, WriteFn write_fn)
+{
+    const std::string tmp = dst + ".tmp";
+    try {
+        write_fn(tmp);
+    } catch (...) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(tmp, ec);
+        throw;
+    }
+    if (std::error_code ec = rename_file(tmp, dst); ec)
+        throw Slic3r::RuntimeError(std::string("Failed to rename ") + tmp + " to " + dst + ": " + ec.message());
+}
+
+void convert_ascii_to_binary(const std::string &src, const std::string &dst, const Metadata &printer_metadata, const Metadata &print_metadata)
+{
+    std::vector<Thumbnail> thumbnails;
+    Metadata               config;
+    scan_ascii_gcode(src, thumbnails, config);
+
+    write_replacing(dst, [&](const std::string &tmp) {
+        Writer writer(tmp);
+        writer.write_metadata(EBlockType::FileMetadata, { { "Producer", std::string(SLIC3R_APP_NAME) + " " + SoftFever_VERSION } });
+        writer.write_metadata(EBlockType::PrinterMetadata, printer_metadata);
+        for (const Thumbnail &thumbnail : thumbnails)
+            writer.write_thumbnail(thumbnail.format, thumbnail.width, thumbnail.height, thumbnail.data);
+        writer.write_metadata(EBlockType::PrintMetadata, print_metadata);
+        writer.write_metadata(EBlockType::SlicerMetadata, config);
+
+        FILE *in = boost::nowide::fopen(src.c_str(), "rb");
+        if (in == nullptr)
+            throw Slic3r::RuntimeError(std::string("Cannot open G-code file ") + src);
+        std::vector<char> buffer(1024 * 1024);
+        size_t            cnt;
+        while ((cnt = ::fread(buffer.data(), 1, buffer.size(), in)) > 0)
+            writer.append_gcode(buffer.data(), cnt);
+        bool failed = ::ferror(in) != 0;
+        ::fclose(in);
+        if (failed)
+            throw Slic3r::RuntimeError(std::string("Failed reading G-code file ") + src);
+        writer.close();
+    });
+    BOOST_LOG_TRIVIAL(info) << "Converted G-code " << src << " to binary G-code " << dst << ", " << thumbnails.size() << " thumbnails";
+}
+
+void convert_binary_to_ascii(const std::string &src, const std::string &dst)
+{
+    write_replacing(dst, [&src](const std::string &tmp) {
+        Reader reader(src);
+        FILE  *out = boost::nowide::fopen(tmp.c_str(), "wb");
+        if (out == nullptr)
+            throw Slic3r::RuntimeError(std::string("Cannot create G-code file ") + tmp);
+        std::string gcode;
+        bool        failed = false;
+        try {
+            while (! failed && reader.next_gcode(gcode))
+                failed = ::fwrite(gcode.data(), 1, gcode.size(), out) != gcode.size();
+        } catch (...) {
+            ::fclose(out);
+            throw;
+        }
+        failed |= ::fclose(out) != 0;
+        if (failed)
+            throw Slic3r::RuntimeError(std::string("Failed writing G-code file ") + tmp);
+    });
+}
+
+} // namespace BinaryGCode
+} // namespace Slic3r
@@ -0,0 +1,121 @@
+#ifndef slic3r_GCode_BinaryGCode_hpp_
+#define slic3r_GCode_BinaryGCode_hpp_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Slic3r {
+namespace BinaryGCode {
+
+// Compact binary container of G-code. All values are little endian.
+//
+// File header:  magic number "GCDE", version (uint32), checksum type (uint16).
+// Blocks:       block header:  type (uint16), compression (uint16), uncompressed size (uint32),
+//                              compressed size (uint32, only present if compressed),
+//               parameters:    encoding (uint16) for the metadata and G-code blocks,
+//                              format, width, height (uint16 each) for the thumbnail blocks,
+//               payload,
+//               CRC32 of the block header, parameters and payload (if the checksum type is CRC32).
+//
+// Block order:  file metadata, printer metadata, thumbnails, print metadata, slicer metadata, G-code.
+// Metadata payloads are "key = value" lines. The G-code blocks store the ASCII G-code split at line ends,
+// so that the ASCII G-code is restored byte for byte by concatenating the G-code blocks.
+
+enum class EBlockType : uint16_t {
+    FileMetadata    = 0,
+    GCode           = 1,
+    SlicerMetadata  = 2,
+    PrinterMetadata = 3,
+    PrintMetadata   = 4,
+    Thumbnail       = 5,
+};
+
+enum class ECompression : uint16_t {
+    None    = 0,
+    Deflate = 1,
+};
+
+enum class EChecksum : uint16_t {
+    None  = 0,
+    CRC32 = 1,
+};
+
+enum class EThumbnailFormat : uint16_t {
+    PNG = 0,
+    JPG = 1,
+    QOI = 2,
+};
+
+using Metadata = std::vector<std::pair<std::string, std::string>>;
+
+// Does the file start with the magic number of the binary G-code?
+bool is_binary_gcode_file(const std::string &path);
+
+class Writer
+{
+public:
+    // Throws Slic3r::RuntimeError if the file cannot be created.
+    explicit Writer(const std::string &path);
+    ~Writer();
+
+    void write_metadata(EBlockType type, const Metadata &metadata);
+    void write_thumbnail(EThumbnailFormat format, uint16_t width, uint16_t height, const std::string &data);
+    // Append ASCII G-code. It is buffered and split into G-code blocks at line ends.
+    void append_gcode(const char *data, size_t size);
+    void append_gcode(const std::string &data) { this->append_gcode(data.data(), data.size()); }
+    // Flush the buffered G-code and close the file. Throws Slic3r::RuntimeError on write error.
+    void close();
+
+private:
+    void write_block(EBlockType type, const std::string &params, const std::string &payload);
+    void flush_gcode(bool all);
+
+    FILE        *m_file { nullptr };
+    std::string  m_path;
+    std::string  m_gcode;
+};
+
+class Reader
+{
+public:
+    struct Block {
+        EBlockType  type;
+        // Raw block parameters, see the layout above.
+        std::string params;
+        // Decompressed payload.
+        std::string data;
+    };
+
+    // Throws Slic3r::RuntimeError if the file cannot be opened or it is not a binary G-code.
+    explicit Reader(const std::string &path);
+    ~Reader();
+
+    // Read the next block. Returns false at the end of file, throws Slic3r::RuntimeError on a corrupted file.
+    bool next_block(Block &block);
+    // Read the next G-code block, skipping the other blocks. Returns false at the end of file.
+    bool next_gcode(std::string &gcode);
+
+private:
+    FILE        *m_file { nullptr };
+    std::string  m_path;
+    EChecksum    m_checksum { EChecksum::None };
+};
+
+// Parse "key = value" lines of a metadata block.
+Metadata parse_metadata(const std::string &data);
+// Read a metadata block of the given type. Returns false if the file does not contain such block.
+bool read_metadata(const std::string &path, EBlockType type, Metadata &metadata);
+
+// Convert an ASCII G-code into the binary container. The thumbnails embedded as comments are stored into the thumbnail
+// blocks as well, the configuration block into the slicer metadata block. src and dst may be the same file.
+void convert_ascii_to_binary(const std::string &src, const std::string &dst, const Metadata &printer_metadata, const Metadata &print_metadata);
+// Lossless conversion back to the ASCII G-code.
+void convert_binary_to_ascii(const std::string &src, const std::string &dst);
+
+} // namespace BinaryGCode
+} // namespace Slic3r
+
+#endif /* slic3r_GCode_BinaryGCode_hpp_ */
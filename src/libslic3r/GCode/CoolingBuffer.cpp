@@ -1,12 +1,12 @@
 #include "../GCode.hpp"
 #include "CoolingBuffer.hpp"
-#include <boost/algorithm/string/predicate.hpp>
-#include <boost/algorithm/string/replace.hpp>
 #include <boost/log/trivial.hpp>
 #include <iostream>
 #include <float.h>
+#include <charconv>
+#include <cstring>
+#include <string_view>
 #include <system_error>
-#include <unordered_map>
 
 #if 0
     #define DEBUG
@@ -18,22 +18,10 @@
 
 namespace Slic3r {
 
-CoolingBuffer::CoolingBuffer(GCode &gcodegen) : m_config(gcodegen.config()), m_toolchange_prefix(gcodegen.writer().toolchange_prefix()), m_current_extruder(0)
-{
-    this->reset(gcodegen.writer().get_position());
-
-    const std::vector<Extruder> &extruders = gcodegen.writer().extruders();
-    m_extruder_ids.reserve(extruders.size());
-    for (const Extruder &ex : extruders) {
-        m_num_extruders = std::max(ex.id() + 1, m_num_extruders);
-        m_extruder_ids.emplace_back(ex.id());
-    }
-}
-
 void CoolingBuffer::reset(const Vec3d &position)
 {
     // BBS: add I and J axis to store center of arc
-    m_current_pos.assign(7, 0.f);
+    m_current_pos.fill(0.f);
     m_current_pos[0] = float(position.x());
     m_current_pos[1] = float(position.y());
     m_current_pos[2] = float(position.z());
@@ -111,19 +99,23 @@ struct PerExtruderAdjustments
             time_total += line.time;
         return time_total;
     }
-    // Calculate the total elapsed time when slowing down 
-    // to the minimum extrusion feed rate defined for the current material.
-    float maximum_time_after_slowdown(bool slowdown_external_perimeters) const {
-        float time_total = 0.f;
-        for (const CoolingLine &line : lines)
+    // Calculate the total elapsed time into time_total and the total elapsed time when slowing down
+    // to the minimum extrusion feed rate defined for the current material into time_maximum, in a single pass.
+    void update_time_totals(bool slowdown_external_perimeters) {
+        time_total   = 0.f;
+        time_maximum = 0.f;
+        for (const CoolingLine &line : lines) {
+            time_total += line.time;
+            if (time_maximum == FLT_MAX)
+                continue;
             if (line.adjustable(slowdown_external_perimeters)) {
                 if (line.time_max == FLT_MAX)
-                    return FLT_MAX;
+                    time_maximum = FLT_MAX;
                 else
-                    time_total += line.time_max;
+                    time_maximum += line.time_max;
             } else
-                time_total += line.time;
-        return time_total;
+                time_maximum += line.time;
+        }
     }
     // Calculate the adjustable part of the total time.
     float adjustable_time(bool slowdown_external_perimeters) const {
@@ -249,8 +241,48 @@ struct PerExtruderAdjustments
     // Temporaries for processing the slow down. Both thresholds go from 0 to n_lines_adjustable.
     size_t                      idx_line_begin      = 0;
     size_t                      idx_line_end        = 0;
+
+    // Clear the lines of the previous layer, keeping their memory.
+    void clear_lines() {
+        lines.clear();
+        n_lines_adjustable  = 0;
+        time_non_adjustable = 0;
+        time_total          = 0;
+        time_maximum        = 0;
+        idx_line_begin      = 0;
+        idx_line_end        = 0;
+    }
 };
 
+CoolingBuffer::CoolingBuffer(GCode &gcodegen) : m_config(gcodegen.config()), m_toolchange_prefix(gcodegen.writer().toolchange_prefix()), m_current_extruder(0)
+{
+    this->reset(gcodegen.writer().get_position());
+
+    const std::vector<Extruder> &extruders = gcodegen.writer().extruders();
+    m_extruder_ids.reserve(extruders.size());
+    for (const Extruder &ex : extruders) {
+        m_num_extruders = std::max(ex.id() + 1, m_num_extruders);
+        m_extruder_ids.emplace_back(ex.id());
+    }
+
+    // The cooling settings are constant during the export, set them up once for all the layers.
+    m_per_extruder_adjustments.assign(m_extruder_ids.size(), PerExtruderAdjustments());
+    m_map_extruder_to_per_extruder_adjustment.assign(m_num_extruders, 0);
+    for (size_t i = 0; i < m_extruder_ids.size(); ++ i) {
+        PerExtruderAdjustments &adj         = m_per_extruder_adjustments[i];
+        unsigned int            extruder_id = m_extruder_ids[i];
+        adj.extruder_id               = extruder_id;
+        adj.cooling_slow_down_enabled = m_config.slow_down_for_layer_cooling.get_at(extruder_id);
+        adj.slow_down_layer_time = float(m_config.slow_down_layer_time.get_at(extruder_id));
+        adj.slow_down_min_speed           = float(m_config.slow_down_min_speed.get_at(extruder_id));
+        // ORCA: To enable dont slow down external perimeters feature per filament (extruder)
+        adj.dont_slow_down_outer_wall   = m_config.dont_slow_down_outer_wall.get_at(extruder_id);
+        m_map_extruder_to_per_extruder_adjustment[extruder_id] = i;
+    }
+}
+
+CoolingBuffer::~CoolingBuffer() = default;
+
 // Calculate a new feedrate when slowing down by time_stretch for segments faster than min_feedrate.
 // Used by non-proportional slow down.
 float new_feedrate_to_reach_time_stretch(
@@ -320,36 +352,37 @@ std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, b
     if (flush) {
         // This is either an object layer or the very last print layer. Calculate cool down over the collected support layers
         // and one object layer.
-        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_current_pos);
-        float layer_time_stretched = this->calculate_layer_slowdown(per_extruder_adjustments);
-        out = this->apply_layer_cooldown(m_gcode, layer_id, layer_time_stretched, per_extruder_adjustments);
+        this->parse_layer_gcode(m_gcode, m_current_pos);
+        float layer_time_stretched = this->calculate_layer_slowdown(m_per_extruder_adjustments);
+        out = this->apply_layer_cooldown(m_gcode, layer_id, layer_time_stretched, m_per_extruder_adjustments);
         m_gcode.clear();
     }
     return out;
 }
 
+static inline bool starts_with(const std::string_view str, const std::string_view prefix)
+{
+    return str.size() >= prefix.size() && memcmp(str.data(), prefix.data(), prefix.size()) == 0;
+}
+
+static inline bool has_marker(const std::string_view comment, const std::string_view marker)
+{
+    return comment.find(marker) != std::string_view::npos;
+}
+
 // Parse the layer G-code for the moves, which could be adjusted.
-// Return the list of parsed lines, bucketed by an extruder.
-std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const
+// The parsed lines are bucketed by an extruder into m_per_extruder_adjustments.
+void CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::array<float, 7> &current_pos)
 {
-    std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
-    std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
-    for (size_t i = 0; i < m_extruder_ids.size(); ++ i) {
-        PerExtruderAdjustments &adj         = per_extruder_adjustments[i];
-        unsigned int            extruder_id = m_extruder_ids[i];
-        adj.extruder_id               = extruder_id;
-        adj.cooling_slow_down_enabled = m_config.slow_down_for_layer_cooling.get_at(extruder_id);
-        adj.slow_down_layer_time = float(m_config.slow_down_layer_time.get_at(extruder_id));
-        adj.slow_down_min_speed           = float(m_config.slow_down_min_speed.get_at(extruder_id));
-        // ORCA: To enable dont slow down external perimeters feature per filament (extruder)
-        adj.dont_slow_down_outer_wall   = m_config.dont_slow_down_outer_wall.get_at(extruder_id);
-        map_extruder_to_per_extruder_adjustment[extruder_id] = i;
-    }
+    for (PerExtruderAdjustments &adj : m_per_extruder_adjustments)
+        adj.clear_lines();
 
     unsigned int      current_extruder  = m_current_extruder;
-    PerExtruderAdjustments *adjustment  = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
-    const char       *line_start = gcode.c_str();
-    const char       *line_end   = line_start;
+    PerExtruderAdjustments *adjustment  = &m_per_extruder_adjustments[m_map_extruder_to_per_extruder_adjustment[current_extruder]];
+    const char       *gcode_begin = gcode.c_str();
+    const char       *gcode_end   = gcode_begin + gcode.size();
+    const char       *line_start  = gcode_begin;
+    const char       *line_end    = line_start;
     // Index of an existing CoolingLine of the current adjustment, which holds the feedrate setting command
     // for a sequence of extrusion moves.
     size_t            active_speed_modifier = size_t(-1);
@@ -358,35 +391,39 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
     // Time of any other movements before the first extrusion will be excluded from the layer time.
     bool layer_had_extrusion = false;
 
-    for (; *line_start != 0; line_start = line_end) 
+    for (; line_start < gcode_end; line_start = line_end)
     {
-        while (*line_end != '\n' && *line_end != 0)
-            ++ line_end;
+        const char *eol = static_cast<const char*>(memchr(line_start, '\n', gcode_end - line_start));
+        if (eol == nullptr)
+            eol = gcode_end;
         // sline will not contain the trailing '\n'.
-        std::string sline(line_start, line_end);
+        const std::string_view sline(line_start, eol - line_start);
         // CoolingLine will contain the trailing '\n'.
-        if (*line_end == '\n')
-            ++ line_end;
-        CoolingLine line(0, line_start - gcode.c_str(), line_end - gcode.c_str());
-        if (boost::starts_with(sline, "G0 "))
-            line.type = CoolingLine::TYPE_G0;
-        else if (boost::starts_with(sline, "G1 "))
+        line_end = (eol == gcode_end) ? eol : eol + 1;
+        CoolingLine line(0, line_start - gcode_begin, line_end - gcode_begin);
+        if (starts_with(sline, "G1 "))
             line.type = CoolingLine::TYPE_G1;
-        else if (boost::starts_with(sline, "G92 "))
+        else if (starts_with(sline, "G0 "))
+            line.type = CoolingLine::TYPE_G0;
+        else if (starts_with(sline, "G92 "))
             line.type = CoolingLine::TYPE_G92;
-        else if (boost::starts_with(sline, "G2 "))
+        else if (starts_with(sline, "G2 "))
             line.type = CoolingLine::TYPE_G2;
-        else if (boost::starts_with(sline, "G3 "))
+        else if (starts_with(sline, "G3 "))
             line.type = CoolingLine::TYPE_G3;
         if (line.type) {
             // G0, G1 or G92
+            // The cooling markers are comments, they are only searched for past the first ';'.
+            const size_t           comment_pos = sline.find(';');
+            const std::string_view comment     = comment_pos == std::string_view::npos ? std::string_view() : sline.substr(comment_pos);
             // Parse the G-code line.
-            std::vector<float> new_pos(current_pos);
-            const char *c = sline.data() + 3;
+            std::array<float, 7> new_pos = current_pos;
+            const char *c          = sline.data() + 3;
+            const char *params_end = sline.data() + (comment_pos == std::string_view::npos ? sline.size() : comment_pos);
             for (;;) {
                 // Skip whitespaces.
-                for (; *c == ' ' || *c == '\t'; ++ c);
-                if (*c == 0 || *c == ';')
+                for (; c < params_end && (*c == ' ' || *c == '\t'); ++ c);
+                if (c >= params_end)
                     break;
 
                 assert(is_decimal_separator_point()); // for atof
@@ -408,17 +445,18 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                     }
                 }
                 // Skip this word.
-                for (; *c != ' ' && *c != '\t' && *c != 0; ++ c);
+                for (; c < params_end && *c != ' ' && *c != '\t'; ++ c);
             }
-            bool external_perimeter = boost::contains(sline, ";_EXTERNAL_PERIMETER");
-            bool wipe               = boost::contains(sline, ";_WIPE");
+            bool external_perimeter = has_marker(comment, ";_EXTERNAL_PERIMETER");
+            bool wipe               = has_marker(comment, ";_WIPE");
+            bool set_speed          = has_marker(comment, ";_EXTRUDE_SET_SPEED");
             if (external_perimeter)
                 line.type |= CoolingLine::TYPE_EXTERNAL_PERIMETER;
             if (wipe)
                 line.type |= CoolingLine::TYPE_WIPE;
 
             // Orca: only slow down movements since the first extrusion
-            if (boost::contains(sline, ";_EXTRUDE_SET_SPEED"))
+            if (set_speed)
                 layer_had_extrusion = true;
             
             // ORCA: Dont slowdown external perimeters for layer time feature
@@ -428,7 +466,7 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
             
             // ORCA: Dont slowdown external perimeters for layer time works by not marking the external perimeter as adjustable, 
             // hence the slowdown algorithm ignores it.
-            if (boost::contains(sline, ";_EXTRUDE_SET_SPEED") && ! wipe && adjust_external) {
+            if (set_speed && ! wipe && adjust_external) {
                 line.type |= CoolingLine::TYPE_ADJUSTABLE;
                 active_speed_modifier = adjustment->lines.size();
             }
@@ -487,51 +525,51 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                     line.type = 0;
                 }
             }
-            current_pos = std::move(new_pos);
-        } else if (boost::starts_with(sline, ";_EXTRUDE_END")) {
+            current_pos = new_pos;
+        } else if (starts_with(sline, ";_EXTRUDE_END")) {
             line.type = CoolingLine::TYPE_EXTRUDE_END;
             active_speed_modifier = size_t(-1);
-        } else if (boost::starts_with(sline, m_toolchange_prefix)) {
+        } else if (starts_with(sline, m_toolchange_prefix)) {
             unsigned int new_extruder = 0;
             auto ret = std::from_chars(sline.data() + m_toolchange_prefix.size(), sline.data() + sline.size(), new_extruder);
             if (std::errc::invalid_argument != ret.ec) {
                 // Only change extruder in case the number is meaningful. User could provide an out-of-range index through custom gcodes -
                 // those shall be ignored.
-                if (new_extruder < map_extruder_to_per_extruder_adjustment.size()) {
+                if (new_extruder < m_map_extruder_to_per_extruder_adjustment.size()) {
                     if (new_extruder != current_extruder) {
                         // Switch the tool.
                         line.type        = CoolingLine::TYPE_SET_TOOL;
                         current_extruder = new_extruder;
-                        adjustment       = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
+                        adjustment       = &m_per_extruder_adjustments[m_map_extruder_to_per_extruder_adjustment[current_extruder]];
                     }
                 } else {
                     // Only log the error in case of MM printer. Single extruder printers likely ignore any T anyway.
-                    if (map_extruder_to_per_extruder_adjustment.size() > 1)
+                    if (m_map_extruder_to_per_extruder_adjustment.size() > 1)
                         BOOST_LOG_TRIVIAL(error) << "CoolingBuffer encountered an invalid toolchange, maybe from a custom gcode: " << sline;
                 }
             }
-        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_START")) {
+        } else if (starts_with(sline, ";_OVERHANG_FAN_START")) {
             line.type = CoolingLine::TYPE_OVERHANG_FAN_START;
-        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_END")) {
+        } else if (starts_with(sline, ";_OVERHANG_FAN_END")) {
             line.type = CoolingLine::TYPE_OVERHANG_FAN_END;
-        } else if (boost::starts_with(sline, ";_INTERNAL_BRIDGE_FAN_START")) { // ORCA: Add support for separate internal bridge fan speed control
+        } else if (starts_with(sline, ";_INTERNAL_BRIDGE_FAN_START")) { // ORCA: Add support for separate internal bridge fan speed control
             line.type = CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START;
-        } else if (boost::starts_with(sline, ";_INTERNAL_BRIDGE_FAN_END")) { // ORCA: Add support for separate internal bridge fan speed control
+        } else if (starts_with(sline, ";_INTERNAL_BRIDGE_FAN_END")) { // ORCA: Add support for separate internal bridge fan speed control
             line.type = CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_END;
-        } else if (boost::starts_with(sline, ";_SUPP_INTERFACE_FAN_START")) {
+        } else if (starts_with(sline, ";_SUPP_INTERFACE_FAN_START")) {
             line.type = CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START;
-        } else if (boost::starts_with(sline, ";_SUPP_INTERFACE_FAN_END")) {
+        } else if (starts_with(sline, ";_SUPP_INTERFACE_FAN_END")) {
             line.type = CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_END;
-        } else if (boost::starts_with(sline, "G4 ")) {
+        } else if (starts_with(sline, "G4 ")) {
             // Parse the wait time.
             line.type = CoolingLine::TYPE_G4;
             size_t pos_S = sline.find('S', 3);
             size_t pos_P = sline.find('P', 3);
             assert(is_decimal_separator_point()); // for atof
             line.time = line.time_max = float(
-                (pos_S > 0) ? atof(sline.c_str() + pos_S + 1) :
-                (pos_P > 0) ? atof(sline.c_str() + pos_P + 1) * 0.001 : 0.);
-        } else if (boost::starts_with(sline, ";_FORCE_RESUME_FAN_SPEED")) {
+                (pos_S != std::string_view::npos) ? atof(sline.data() + pos_S + 1) :
+                (pos_P != std::string_view::npos) ? atof(sline.data() + pos_P + 1) * 0.001 : 0.);
+        } else if (starts_with(sline, ";_FORCE_RESUME_FAN_SPEED")) {
             line.type = CoolingLine::TYPE_FORCE_RESUME_FAN;
         }
 
@@ -544,8 +582,6 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
         if (line.type != 0)
             adjustment->lines.emplace_back(std::move(line));
     }
-
-    return per_extruder_adjustments;
 }
 
 // Slow down an extruder range to slow_down_layer_time.
@@ -638,16 +674,15 @@ float CoolingBuffer::calculate_layer_slowdown(std::vector<PerExtruderAdjustments
     // Collect total print time of non-adjustable extruders.
     float elapsed_time_total0 = 0.f;
     for (PerExtruderAdjustments &adj : per_extruder_adjustments) {
-        // Curren total time for this extruder.
-        adj.time_total  = adj.elapsed_time_total();
-        // Maximum time for this extruder, when all extrusion moves are slowed down to min_extrusion_speed.
-        adj.time_maximum = adj.maximum_time_after_slowdown(true);
+        // Curren total time for this extruder and the maximum time for this extruder,
+        // when all extrusion moves are slowed down to min_extrusion_speed.
+        adj.update_time_totals(true);
         if (adj.cooling_slow_down_enabled && adj.lines.size() > 0) {
             by_slowdown_time.emplace_back(&adj);
             // sorts the lines, also sets adj.time_non_adjustable
             adj.sort_lines_by_decreasing_feedrate();
         } else
-            elapsed_time_total0 += adj.elapsed_time_total();
+            elapsed_time_total0 += adj.time_total;
     }
 
     std::sort(by_slowdown_time.begin(), by_slowdown_time.end(),
@@ -683,6 +718,38 @@ float CoolingBuffer::calculate_layer_slowdown(std::vector<PerExtruderAdjustments
     return elapsed_time_total0;
 }
 
+// Append a comment of a G-code line to out, removing ";_EXTRUDE_SET_SPEED" and, depending on the line type,
+// ";_EXTERNAL_PERIMETER" and ";_WIPE" markers on the fly.
+static void append_comment_without_cooling_markers(std::string &out, const char *begin, const char *end, size_t type)
+{
+    static constexpr const std::string_view extrude_set_speed  = ";_EXTRUDE_SET_SPEED";
+    static constexpr const std::string_view external_perimeter = ";_EXTERNAL_PERIMETER";
+    static constexpr const std::string_view wipe               = ";_WIPE";
+    auto marker_length = [end, type](const char *p) -> size_t {
+        const std::string_view rest(p, end - p);
+        if (starts_with(rest, extrude_set_speed))
+            return extrude_set_speed.size();
+        if ((type & CoolingLine::TYPE_EXTERNAL_PERIMETER) && starts_with(rest, external_perimeter))
+            return external_perimeter.size();
+        if ((type & CoolingLine::TYPE_WIPE) && starts_with(rest, wipe))
+            return wipe.size();
+        return 0;
+    };
+    // Start of the text not yet appended.
+    const char *run = begin;
+    for (const char *p = begin; p < end;) {
+        const char *semicolon = static_cast<const char*>(memchr(p, ';', end - p));
+        if (semicolon == nullptr)
+            break;
+        if (size_t len = marker_length(semicolon); len > 0) {
+            out.append(run, semicolon - run);
+            run = p = semicolon + len;
+        } else
+            p = semicolon + 1;
+    }
+    out.append(run, end - run);
+}
+
 // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
 // Returns the adjusted G-code.
 std::string CoolingBuffer::apply_layer_cooldown(
@@ -695,21 +762,34 @@ std::string CoolingBuffer::apply_layer_cooldown(
     // Per extruder list of G-code lines and their cool down attributes.
     std::vector<PerExtruderAdjustments>    &per_extruder_adjustments)
 {
+    // Lines, which may emit fan speed commands.
+    static constexpr const size_t fan_line_types = CoolingLine::TYPE_SET_TOOL | CoolingLine::TYPE_OVERHANG_FAN_START | CoolingLine::TYPE_OVERHANG_FAN_END |
+        CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START | CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_END | CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START |
+        CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_END | CoolingLine::TYPE_FORCE_RESUME_FAN;
+    // Upper estimate of the length of the fan speed commands emitted for a single line.
+    static constexpr const size_t fan_commands_length = 64;
+
     // First sort the adjustment lines by of multiple extruders by their position in the source G-code.
-    std::vector<const CoolingLine*> lines;
+    std::vector<const CoolingLine*> &lines = m_sorted_lines;
+    size_t n_fan_lines = 1;
     {
         size_t n_lines = 0;
         for (const PerExtruderAdjustments &adj : per_extruder_adjustments)
             n_lines += adj.lines.size();
+        lines.clear();
         lines.reserve(n_lines);
         for (const PerExtruderAdjustments &adj : per_extruder_adjustments)
-            for (const CoolingLine &line : adj.lines)
+            for (const CoolingLine &line : adj.lines) {
                 lines.emplace_back(&line);
+                if (line.type & fan_line_types)
+                    ++ n_fan_lines;
+            }
         std::sort(lines.begin(), lines.end(), [](const CoolingLine *ln1, const CoolingLine *ln2) { return ln1->line_start < ln2->line_start; } );
     }
-    // Second generate the adjusted G-code.
+    // Second generate the adjusted G-code. The slowed down feedrates are never longer than the source ones and the cooling markers
+    // are removed, thus only the fan speed commands may make the output longer than the source.
     std::string new_gcode;
-    new_gcode.reserve(gcode.size() * 2);
+    new_gcode.reserve(gcode.size() + n_fan_lines * fan_commands_length);
     bool overhang_fan_control= false;
     int  overhang_fan_speed   = 0;
     bool internal_bridge_fan_control= false; // ORCA: Add support for separate internal bridge fan speed control
@@ -800,10 +880,14 @@ std::string CoolingBuffer::apply_layer_cooldown(
 
     // Orca: Reduce set fan commands by deferring the GCodeWriter::set_fan calls. Inspired by SuperSlicer
     // define fan_speed_change_requests and initialize it with all possible types fan speed change requests
-    std::unordered_map<int, bool> fan_speed_change_requests = {{CoolingLine::TYPE_OVERHANG_FAN_START, false},
-                                                               {CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START, false}, // ORCA: Add support for separate internal bridge fan speed control
-                                                               {CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START, false},
-                                                               {CoolingLine::TYPE_FORCE_RESUME_FAN, false}};
+    enum FanSpeedChangeRequest {
+        OVERHANG_FAN,
+        INTERNAL_BRIDGE_FAN, // ORCA: Add support for separate internal bridge fan speed control
+        SUPPORT_INTERFACE_FAN,
+        FORCE_RESUME_FAN,
+        FAN_SPEED_CHANGE_REQUEST_COUNT
+    };
+    std::array<bool, FAN_SPEED_CHANGE_REQUEST_COUNT> fan_speed_change_requests { false, false, false, false };
     bool need_set_fan = false;
 
     for (const CoolingLine *line : lines) {
@@ -822,39 +906,39 @@ std::string CoolingBuffer::apply_layer_cooldown(
             }
             new_gcode.append(line_start, line_end - line_start);
         } else if (line->type & CoolingLine::TYPE_OVERHANG_FAN_START) {
-            if (overhang_fan_control && !fan_speed_change_requests[CoolingLine::TYPE_OVERHANG_FAN_START]) {
+            if (overhang_fan_control && !fan_speed_change_requests[OVERHANG_FAN]) {
                 need_set_fan = true;
-                fan_speed_change_requests[CoolingLine::TYPE_OVERHANG_FAN_START] = true;
+                fan_speed_change_requests[OVERHANG_FAN] = true;
            }
         } else if (line->type & CoolingLine::TYPE_OVERHANG_FAN_END) {
-            if (overhang_fan_control && fan_speed_change_requests[CoolingLine::TYPE_OVERHANG_FAN_START]) {
-                fan_speed_change_requests[CoolingLine::TYPE_OVERHANG_FAN_START] = false;
+            if (overhang_fan_control && fan_speed_change_requests[OVERHANG_FAN]) {
+                fan_speed_change_requests[OVERHANG_FAN] = false;
             }
             need_set_fan = true;
         } else if (line->type & CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START) { // ORCA: Add support for separate internal bridge fan speed control
-            if (internal_bridge_fan_control && !fan_speed_change_requests[CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START]) {
+            if (internal_bridge_fan_control && !fan_speed_change_requests[INTERNAL_BRIDGE_FAN]) {
                 need_set_fan = true;
-                fan_speed_change_requests[CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START] = true;
+                fan_speed_change_requests[INTERNAL_BRIDGE_FAN] = true;
            }
         } else if (line->type & CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_END) { // ORCA: Add support for separate internal bridge fan speed control
-            if (internal_bridge_fan_control && fan_speed_change_requests[CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START]) {
-                fan_speed_change_requests[CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START] = false;
+            if (internal_bridge_fan_control && fan_speed_change_requests[INTERNAL_BRIDGE_FAN]) {
+                fan_speed_change_requests[INTERNAL_BRIDGE_FAN] = false;
             }
             need_set_fan = true;
         } else if (line->type & CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START) {
-            if (supp_interface_fan_control && !fan_speed_change_requests[CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START]) {
-                fan_speed_change_requests[CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START] = true;
+            if (supp_interface_fan_control && !fan_speed_change_requests[SUPPORT_INTERFACE_FAN]) {
+                fan_speed_change_requests[SUPPORT_INTERFACE_FAN] = true;
                 need_set_fan = true;
             }
-        } else if (line->type & CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_END && fan_speed_change_requests[CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START]) {
+        } else if (line->type & CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_END && fan_speed_change_requests[SUPPORT_INTERFACE_FAN]) {
             if (supp_interface_fan_control) {
-                fan_speed_change_requests[CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START] = false;
+                fan_speed_change_requests[SUPPORT_INTERFACE_FAN] = false;
             }
             need_set_fan = true;
         } else if (line->type & CoolingLine::TYPE_FORCE_RESUME_FAN) {
             // check if any fan speed change request is active
-            if (m_fan_speed != -1 && !std::any_of(fan_speed_change_requests.begin(), fan_speed_change_requests.end(), [](const std::pair<int, bool>& p) { return p.second; })){
-                fan_speed_change_requests[CoolingLine::TYPE_FORCE_RESUME_FAN] = true;
+            if (m_fan_speed != -1 && !std::any_of(fan_speed_change_requests.begin(), fan_speed_change_requests.end(), [](bool request) { return request; })){
+                fan_speed_change_requests[FORCE_RESUME_FAN] = true;
                 need_set_fan = true;
             }
             if (m_additional_fan_speed != -1 && m_config.auxiliary_fan.value)
@@ -866,14 +950,16 @@ std::string CoolingBuffer::apply_layer_cooldown(
             // Find the start of a comment, or roll to the end of line.
             const char *end = line_start;
             for (; end < line_end && *end != ';'; ++ end);
-            // Find the 'F' word.
-            const char *fpos            = strstr(line_start + 2, " F") + 2;
+            // Find the 'F' word. The marked lines are emitted by GCodeWriter::set_speed() with the 'F' word,
+            // look for it inside the current line only.
+            const size_t f_idx          = std::string_view(line_start, line_end - line_start).find(" F", 2);
+            assert(f_idx != std::string_view::npos);
+            const char *fpos            = (f_idx == std::string_view::npos) ? end : line_start + f_idx + 2;
             int         new_feedrate    = current_feedrate;
             // Modify the F word of the current G-code line.
             bool        modify          = false;
             // Remove the F word from the current G-code line.
             bool        remove          = false;
-            assert(fpos != nullptr);
             new_feedrate = line->slowdown ? int(floor(60. * line->feedrate + 0.5)) : atoi(fpos);
             if (new_feedrate == current_feedrate) {
                 // No need to change the F value.
@@ -897,9 +983,8 @@ std::string CoolingBuffer::apply_layer_cooldown(
                     // Replace the feedrate.
                     new_gcode.append(line_start, fpos - line_start);
                     current_feedrate = new_feedrate;
-                    char buf[64];
-                    sprintf(buf, "%d", int(current_feedrate));
-                    new_gcode += buf;
+                    char buf[16];
+                    new_gcode.append(buf, std::to_chars(buf, buf + sizeof(buf), current_feedrate).ptr);
                 } else {
                     // Remove the feedrate word.
                     const char *f = fpos;
@@ -929,13 +1014,7 @@ std::string CoolingBuffer::apply_layer_cooldown(
             if (end < line_end) {
                 if (line->type & (CoolingLine::TYPE_ADJUSTABLE | CoolingLine::TYPE_EXTERNAL_PERIMETER | CoolingLine::TYPE_WIPE)) {
                     // Process comments, remove ";_EXTRUDE_SET_SPEED", ";_EXTERNAL_PERIMETER", ";_WIPE"
-                    std::string comment(end, line_end);
-                    boost::replace_all(comment, ";_EXTRUDE_SET_SPEED", "");
-                    if (line->type & CoolingLine::TYPE_EXTERNAL_PERIMETER)
-                        boost::replace_all(comment, ";_EXTERNAL_PERIMETER", "");
-                    if (line->type & CoolingLine::TYPE_WIPE)
-                        boost::replace_all(comment, ";_WIPE", "");
-                    new_gcode += comment;
+                    append_comment_without_cooling_markers(new_gcode, end, line_end, line->type);
                 } else {
                     // Just attach the rest of the source line.
                     new_gcode.append(end, line_end - end);
@@ -946,20 +1025,20 @@ std::string CoolingBuffer::apply_layer_cooldown(
         }
 
         if (need_set_fan) {
-            if (fan_speed_change_requests[CoolingLine::TYPE_OVERHANG_FAN_START]){
+            if (fan_speed_change_requests[OVERHANG_FAN]){
                 new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, overhang_fan_speed);
                 m_current_fan_speed = overhang_fan_speed;
-            } else if (fan_speed_change_requests[CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START]){ // ORCA: Add support for separate internal bridge fan speed control
+            } else if (fan_speed_change_requests[INTERNAL_BRIDGE_FAN]){ // ORCA: Add support for separate internal bridge fan speed control
                 new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, internal_bridge_fan_speed);
                 m_current_fan_speed = internal_bridge_fan_speed;
             }
-            else if (fan_speed_change_requests[CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START]){
+            else if (fan_speed_change_requests[SUPPORT_INTERFACE_FAN]){
                 new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, supp_interface_fan_speed);
                 m_current_fan_speed = supp_interface_fan_speed;
             }
-            else if(fan_speed_change_requests[CoolingLine::TYPE_FORCE_RESUME_FAN] && m_current_fan_speed != -1){
+            else if(fan_speed_change_requests[FORCE_RESUME_FAN] && m_current_fan_speed != -1){
                 new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_current_fan_speed);
-                fan_speed_change_requests[CoolingLine::TYPE_FORCE_RESUME_FAN] = false;
+                fan_speed_change_requests[FORCE_RESUME_FAN] = false;
             }
             else
                 new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_fan_speed);
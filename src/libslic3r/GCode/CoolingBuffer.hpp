@@ -2,6 +2,7 @@
 #define slic3r_CoolingBuffer_hpp_
 
 #include "../libslic3r.h"
+#include <array>
 #include <map>
 #include <string>
 #include <cfloat>
@@ -10,6 +11,7 @@ namespace Slic3r {
 
 class GCode;
 class Layer;
+struct CoolingLine;
 struct PerExtruderAdjustments;
 
 // A standalone G-code filter, to control cooling of the print.
@@ -24,13 +26,15 @@ struct PerExtruderAdjustments;
 class CoolingBuffer {
 public:
     CoolingBuffer(GCode &gcodegen);
+    ~CoolingBuffer();
     void        reset(const Vec3d &position);
     void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; }
     std::string process_layer(std::string &&gcode, size_t layer_id, bool flush);
 
 private:
 	CoolingBuffer& operator=(const CoolingBuffer&) = delete;
-    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const;
+    // Parse the layer G-code into the lines of m_per_extruder_adjustments.
+    void        parse_layer_gcode(const std::string &gcode, std::array<float, 7> &current_pos);
     float       calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
     // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
     // Returns the adjusted G-code.
@@ -41,7 +45,7 @@ private:
     // Internal data.
     // BBS: X,Y,Z,E,F,I,J
     std::vector<char>           m_axis;
-    std::vector<float>          m_current_pos;
+    std::array<float, 7>        m_current_pos;
     // Current known fan speed or -1 if not known yet.
     int                         m_fan_speed;
     int                         m_additional_fan_speed;
@@ -50,6 +54,13 @@ private:
     std::vector<unsigned int>   m_extruder_ids;
     // Highest of m_extruder_ids plus 1.
     unsigned int                m_num_extruders { 0 };
+    // Lines of the layer being processed, bucketed by an extruder. The per extruder settings are set up once,
+    // the lines are cleared for each layer while keeping their memory.
+    std::vector<PerExtruderAdjustments> m_per_extruder_adjustments;
+    // Index into m_per_extruder_adjustments for an extruder ID.
+    std::vector<size_t>         m_map_extruder_to_per_extruder_adjustment;
+    // Lines of all the extruders sorted by their position in the layer G-code, reused by apply_layer_cooldown().
+    std::vector<const CoolingLine*> m_sorted_lines;
     const std::string           m_toolchange_prefix;
     // Referencs GCode::m_config, which is FullPrintConfig. While the PrintObjectConfig slice of FullPrintConfig is being modified,
     // the PrintConfig slice of FullPrintConfig is constant, thus no thread synchronization is required.
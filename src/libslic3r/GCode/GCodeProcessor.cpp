@@ -17,6 +17,8 @@
 
 #include <fast_float/fast_float.h>
 
+#include <tbb/parallel_for.h>
+
 #include <float.h>
 #include <assert.h>
 #include <regex>
@@ -104,7 +106,7 @@ const std::string GCodeProcessor::External_Purge_Tag = " EXTERNAL_PURGE";
 const float GCodeProcessor::Wipe_Width = 0.05f;
 const float GCodeProcessor::Wipe_Height = 0.05f;
 
-bool GCodeProcessor::s_IsBBLPrinter = true;
+std::atomic<bool> GCodeProcessor::s_IsBBLPrinter { true };
 
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
 const std::string GCodeProcessor::Mm3_Per_Mm_Tag = "MM3_PER_MM:";
@@ -551,12 +553,145 @@ void GCodeProcessor::UsedFilaments::process_caches(GCodeProcessor* processor)
     process_total_volume_cache(processor);
 }
 
+template<typename Fn>
+void GCodeProcessorResult::MoveVertexStore::for_each_column(Fn &&fn)
+{
+    fn(gcode_id);
+    fn(type);
+    fn(extrusion_role);
+    fn(extruder_id);
+    fn(cp_color_id);
+    fn(position);
+    fn(delta_extruder);
+    fn(feedrate);
+    fn(width);
+    fn(height);
+    fn(mm3_per_mm);
+    fn(travel_dist);
+    fn(fan_speed);
+    fn(temperature);
+    fn(time);
+    fn(layer_duration);
+    fn(move_path_type);
+    fn(arc_center_position);
+    fn(interpolation_points_offset);
+    fn(interpolation_points_count);
+}
+
+void GCodeProcessorResult::MoveVertexStore::push_back(const MoveVertex &move)
+{
+    gcode_id.push_back(move.gcode_id);
+    type.push_back(move.type);
+    extrusion_role.push_back(move.extrusion_role);
+    extruder_id.push_back(move.extruder_id);
+    cp_color_id.push_back(move.cp_color_id);
+    position.push_back(move.position);
+    delta_extruder.push_back(move.delta_extruder);
+    feedrate.push_back(move.feedrate);
+    width.push_back(move.width);
+    height.push_back(move.height);
+    mm3_per_mm.push_back(move.mm3_per_mm);
+    travel_dist.push_back(move.travel_dist);
+    fan_speed.push_back(move.fan_speed);
+    temperature.push_back(move.temperature);
+    time.push_back(move.time);
+    layer_duration.push_back(move.layer_duration);
+    move_path_type.push_back(move.move_path_type);
+    arc_center_position.push_back(move.arc_center_position);
+    assert(interpolation_points_pool.size() + move.interpolation_points.size() <= std::numeric_limits<uint32_t>::max());
+    interpolation_points_offset.push_back(uint32_t(interpolation_points_pool.size()));
+    interpolation_points_count.push_back(uint32_t(move.interpolation_points.size()));
+    // The points may live in the pool itself, reserve first to not invalidate them while appending.
+    interpolation_points_pool.reserve(interpolation_points_pool.size() + move.interpolation_points.size());
+    interpolation_points_pool.insert(interpolation_points_pool.end(), move.interpolation_points.begin(), move.interpolation_points.end());
+}
+
+void GCodeProcessorResult::MoveVertexStore::move_to_back(size_t idx)
+{
+    assert(idx < this->size());
+    // The interpolation points stay in place in the pool, only their offset moves with the other fields.
+    this->for_each_column([idx](auto &column) { std::rotate(column.begin() + idx, column.begin() + idx + 1, column.end()); });
+}
+
+void GCodeProcessorResult::MoveVertexStore::reserve(size_t n)
+{
+    this->for_each_column([n](auto &column) { column.reserve(n); });
+}
+
+void GCodeProcessorResult::MoveVertexStore::clear()
+{
+    this->for_each_column([](auto &column) { column.clear(); });
+    interpolation_points_pool.clear();
+}
+
+void GCodeProcessorResult::MoveVertexStore::shrink_to_fit()
+{
+    this->for_each_column([](auto &column) { column.shrink_to_fit(); });
+    interpolation_points_pool.shrink_to_fit();
+}
+
+size_t GCodeProcessorResult::MoveVertexStore::memsize() const
+{
+    size_t out = 0;
+    const_cast<MoveVertexStore*>(this)->for_each_column([&out](const auto &column) { out += column.capacity() * sizeof(column.front()); });
+    return out + interpolation_points_pool.capacity() * sizeof(Vec3f);
+}
+
+uint64_t GCodeProcessorResult::MoveVertexStore::hash(size_t begin, size_t end) const
+{
+    assert(begin <= end && end <= this->size());
+    // FNV-1a over the bytes of the columns.
+    uint64_t out = 14695981039346656037ull;
+    auto hash_bytes = [&out](const void *data, size_t size) {
+        const unsigned char *bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++ i) {
+            out ^= bytes[i];
+            out *= 1099511628211ull;
+        }
+    };
+    auto hash_column = [begin, end, &hash_bytes](const auto &column) {
+        if (begin < end)
+            hash_bytes(column.data() + begin, (end - begin) * sizeof(column.front()));
+    };
+    const size_t count = end - begin;
+    hash_bytes(&count, sizeof(count));
+    hash_column(type);
+    hash_column(extrusion_role);
+    hash_column(extruder_id);
+    hash_column(cp_color_id);
+    hash_column(position);
+    hash_column(delta_extruder);
+    hash_column(feedrate);
+    hash_column(width);
+    hash_column(height);
+    hash_column(mm3_per_mm);
+    hash_column(travel_dist);
+    hash_column(fan_speed);
+    hash_column(temperature);
+    hash_column(layer_duration);
+    hash_column(move_path_type);
+    hash_column(arc_center_position);
+    hash_column(interpolation_points_count);
+    for (size_t i = begin; i < end; ++ i)
+        if (interpolation_points_count[i] > 0)
+            hash_bytes(interpolation_points_pool.data() + interpolation_points_offset[i], interpolation_points_count[i] * sizeof(Vec3f));
+    return out;
+}
+
+size_t GCodeProcessorResult::common_moves_prefix(const std::vector<LayerHash> &lhs, const std::vector<LayerHash> &rhs)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < std::min(lhs.size(), rhs.size()) && lhs[i] == rhs[i]; ++ i)
+        out = lhs[i].first_move + lhs[i].moves_count;
+    return out;
+}
+
 #if ENABLE_GCODE_VIEWER_STATISTICS
 void GCodeProcessorResult::reset() {
     //BBS: add mutex for protection of gcode result
     lock();
 
-    moves = std::vector<GCodeProcessorResult::MoveVertex>();
+    moves = GCodeProcessorResult::MoveVertexStore();
     printable_area = Pointfs();
     //BBS: add bed exclude area
     bed_exclude_area = Pointfs();
@@ -573,6 +708,7 @@ void GCodeProcessorResult::reset() {
     filament_densities = std::vector<float>(MIN_EXTRUDERS_COUNT, DEFAULT_FILAMENT_DENSITY);
     custom_gcode_per_print_z = std::vector<CustomGCode::Item>();
     spiral_vase_layers = std::vector<std::pair<float, std::pair<size_t, size_t>>>();
+    layer_hashes.clear();
     time = 0;
 
     //BBS: add mutex for protection of gcode result
@@ -605,6 +741,7 @@ void GCodeProcessorResult::reset() {
     filament_costs = std::vector<float>(MIN_EXTRUDERS_COUNT, DEFAULT_FILAMENT_COST);
     custom_gcode_per_print_z = std::vector<CustomGCode::Item>();
     spiral_vase_layers = std::vector<std::pair<float, std::pair<size_t, size_t>>>();
+    layer_hashes.clear();
     bed_match_result = BedMatchResult(true);
     warnings.clear();
 
@@ -632,7 +769,7 @@ const std::vector<std::pair<GCodeProcessor::EProducer, std::string>> GCodeProces
     //{ EProducer::KissSlicer,  "KISSlicer" }
 };
 
-unsigned int GCodeProcessor::s_result_id = 0;
+std::atomic<unsigned int> GCodeProcessor::s_result_id { 0 };
 
 bool GCodeProcessor::contains_reserved_tag(const std::string& gcode, std::string& found_tag)
 {
@@ -1263,7 +1400,7 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     m_result.filename = filename;
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
+    m_result.moves.push_back(GCodeProcessorResult::MoveVertex());
     size_t parse_line_callback_cntr = 10000;
     m_parser.parse_file(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (-- parse_line_callback_cntr == 0) {
@@ -1291,7 +1428,7 @@ void GCodeProcessor::initialize(const std::string& filename)
     m_result.filename = filename;
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
+    m_result.moves.push_back(GCodeProcessorResult::MoveVertex());
 }
 
 void GCodeProcessor::process_buffer(const std::string &buffer)
@@ -1305,10 +1442,10 @@ void GCodeProcessor::process_buffer(const std::string &buffer)
 void GCodeProcessor::finalize(bool post_process)
 {
     // update width/height of wipe moves
-    for (GCodeProcessorResult::MoveVertex& move : m_result.moves) {
-        if (move.type == EMoveType::Wipe) {
-            move.width = Wipe_Width;
-            move.height = Wipe_Height;
+    for (size_t i = 0; i < m_result.moves.size(); ++ i) {
+        if (m_result.moves.type[i] == EMoveType::Wipe) {
+            m_result.moves.width[i] = Wipe_Width;
+            m_result.moves.height[i] = Wipe_Height;
         }
     }
 
@@ -1329,17 +1466,35 @@ void GCodeProcessor::finalize(bool post_process)
     auto it = std::find_if(time_mode.roles_times.begin(), time_mode.roles_times.end(), [](const std::pair<ExtrusionRole, float>& item) { return erCustom == item.first; });
     auto prepare_time = (it != time_mode.roles_times.end()) ? it->second : 0.0f;
 
+    // split the moves into layers for the content hashes while layer_duration still contains the layer ids
+    std::vector<size_t> layer_first_moves;
+    for (size_t i = 0; i < m_result.moves.size(); ++i) {
+        if (i == 0 || m_result.moves.layer_duration[i] != m_result.moves.layer_duration[i - 1])
+            layer_first_moves.emplace_back(i);
+    }
+
     //update times for results
-    for (size_t i = 0; i < m_result.moves.size(); i++) {
+    for (float &layer_duration : m_result.moves.layer_duration) {
         //field layer_duration contains the layer id for the move in which the layer_duration has to be set.
-        size_t layer_id = size_t(m_result.moves[i].layer_duration);
+        size_t layer_id = size_t(layer_duration);
         std::vector<float>& layer_times = m_result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].layers_times;
         if (layer_times.size() > layer_id - 1 && layer_id > 0)
-            m_result.moves[i].layer_duration = layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
+            layer_duration = layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
         else
-            m_result.moves[i].layer_duration = 0;
+            layer_duration = 0;
     }
-    
+
+    m_result.layer_hashes.assign(layer_first_moves.size(), GCodeProcessorResult::LayerHash());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layer_first_moves.size()),
+        [this, &layer_first_moves](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                GCodeProcessorResult::LayerHash &layer_hash = m_result.layer_hashes[i];
+                layer_hash.first_move  = layer_first_moves[i];
+                layer_hash.moves_count = (i + 1 < layer_first_moves.size() ? layer_first_moves[i + 1] : m_result.moves.size()) - layer_first_moves[i];
+                layer_hash.hash        = m_result.moves.hash(layer_hash.first_move, layer_hash.first_move + layer_hash.moves_count);
+            }
+        }); // end of parallel_for
+
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     std::cout << "\n";
     m_mm3_per_mm_compare.output();
@@ -2956,7 +3111,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
         // check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
             //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position.back() - m_extruder_offsets[m_extruder_id] - plate_offset;
             if (!m_seams_detector.has_first_vertex()) {
                 m_seams_detector.set_first_vertex(new_pos);
             } else if (m_detect_layer_based_on_tag) {
@@ -2975,7 +3130,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
 
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
             //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position.back() - m_extruder_offsets[m_extruder_id] - plate_offset;
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             // the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
 
@@ -2990,7 +3145,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
     }
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.position.back() - m_extruder_offsets[m_extruder_id] - plate_offset);
     }
 
     if (m_detect_layer_based_on_tag && !m_result.spiral_vase_layers.empty()) {
@@ -3391,7 +3546,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     if (m_seams_detector.is_active()) {
         //BBS: check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position.back() - m_extruder_offsets[m_extruder_id] - plate_offset;
             if (!m_seams_detector.has_first_vertex()) {
                 m_seams_detector.set_first_vertex(new_pos);
             } else if (m_detect_layer_based_on_tag) {
@@ -3408,7 +3563,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
                 m_end_position[X] = pos.x(); m_end_position[Y] = pos.y(); m_end_position[Z] = pos.z();
             };
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position.back() - m_extruder_offsets[m_extruder_id] - plate_offset;
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             //BBS: the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
 
@@ -3423,7 +3578,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     }
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.position.back() - m_extruder_offsets[m_extruder_id] - plate_offset);
     }
 
     // Orca: we now use spiral_vase_layers for proper layer detect when scarf joint is enabled,
@@ -4368,12 +4523,12 @@ void GCodeProcessor::run_post_process()
 
         void synchronize_moves(GCodeProcessorResult& result) const {
             auto it = m_gcode_lines_map.begin();
-            for (GCodeProcessorResult::MoveVertex& move : result.moves) {
-                while (it != m_gcode_lines_map.end() && it->first < move.gcode_id) {
+            for (unsigned int& gcode_id : result.moves.gcode_id) {
+                while (it != m_gcode_lines_map.end() && it->first < gcode_id) {
                     ++it;
                 }
-                if (it != m_gcode_lines_map.end() && it->first == move.gcode_id)
-                    move.gcode_id = it->second;
+                if (it != m_gcode_lines_map.end() && it->first == gcode_id)
+                    gcode_id = it->second;
             }
         }
 
@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <array>
+#include <atomic>
 #include <vector>
 #include <mutex>
 #include <string>
@@ -149,6 +150,26 @@ class Print;
             }
         };
 
+        // Non owning view of the interpolation points of an arc move, stored in the pool of MoveVertexStore.
+        // It is valid as long as the store is not modified.
+        class PointsView
+        {
+        public:
+            PointsView() = default;
+            PointsView(const Vec3f *data, size_t size) : m_data(data), m_size(size) {}
+            PointsView(const std::vector<Vec3f> &points) : m_data(points.data()), m_size(points.size()) {}
+
+            size_t       size()  const { return m_size; }
+            bool         empty() const { return m_size == 0; }
+            const Vec3f& operator[](size_t idx) const { assert(idx < m_size); return m_data[idx]; }
+            const Vec3f* begin() const { return m_data; }
+            const Vec3f* end()   const { return m_data + m_size; }
+
+        private:
+            const Vec3f *m_data { nullptr };
+            size_t       m_size { 0 };
+        };
+
         struct MoveVertex
         {
             unsigned int gcode_id{ 0 };
@@ -172,7 +193,7 @@ class Print;
             //BBS: arc move related data
             EMovePathType move_path_type{ EMovePathType::Noop_move };
             Vec3f arc_center_position{ Vec3f::Zero() };      // mm
-            std::vector<Vec3f> interpolation_points;     // interpolation points of arc for drawing
+            PointsView interpolation_points;             // interpolation points of arc for drawing
 
             float volumetric_rate() const { return feedrate * mm3_per_mm; }
             //BBS: new function to support arc move
@@ -184,6 +205,110 @@ class Print;
             }
         };
 
+        // Columnar storage of the moves: Each field of MoveVertex is stored in its own array, so that the readers
+        // touching a few fields only stream through these fields. The interpolation points of all the arc moves share
+        // a single pool and they are referenced by offset, thus no allocation is made per move.
+        // operator[] and the iterators assemble a MoveVertex on the fly for the readers needing the whole move.
+        class MoveVertexStore
+        {
+        public:
+            class const_iterator
+            {
+            public:
+                using iterator_category = std::random_access_iterator_tag;
+                using value_type        = MoveVertex;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = void;
+                using reference         = MoveVertex;
+
+                const_iterator() = default;
+                const_iterator(const MoveVertexStore *store, size_t idx) : m_store(store), m_idx(idx) {}
+
+                MoveVertex      operator*() const { return (*m_store)[m_idx]; }
+                MoveVertex      operator[](difference_type n) const { return (*m_store)[m_idx + n]; }
+                const_iterator& operator++() { ++ m_idx; return *this; }
+                const_iterator  operator++(int) { const_iterator out = *this; ++ m_idx; return out; }
+                const_iterator& operator--() { -- m_idx; return *this; }
+                const_iterator  operator--(int) { const_iterator out = *this; -- m_idx; return out; }
+                const_iterator& operator+=(difference_type n) { m_idx += n; return *this; }
+                const_iterator& operator-=(difference_type n) { m_idx -= n; return *this; }
+                const_iterator  operator+(difference_type n) const { return const_iterator(m_store, m_idx + n); }
+                const_iterator  operator-(difference_type n) const { return const_iterator(m_store, m_idx - n); }
+                difference_type operator-(const const_iterator &rhs) const { return difference_type(m_idx) - difference_type(rhs.m_idx); }
+                bool            operator==(const const_iterator &rhs) const { return m_idx == rhs.m_idx; }
+                bool            operator!=(const const_iterator &rhs) const { return m_idx != rhs.m_idx; }
+                bool            operator<(const const_iterator &rhs) const { return m_idx < rhs.m_idx; }
+                size_t          index() const { return m_idx; }
+
+            private:
+                const MoveVertexStore *m_store { nullptr };
+                size_t                 m_idx { 0 };
+            };
+
+            size_t          size()  const { return gcode_id.size(); }
+            bool            empty() const { return gcode_id.empty(); }
+            MoveVertex      operator[](size_t idx) const {
+                assert(idx < this->size());
+                return { gcode_id[idx], type[idx], extrusion_role[idx], extruder_id[idx], cp_color_id[idx], position[idx],
+                         delta_extruder[idx], feedrate[idx], width[idx], height[idx], mm3_per_mm[idx], travel_dist[idx],
+                         fan_speed[idx], temperature[idx], time[idx], layer_duration[idx], move_path_type[idx], arc_center_position[idx],
+                         this->interpolation_points(idx) };
+            }
+            MoveVertex      front() const { return (*this)[0]; }
+            MoveVertex      back()  const { return (*this)[this->size() - 1]; }
+            const_iterator  begin() const { return const_iterator(this, 0); }
+            const_iterator  end()   const { return const_iterator(this, this->size()); }
+
+            // Accessors of single columns, to be used by the loops over many moves instead of operator[],
+            // which assembles a MoveVertex from all the columns.
+            PointsView      interpolation_points(size_t idx) const
+                { return { interpolation_points_pool.data() + interpolation_points_offset[idx], interpolation_points_count[idx] }; }
+            bool            is_arc_move(size_t idx) const
+                { return move_path_type[idx] == EMovePathType::Arc_move_ccw || move_path_type[idx] == EMovePathType::Arc_move_cw; }
+            bool            is_arc_move_with_interpolation_points(size_t idx) const
+                { return this->is_arc_move(idx) && interpolation_points_count[idx] > 0; }
+
+            void            push_back(const MoveVertex &move);
+            // Move the move at idx to the end, shifting the following moves by one to the front.
+            void            move_to_back(size_t idx);
+            void            reserve(size_t n);
+            void            clear();
+            void            shrink_to_fit();
+            // Memory allocated by the store in bytes.
+            size_t          memsize() const;
+            // Hash of the moves [begin, end) as drawn by the G-code viewer. The G-code line ids and the times of the moves are not hashed,
+            // the layer durations are, as they split the paths and color the layer time view. The interpolation points are hashed by value.
+            uint64_t        hash(size_t begin, size_t end) const;
+
+            // Columns, one item per move. Writers may modify the items in place.
+            std::vector<unsigned int>   gcode_id;
+            std::vector<EMoveType>      type;
+            std::vector<ExtrusionRole>  extrusion_role;
+            std::vector<unsigned char>  extruder_id;
+            std::vector<unsigned char>  cp_color_id;
+            std::vector<Vec3f>          position;
+            std::vector<float>          delta_extruder;
+            std::vector<float>          feedrate;
+            std::vector<float>          width;
+            std::vector<float>          height;
+            std::vector<float>          mm3_per_mm;
+            std::vector<float>          travel_dist;
+            std::vector<float>          fan_speed;
+            std::vector<float>          temperature;
+            std::vector<float>          time;
+            std::vector<float>          layer_duration;
+            std::vector<EMovePathType>  move_path_type;
+            std::vector<Vec3f>          arc_center_position;
+            // Range of each move in interpolation_points_pool.
+            std::vector<uint32_t>       interpolation_points_offset;
+            std::vector<uint32_t>       interpolation_points_count;
+            // Interpolation points of all the arc moves.
+            std::vector<Vec3f>          interpolation_points_pool;
+
+        private:
+            template<typename Fn> void for_each_column(Fn &&fn);
+        };
+
         struct SliceWarning {
             int         level;                  // 0: normal tips, 1: warning; 2: error
             std::string msg;                    // enum string
@@ -193,7 +318,7 @@ class Print;
 
         std::string filename;
         unsigned int id;
-        std::vector<MoveVertex> moves;
+        MoveVertexStore moves;
         // Positions of ends of lines of the final G-code this->filename after TimeProcessor::post_process() finalizes the G-code.
         std::vector<size_t> lines_ends;
         Pointfs printable_area;
@@ -220,6 +345,18 @@ class Print;
         PrintEstimatedStatistics print_statistics;
         std::vector<CustomGCode::Item> custom_gcode_per_print_z;
         std::vector<std::pair<float, std::pair<size_t, size_t>>> spiral_vase_layers;
+        // Content hashes of the moves, split into blocks at each change of the layer id of the moves.
+        // The G-code viewer reuses the toolpaths of the leading layers not changed since the previously loaded result.
+        struct LayerHash
+        {
+            size_t   first_move { 0 };
+            size_t   moves_count { 0 };
+            uint64_t hash { 0 };
+
+            bool operator==(const LayerHash &rhs) const { return first_move == rhs.first_move && moves_count == rhs.moves_count && hash == rhs.hash; }
+            bool operator!=(const LayerHash &rhs) const { return ! (*this == rhs); }
+        };
+        std::vector<LayerHash> layer_hashes;
         //BBS
         std::vector<SliceWarning> warnings;
         int nozzle_hrc;
@@ -229,6 +366,8 @@ class Print;
         int64_t time{ 0 };
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
         void reset();
+        // Number of the leading moves of two results drawn the same, given their layer hashes.
+        static size_t common_moves_prefix(const std::vector<LayerHash> &lhs, const std::vector<LayerHash> &rhs);
 
         //BBS: add mutex for protection of gcode result
         mutable std::mutex result_mutex;
@@ -254,6 +393,7 @@ class Print;
             print_statistics = other.print_statistics;
             custom_gcode_per_print_z = other.custom_gcode_per_print_z;
             spiral_vase_layers = other.spiral_vase_layers;
+            layer_hashes = other.layer_hashes;
             warnings = other.warnings;
             bed_type = other.bed_type;
             bed_match_result = other.bed_match_result;
@@ -310,7 +450,9 @@ class Print;
         static const float Wipe_Width;
         static const float Wipe_Height;
 
-        static bool s_IsBBLPrinter;
+        // Written by each G-code export and by the wipe tower generators, which run in parallel for the plates sliced in parallel.
+        // All the writers of a print store the same value, see Print::is_BBL_printer().
+        static std::atomic<bool> s_IsBBLPrinter;
 
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
         static const std::string Mm3_Per_Mm_Tag;
@@ -587,12 +729,11 @@ class Print;
                 if (!m_move_id.has_value() || !m_custom_gcode_per_print_z_id.has_value())
                     return;
 
-                const Vec3f position = m_result.moves.back().position;
+                const Vec3f position = m_result.moves.position.back();
 
-                GCodeProcessorResult::MoveVertex& move = m_result.moves.emplace_back(m_result.moves[*m_move_id]);
-                move.position = position;
-                move.height = height;
-                m_result.moves.erase(m_result.moves.begin() + *m_move_id);
+                m_result.moves.move_to_back(*m_move_id);
+                m_result.moves.position.back() = position;
+                m_result.moves.height.back() = height;
                 m_result.custom_gcode_per_print_z[*m_custom_gcode_per_print_z_id].print_z = position.z();
                 reset();
             }
@@ -760,7 +901,7 @@ class Print;
         Print* m_print{ nullptr };
 
         GCodeProcessorResult m_result;
-        static unsigned int s_result_id;
+        static std::atomic<unsigned int> s_result_id;
 
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
         DataChecker m_mm3_per_mm_compare{ "mm3_per_mm", 0.01f };
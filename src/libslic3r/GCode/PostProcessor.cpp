@@ -1,4 +1,5 @@
 #include "PostProcessor.hpp"
+#include "BinaryGCode.hpp"
 
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/format.hpp"
@@ -225,6 +226,59 @@ void gcode_add_line_number(const std::string& path, const DynamicPrintConfig& co
     fs.close();
 }
 
+bool gcode_convert_to_binary(std::string &src_path, bool make_copy, std::string &output_name, const DynamicPrintConfig &config, const DynamicConfig &print_statistics, bool add_line_number)
+{
+    const ConfigOptionBool *opt = config.opt<ConfigOptionBool>("binary_gcode");
+    if (opt == nullptr || !opt->getBool())
+        return false;
+    if (!boost::filesystem::exists(src_path))
+        throw Slic3r::RuntimeError(std::string("Binary G-code converter can't find exported gcode file ") + src_path);
+
+    BinaryGCode::Metadata printer_metadata;
+    for (const char *key : { "printer_model", "nozzle_diameter", "filament_type", "printable_area", "printable_height" })
+        if (const ConfigOption *o = config.option(key); o != nullptr)
+            printer_metadata.emplace_back(key, o->serialize());
+    BinaryGCode::Metadata print_metadata;
+    for (const std::string &key : print_statistics.keys())
+        print_metadata.emplace_back(key, print_statistics.option(key)->serialize());
+
+    // Don't convert the input file if make_copy, it may be memory mapped by the G-code viewer.
+    const std::string path = make_copy ? src_path + ".bgcode" : src_path;
+    // The line numbers are stored into the ASCII G-code, which is then stored losslessly by the binary G-code.
+    const ConfigOptionBool *opt_line_number = config.opt<ConfigOptionBool>("gcode_add_line_number");
+    std::string ascii_path = src_path;
+    if (add_line_number && opt_line_number != nullptr && opt_line_number->getBool()) {
+        if (make_copy) {
+            ascii_path = src_path + ".ln";
+            std::string error_message;
+            if (copy_file(src_path, ascii_path, error_message, false) != SUCCESS)
+                throw Slic3r::RuntimeError(Slic3r::format("Failed making a temporary copy of G-code file %1% before adding the line numbers: %2%", src_path, error_message));
+        }
+        gcode_add_line_number(ascii_path, config);
+    }
+    auto delete_numbered_copy = [&ascii_path, &src_path]() {
+        if (ascii_path != src_path)
+            try {
+                boost::filesystem::remove(ascii_path);
+            } catch (const std::exception &err) {
+                BOOST_LOG_TRIVIAL(error) << Slic3r::format("Failed deleting a temporary copy %1% of a G-code file %2% : %3%", ascii_path, src_path, err.what());
+            }
+    };
+
+    BOOST_LOG_TRIVIAL(info) << "Converting " << src_path << " to binary G-code " << path;
+    try {
+        BinaryGCode::convert_ascii_to_binary(ascii_path, path, printer_metadata, print_metadata);
+    } catch (...) {
+        delete_numbered_copy();
+        throw;
+    }
+    delete_numbered_copy();
+
+    src_path    = path;
+    output_name = boost::filesystem::path(output_name).replace_extension(".bgcode").string();
+    return true;
+}
+
 // Run post processing script / scripts if defined.
 // Returns true if a post-processing script was executed.
 // Returns false if no post-processing script was defined.
@@ -28,6 +28,14 @@ inline bool run_post_process_scripts(std::string &src_path, const DynamicPrintCo
 
 // BBS
 extern void gcode_add_line_number(const std::string &path, const DynamicPrintConfig &config);
+// Convert the G-code at src_path into the binary G-code if enabled by "binary_gcode", returns false if not enabled.
+// Throws an exception on error. The extension of output_name is replaced by ".bgcode".
+// If make_copy, src_path is left intact, as it may be memory mapped by the G-code viewer: the binary G-code is written
+// into a new temporary file next to it and src_path is set to the temporary file. Otherwise src_path is converted in place.
+// If add_line_number, the G-code is numbered by gcode_add_line_number() before the conversion.
+// print_statistics are stored into the print metadata block.
+extern bool gcode_convert_to_binary(std::string &src_path, bool make_copy, std::string &output_name, const DynamicPrintConfig &config,
+                                    const DynamicConfig &print_statistics, bool add_line_number = false);
 
 } // namespace Slic3r
 
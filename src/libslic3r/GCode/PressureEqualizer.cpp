@@ -3,6 +3,7 @@
 #include <cstring>
 #include <cfloat>
 #include <algorithm>
+#include <string_view>
 
 #include "../libslic3r.h"
 #include "../PrintConfig.hpp"
@@ -112,11 +113,12 @@ void PressureEqualizer::process_layer(const std::string &gcode)
     // at this point, we have an entire layer of gcode lines loaded into m_gcode_lines
     // now we will split the mix of travels and extrudes into segments of continous extrusion and process those
     // We skip over large travels, and pretend small ones are part of a continous extrusion segment
+    this->gather_extruding_lines();
     long idx_end_current_extrusion = 0;
     while (idx_end_current_extrusion < m_gcode_lines.size()) {
         // find beginning of next extrusion segment from current pos
         const long idx_begin_current_extrusion   = find_if(m_gcode_lines.begin() + idx_end_current_extrusion, m_gcode_lines.end(),
-                                                          [](GCodeLine line) { return line.extruding(); }) - m_gcode_lines.begin();
+                                                          [](const GCodeLine &line) { return line.extruding(); }) - m_gcode_lines.begin();
         // (extrusion begin idx = extrusion end idx) here because we start with extrusion length of zero
         idx_end_current_extrusion = idx_begin_current_extrusion;
 
@@ -124,7 +126,7 @@ void PressureEqualizer::process_layer(const std::string &gcode)
         while (idx_end_current_extrusion < m_gcode_lines.size()) {
             // find end of the current extrusion segment
             const auto just_after_end_extrusion = find_if(m_gcode_lines.begin() + idx_end_current_extrusion, m_gcode_lines.end(),
-                                                          [](GCodeLine line) { return !line.extruding(); });
+                                                          [](const GCodeLine &line) { return !line.extruding(); });
             idx_end_current_extrusion = std::max<long>(0,(just_after_end_extrusion - m_gcode_lines.begin()) - 1);
             const long idx_begin_segment_continuation = advance_segment_beyond_small_gap(idx_end_current_extrusion);
             if (idx_begin_segment_continuation > idx_end_current_extrusion) {
@@ -147,6 +149,60 @@ void PressureEqualizer::process_layer(const std::string &gcode)
         // current extrusion is all done processing so advance beyond it for next loop
         idx_end_current_extrusion++;
     }
+    this->scatter_extruding_lines();
+}
+
+void PressureEqualizer::ExtrudingLines::clear()
+{
+    line_idx.clear();
+    extrusion_role.clear();
+    adjustable_flow.clear();
+    rate_locked.clear();
+    rate_length2.clear();
+    feedrate.clear();
+    volumetric_extrusion_rate_start.clear();
+    volumetric_extrusion_rate_end.clear();
+    max_volumetric_extrusion_rate_slope_positive.clear();
+    max_volumetric_extrusion_rate_slope_negative.clear();
+    modified.clear();
+}
+
+void PressureEqualizer::gather_extruding_lines()
+{
+    ExtrudingLines &out = m_extruding_lines;
+    out.clear();
+    for (size_t idx = 0; idx < m_gcode_lines.size(); ++ idx) {
+        const GCodeLine &line = m_gcode_lines[idx];
+        if (! line.extruding())
+            continue;
+        // Orca: Limit ERS to external perimeters and overhangs if option selected by user
+        const bool rate_locked = ! line.adjustable_flow || line.extrusion_role == ExtrusionRole::erBridgeInfill || line.extrusion_role == ExtrusionRole::erIroning ||
+            (m_extrusion_rate_smoothing_external_perimeter_only && line.extrusion_role != ExtrusionRole::erOverhangPerimeter && line.extrusion_role != ExtrusionRole::erExternalPerimeter);
+        out.line_idx.emplace_back(idx);
+        out.extrusion_role.emplace_back(line.extrusion_role);
+        out.adjustable_flow.emplace_back(line.adjustable_flow);
+        out.rate_locked.emplace_back(rate_locked);
+        out.rate_length2.emplace_back(2 * line.volumetric_extrusion_rate * line.dist_xyz());
+        out.feedrate.emplace_back(line.feedrate());
+        out.volumetric_extrusion_rate_start.emplace_back(line.volumetric_extrusion_rate_start);
+        out.volumetric_extrusion_rate_end.emplace_back(line.volumetric_extrusion_rate_end);
+        out.max_volumetric_extrusion_rate_slope_positive.emplace_back(line.max_volumetric_extrusion_rate_slope_positive);
+        out.max_volumetric_extrusion_rate_slope_negative.emplace_back(line.max_volumetric_extrusion_rate_slope_negative);
+        out.modified.emplace_back(line.modified);
+    }
+}
+
+void PressureEqualizer::scatter_extruding_lines()
+{
+    const ExtrudingLines &in = m_extruding_lines;
+    for (size_t i = 0; i < in.size(); ++ i) {
+        GCodeLine &line = m_gcode_lines[in.line_idx[i]];
+        line.volumetric_extrusion_rate_start              = in.volumetric_extrusion_rate_start[i];
+        line.volumetric_extrusion_rate_end                = in.volumetric_extrusion_rate_end[i];
+        line.max_volumetric_extrusion_rate_slope_positive = in.max_volumetric_extrusion_rate_slope_positive[i];
+        line.max_volumetric_extrusion_rate_slope_negative = in.max_volumetric_extrusion_rate_slope_negative[i];
+        line.modified                                     = in.modified[i];
+    }
 }
 
 long PressureEqualizer::advance_segment_beyond_small_gap(const long idx_orig)
@@ -285,9 +341,9 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
     buf.max_volumetric_extrusion_rate_slope_negative = 0.f;
 	buf.extrusion_role = m_current_extrusion_role;
 
-    std::string str_line(line, line_end);
-    const bool found_extrude_set_speed_tag = boost::contains(str_line, EXTRUDE_SET_SPEED_TAG);
-    const bool found_extrude_end_tag = boost::contains(str_line, EXTRUDE_END_TAG);
+    const std::string_view str_line(line, len);
+    const bool found_extrude_set_speed_tag = str_line.find(EXTRUDE_SET_SPEED_TAG) != std::string_view::npos;
+    const bool found_extrude_end_tag = str_line.find(EXTRUDE_END_TAG) != std::string_view::npos;
     assert(!found_extrude_set_speed_tag || !found_extrude_end_tag);
 
     if (found_extrude_set_speed_tag)
@@ -596,128 +652,116 @@ void PressureEqualizer::adjust_volumetric_rate(const size_t fist_line_idx, const
     if (last_line_idx-fist_line_idx < 2)
         return;
 
-    size_t       line_idx      = last_line_idx;
-    if (line_idx == fist_line_idx || !m_gcode_lines[line_idx].extruding())
+    // Range of the extruding lines [first, last] to sweep over.
+    ExtrudingLines &lines = m_extruding_lines;
+    const auto it_last = std::lower_bound(lines.line_idx.begin(), lines.line_idx.end(), last_line_idx);
+    if (it_last == lines.line_idx.end() || *it_last != last_line_idx)
         // Nothing to do, the last move is not extruding.
         return;
-    std::array<float, size_t(ExtrusionRole::erCount)> feedrate_per_extrusion_role{};
-    feedrate_per_extrusion_role.fill(std::numeric_limits<float>::max());
-    feedrate_per_extrusion_role[int(m_gcode_lines[line_idx].extrusion_role)] = m_gcode_lines[line_idx].volumetric_extrusion_rate_start;
-
-    while (line_idx != fist_line_idx) {
-        size_t idx_prev = line_idx - 1;
-        for (; !m_gcode_lines[idx_prev].extruding() && idx_prev != fist_line_idx; --idx_prev);
-        if (!m_gcode_lines[idx_prev].extruding())
-            break;
-        // Don't decelerate before ironing.
-        if (m_gcode_lines[line_idx].extrusion_role == ExtrusionRole::erIroning) {            line_idx = idx_prev;
-            continue;
-        }
-        // Volumetric extrusion rate at the start of the succeding segment.
-        float rate_succ = m_gcode_lines[line_idx].volumetric_extrusion_rate_start;
-        // What is the gradient of the extrusion rate between idx_prev and idx?
-        line_idx        = idx_prev;
-        GCodeLine &line = m_gcode_lines[line_idx];
-
-        for (size_t iRole = 1; iRole < size_t(ExtrusionRole::erCount); ++ iRole) {
-            const float &rate_slope = m_max_volumetric_extrusion_rate_slopes[iRole].negative;
-            if (rate_slope == 0 || feedrate_per_extrusion_role[iRole] == std::numeric_limits<float>::max())
-                continue; // The negative rate is unlimited or the rate for ExtrusionRole iRole is unlimited.
-
-            float rate_end = feedrate_per_extrusion_role[iRole];
-            if (iRole == size_t(line.extrusion_role) && rate_succ < rate_end)
-                // Limit by the succeeding volumetric flow rate.
-                rate_end = rate_succ;
-
-            // don't alter the flow rate for these extrusion types
-            // Orca: Limit ERS to external perimeters and overhangs if option selected by user
-            if (!line.adjustable_flow || line.extrusion_role == ExtrusionRole::erBridgeInfill || line.extrusion_role == ExtrusionRole::erIroning ||
-                (m_extrusion_rate_smoothing_external_perimeter_only && line.extrusion_role != ExtrusionRole::erOverhangPerimeter && line.extrusion_role != ExtrusionRole::erExternalPerimeter)) {
-                rate_end = line.volumetric_extrusion_rate_end;
-            } else if (line.volumetric_extrusion_rate_end > rate_end) {
-                line.volumetric_extrusion_rate_end = rate_end;
-                line.max_volumetric_extrusion_rate_slope_negative = rate_slope;
-                line.modified = true;
-            } else if (iRole == size_t(line.extrusion_role)) {
-                rate_end = line.volumetric_extrusion_rate_end;
-            } else {
-                // Use the original, 'floating' extrusion rate as a starting point for the limiter.
-            }
+    const size_t first = std::lower_bound(lines.line_idx.begin(), it_last, fist_line_idx) - lines.line_idx.begin();
+    const size_t last  = it_last - lines.line_idx.begin();
 
-            if (line.adjustable_flow) {
-                float rate_start = sqrt(rate_end * rate_end + 2 * line.volumetric_extrusion_rate * line.dist_xyz() * rate_slope / line.feedrate());
-                if (rate_start < line.volumetric_extrusion_rate_start) {
-                    // Limit the volumetric extrusion rate at the start of this segment due to a segment
-                    // of ExtrusionType iRole, which will be extruded in the future.
-                    line.volumetric_extrusion_rate_start = rate_start;
-                    line.max_volumetric_extrusion_rate_slope_negative = rate_slope;
-                    line.modified = true;
+    // Each sweep limits the flow rate by the flow rate of the extrusion role of the line the sweep starts with.
+    // The limits of the other extrusion roles stay unlimited over the whole sweep, thus a single limit is propagated.
+    {
+        const size_t role_limit = size_t(lines.extrusion_role[last]);
+        const float  rate_slope = m_max_volumetric_extrusion_rate_slopes[role_limit].negative;
+        if (role_limit != size_t(ExtrusionRole::erNone) && rate_slope != 0) {
+            float feedrate_limit = lines.volumetric_extrusion_rate_start[last];
+            for (size_t i = last; i != first;) {
+                // Don't decelerate before ironing.
+                if (lines.extrusion_role[i] == ExtrusionRole::erIroning) {
+                    -- i;
+                    continue;
+                }
+                // Volumetric extrusion rate at the start of the succeding segment.
+                float rate_succ = lines.volumetric_extrusion_rate_start[i];
+                // What is the gradient of the extrusion rate between idx_prev and idx?
+                -- i;
+                const size_t role = size_t(lines.extrusion_role[i]);
+
+                float rate_end = feedrate_limit;
+                if (role == role_limit && rate_succ < rate_end)
+                    // Limit by the succeeding volumetric flow rate.
+                    rate_end = rate_succ;
+
+                // don't alter the flow rate for these extrusion types
+                if (lines.rate_locked[i]) {
+                    rate_end = lines.volumetric_extrusion_rate_end[i];
+                } else if (lines.volumetric_extrusion_rate_end[i] > rate_end) {
+                    lines.volumetric_extrusion_rate_end[i] = rate_end;
+                    lines.max_volumetric_extrusion_rate_slope_negative[i] = rate_slope;
+                    lines.modified[i] = true;
+                } else if (role == role_limit) {
+                    rate_end = lines.volumetric_extrusion_rate_end[i];
+                } else {
+                    // Use the original, 'floating' extrusion rate as a starting point for the limiter.
                 }
+
+                if (lines.adjustable_flow[i]) {
+                    float rate_start = sqrt(rate_end * rate_end + lines.rate_length2[i] * rate_slope / lines.feedrate[i]);
+                    if (rate_start < lines.volumetric_extrusion_rate_start[i]) {
+                        // Limit the volumetric extrusion rate at the start of this segment due to a segment
+                        // of ExtrusionType role_limit, which will be extruded in the future.
+                        lines.volumetric_extrusion_rate_start[i] = rate_start;
+                        lines.max_volumetric_extrusion_rate_slope_negative[i] = rate_slope;
+                        lines.modified[i] = true;
+                    }
+                }
+                // Don't store feed rate for ironing
+                if (role != size_t(ExtrusionRole::erIroning))
+                    feedrate_limit = lines.volumetric_extrusion_rate_start[i];
             }
-//            feedrate_per_extrusion_role[iRole] = (iRole == line.extrusion_role) ? line.volumetric_extrusion_rate_start : rate_start;
-            // Don't store feed rate for ironing
-            if (line.extrusion_role != ExtrusionRole::erIroning)
-                feedrate_per_extrusion_role[iRole] = line.volumetric_extrusion_rate_start;
         }
     }
 
-    feedrate_per_extrusion_role.fill(std::numeric_limits<float>::max());
-    feedrate_per_extrusion_role[size_t(m_gcode_lines[line_idx].extrusion_role)] = m_gcode_lines[line_idx].volumetric_extrusion_rate_end;
-
-    assert(m_gcode_lines[line_idx].extruding());
-    while (line_idx != last_line_idx) {
-        size_t idx_next = line_idx + 1;
-        for (; !m_gcode_lines[idx_next].extruding() && idx_next != last_line_idx; ++idx_next);
-        if (!m_gcode_lines[idx_next].extruding())
-            break;
-        // Don't accelerate after ironing.
-        if (m_gcode_lines[line_idx].extrusion_role == ExtrusionRole::erIroning) {
-            line_idx = idx_next;
-            continue;
-        }
-        float rate_prec = m_gcode_lines[line_idx].volumetric_extrusion_rate_end;
-        // What is the gradient of the extrusion rate between idx_prev and idx?
-        line_idx = idx_next;
-        GCodeLine &line = m_gcode_lines[line_idx];
-
-        for (size_t iRole = 1; iRole < size_t(ExtrusionRole::erCount); ++ iRole) {
-            const float &rate_slope = m_max_volumetric_extrusion_rate_slopes[iRole].positive;
-            if (rate_slope == 0 || feedrate_per_extrusion_role[iRole] == std::numeric_limits<float>::max())
-                continue; // The positive rate is unlimited or the rate for ExtrusionRole iRole is unlimited.
-
-            float rate_start = feedrate_per_extrusion_role[iRole];
-            // don't alter the flow rate for these extrusion types
-            // Orca: Limit ERS to external perimeters and overhangs if option selected by user
-            if (!line.adjustable_flow || line.extrusion_role == ExtrusionRole::erBridgeInfill || line.extrusion_role == ExtrusionRole::erIroning ||
-                (m_extrusion_rate_smoothing_external_perimeter_only && line.extrusion_role != ExtrusionRole::erOverhangPerimeter && line.extrusion_role != ExtrusionRole::erExternalPerimeter)) {
-                rate_start = line.volumetric_extrusion_rate_start;
-            } else if (iRole == size_t(line.extrusion_role) && rate_prec < rate_start)
-                rate_start = rate_prec;
-            
-            if (line.volumetric_extrusion_rate_start > rate_start) {
-                line.volumetric_extrusion_rate_start = rate_start;
-                line.max_volumetric_extrusion_rate_slope_positive = rate_slope;
-                line.modified = true;
-            } else if (iRole == size_t(line.extrusion_role)) {
-                rate_start = line.volumetric_extrusion_rate_start;
-            } else {
-                // Use the original, 'floating' extrusion rate as a starting point for the limiter.
-            }
+    {
+        const size_t role_limit = size_t(lines.extrusion_role[first]);
+        const float  rate_slope = m_max_volumetric_extrusion_rate_slopes[role_limit].positive;
+        if (role_limit != size_t(ExtrusionRole::erNone) && rate_slope != 0) {
+            float feedrate_limit = lines.volumetric_extrusion_rate_end[first];
+            for (size_t i = first; i != last;) {
+                // Don't accelerate after ironing.
+                if (lines.extrusion_role[i] == ExtrusionRole::erIroning) {
+                    ++ i;
+                    continue;
+                }
+                float rate_prec = lines.volumetric_extrusion_rate_end[i];
+                // What is the gradient of the extrusion rate between idx_prev and idx?
+                ++ i;
+                const size_t role = size_t(lines.extrusion_role[i]);
+
+                float rate_start = feedrate_limit;
+                // don't alter the flow rate for these extrusion types
+                if (lines.rate_locked[i]) {
+                    rate_start = lines.volumetric_extrusion_rate_start[i];
+                } else if (role == role_limit && rate_prec < rate_start)
+                    rate_start = rate_prec;
+
+                if (lines.volumetric_extrusion_rate_start[i] > rate_start) {
+                    lines.volumetric_extrusion_rate_start[i] = rate_start;
+                    lines.max_volumetric_extrusion_rate_slope_positive[i] = rate_slope;
+                    lines.modified[i] = true;
+                } else if (role == role_limit) {
+                    rate_start = lines.volumetric_extrusion_rate_start[i];
+                } else {
+                    // Use the original, 'floating' extrusion rate as a starting point for the limiter.
+                }
 
-            if (line.adjustable_flow) {
-                float rate_end = sqrt(rate_start * rate_start + 2 * line.volumetric_extrusion_rate * line.dist_xyz() * rate_slope / line.feedrate());
-                if (rate_end < line.volumetric_extrusion_rate_end) {
-                    // Limit the volumetric extrusion rate at the start of this segment due to a segment
-                    // of ExtrusionType iRole, which was extruded before.
-                    line.volumetric_extrusion_rate_end                = rate_end;
-                    line.max_volumetric_extrusion_rate_slope_positive = rate_slope;
-                    line.modified                                     = true;
+                if (lines.adjustable_flow[i]) {
+                    float rate_end = sqrt(rate_start * rate_start + lines.rate_length2[i] * rate_slope / lines.feedrate[i]);
+                    if (rate_end < lines.volumetric_extrusion_rate_end[i]) {
+                        // Limit the volumetric extrusion rate at the start of this segment due to a segment
+                        // of ExtrusionType role_limit, which was extruded before.
+                        lines.volumetric_extrusion_rate_end[i]                = rate_end;
+                        lines.max_volumetric_extrusion_rate_slope_positive[i] = rate_slope;
+                        lines.modified[i]                                     = true;
+                    }
                 }
+                // Don't store feed rate for ironing
+                if (role != size_t(ExtrusionRole::erIroning))
+                    feedrate_limit = lines.volumetric_extrusion_rate_end[i];
             }
-//            feedrate_per_extrusion_role[iRole] = (iRole == line.extrusion_role) ? line.volumetric_extrusion_rate_end : rate_end;
-            // Don't store feed rate for ironing
-            if (line.extrusion_role != ExtrusionRole::erIroning)
-                feedrate_per_extrusion_role[iRole] = line.volumetric_extrusion_rate_end;
         }
     }
 }
@@ -765,7 +809,7 @@ inline void PressureEqualizer::push_to_output(const char *text, const size_t len
     output_buffer[output_buffer_length] = 0;
 }
 
-inline bool is_just_line_with_extrude_set_speed_tag(const std::string &line)
+inline bool is_just_line_with_extrude_set_speed_tag(const std::string_view line)
 {
     if (line.empty() && !boost::starts_with(line, "G1 ") && !boost::ends_with(line, EXTRUDE_SET_SPEED_TAG))
         return false;
@@ -793,8 +837,8 @@ void PressureEqualizer::push_line_to_output(const size_t line_idx, float new_fee
     new_feedrate = std::round(new_feedrate / 60.0) * 60.0;
     const GCodeLine &line = m_gcode_lines[line_idx];
     if (line_idx > 0 && output_buffer_length > 0) {
-        const std::string prev_line_str = std::string(output_buffer.begin() + int(this->output_buffer_prev_length),
-                                                      output_buffer.begin() + int(this->output_buffer_length) + 1);
+        const std::string_view prev_line_str(output_buffer.data() + this->output_buffer_prev_length,
+                                             this->output_buffer_length + 1 - this->output_buffer_prev_length);
         if (is_just_line_with_extrude_set_speed_tag(prev_line_str))
             this->output_buffer_length = this->output_buffer_prev_length; // Remove the last line because it only sets the speed for an empty block of g-code lines, so it is useless.
         else
@@ -186,6 +186,36 @@ private:
     size_t                          line_idx;
 #endif
 
+    // The extruding lines of m_gcode_lines stored as arrays, over which adjust_volumetric_rate() sweeps back and forth.
+    // The sweeps do not need to skip the non-extruding lines and the per line invariants are not recalculated
+    // for each of the overlapping windows adjusted.
+    struct ExtrudingLines
+    {
+        void   clear();
+        size_t size() const { return line_idx.size(); }
+
+        // Index of the line in m_gcode_lines, increasing.
+        std::vector<size_t>         line_idx;
+        std::vector<ExtrusionRole>  extrusion_role;
+        // GCodeLine::adjustable_flow
+        std::vector<uint8_t>        adjustable_flow;
+        // The flow rate of the line shall not be limited, because of its extrusion role or because it is not adjustable.
+        std::vector<uint8_t>        rate_locked;
+        // 2 * volumetric_extrusion_rate * dist_xyz() of the line.
+        std::vector<float>          rate_length2;
+        std::vector<float>          feedrate;
+        // Working copies of the GCodeLine members, written back by scatter_extruding_lines().
+        std::vector<float>          volumetric_extrusion_rate_start;
+        std::vector<float>          volumetric_extrusion_rate_end;
+        std::vector<float>          max_volumetric_extrusion_rate_slope_positive;
+        std::vector<float>          max_volumetric_extrusion_rate_slope_negative;
+        std::vector<uint8_t>        modified;
+    };
+    ExtrudingLines                  m_extruding_lines;
+
+    void gather_extruding_lines();
+    void scatter_extruding_lines();
+
     bool process_line(const char *line, const char *line_end, GCodeLine &buf);
     long advance_segment_beyond_small_gap(long idx_cur_pos);
     void output_gcode_line(size_t line_idx);
@@ -154,6 +154,8 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                      &raycasting_tree, &result, &samples](tbb::blocked_range<size_t> r) {
                       // Maintaining hits memory outside of the loop, so it does not have to be reallocated for each query.
                       std::vector<igl::Hit> hits;
+                      std::vector<Vec3d> ray_origins;
+                      std::vector<Vec3d> ray_dirs;
                       for (size_t s_idx = r.begin(); s_idx < r.end(); ++s_idx) {
                         result[s_idx] = 1.0f;
                         constexpr float decrease_step = 1.0f
@@ -165,49 +167,53 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                         Frame f;
                         f.set_from_z(normal);
 
-                        for (const auto &dir : precomputed_sample_directions) {
-                          Vec3f final_ray_dir = (f.to_world(dir));
-                          if (!model_contains_negative_parts) {
-                            igl::Hit hitpoint;
-                            // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                            // direction.
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            bool hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices,
-                                                                                 triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
-                            if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) {
+                        if (!model_contains_negative_parts) {
+                          // The rays of a sample share their origin, thus they are coherent and they are cast in packets.
+                          // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
+                          // direction.
+                          ray_origins.assign(precomputed_sample_directions.size(), (center + normal * 0.01f).cast<double>()); // start above surface.
+                          ray_dirs.clear();
+                          for (const auto &dir : precomputed_sample_directions)
+                            ray_dirs.emplace_back(f.to_world(dir).cast<double>());
+                          AABBTreeIndirect::intersect_rays_first_hit(triangles.vertices, triangles.indices, raycasting_tree, ray_origins, ray_dirs, hits);
+                          for (size_t ray_idx = 0; ray_idx < hits.size(); ++ray_idx)
+                            if (hits[ray_idx].id != -1 && its_face_normal(triangles, hits[ray_idx].id).dot(ray_dirs[ray_idx].cast<float>()) <= 0) {
                               result[s_idx] -= decrease_step;
                             }
-                          } else { //TODO improve logic for order based boolean operations - consider order of volumes
-                            bool casting_from_negative_volume = samples.triangle_indices[s_idx]
-                                                                >= negative_volumes_start_index;
-
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
-                              final_ray_dir = -1.0 * final_ray_dir;
-                              ray_origin_d = (center - normal * 0.01f).cast<double>();
-                            }
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
-                                                                                     triangles.indices, raycasting_tree,
-                                                                                     ray_origin_d, final_ray_dir_d, hits);
-                            if (some_hit) {
-                              int counter = 0;
-                              // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
-                              //  It cannot be inside model, and it cannot be inside negative volume
-                              for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
-                                Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
-                                if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
-                                  counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
-                                                                                               // which in reverse hit analysis means, that we are entering negative space :) and vice versa
-                                } else {
-                                  counter += sgn(face_normal.dot(final_ray_dir));
-                                }
-                              }
-                              if (counter == 0) {
-                                result[s_idx] -= decrease_step;
+                          continue;
+                        }
+
+                        for (const auto &dir : precomputed_sample_directions) {
+                          Vec3f final_ray_dir = (f.to_world(dir));
+                          //TODO improve logic for order based boolean operations - consider order of volumes
+                          bool casting_from_negative_volume = samples.triangle_indices[s_idx]
+                                                              >= negative_volumes_start_index;
+
+                          Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                          if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
+                            final_ray_dir = -1.0 * final_ray_dir;
+                            ray_origin_d = (center - normal * 0.01f).cast<double>();
+                          }
+                          Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
+                          bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
+                                                                                   triangles.indices, raycasting_tree,
+                                                                                   ray_origin_d, final_ray_dir_d, hits);
+                          if (some_hit) {
+                            int counter = 0;
+                            // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
+                            //  It cannot be inside model, and it cannot be inside negative volume
+                            for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
+                              Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
+                              if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
+                                counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
+                                                                                             // which in reverse hit analysis means, that we are entering negative space :) and vice versa
+                              } else {
+                                counter += sgn(face_normal.dot(final_ray_dir));
                               }
                             }
+                            if (counter == 0) {
+                              result[s_idx] -= decrease_step;
+                            }
                           }
                         }
                       }
@@ -709,11 +715,13 @@ void gather_enforcers_blockers(GlobalModelInfo &result, const PrintObject *po) {
     if (mv->is_seam_painted()) {
       auto model_transformation = obj_transform * mv->get_matrix();
 
-      indexed_triangle_set enforcers = mv->seam_facets.get_facets(*mv, EnforcerBlockerType::ENFORCER);
+      const TriangleSelector::FacetsPerState facets = mv->seam_facets.get_facets_per_state(*mv, false);
+
+      indexed_triangle_set enforcers = facets.facets(EnforcerBlockerType::ENFORCER);
       its_transform(enforcers, model_transformation);
       its_merge(result.enforcers, enforcers);
 
-      indexed_triangle_set blockers = mv->seam_facets.get_facets(*mv, EnforcerBlockerType::BLOCKER);
+      indexed_triangle_set blockers = facets.facets(EnforcerBlockerType::BLOCKER);
       its_transform(blockers, model_transformation);
       its_merge(result.blockers, blockers);
     }
@@ -25,8 +25,14 @@ namespace Slic3r {
 const static bool g_wipe_into_objects = false;
 
 
-// Shortest hamilton path problem
-static std::vector<unsigned int> solve_extruder_order(const std::vector<std::vector<float>>& wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int> start_extruder_id) 
+// Up to this many extruders of a layer are ordered exactly, the limit may be changed for a slicing job by its execution context.
+static size_t max_extruders_exact(const Print &print)
+{
+    const ExecutionContext *context = print.execution_context();
+    return context && context->params().max_extruders_exact > 0 ? context->params().max_extruders_exact : ExtruderOrderSolver::max_extruders_exact_default;
+}
+
+std::vector<unsigned int> ExtruderOrderSolver::solve(std::vector<unsigned int> all_extruders, std::optional<unsigned int> start_extruder_id)
 {
     bool add_start_extruder_flag = false;
 
@@ -37,26 +43,37 @@ static std::vector<unsigned int> solve_extruder_order(const std::vector<std::vec
         else
             std::swap(*all_extruders.begin(), *start_iter);
     }
-    else {
-        start_extruder_id = all_extruders.front();
-    }
 
-    unsigned int iterations = (1 << all_extruders.size());
+    // The path starts with all_extruders.front().
+    std::vector<unsigned int> path = all_extruders.size() <= m_max_extruders_exact ? this->solve_exact(all_extruders) : this->solve_heuristic(all_extruders);
+    if (add_start_extruder_flag)
+        path.erase(path.begin());
+    return path;
+}
+
+std::vector<unsigned int> ExtruderOrderSolver::solve_exact(const std::vector<unsigned int> &all_extruders)
+{
+    const unsigned int start_extruder_id = all_extruders.front();
+    const size_t       n                 = all_extruders.size();
+    assert(n < 32 && n <= size_t(std::numeric_limits<int8_t>::max()));
+    unsigned int iterations = (1 << n);
     unsigned int final_state = iterations - 1;
-    std::vector<std::vector<float>>cache(iterations, std::vector<float>(all_extruders.size(),0x7fffffff));
-    std::vector<std::vector<int>>prev(iterations, std::vector<int>(all_extruders.size(), -1));
-    cache[1][0] = 0.;
-    for (unsigned int state = 0; state < iterations; ++state) {
-        if (state & 1) {
-            for (unsigned int target = 0; target < all_extruders.size(); ++target) {
-                if (state >> target & 1) {
-                    for (unsigned int mid_point = 0; mid_point < all_extruders.size(); ++mid_point) {
-                        if(state>>mid_point&1){
-                            auto tmp = cache[state - (1 << target)][mid_point] + wipe_volumes[all_extruders[mid_point]][all_extruders[target]];
-                            if (cache[state][target] >tmp) {
-                                cache[state][target] = tmp;
-                                prev[state][target] = mid_point;
-                            }
+    // Flat tables indexed by state * n + target.
+    m_cost.assign(iterations * n, float(0x7fffffff));
+    m_prev.assign(iterations * n, -1);
+    auto cost = [this, n](unsigned int state, size_t target) -> float& { return m_cost[state * n + target]; };
+    auto prev = [this, n](unsigned int state, size_t target) -> int8_t& { return m_prev[state * n + target]; };
+    cost(1, 0) = 0.;
+    for (unsigned int state = 1; state < iterations; state += 2) {
+        for (unsigned int target = 0; target < n; ++target) {
+            if (state >> target & 1) {
+                const unsigned int prev_state = state - (1 << target);
+                for (unsigned int mid_point = 0; mid_point < n; ++mid_point) {
+                    if (state >> mid_point & 1) {
+                        auto tmp = cost(prev_state, mid_point) + this->wipe_volume(all_extruders[mid_point], all_extruders[target]);
+                        if (cost(state, target) > tmp) {
+                            cost(state, target) = tmp;
+                            prev(state, target) = int8_t(mid_point);
                         }
                     }
                 }
@@ -65,37 +82,93 @@ static std::vector<unsigned int> solve_extruder_order(const std::vector<std::vec
     }
 
     //get res
-    float cost = std::numeric_limits<float>::max();
-    int final_dst =0;
-    for (unsigned int dst = 0; dst < all_extruders.size(); ++dst) {
-        if (all_extruders[dst] != start_extruder_id && cost > cache[final_state][dst]) {
-            cost = cache[final_state][dst];
+    float min_cost = std::numeric_limits<float>::max();
+    int final_dst = 0;
+    for (unsigned int dst = 0; dst < n; ++dst) {
+        if (all_extruders[dst] != start_extruder_id && min_cost > cost(final_state, dst)) {
+            min_cost = cost(final_state, dst);
             final_dst = dst;
         }
     }
 
-    std::vector<unsigned int>path;
+    std::vector<unsigned int> path;
     unsigned int curr_state = final_state;
     int curr_point = final_dst;
     while (curr_point != -1) {
         path.emplace_back(all_extruders[curr_point]);
-        auto mid_point = prev[curr_state][curr_point];
+        auto mid_point = prev(curr_state, curr_point);
         curr_state -= (1 << curr_point);
         curr_point = mid_point;
     };
 
-    if (add_start_extruder_flag)
-        path.pop_back();
-
     std::reverse(path.begin(), path.end());
     return path;
 }
 
+float ExtruderOrderSolver::path_cost(const std::vector<unsigned int> &path) const
+{
+    float cost = 0.f;
+    for (size_t i = 1; i < path.size(); ++ i)
+        cost += this->wipe_volume(path[i - 1], path[i]);
+    return cost;
+}
+
+std::vector<unsigned int> ExtruderOrderSolver::solve_heuristic(const std::vector<unsigned int> &all_extruders) const
+{
+    // Nearest neighbour path from the start extruder.
+    std::vector<unsigned int> path(all_extruders);
+    for (size_t i = 1; i + 1 < path.size(); ++ i) {
+        auto next = std::min_element(path.begin() + i, path.end(), [this, prev = path[i - 1]](unsigned int lhs, unsigned int rhs) {
+            return this->wipe_volume(prev, lhs) < this->wipe_volume(prev, rhs);
+        });
+        std::swap(path[i], *next);
+    }
+
+    // 2-opt: Reverse the sub-paths as long as it reduces the flush volume. The flush volumes are not symmetric,
+    // thus the cost of the reversed sub-path is evaluated as a whole. Then try to move single extruders to another position
+    // (or-opt), which does not reverse anything. The number of passes is bounded.
+    static constexpr const size_t max_passes = 8;
+    float cost = this->path_cost(path);
+    for (size_t pass = 0; pass < max_passes; ++ pass) {
+        bool improved = false;
+        for (size_t i = 1; i + 1 < path.size(); ++ i)
+            for (size_t j = i + 1; j < path.size(); ++ j) {
+                std::reverse(path.begin() + i, path.begin() + j + 1);
+                if (float new_cost = this->path_cost(path); new_cost < cost) {
+                    cost     = new_cost;
+                    improved = true;
+                } else
+                    std::reverse(path.begin() + i, path.begin() + j + 1);
+            }
+        for (size_t i = 1; i < path.size(); ++ i)
+            for (size_t j = 1; j < path.size(); ++ j) {
+                if (i == j)
+                    continue;
+                // Move path[i] to position j.
+                auto rotate = [&path](size_t from, size_t to) {
+                    if (from < to)
+                        std::rotate(path.begin() + from, path.begin() + from + 1, path.begin() + to + 1);
+                    else
+                        std::rotate(path.begin() + to, path.begin() + from, path.begin() + from + 1);
+                };
+                rotate(i, j);
+                if (float new_cost = this->path_cost(path); new_cost < cost) {
+                    cost     = new_cost;
+                    improved = true;
+                } else
+                    rotate(j, i);
+            }
+        if (! improved)
+            break;
+    }
+    return path;
+}
+
 std::vector<unsigned int> get_extruders_order(const std::vector<std::vector<float>> &wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int>start_extruder_id)
 {
 #define USE_DP_OPTIMIZE
 #ifdef USE_DP_OPTIMIZE
-    return solve_extruder_order(wipe_volumes, all_extruders, start_extruder_id);
+    return ExtruderOrderSolver(wipe_volumes).solve(all_extruders, start_extruder_id);
 #else
 if (all_extruders.size() > 1) {
         int begin_index = 0;
@@ -208,6 +281,7 @@ ToolOrdering::ToolOrdering(const PrintObject &object, unsigned int first_extrude
     m_is_BBL_printer = object.print()->is_BBL_printer();
     m_print_full_config = &object.print()->full_print_config();
     m_print_object_ptr = &object;
+    m_max_extruders_exact = max_extruders_exact(*object.print());
     if (object.layers().empty())
         return;
 
@@ -253,6 +327,7 @@ ToolOrdering::ToolOrdering(const Print &print, unsigned int first_extruder, bool
     m_is_BBL_printer = print.is_BBL_printer();
     m_print_full_config = &print.full_print_config();
     m_print_config_ptr = &print.config();
+    m_max_extruders_exact = max_extruders_exact(print);
 
     // Initialize the print layers for all objects and all layers.
     coordf_t object_bottom_z = 0.;
@@ -852,16 +927,25 @@ void ToolOrdering::reorder_extruders_for_minimum_flush_volume()
             wipe_volumes.push_back(std::vector<float>(number_of_extruders, print_config->prime_volume));
     }
 
+    // The extruder orders are memoized by the initial extruder and the set of extruders of a layer.
     auto extruders_to_hash_key = [](const std::vector<unsigned int>& extruders,
-                                    std::optional<unsigned int>      initial_extruder_id) -> uint32_t {
-        uint32_t hash_key = 0;
-        // high 16 bit define initial extruder ,low 16 bit define extruder set
-        if (initial_extruder_id)
-            hash_key |= (1 << (16 + *initial_extruder_id));
-        for (auto item : extruders)
-            hash_key |= (1 << item);
+                                    std::optional<unsigned int>      initial_extruder_id) -> std::optional<uint64_t> {
+        uint64_t hash_key = 0;
+        // high 8 bit define initial extruder + 1 (zero if none), low 56 bit define extruder set
+        if (initial_extruder_id) {
+            if (*initial_extruder_id >= 255)
+                return std::nullopt;
+            hash_key |= uint64_t(*initial_extruder_id + 1) << 56;
+        }
+        for (auto item : extruders) {
+            if (item >= 56)
+                return std::nullopt;
+            hash_key |= uint64_t(1) << item;
+        }
         return hash_key;
     };
+    // Reuses its tables for all the layers.
+    ExtruderOrderSolver extruder_order_solver(wipe_volumes, m_max_extruders_exact);
 
     std::vector<LayerPrintSequence> other_layers_seqs;
     const ConfigOptionInts *other_layers_print_sequence_op = print_config->option<ConfigOptionInts>("other_layers_print_sequence");
@@ -909,14 +993,16 @@ void ToolOrdering::reorder_extruders_for_minimum_flush_volume()
         // The algorithm complexity is O(n2*2^n)
         if (i != 0) {
             auto hash_key = extruders_to_hash_key(lt.extruders, current_extruder_id);
-            auto iter = m_tool_order_cache.find(hash_key);
+            auto iter = hash_key ? m_tool_order_cache.find(*hash_key) : m_tool_order_cache.end();
             if (iter == m_tool_order_cache.end()) {
-                lt.extruders = get_extruders_order(wipe_volumes, lt.extruders, current_extruder_id);
-                std::vector<uint8_t> hash_val;
-                hash_val.reserve(lt.extruders.size());
-                for (auto item : lt.extruders)
-                    hash_val.emplace_back(static_cast<uint8_t>(item));
-                m_tool_order_cache[hash_key] = hash_val;
+                lt.extruders = extruder_order_solver.solve(lt.extruders, current_extruder_id);
+                if (hash_key) {
+                    std::vector<uint8_t> hash_val;
+                    hash_val.reserve(lt.extruders.size());
+                    for (auto item : lt.extruders)
+                        hash_val.emplace_back(static_cast<uint8_t>(item));
+                    m_tool_order_cache[*hash_key] = hash_val;
+                }
             }
             else {
                 std::vector<unsigned int>extruder_order;
@@ -5,7 +5,10 @@
 
 #include "../libslic3r.h"
 
+#include <algorithm>
+#include <optional>
 #include <utility>
+#include <vector>
 
 #include <boost/container/small_vector.hpp>
 
@@ -143,6 +146,40 @@ private:
     WipingExtrusions m_wiping_extrusions;
 };
 
+// Shortest hamilton path problem: Order the extruders of a layer to minimize the flush volume, starting with start_extruder_id.
+// Solved exactly by the Held-Karp dynamic programming for up to max_extruders_exact extruders (including the start extruder),
+// approximated by the nearest neighbour path improved by 2-opt and or-opt moves for more extruders.
+// The dynamic programming tables are kept between the calls, they are not reallocated for each layer.
+class ExtruderOrderSolver
+{
+public:
+    // The complexity of the exact solution is O(n^2 * 2^n). All the layers of the printers with up to 16 filaments are ordered exactly
+    // by default, as before the heuristic was introduced; a lower limit trades the optimal order for time.
+    static constexpr const size_t max_extruders_exact_default = 16;
+    // Upper bound of max_extruders_exact, the tables of the exact solution take 5 * n * 2^n bytes.
+    static constexpr const size_t max_extruders_exact_max     = 20;
+
+    explicit ExtruderOrderSolver(const std::vector<std::vector<float>> &wipe_volumes, size_t max_extruders_exact = max_extruders_exact_default) :
+        m_wipe_volumes(wipe_volumes), m_max_extruders_exact(std::min(max_extruders_exact, max_extruders_exact_max)) {}
+
+    // Without start_extruder_id, the path starts with all_extruders.front().
+    std::vector<unsigned int> solve(std::vector<unsigned int> all_extruders, std::optional<unsigned int> start_extruder_id);
+
+    // The paths start with all_extruders.front(), all_extruders shall not contain duplicates.
+    std::vector<unsigned int> solve_exact(const std::vector<unsigned int> &all_extruders);
+    std::vector<unsigned int> solve_heuristic(const std::vector<unsigned int> &all_extruders) const;
+
+    float                     path_cost(const std::vector<unsigned int> &path) const;
+
+private:
+    float wipe_volume(unsigned int from, unsigned int to) const { return m_wipe_volumes[from][to]; }
+
+    const std::vector<std::vector<float>> &m_wipe_volumes;
+    const size_t                           m_max_extruders_exact;
+    std::vector<float>                     m_cost;
+    std::vector<int8_t>                    m_prev;
+};
+
 class ToolOrdering
 {
 public:
@@ -209,11 +246,13 @@ private:
     unsigned int               m_last_printing_extruder  = (unsigned int)-1;
     // All extruders, which extrude some material over m_layer_tools.
     std::vector<unsigned int>  m_all_printing_extruders;
-    std::unordered_map<uint32_t, std::vector<uint8_t>> m_tool_order_cache;
+    std::unordered_map<uint64_t, std::vector<uint8_t>> m_tool_order_cache;
     const DynamicPrintConfig*  m_print_full_config = nullptr;
     const PrintConfig*         m_print_config_ptr = nullptr;
     const PrintObject*         m_print_object_ptr = nullptr;
     bool                       m_is_BBL_printer = false;
+    // Up to this many extruders of a layer are ordered exactly, see ExtruderOrderSolver.
+    size_t                     m_max_extruders_exact = ExtruderOrderSolver::max_extruders_exact_default;
 };
 
 } // namespace SLic3r
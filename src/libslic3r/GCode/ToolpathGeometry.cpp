@@ -0,0 +1,216 @@
+#include "ToolpathGeometry.hpp"
+
+#include <algorithm>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace Slic3r {
+namespace ToolpathGeometry {
+
+// Interpolation points of the move, if it is an arc move to be drawn by its interpolation points.
+static GCodeProcessorResult::PointsView arc_points(const GCodeProcessorResult::MoveVertexStore &moves, size_t move_id)
+{
+    const EMovePathType path_type = moves.move_path_type[move_id];
+    return (path_type == EMovePathType::Arc_move_ccw || path_type == EMovePathType::Arc_move_cw) ?
+        moves.interpolation_points(move_id) : GCodeProcessorResult::PointsView();
+}
+
+size_t line_vertices_size(const GCodeProcessorResult::MoveVertexStore &moves, size_t move_id)
+{
+    // Two vertices per segment, position only.
+    return (arc_points(moves, move_id).size() + 1) * 2 * 3;
+}
+
+size_t solid_vertices_size(const GCodeProcessorResult::MoveVertexStore &moves, size_t move_id, bool first_segment)
+{
+    // Six vertices per segment, eight for the first segment, position and normal.
+    return ((arc_points(moves, move_id).size() + 1) * 6 + (first_segment ? 2 : 0)) * 6;
+}
+
+static void generate_line_vertices(const GCodeProcessorResult::MoveVertexStore &moves, const VertexJob &job)
+{
+    float *dst = job.buffer->data() + job.offset;
+    auto add_vertex = [&dst](const Vec3f &position) {
+        *dst ++ = position.x();
+        *dst ++ = position.y();
+        *dst ++ = position.z();
+    };
+
+    const GCodeProcessorResult::PointsView points = arc_points(moves, job.move_id);
+    const size_t loop_num = points.size();
+    for (size_t i = 0; i < loop_num + 1; ++ i) {
+        // add previous vertex
+        add_vertex(i == 0 ? moves.position[job.move_id - 1] : points[i - 1]);
+        // add current vertex
+        add_vertex(i == loop_num ? moves.position[job.move_id] : points[i]);
+    }
+    assert(dst == job.buffer->data() + job.offset + line_vertices_size(moves, job.move_id));
+}
+
+static void generate_solid_vertices(const GCodeProcessorResult::MoveVertexStore &moves, const VertexJob &job)
+{
+    float *dst = job.buffer->data() + job.offset;
+    auto store_vertex = [&dst](const Vec3f &position, const Vec3f &normal) {
+        // append position
+        *dst ++ = position.x();
+        *dst ++ = position.y();
+        *dst ++ = position.z();
+        // append normal
+        *dst ++ = normal.x();
+        *dst ++ = normal.y();
+        *dst ++ = normal.z();
+    };
+
+    const GCodeProcessorResult::PointsView points = arc_points(moves, job.move_id);
+    const size_t loop_num = points.size();
+    for (size_t i = 0; i < loop_num + 1; ++ i) {
+        const Vec3f &prev_position = (i == 0 ? moves.position[job.move_id - 1] : points[i - 1]);
+        const Vec3f &curr_position = (i == loop_num ? moves.position[job.move_id] : points[i]);
+
+        const Vec3f dir = (curr_position - prev_position).normalized();
+        const Vec3f right = Vec3f(dir.y(), -dir.x(), 0.0f).normalized();
+        const Vec3f left = -right;
+        const Vec3f up = right.cross(dir);
+        const Vec3f down = -up;
+        const float half_width = 0.5f * job.width;
+        const float half_height = 0.5f * job.height;
+        const Vec3f prev_pos = prev_position - half_height * up;
+        const Vec3f curr_pos = curr_position - half_height * up;
+        const Vec3f d_up = half_height * up;
+        const Vec3f d_down = -half_height * up;
+        const Vec3f d_right = half_width * right;
+        const Vec3f d_left = -half_width * right;
+
+        if (job.first_segment && i == 0) {
+            store_vertex(prev_pos + d_up, up);
+            store_vertex(prev_pos + d_right, right);
+            store_vertex(prev_pos + d_down, down);
+            store_vertex(prev_pos + d_left, left);
+        } else {
+            store_vertex(prev_pos + d_right, right);
+            store_vertex(prev_pos + d_left, left);
+        }
+
+        store_vertex(curr_pos + d_up, up);
+        store_vertex(curr_pos + d_right, right);
+        store_vertex(curr_pos + d_down, down);
+        store_vertex(curr_pos + d_left, left);
+    }
+    assert(dst == job.buffer->data() + job.offset + solid_vertices_size(moves, job.move_id, job.first_segment));
+}
+
+void generate_vertices(const GCodeProcessorResult::MoveVertexStore &moves, const VertexJob &job)
+{
+    assert(job.move_id > 0 && job.move_id < moves.size());
+    assert(job.buffer != nullptr);
+    switch (job.type) {
+    case VertexJob::EType::Line:  generate_line_vertices(moves, job); break;
+    case VertexJob::EType::Solid: generate_solid_vertices(moves, job); break;
+    }
+}
+
+void generate_vertices(const GCodeProcessorResult::MoveVertexStore &moves, const std::vector<VertexJob> &jobs)
+{
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, jobs.size(), 1024),
+        [&moves, &jobs](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                generate_vertices(moves, jobs[i]);
+        }); // end of parallel_for
+}
+
+LODParams select_lod(size_t moves_count, size_t visible_layers, double pixels_per_mm)
+{
+    LODParams params;
+    if (moves_count < LODMinMoves || visible_layers < LODMinLayers || pixels_per_mm <= 0.)
+        return params;
+
+    // Size of a screen pixel in mm. The preview is not rebuilt on zoom, thus the size is clamped
+    // to keep the simplified toolpaths usable when zooming in later.
+    float pixel = float(std::clamp(1. / pixels_per_mm, 0.01, 0.1));
+    if (moves_count >= 4 * LODMinMoves)
+        pixel *= 2.f;
+    params.collinear_tolerance = 0.25f * pixel;
+    params.min_segment_length  = pixel;
+    params.aggregate_travels   = true;
+    return params;
+}
+
+static bool is_arc(const GCodeProcessorResult::MoveVertexStore &moves, size_t move_id)
+{
+    return moves.move_path_type[move_id] == EMovePathType::Arc_move_ccw || moves.move_path_type[move_id] == EMovePathType::Arc_move_cw;
+}
+
+// Is the segment ending with move i drawn the same way as the segment ending with move j?
+static bool same_attributes(const GCodeProcessorResult::MoveVertexStore &moves, size_t i, size_t j)
+{
+    if (moves.type[i] != moves.type[j] || moves.extruder_id[i] != moves.extruder_id[j] || moves.cp_color_id[i] != moves.cp_color_id[j] ||
+        moves.feedrate[i] != moves.feedrate[j])
+        return false;
+    return moves.type[i] == EMoveType::Travel ||
+        (moves.extrusion_role[i] == moves.extrusion_role[j] && moves.width[i] == moves.width[j] && moves.height[i] == moves.height[j] &&
+         moves.mm3_per_mm[i] == moves.mm3_per_mm[j] && moves.fan_speed[i] == moves.fan_speed[j] &&
+         moves.temperature[i] == moves.temperature[j] && moves.layer_duration[i] == moves.layer_duration[j]);
+}
+
+static float distance_to_segment(const Vec3f &pt, const Vec3f &a, const Vec3f &b)
+{
+    const Vec3f v  = b - a;
+    const float l2 = v.squaredNorm();
+    const float t  = l2 > 0.f ? std::clamp((pt - a).dot(v) / l2, 0.f, 1.f) : 0.f;
+    return (a + t * v - pt).norm();
+}
+
+// Can move i be dropped, extending the segment ending with the next move back to the kept move anchor?
+// The moves in dropped were dropped since anchor.
+static bool can_drop(const GCodeProcessorResult::MoveVertexStore &moves, const LODParams &params, size_t anchor, const std::vector<size_t> &dropped, size_t i)
+{
+    const size_t next = i + 1;
+    const EMoveType type = moves.type[i];
+    if ((type != EMoveType::Extrude && type != EMoveType::Travel) || is_arc(moves, i) || is_arc(moves, next) || ! same_attributes(moves, i, next))
+        return false;
+
+    const Vec3f &pa = moves.position[anchor];
+    const Vec3f &pn = moves.position[next];
+    const Vec3f &pi = moves.position[i];
+    // Never drop a change of height, the layers are detected from the heights of the moves.
+    if (std::abs(pi.z() - pa.z()) > EPSILON || std::abs(pn.z() - pa.z()) > EPSILON)
+        return false;
+    if (type == EMoveType::Travel && params.aggregate_travels)
+        return true;
+
+    float deviation = distance_to_segment(pi, pa, pn);
+    for (size_t k : dropped)
+        deviation = std::max(deviation, distance_to_segment(moves.position[k], pa, pn));
+    return deviation <= params.collinear_tolerance ||
+        ((pi - pa).norm() < params.min_segment_length && deviation <= params.min_segment_length);
+}
+
+GCodeProcessorResult::MoveVertexStore simplify(const GCodeProcessorResult::MoveVertexStore &moves, const LODParams &params, std::vector<size_t> *kept_ids)
+{
+    // Limit the number of moves merged into a single segment, the deviation of all of them is verified for each candidate.
+    static constexpr const size_t max_dropped_run = 64;
+
+    std::vector<size_t> kept;
+    kept.reserve(moves.size());
+    std::vector<size_t> dropped;
+    for (size_t i = 0; i < moves.size(); ++ i) {
+        if (i > 0 && i + 1 < moves.size() && dropped.size() < max_dropped_run && can_drop(moves, params, kept.back(), dropped, i))
+            dropped.emplace_back(i);
+        else {
+            kept.emplace_back(i);
+            dropped.clear();
+        }
+    }
+
+    GCodeProcessorResult::MoveVertexStore out;
+    out.reserve(kept.size());
+    for (size_t id : kept)
+        out.push_back(moves[id]);
+    if (kept_ids != nullptr)
+        *kept_ids = std::move(kept);
+    return out;
+}
+
+} // namespace ToolpathGeometry
+} // namespace Slic3r
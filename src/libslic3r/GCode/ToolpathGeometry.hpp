@@ -0,0 +1,80 @@
+#ifndef slic3r_GCode_ToolpathGeometry_hpp_
+#define slic3r_GCode_ToolpathGeometry_hpp_
+
+#include "GCodeProcessor.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace Slic3r {
+namespace ToolpathGeometry {
+
+// CPU side vertex data of the G-code preview toolpaths.
+// The layout of the vertex buffers (which buffer and offset receives the vertices of a move) is decided serially
+// by the G-code viewer, while the vertices themselves are generated in parallel by generate_vertices() into the
+// space reserved for them. The result does not depend on the number of threads.
+
+// One toolpath segment between the moves move_id - 1 and move_id, including the interpolation points of an arc.
+struct VertexJob
+{
+    enum class EType : unsigned char {
+        // Position only, two vertices per segment.
+        Line,
+        // Position and normal, the section of a solid extrusion of the given width and height.
+        Solid,
+    };
+
+    EType               type { EType::Line };
+    // Solid: the segment starts a path or a vertex buffer, four vertices of the starting cap are emitted.
+    bool                first_segment { false };
+    size_t              move_id { 0 };
+    // Solid: width and height of the path the segment belongs to.
+    float               width { 0.0f };
+    float               height { 0.0f };
+    // Vertex buffer and offset (in floats) receiving the vertices.
+    // The buffer has to be resized to make room for the vertices before generate_vertices() is called.
+    std::vector<float> *buffer { nullptr };
+    size_t              offset { 0 };
+};
+
+// Number of floats generated for a Line segment ending with move move_id.
+size_t line_vertices_size(const GCodeProcessorResult::MoveVertexStore &moves, size_t move_id);
+// Number of floats generated for a Solid segment ending with move move_id.
+size_t solid_vertices_size(const GCodeProcessorResult::MoveVertexStore &moves, size_t move_id, bool first_segment);
+
+// Generate the vertices of a single segment into job.buffer.
+void   generate_vertices(const GCodeProcessorResult::MoveVertexStore &moves, const VertexJob &job);
+// Generate the vertices of all the jobs in parallel. The jobs shall not overlap.
+void   generate_vertices(const GCodeProcessorResult::MoveVertexStore &moves, const std::vector<VertexJob> &jobs);
+
+// Level of detail of the toolpaths: Huge prints are previewed from a simplified copy of the moves,
+// with collinear moves merged, sub-pixel segments dropped and runs of travel moves aggregated.
+struct LODParams
+{
+    // Maximum distance of a dropped move from the simplified toolpath, in mm.
+    float collinear_tolerance { 0.0f };
+    // A move closer than min_segment_length to the previous kept move is dropped if the simplified toolpath
+    // stays within min_segment_length of it, in mm.
+    float min_segment_length { 0.0f };
+    // Drop the inner moves of a run of travel moves of the same height.
+    bool  aggregate_travels { false };
+
+    bool  enabled() const { return collinear_tolerance > 0.0f || min_segment_length > 0.0f || aggregate_travels; }
+};
+
+// Prints with fewer moves or layers are always previewed at full detail.
+static constexpr const size_t LODMinMoves  = 2000000;
+static constexpr const size_t LODMinLayers = 200;
+
+// Choose the level of detail for moves_count moves spread over visible_layers layers, displayed at pixels_per_mm.
+LODParams select_lod(size_t moves_count, size_t visible_layers, double pixels_per_mm);
+
+// Simplified copy of moves. Only the Extrude and Travel moves are dropped, and only if the following move of the same type
+// has the same attributes, so that the dropped segment is drawn as a part of the following one. The first and the last moves
+// are always kept. If kept_ids is not null, it receives the indices of the kept moves into moves.
+GCodeProcessorResult::MoveVertexStore simplify(const GCodeProcessorResult::MoveVertexStore &moves, const LODParams &params, std::vector<size_t> *kept_ids = nullptr);
+
+} // namespace ToolpathGeometry
+} // namespace Slic3r
+
+#endif // slic3r_GCode_ToolpathGeometry_hpp_
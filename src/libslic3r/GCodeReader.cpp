@@ -1,4 +1,5 @@
 #include "GCodeReader.hpp"
+#include "GCode/BinaryGCode.hpp"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/log/trivial.hpp>
@@ -7,6 +8,7 @@
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include "Utils.hpp"
 
 #include "LocalesUtils.hpp"
@@ -125,18 +127,34 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
 template<typename ParseLineCallback, typename LineEndCallback>
 bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback)
 {
-    FilePtr in{ boost::nowide::fopen(filename.c_str(), "rb") };
+    // A binary G-code stores the ASCII G-code split into blocks, it is parsed block by block.
+    // Line ends are then reported as positions in the ASCII G-code.
+    std::unique_ptr<BinaryGCode::Reader> binary_reader;
+    if (BinaryGCode::is_binary_gcode_file(filename))
+        binary_reader = std::make_unique<BinaryGCode::Reader>(filename);
+    FilePtr in{ binary_reader ? nullptr : boost::nowide::fopen(filename.c_str(), "rb") };
 
     // Read the input stream 64kB at a time, extract lines and process them.
     std::vector<char> buffer(65536 * 10, 0);
     // Line buffer.
     std::string gcode_line;
+    std::string gcode_block;
     size_t file_pos = 0;
     m_parsing = true;
     for (;;) {
-        size_t cnt_read = ::fread(buffer.data(), 1, buffer.size(), in.f);
-        if (::ferror(in.f))
-            return false;
+        size_t cnt_read = 0;
+        if (binary_reader) {
+            if (binary_reader->next_gcode(gcode_block)) {
+                if (buffer.size() < gcode_block.size())
+                    buffer.resize(gcode_block.size());
+                std::copy(gcode_block.begin(), gcode_block.end(), buffer.begin());
+                cnt_read = gcode_block.size();
+            }
+        } else {
+            cnt_read = ::fread(buffer.data(), 1, buffer.size(), in.f);
+            if (::ferror(in.f))
+                return false;
+        }
         bool eof       = cnt_read == 0;
         auto it        = buffer.begin();
         auto it_bufend = buffer.begin() + cnt_read;
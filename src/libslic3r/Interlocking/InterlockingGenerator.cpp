@@ -3,21 +3,8 @@
 
 #include "InterlockingGenerator.hpp"
 
-namespace std {
-template<> struct hash<Slic3r::GridPoint3>
-{
-    size_t operator()(const Slic3r::GridPoint3& pp) const noexcept
-    {
-        static int prime  = 31;
-        int        result = 89;
-        result            = static_cast<int>(result * prime + pp.x());
-        result            = static_cast<int>(result * prime + pp.y());
-        result            = static_cast<int>(result * prime + pp.z());
-        return static_cast<size_t>(result);
-    }
-};
-} // namespace std
-
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 namespace Slic3r {
 
@@ -82,7 +69,7 @@ std::pair<ExPolygons, ExPolygons> InterlockingGenerator::growBorderAreasPerpendi
     return {from_border_a, from_border_b};
 }
 
-void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>& has_all_meshes) const
+void InterlockingGenerator::handleThinAreas(const VoxelGrid& has_all_meshes) const
 {
     const coord_t     number_of_beams_detect = boundary_avoidance;
     const coord_t     number_of_beams_expand = boundary_avoidance - 1;
@@ -95,59 +82,53 @@ void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>
         std::min(print_object.printing_region(region_a_index).flow(print_object, frExternalPerimeter, 0.1).scaled_width(),
                  print_object.printing_region(region_b_index).flow(print_object, frExternalPerimeter, 0.1).scaled_width()) / 4;
 
-    // Make an inclusionary polygon, to only actually handle thin areas near actual microstructures (so not in skin for example).
-    std::vector<Polygons> near_interlock_per_layer;
-    near_interlock_per_layer.assign(print_object.layer_count(), Polygons());
-    for (const auto& cell : has_all_meshes) {
-        const auto bottom_corner = vu.toLowerCorner(cell);
-        for (coord_t layer_nr = bottom_corner.z();
-             layer_nr < bottom_corner.z() + cell_size.z() && layer_nr < static_cast<coord_t>(near_interlock_per_layer.size()); ++layer_nr) {
-            near_interlock_per_layer[static_cast<size_t>(layer_nr)].push_back(vu.toPolygon(cell));
+    // The layers are independent of each other.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layer_count()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++ layer_nr) {
+            // Make an inclusionary polygon, to only actually handle thin areas near actual microstructures (so not in skin for example).
+            Polygons near_interlock;
+            has_all_meshes.forEachInSlab(vu.toGridCoord(static_cast<coord_t>(layer_nr), 2),
+                                         [this, &near_interlock](const GridPoint3& cell) { near_interlock.push_back(vu.toPolygon(cell)); });
+            near_interlock = offset(union_(closing(near_interlock, rounding_errors)), detect);
+            polygons_rotate(near_interlock, rotation);
+
+            // Only alter layers when they are present in both meshes, zip should take care if that.
+            auto       layer   = print_object.get_layer(layer_nr);
+            ExPolygons polys_a = to_expolygons(layer->get_region(region_a_index)->slices.surfaces);
+            ExPolygons polys_b = to_expolygons(layer->get_region(region_b_index)->slices.surfaces);
+
+            const auto [from_border_a, from_border_b] = growBorderAreasPerpendicular(polys_a, polys_b, detect);
+
+            // Get the areas of each mesh that are _not_ thin (large), by performing a morphological open.
+            const ExPolygons large_a = opening_ex(polys_a, detect);
+            const ExPolygons large_b = opening_ex(polys_b, detect);
+
+            // Derive the area that the thin areas need to expand into (so the added areas to the thin strips) from the information we already have.
+            const ExPolygons thin_expansion_a =
+                offset_ex(intersection_ex(intersection_ex(intersection_ex(large_b, offset_ex(diff_ex(polys_a, large_a), expand)),
+                                                          near_interlock),
+                                          from_border_a),
+                          rounding_errors);
+            const ExPolygons thin_expansion_b =
+                offset_ex(intersection_ex(intersection_ex(intersection_ex(large_a, offset_ex(diff_ex(polys_b, large_b), expand)),
+                                                          near_interlock),
+                                          from_border_b),
+                          rounding_errors);
+
+            // Expanded thin areas of the opposing polygon should 'eat into' the larger areas of the polygon,
+            // and conversely, add the expansions to their own thin areas.
+            layer->get_region(region_a_index)->slices.set(closing_ex(diff_ex(union_ex(polys_a, thin_expansion_a), thin_expansion_b), close_gaps), stInternal);
+            layer->get_region(region_b_index)->slices.set(closing_ex(diff_ex(union_ex(polys_b, thin_expansion_b), thin_expansion_a), close_gaps), stInternal);
         }
-    }
-    for (auto& near_interlock : near_interlock_per_layer) {
-        near_interlock = offset(union_(closing(near_interlock, rounding_errors)), detect);
-        polygons_rotate(near_interlock, rotation);
-    }
-
-    // Only alter layers when they are present in both meshes, zip should take care if that.
-    for (size_t layer_nr = 0; layer_nr < print_object.layer_count(); layer_nr++){
-        auto       layer   = print_object.get_layer(layer_nr);
-        ExPolygons polys_a = to_expolygons(layer->get_region(region_a_index)->slices.surfaces);
-        ExPolygons polys_b = to_expolygons(layer->get_region(region_b_index)->slices.surfaces);
-
-        const auto [from_border_a, from_border_b] = growBorderAreasPerpendicular(polys_a, polys_b, detect);
-
-        // Get the areas of each mesh that are _not_ thin (large), by performing a morphological open.
-        const ExPolygons large_a = opening_ex(polys_a, detect);
-        const ExPolygons large_b = opening_ex(polys_b, detect);
-
-        // Derive the area that the thin areas need to expand into (so the added areas to the thin strips) from the information we already have.
-        const ExPolygons thin_expansion_a =
-            offset_ex(intersection_ex(intersection_ex(intersection_ex(large_b, offset_ex(diff_ex(polys_a, large_a), expand)),
-                                                      near_interlock_per_layer[layer_nr]),
-                                      from_border_a),
-                      rounding_errors);
-        const ExPolygons thin_expansion_b =
-            offset_ex(intersection_ex(intersection_ex(intersection_ex(large_a, offset_ex(diff_ex(polys_b, large_b), expand)),
-                                                      near_interlock_per_layer[layer_nr]),
-                                      from_border_b),
-                      rounding_errors);
-
-        // Expanded thin areas of the opposing polygon should 'eat into' the larger areas of the polygon,
-        // and conversely, add the expansions to their own thin areas.
-        layer->get_region(region_a_index)->slices.set(closing_ex(diff_ex(union_ex(polys_a, thin_expansion_a), thin_expansion_b), close_gaps), stInternal);
-        layer->get_region(region_b_index)->slices.set(closing_ex(diff_ex(union_ex(polys_b, thin_expansion_b), thin_expansion_a), close_gaps), stInternal);
-    }
+    }); // end of parallel_for
 }
 
 void InterlockingGenerator::generateInterlockingStructure() const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh = getShellVoxels(interface_dilation);
+    std::vector<VoxelGrid> voxels_per_mesh = getShellVoxels(interface_dilation);
 
-    std::unordered_set<GridPoint3>& has_any_mesh   = voxels_per_mesh[0];
-    std::unordered_set<GridPoint3>& has_all_meshes = voxels_per_mesh[1];
-    has_any_mesh.merge(has_all_meshes); // perform union and intersection simultaneously. Cannibalizes voxels_per_mesh
+    VoxelGrid& has_all_meshes = voxels_per_mesh[0];
+    has_all_meshes.intersect(voxels_per_mesh[1]);
 
     if (has_all_meshes.empty()) {
         return;
@@ -156,12 +137,10 @@ void InterlockingGenerator::generateInterlockingStructure() const
     const std::vector<ExPolygons> layer_regions = computeUnionedVolumeRegions();
 
     if (air_filtering) {
-        std::unordered_set<GridPoint3> air_cells;
+        VoxelGrid air_cells(has_all_meshes.min(), has_all_meshes.max());
         addBoundaryCells(layer_regions, air_dilation, air_cells);
 
-        for (const GridPoint3& p : air_cells) {
-            has_all_meshes.erase(p);
-        }
+        has_all_meshes.subtract(air_cells);
 
         handleThinAreas(has_all_meshes);
     }
@@ -169,52 +148,81 @@ void InterlockingGenerator::generateInterlockingStructure() const
     applyMicrostructureToOutlines(has_all_meshes, layer_regions);
 }
 
-std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
+std::vector<VoxelGrid> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh(2);
+    std::vector<VoxelGrid> voxels_per_mesh(2);
 
-    // mark all cells which contain some boundary
+    std::vector<ExPolygons> rotated_polygons_per_layer_per_mesh[2];
+    BoundingBox             bbox;
     for (size_t region_idx = 0; region_idx < 2; region_idx++)
     {
         const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
-        std::unordered_set<GridPoint3>& mesh_voxels = voxels_per_mesh[region_idx];
-
-        std::vector<ExPolygons> rotated_polygons_per_layer(print_object.layer_count());
-        for (size_t layer_nr = 0; layer_nr < print_object.layer_count(); layer_nr++)
-        {
-            auto layer = print_object.get_layer(layer_nr);
-            rotated_polygons_per_layer[layer_nr] = to_expolygons(layer->get_region(region)->slices.surfaces);
-            expolygons_rotate(rotated_polygons_per_layer[layer_nr], rotation);
-        }
+        std::vector<ExPolygons>& rotated_polygons_per_layer = rotated_polygons_per_layer_per_mesh[region_idx];
+        rotated_polygons_per_layer.resize(print_object.layer_count());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layer_count()), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++ layer_nr) {
+                auto layer = print_object.get_layer(layer_nr);
+                rotated_polygons_per_layer[layer_nr] = to_expolygons(layer->get_region(region)->slices.surfaces);
+                expolygons_rotate(rotated_polygons_per_layer[layer_nr], rotation);
+            }
+        }); // end of parallel_for
+        for (const ExPolygons& polygons : rotated_polygons_per_layer)
+            if (! polygons.empty())
+                bbox.merge(get_extents(polygons));
+    }
+    if (! bbox.defined)
+        return voxels_per_mesh;
+
+    // Box of the voxel grids: The cells walked along the outlines of both models and of their union (closed by ignored_gap_)
+    // are at most a cell away from the outlines, then they are dilated by the interface or by the air kernel.
+    const GridPoint3 margin = interface_dilation.kernel_size_.cwiseMax(air_dilation.kernel_size_) + GridPoint3::Ones();
+    const GridPoint3 min    = vu.toGridPoint(Vec3crd(bbox.min.x() - cell_size.x(), bbox.min.y() - cell_size.y(), - cell_size.z())) - margin;
+    const GridPoint3 max    = vu.toGridPoint(Vec3crd(bbox.max.x() + cell_size.x(), bbox.max.y() + cell_size.y(),
+                                                     static_cast<coord_t>(print_object.layer_count()) + cell_size.z())) + margin;
 
-        addBoundaryCells(rotated_polygons_per_layer, kernel, mesh_voxels);
+    // mark all cells which contain some boundary
+    for (size_t region_idx = 0; region_idx < 2; region_idx++)
+    {
+        voxels_per_mesh[region_idx] = VoxelGrid(min, max);
+        addBoundaryCells(rotated_polygons_per_layer_per_mesh[region_idx], kernel, voxels_per_mesh[region_idx]);
     }
 
     return voxels_per_mesh;
 }
 
-void InterlockingGenerator::addBoundaryCells(const std::vector<ExPolygons>&  layers,
-                                             const DilationKernel&           kernel,
-                                             std::unordered_set<GridPoint3>& cells) const
+void InterlockingGenerator::addBoundaryCells(const std::vector<ExPolygons>& layers,
+                                             const DilationKernel&          kernel,
+                                             VoxelGrid&                     cells) const
 {
-    auto voxel_emplacer = [&cells](GridPoint3 p) {
-        if (p.z() < 0) {
-            return true;
-        }
-        cells.emplace(p);
-        return true;
-    };
-
-    for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++) {
-        const coord_t z = static_cast<coord_t>(layer_nr);
-        vu.walkDilatedPolygons(layers[layer_nr], z, kernel, voxel_emplacer);
-        ExPolygons skin = layers[layer_nr];
-        if (layer_nr > 0) {
-            skin = xor_ex(skin, layers[layer_nr - 1]);
+    // Cells walked along the outlines and over the skin of each layer, before the dilation by the kernel.
+    std::vector<std::vector<GridPoint3>> cells_per_layer(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++ layer_nr) {
+            std::vector<GridPoint3>& layer_cells = cells_per_layer[layer_nr];
+            auto voxel_emplacer = [&layer_cells](GridPoint3 p) {
+                layer_cells.emplace_back(p);
+                return true;
+            };
+
+            const coord_t z = static_cast<coord_t>(layer_nr);
+            for (const ExPolygon& poly : layers[layer_nr])
+                vu.walkPolygonsForKernel(poly, z, kernel, voxel_emplacer);
+            ExPolygons skin = layers[layer_nr];
+            if (layer_nr > 0) {
+                skin = xor_ex(skin, layers[layer_nr - 1]);
+            }
+            skin = opening_ex(skin, cell_size.x() / 2.f); // remove superfluous small areas, which would anyway be included because of walkPolygons
+            for (const ExPolygon& poly : skin)
+                vu.walkAreasForKernel(poly, z, kernel, voxel_emplacer);
         }
-        skin = opening_ex(skin, cell_size.x() / 2.f); // remove superfluous small areas, which would anyway be included because of walkPolygons
-        vu.walkDilatedAreas(skin, z, kernel, voxel_emplacer);
-    }
+    }); // end of parallel_for
+
+    VoxelGrid walked_cells(cells.min(), cells.max());
+    for (const std::vector<GridPoint3>& layer_cells : cells_per_layer)
+        for (const GridPoint3& p : layer_cells)
+            walked_cells.set(p);
+    cells.unite(walked_cells.dilated(kernel));
+    cells.clearBelowZ(0);
 }
 
 std::vector<ExPolygons> InterlockingGenerator::computeUnionedVolumeRegions() const
@@ -223,15 +231,17 @@ std::vector<ExPolygons> InterlockingGenerator::computeUnionedVolumeRegions() con
                                    1; // introduce ghost layer on top for correct skin computation of topmost layer.
     std::vector<ExPolygons> layer_regions(max_layer_count);
 
-    for (size_t layer_nr = 0; layer_nr < max_layer_count - 1; layer_nr++) {
-        auto& layer_region = layer_regions[static_cast<size_t>(layer_nr)];
-        for (size_t region_idx : {region_a_index, region_b_index}) {
-            auto layer = print_object.get_layer(layer_nr);
-            expolygons_append(layer_region, to_expolygons(layer->get_region(region_idx)->slices.surfaces));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, max_layer_count - 1), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++ layer_nr) {
+            auto& layer_region = layer_regions[static_cast<size_t>(layer_nr)];
+            for (size_t region_idx : {region_a_index, region_b_index}) {
+                auto layer = print_object.get_layer(layer_nr);
+                expolygons_append(layer_region, to_expolygons(layer->get_region(region_idx)->slices.surfaces));
+            }
+            layer_region = closing_ex(layer_region, ignored_gap_); // Morphological close to merge meshes into single volume
+            expolygons_rotate(layer_region, rotation);
         }
-        layer_region = closing_ex(layer_region, ignored_gap_); // Morphological close to merge meshes into single volume
-        expolygons_rotate(layer_region, rotation);
-    }
+    }); // end of parallel_for
     return layer_regions;
 }
 
@@ -265,8 +275,8 @@ std::vector<std::vector<ExPolygons>> InterlockingGenerator::generateMicrostructu
     return cell_area_per_mesh_per_layer;
 }
 
-void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_set<GridPoint3>& cells,
-                                                          const std::vector<ExPolygons>&        layer_regions) const
+void InterlockingGenerator::applyMicrostructureToOutlines(const VoxelGrid&               cells,
+                                                          const std::vector<ExPolygons>& layer_regions) const
 {
     std::vector<std::vector<ExPolygons>> cell_area_per_mesh_per_layer = generateMicrostructure();
 
@@ -285,46 +295,51 @@ void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_s
 
     // Only compute cell structure for half the layers, because since our beams are two layers high, every odd layer of the structure will
     // be the same as the layer below.
-    for (const GridPoint3& grid_loc : cells) {
-        Vec3crd bottom_corner = vu.toLowerCorner(grid_loc);
-        for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++) {
-            for (size_t layer_nr = bottom_corner.z(); layer_nr < bottom_corner.z() + cell_size.z() && layer_nr < max_layer_count;
-                 layer_nr += beam_layer_count) {
-                ExPolygons areas_here = cell_area_per_mesh_per_layer[static_cast<size_t>(layer_nr / beam_layer_count) %
-                                                                cell_area_per_mesh_per_layer.size()][mesh_idx];
-                for (auto & here : areas_here) {
-                    here.translate(bottom_corner.x(), bottom_corner.y());
+    // Each interlocking layer is generated from the cells of the single slab of the grid it belongs to.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_interlocking_layers), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t interlocking_layer_nr = range.begin(); interlocking_layer_nr < range.end(); ++ interlocking_layer_nr) {
+            const coord_t layer_nr = static_cast<coord_t>(interlocking_layer_nr) * beam_layer_count;
+            const std::vector<ExPolygons>& cell_area_per_mesh =
+                cell_area_per_mesh_per_layer[interlocking_layer_nr % cell_area_per_mesh_per_layer.size()];
+            cells.forEachInSlab(vu.toGridCoord(layer_nr, 2), [&](const GridPoint3& grid_loc) {
+                Vec3crd bottom_corner = vu.toLowerCorner(grid_loc);
+                for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++) {
+                    ExPolygons areas_here = cell_area_per_mesh[mesh_idx];
+                    for (auto & here : areas_here) {
+                        here.translate(bottom_corner.x(), bottom_corner.y());
+                    }
+                    expolygons_append(structure_per_layer[mesh_idx][interlocking_layer_nr], areas_here);
                 }
-                expolygons_append(structure_per_layer[mesh_idx][static_cast<size_t>(layer_nr / beam_layer_count)], areas_here);
-            }
-        }
-    }
+            });
 
-    for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++) {
-        for (size_t layer_nr = 0; layer_nr < structure_per_layer[mesh_idx].size(); layer_nr++) {
-            ExPolygons& layer_structure = structure_per_layer[mesh_idx][layer_nr];
-            layer_structure = union_ex(layer_structure);
-            expolygons_rotate(layer_structure, unapply_rotation);
+            for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++) {
+                ExPolygons& layer_structure = structure_per_layer[mesh_idx][interlocking_layer_nr];
+                layer_structure = union_ex(layer_structure);
+                expolygons_rotate(layer_structure, unapply_rotation);
+            }
         }
-    }
+    }); // end of parallel_for
 
-    for (size_t region_idx = 0; region_idx < 2; region_idx++) {
-        const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
-        for (size_t layer_nr = 0; layer_nr < max_layer_count; layer_nr++) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, max_layer_count), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++ layer_nr) {
             ExPolygons layer_outlines = layer_regions[layer_nr];
             expolygons_rotate(layer_outlines, unapply_rotation);
 
-            const ExPolygons areas_here = intersection_ex(structure_per_layer[region_idx][layer_nr / static_cast<size_t>(beam_layer_count)], layer_outlines);
-            const ExPolygons& areas_other = structure_per_layer[!region_idx][layer_nr / static_cast<size_t>(beam_layer_count)];
+            for (size_t region_idx = 0; region_idx < 2; region_idx++) {
+                const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
 
-            auto       layer  = print_object.get_layer(layer_nr);
-            auto&      slices = layer->get_region(region)->slices;
-            ExPolygons polys  = to_expolygons(slices.surfaces);
-            slices.set(union_ex(diff_ex(polys, areas_other), // reduce layer areas inward with beams from other mesh
-                                areas_here)                  // extend layer areas outward with newly added beams
-                       , stInternal);
+                const ExPolygons areas_here = intersection_ex(structure_per_layer[region_idx][layer_nr / static_cast<size_t>(beam_layer_count)], layer_outlines);
+                const ExPolygons& areas_other = structure_per_layer[!region_idx][layer_nr / static_cast<size_t>(beam_layer_count)];
+
+                auto       layer  = print_object.get_layer(layer_nr);
+                auto&      slices = layer->get_region(region)->slices;
+                ExPolygons polys  = to_expolygons(slices.surfaces);
+                slices.set(union_ex(diff_ex(polys, areas_other), // reduce layer areas inward with beams from other mesh
+                                    areas_here)                  // extend layer areas outward with newly added beams
+                           , stInternal);
+            }
         }
-    }
+    }); // end of parallel_for
 }
 
 } // namespace Slic3r
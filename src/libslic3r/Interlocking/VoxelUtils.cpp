@@ -6,6 +6,12 @@
 #include "../Fill/FillRectilinear.hpp"
 #include "../Surface.hpp"
 
+#include <algorithm>
+#include <map>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace Slic3r
 {
 
@@ -47,6 +53,140 @@ DilationKernel::DilationKernel(GridPoint3 kernel_size, DilationKernel::Type type
     }
 }
 
+VoxelGrid::VoxelGrid(const GridPoint3& min, const GridPoint3& max)
+    : min_(min)
+    , max_(max)
+{
+    assert((min.array() <= max.array()).all());
+    words_per_row_ = size_t(max.x() - min.x() + 1 + 63) / 64;
+    bits_.assign(size_t(max.y() - min.y() + 1) * size_t(max.z() - min.z() + 1) * words_per_row_, 0);
+}
+
+bool VoxelGrid::empty() const
+{
+    return std::all_of(bits_.begin(), bits_.end(), [](uint64_t word) { return word == 0; });
+}
+
+void VoxelGrid::unite(const VoxelGrid& other)
+{
+    assert(min_ == other.min_ && max_ == other.max_);
+    for (size_t i = 0; i < bits_.size(); ++ i)
+        bits_[i] |= other.bits_[i];
+}
+
+void VoxelGrid::intersect(const VoxelGrid& other)
+{
+    assert(min_ == other.min_ && max_ == other.max_);
+    for (size_t i = 0; i < bits_.size(); ++ i)
+        bits_[i] &= other.bits_[i];
+}
+
+void VoxelGrid::subtract(const VoxelGrid& other)
+{
+    assert(min_ == other.min_ && max_ == other.max_);
+    for (size_t i = 0; i < bits_.size(); ++ i)
+        bits_[i] &= ~ other.bits_[i];
+}
+
+void VoxelGrid::clearBelowZ(coord_t z)
+{
+    if (z <= min_.z() || bits_.empty())
+        return;
+    const coord_t num_layers = std::min(z, max_.z() + 1) - min_.z();
+    std::fill(bits_.begin(), bits_.begin() + size_t(num_layers) * size_t(max_.y() - min_.y() + 1) * words_per_row_, 0);
+}
+
+// OR the row src shifted by shift voxels towards the higher x into the row dst.
+static void or_shifted_row(const uint64_t* src, uint64_t* dst, size_t num_words, coord_t shift)
+{
+    if (shift >= 0) {
+        const size_t word_shift = size_t(shift) / 64;
+        const size_t bit_shift  = size_t(shift) % 64;
+        for (size_t i = num_words; i > word_shift; -- i) {
+            const size_t from = i - 1 - word_shift;
+            uint64_t     word = src[from] << bit_shift;
+            if (bit_shift > 0 && from > 0)
+                word |= src[from - 1] >> (64 - bit_shift);
+            dst[i - 1] |= word;
+        }
+    } else {
+        const size_t word_shift = size_t(- shift) / 64;
+        const size_t bit_shift  = size_t(- shift) % 64;
+        for (size_t i = 0; i + word_shift < num_words; ++ i) {
+            const size_t from = i + word_shift;
+            uint64_t     word = src[from] >> bit_shift;
+            if (bit_shift > 0 && from + 1 < num_words)
+                word |= src[from + 1] << (64 - bit_shift);
+            dst[i] |= word;
+        }
+    }
+}
+
+VoxelGrid VoxelGrid::dilated(const DilationKernel& kernel) const
+{
+    VoxelGrid out(min_, max_);
+    if (bits_.empty())
+        return out;
+
+    // Split the kernel into runs of consecutive x offsets sharing the same y and z offsets,
+    // grouped by the x range of the run, so that each x range is applied to this grid only once.
+    std::map<std::pair<coord_t, coord_t>, std::vector<std::pair<coord_t, coord_t>>> yz_offsets_per_x_range;
+    {
+        std::map<std::pair<coord_t, coord_t>, std::vector<coord_t>> x_offsets_per_yz;
+        for (const GridPoint3& rel : kernel.relative_cells_)
+            x_offsets_per_yz[{ rel.y(), rel.z() }].emplace_back(rel.x());
+        for (auto& [yz, x_offsets] : x_offsets_per_yz) {
+            std::sort(x_offsets.begin(), x_offsets.end());
+            x_offsets.erase(std::unique(x_offsets.begin(), x_offsets.end()), x_offsets.end());
+            for (size_t begin = 0; begin < x_offsets.size();) {
+                size_t end = begin + 1;
+                while (end < x_offsets.size() && x_offsets[end] == x_offsets[end - 1] + 1)
+                    ++ end;
+                yz_offsets_per_x_range[{ x_offsets[begin], x_offsets[end - 1] }].emplace_back(yz);
+                begin = end;
+            }
+        }
+    }
+
+    const size_t   num_rows       = numRows();
+    const coord_t  size_x         = max_.x() - min_.x() + 1;
+    const uint64_t last_word_mask = size_x % 64 == 0 ? ~ uint64_t(0) : (uint64_t(1) << (size_x % 64)) - 1;
+    VoxelGrid      dilated_x(min_, max_);
+    for (const auto& [x_range, yz_offsets] : yz_offsets_per_x_range) {
+        // Dilate the rows along x.
+        std::fill(dilated_x.bits_.begin(), dilated_x.bits_.end(), 0);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_rows), [this, &dilated_x, &x_range](const tbb::blocked_range<size_t>& range) {
+            for (size_t row = range.begin(); row < range.end(); ++ row) {
+                const uint64_t* src = &bits_[row * words_per_row_];
+                uint64_t*       dst = &dilated_x.bits_[row * words_per_row_];
+                for (coord_t dx = x_range.first; dx <= x_range.second; ++ dx)
+                    or_shifted_row(src, dst, words_per_row_, dx);
+            }
+        }); // end of parallel_for
+
+        // Shift the dilated rows along y and z. Each slab of the output is written by a single thread.
+        tbb::parallel_for(tbb::blocked_range<coord_t>(min_.z(), max_.z() + 1), [&](const tbb::blocked_range<coord_t>& range) {
+            for (coord_t z = range.begin(); z < range.end(); ++ z)
+                for (const auto& [dy, dz] : yz_offsets) {
+                    const coord_t src_z = z - dz;
+                    if (src_z < min_.z() || src_z > max_.z())
+                        continue;
+                    for (coord_t y = std::max(min_.y(), min_.y() + dy); y <= std::min(max_.y(), max_.y() + dy); ++ y) {
+                        const uint64_t* src = &dilated_x.bits_[rowIndex(y - dy, src_z) * words_per_row_];
+                        uint64_t*       dst = &out.bits_[rowIndex(y, z) * words_per_row_];
+                        for (size_t i = 0; i < words_per_row_; ++ i)
+                            dst[i] |= src[i];
+                    }
+                }
+        }); // end of parallel_for
+    }
+
+    // Clip the voxels shifted beyond the box.
+    for (size_t row = 0; row < num_rows; ++ row)
+        out.bits_[row * words_per_row_ + words_per_row_ - 1] &= last_word_mask;
+    return out;
+}
+
 bool VoxelUtils::walkLine(Vec3crd start, Vec3crd end, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     Vec3crd diff = end - start;
@@ -115,6 +255,11 @@ bool VoxelUtils::walkPolygons(const ExPolygon& polys, coord_t z, const std::func
 }
 
 bool VoxelUtils::walkDilatedPolygons(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+{
+    return walkPolygonsForKernel(polys, z, kernel, dilate(kernel, process_cell_func));
+}
+
+bool VoxelUtils::walkPolygonsForKernel(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     ExPolygon translated = polys;
     GridPoint3 k = kernel.kernel_size_;
@@ -126,7 +271,7 @@ bool VoxelUtils::walkDilatedPolygons(const ExPolygon& polys, coord_t z, const Di
     {
         translated.translate(Point(translation.x(), translation.y()));
     }
-    return walkPolygons(translated, z + translation.z(), dilate(kernel, process_cell_func));
+    return walkPolygons(translated, z + translation.z(), process_cell_func);
 }
 
 bool VoxelUtils::walkAreas(const ExPolygon& polys, coord_t z, const std::function<bool(GridPoint3)>& process_cell_func) const
@@ -188,6 +333,11 @@ bool VoxelUtils::_walkAreas(const ExPolygon& polys, coord_t z, const std::functi
 }
 
 bool VoxelUtils::walkDilatedAreas(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+{
+    return walkAreasForKernel(polys, z, kernel, dilate(kernel, process_cell_func));
+}
+
+bool VoxelUtils::walkAreasForKernel(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     ExPolygon translated = polys;
     GridPoint3 k = kernel.kernel_size_;
@@ -200,7 +350,7 @@ bool VoxelUtils::walkDilatedAreas(const ExPolygon& polys, coord_t z, const Dilat
     {
         translated.translate(Point(translation.x(), translation.y()));
     }
-    return _walkAreas(translated, z + translation.z(), dilate(kernel, process_cell_func));
+    return _walkAreas(translated, z + translation.z(), process_cell_func);
 }
 
 std::function<bool(GridPoint3)> VoxelUtils::dilate(const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
@@ -4,7 +4,13 @@
 #ifndef UTILS_VOXEL_UTILS_H
 #define UTILS_VOXEL_UTILS_H
 
+#include <cstdint>
 #include <functional>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 #include "../Polygon.hpp"
 #include "../ExPolygon.hpp"
@@ -54,6 +60,115 @@ struct DilationKernel
     DilationKernel(GridPoint3 kernel_size, Type type);
 };
 
+/*!
+ * Dense bit-packed set of voxels inside a fixed box of the grid.
+ *
+ * The voxels of a row along x are packed into 64-bit words, so that the set operations and the dilation by a kernel
+ * process 64 voxels at once. The rows of different z are independent, which allows to process the slabs in parallel.
+ */
+class VoxelGrid
+{
+public:
+    VoxelGrid() = default;
+    /*!
+     * Empty grid spanning the box between \p min and \p max, both included.
+     */
+    VoxelGrid(const GridPoint3& min, const GridPoint3& max);
+
+    const GridPoint3& min() const { return min_; }
+    const GridPoint3& max() const { return max_; }
+
+    bool contains(const GridPoint3& p) const
+    {
+        return (p.array() >= min_.array()).all() && (p.array() <= max_.array()).all();
+    }
+
+    bool get(const GridPoint3& p) const
+    {
+        if (! contains(p))
+            return false;
+        const coord_t x = p.x() - min_.x();
+        return (bits_[rowIndex(p.y(), p.z()) * words_per_row_ + x / 64] >> (x % 64)) & 1;
+    }
+
+    /*!
+     * Add the voxel \p p. The box of the grid has to be large enough, the voxels outside of it are ignored.
+     */
+    void set(const GridPoint3& p)
+    {
+        assert(contains(p));
+        if (! contains(p))
+            return;
+        const coord_t x = p.x() - min_.x();
+        bits_[rowIndex(p.y(), p.z()) * words_per_row_ + x / 64] |= uint64_t(1) << (x % 64);
+    }
+
+    bool empty() const;
+
+    /*!
+     * Set operations with a grid of the same box.
+     */
+    void unite(const VoxelGrid& other);
+    void intersect(const VoxelGrid& other);
+    void subtract(const VoxelGrid& other);
+
+    /*!
+     * Remove all the voxels below the layer \p z of the grid.
+     */
+    void clearBelowZ(coord_t z);
+
+    /*!
+     * Dilate with a kernel.
+     *
+     * Each voxel of the result is the union of the voxels of this grid offset by the relative cells of the \p kernel,
+     * clipped by the box of the grid. The kernel is split into runs of consecutive x offsets, each run is applied to whole
+     * rows by word shifts.
+     */
+    VoxelGrid dilated(const DilationKernel& kernel) const;
+
+    /*!
+     * Call \p func for each voxel of the layer \p z of the grid, ordered by y, then by x.
+     */
+    template<typename Func> void forEachInSlab(coord_t z, Func func) const
+    {
+        if (z < min_.z() || z > max_.z())
+            return;
+        for (coord_t y = min_.y(); y <= max_.y(); ++ y) {
+            const uint64_t* row = &bits_[rowIndex(y, z) * words_per_row_];
+            for (size_t word_idx = 0; word_idx < words_per_row_; ++ word_idx)
+                for (uint64_t word = row[word_idx]; word != 0; word &= word - 1) {
+                    const coord_t x = coord_t(word_idx * 64 + trailingZeros(word));
+                    func(GridPoint3(min_.x() + x, y, z));
+                }
+        }
+    }
+
+private:
+    size_t rowIndex(coord_t y, coord_t z) const
+    {
+        return size_t(z - min_.z()) * size_t(max_.y() - min_.y() + 1) + size_t(y - min_.y());
+    }
+
+    size_t numRows() const { return words_per_row_ == 0 ? 0 : bits_.size() / words_per_row_; }
+
+    static unsigned int trailingZeros(uint64_t word)
+    {
+        assert(word != 0);
+#ifdef _MSC_VER
+        unsigned long idx;
+        _BitScanForward64(&idx, word);
+        return (unsigned int)idx;
+#else
+        return (unsigned int)__builtin_ctzll(word);
+#endif
+    }
+
+    GridPoint3            min_ { GridPoint3::Zero() };
+    GridPoint3            max_ { GridPoint3(-1, -1, -1) };
+    size_t                words_per_row_ { 0 };
+    std::vector<uint64_t> bits_;
+};
+
 /*!
  * Utility class for walking over a 3D voxel grid.
  *
@@ -116,6 +231,12 @@ public:
         return true;
     }
 
+    /*!
+     * Process the voxels which walkDilatedPolygons() would dilate by the \p kernel, without the dilation itself.
+     * The dilation may then be applied to all the collected voxels at once by VoxelGrid::dilated().
+     */
+    bool walkPolygonsForKernel(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+
 private:
     /*!
      * \warning the \p polys is assumed to be translated by half the cell_size in xy already
@@ -158,6 +279,12 @@ public:
         return true;
     }
 
+    /*!
+     * Process the voxels which walkDilatedAreas() would dilate by the \p kernel, without the dilation itself.
+     * The dilation may then be applied to all the collected voxels at once by VoxelGrid::dilated().
+     */
+    bool walkAreasForKernel(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+
     /*!
      * Dilate with a kernel.
      *
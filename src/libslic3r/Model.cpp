@@ -2436,17 +2436,12 @@ std::vector<int> ModelVolume::get_extruders() const
         return std::vector<int>();
 
     if (mmu_segmentation_facets.timestamp() != mmuseg_ts) {
-        std::vector<indexed_triangle_set> its_per_type;
         mmuseg_extruders.clear();
         mmuseg_ts = mmu_segmentation_facets.timestamp();
-        mmu_segmentation_facets.get_facets(*this, its_per_type);
-        for (int idx = 1; idx < its_per_type.size(); idx++) {
-            indexed_triangle_set& its = its_per_type[idx];
-            if (its.indices.empty())
-                continue;
-
-            mmuseg_extruders.push_back(idx);
-        }
+        const TriangleSelector::FacetsPerState facets = mmu_segmentation_facets.get_facets_per_state(*this, false);
+        for (int idx = 1; idx <= int(EnforcerBlockerType::ExtruderMax); idx++)
+            if (facets.num_facets(EnforcerBlockerType(idx)) > 0)
+                mmuseg_extruders.push_back(idx);
     }
 
     std::vector<int> volume_extruders = mmuseg_extruders;
@@ -3375,6 +3370,14 @@ indexed_triangle_set FacetsAnnotation::get_facets_strict(const ModelVolume& mv,
     return selector.get_facets_strict(type);
 }
 
+TriangleSelector::FacetsPerState FacetsAnnotation::get_facets_per_state(const ModelVolume& mv, bool strict) const
+{
+    TriangleSelector selector(mv.mesh());
+    // Reset of TriangleSelector is done inside TriangleSelector's constructor, so we don't need it to perform it again in deserialize().
+    selector.deserialize(m_data, false);
+    return selector.get_facets_per_state(strict);
+}
+
 bool FacetsAnnotation::has_facets(const ModelVolume& mv, EnforcerBlockerType type) const
 {
     return TriangleSelector::has_facets(m_data, type);
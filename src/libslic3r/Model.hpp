@@ -734,6 +734,9 @@ public:
     void get_facets(const ModelVolume& mv, std::vector<indexed_triangle_set>& facets_per_type) const;
     void set_enforcer_block_type_limit(const ModelVolume& mv, EnforcerBlockerType max_type);
     indexed_triangle_set get_facets_strict(const ModelVolume& mv, EnforcerBlockerType type) const;
+    // Facets of all the states, the annotation is deserialized and traversed once for all of them.
+    // Prefer it over querying the states one by one, each query deserializes the annotation again.
+    TriangleSelector::FacetsPerState get_facets_per_state(const ModelVolume& mv, bool strict) const;
     bool has_facets(const ModelVolume& mv, EnforcerBlockerType type) const;
     bool empty() const { return m_data.triangles_to_split.empty(); }
 
@@ -13,6 +13,7 @@
 
 #include <boost/log/trivial.hpp>
 #include <tbb/parallel_for.h>
+#include <tbb/enumerable_thread_specific.h>
 #include <mutex>
 #include <boost/thread/lock_guard.hpp>
 
@@ -1350,8 +1351,11 @@ static inline std::vector<std::vector<ExPolygons>> mmu_segmentation_top_and_bott
         for (const ModelVolume *mv : print_object.model_object()->volumes)
             if (mv->is_model_part()) {
                 const Transform3d volume_trafo = object_trafo * mv->get_matrix();
-                for (size_t extruder_idx = 0; extruder_idx < num_extruders; ++ extruder_idx) {
-                    const indexed_triangle_set painted = mv->mmu_segmentation_facets.get_facets_strict(*mv, EnforcerBlockerType(extruder_idx));
+                // The painting is deserialized once for all the extruders.
+                const TriangleSelector::FacetsPerState facets = mv->mmu_segmentation_facets.get_facets_per_state(*mv, true);
+                // Each extruder only touches its own top_raw / bottom_raw slot, so the extruders are processed in parallel.
+                tbb::parallel_for(size_t(0), num_extruders, [&](const size_t extruder_idx) {
+                    const indexed_triangle_set painted = facets.facets(EnforcerBlockerType(extruder_idx));
 #ifdef MM_SEGMENTATION_DEBUG_TOP_BOTTOM
                     {
                         static int iRun = 0;
@@ -1396,16 +1400,18 @@ static inline std::vector<std::vector<ExPolygons>> mmu_segmentation_top_and_bott
                         merge(std::move(top),    top_raw[extruder_idx]);
                         merge(std::move(bottom), bottom_raw[extruder_idx]);
                     }
-                }
+                }); // end of parallel_for
             }
     }
 
     auto filter_out_small_polygons = [&num_extruders, &num_layers](std::vector<std::vector<Polygons>> &raw_surfaces, double min_area) -> void {
-        for (size_t extruder_idx = 0; extruder_idx < num_extruders; ++extruder_idx)
-            if (!raw_surfaces[extruder_idx].empty())
-                for (size_t layer_idx = 0; layer_idx < num_layers; ++layer_idx)
-                    if (!raw_surfaces[extruder_idx][layer_idx].empty())
-                        remove_small(raw_surfaces[extruder_idx][layer_idx], min_area);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&num_extruders, &raw_surfaces, &min_area](const tbb::blocked_range<size_t> &range) {
+            for (size_t extruder_idx = 0; extruder_idx < num_extruders; ++extruder_idx)
+                if (!raw_surfaces[extruder_idx].empty())
+                    for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx)
+                        if (!raw_surfaces[extruder_idx][layer_idx].empty())
+                            remove_small(raw_surfaces[extruder_idx][layer_idx], min_area);
+        }); // end of parallel_for
     };
 
     // Filter out polygons less than 0.1mm^2, because they are unprintable and causing dimples on outer primers (#7104)
@@ -1437,10 +1443,11 @@ static inline std::vector<std::vector<ExPolygons>> mmu_segmentation_top_and_bott
 #endif // MM_SEGMENTATION_DEBUG_TOP_BOTTOM
 
     // When the upper surface of an object is occluded, it should no longer be considered the upper surface
-    {
-        for (size_t extruder_idx = 0; extruder_idx < num_extruders; ++extruder_idx) {
-            for (size_t layer_idx = 0; layer_idx < layers.size(); ++layer_idx) {
-                if (!top_raw[extruder_idx].empty() && !top_raw[extruder_idx][layer_idx].empty() && layer_idx + 1 < layers.size()) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&num_extruders, &num_layers, &top_raw, &bottom_raw, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            throw_on_cancel_callback();
+            for (size_t extruder_idx = 0; extruder_idx < num_extruders; ++extruder_idx) {
+                if (!top_raw[extruder_idx].empty() && !top_raw[extruder_idx][layer_idx].empty() && layer_idx + 1 < num_layers) {
                     top_raw[extruder_idx][layer_idx] = diff(top_raw[extruder_idx][layer_idx], input_expolygons[layer_idx + 1]);
                 }
                 if (!bottom_raw[extruder_idx].empty() && !bottom_raw[extruder_idx][layer_idx].empty() && layer_idx > 0) {
@@ -1448,7 +1455,7 @@ static inline std::vector<std::vector<ExPolygons>> mmu_segmentation_top_and_bott
                 }
             }
         }
-    }
+    }); // end of parallel_for
 
     std::vector<std::vector<ExPolygons>> triangles_by_color_bottom(num_extruders);
     std::vector<std::vector<ExPolygons>> triangles_by_color_top(num_extruders);
@@ -1660,7 +1667,9 @@ static inline Line clip_finite_voronoi_edge(const Voronoi::VD::edge_type &edge,
 
 static inline bool has_same_color(const ColoredLine &cl1, const ColoredLine &cl2) { return cl1.color == cl2.color; }
 
-static MMU_Graph build_graph(size_t layer_idx, const std::vector<std::vector<ColoredLine>> &color_poly)
+// The Voronoi diagram vd is only a scratch buffer. It is cleared before use, so the caller may reuse the same instance
+// for many layers to recycle its internal storage instead of reallocating it for every layer.
+static MMU_Graph build_graph(size_t layer_idx, const std::vector<std::vector<ColoredLine>> &color_poly, Voronoi::VD &vd)
 {
     const Polygons color_poly_tmp = colored_points_to_polygon(color_poly);
     const Points   points         = to_points(color_poly_tmp);
@@ -1687,7 +1696,7 @@ static MMU_Graph build_graph(size_t layer_idx, const std::vector<std::vector<Col
     ColoredLines       lines_colored = to_lines(color_poly);
     const ColoredLines colored_lines = lines_colored;
 
-    Voronoi::VD vd;
+    vd.clear();
     vd.construct_voronoi(colored_lines.begin(), colored_lines.end());
     // boost::polygon::construct_voronoi(lines_colored.begin(), lines_colored.end(), &vd);
     MMU_Graph graph;
@@ -2134,33 +2143,43 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - slices preparation in parallel - end";
 
     std::vector<BoundingBox> layer_bboxes(num_layers);
-    for (size_t layer_idx = 0; layer_idx < num_layers; ++layer_idx) {
-        throw_on_cancel_callback();
-        layer_bboxes[layer_idx] = get_extents(layers[layer_idx]->regions());
-        layer_bboxes[layer_idx].merge(get_extents(input_expolygons[layer_idx]));
-    }
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&layers, &input_expolygons, &layer_bboxes, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            throw_on_cancel_callback();
+            layer_bboxes[layer_idx] = get_extents(layers[layer_idx]->regions());
+            layer_bboxes[layer_idx].merge(get_extents(input_expolygons[layer_idx]));
+        }
+    }); // end of parallel_for
 
-    for (size_t layer_idx = 0; layer_idx < num_layers; ++layer_idx) {
-        throw_on_cancel_callback();
-        BoundingBox bbox = layer_bboxes[layer_idx];
-        // Projected triangles could, in rare cases (as in GH issue #7299), belongs to polygons printed in the previous or the next layer.
-        // Let's merge the bounding box of the current layer with bounding boxes of the previous and the next layer to ensure that
-        // every projected triangle will be inside the resulting bounding box.
-        if (layer_idx > 1) bbox.merge(layer_bboxes[layer_idx - 1]);
-        if (layer_idx < num_layers - 1) bbox.merge(layer_bboxes[layer_idx + 1]);
-        // Projected triangles may slightly exceed the input polygons.
-        bbox.offset(20 * SCALED_EPSILON);
-        edge_grids[layer_idx].set_bbox(bbox);
-        edge_grids[layer_idx].create(input_expolygons[layer_idx], coord_t(scale_(10.)));
-    }
+    BOOST_LOG_TRIVIAL(debug) << "MM segmentation - creating edge grids in parallel - begin";
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&num_layers, &layer_bboxes, &input_expolygons, &edge_grids, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            throw_on_cancel_callback();
+            BoundingBox bbox = layer_bboxes[layer_idx];
+            // Projected triangles could, in rare cases (as in GH issue #7299), belongs to polygons printed in the previous or the next layer.
+            // Let's merge the bounding box of the current layer with bounding boxes of the previous and the next layer to ensure that
+            // every projected triangle will be inside the resulting bounding box.
+            if (layer_idx > 1) bbox.merge(layer_bboxes[layer_idx - 1]);
+            if (layer_idx < num_layers - 1) bbox.merge(layer_bboxes[layer_idx + 1]);
+            // Projected triangles may slightly exceed the input polygons.
+            bbox.offset(20 * SCALED_EPSILON);
+            edge_grids[layer_idx].set_bbox(bbox);
+            edge_grids[layer_idx].create(input_expolygons[layer_idx], coord_t(scale_(10.)));
+        }
+    }); // end of parallel_for
+    BOOST_LOG_TRIVIAL(debug) << "MM segmentation - creating edge grids in parallel - end";
 
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - projection of painted triangles - begin";
     for (const ModelVolume *mv : print_object.model_object()->volumes) {
-        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_extruders + 1), [&mv, &print_object, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        if (!mv->is_model_part())
+            continue;
+        // The painting is deserialized once for all the extruders.
+        const TriangleSelector::FacetsPerState facets = mv->mmu_segmentation_facets.get_facets_per_state(*mv, false);
+        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_extruders + 1), [&mv, &facets, &print_object, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
             for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
                 throw_on_cancel_callback();
-                const indexed_triangle_set custom_facets = mv->mmu_segmentation_facets.get_facets(*mv, EnforcerBlockerType(extruder_idx));
-                if (!mv->is_model_part() || custom_facets.indices.empty())
+                const indexed_triangle_set custom_facets = facets.facets(EnforcerBlockerType(extruder_idx));
+                if (custom_facets.indices.empty())
                     continue;
 
                 const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
@@ -2250,7 +2269,9 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                              << std::count_if(painted_lines.begin(), painted_lines.end(), [](const std::vector<PaintedLine> &pl) { return !pl.empty(); });
 
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - layers segmentation in parallel - begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_extruders, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    // One Voronoi diagram per worker thread, reused for all layers processed by that thread.
+    tbb::enumerable_thread_specific<Voronoi::VD> voronoi_diagrams;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_extruders, &voronoi_diagrams, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
             throw_on_cancel_callback();
             if (!painted_lines[layer_idx].empty()) {
@@ -2276,7 +2297,7 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                     // If the whole layer is painted using the same color, it is not needed to construct a Voronoi diagram for the segmentation of this layer.
                     segmented_regions[layer_idx][size_t(color_poly.front().front().color)] = input_expolygons[layer_idx];
                 } else {
-                    MMU_Graph graph = build_graph(layer_idx, color_poly);
+                    MMU_Graph graph = build_graph(layer_idx, color_poly, voronoi_diagrams.local());
                     remove_multiple_edges_in_vertices(graph, color_poly);
                     graph.remove_nodes_with_one_arc();
                     segmented_regions[layer_idx] = extract_colored_segments(graph, num_extruders);
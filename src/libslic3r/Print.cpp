@@ -201,6 +201,7 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "activate_chamber_temp_control",
         "manual_filament_change",
         "disable_m73",
+        "binary_gcode",
         "use_firmware_retraction",
         "enable_long_retraction_when_cut",
         "long_retractions_when_cut",
@@ -1755,6 +1756,9 @@ void  PrintObject::clear_shared_object()
         BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": this=%1%, clear previous shared object data %2%")%this %m_shared_object;
         m_layers.clear();
         m_support_layers.clear();
+        // Release the first layer slices of the shared object, so that it does not copy them when modifying them.
+        firstLayerObjSliceByVolume = std::make_shared<std::vector<VolumeSlices>>();
+        firstLayerObjSliceByGroups = std::make_shared<std::vector<groupedVolumeSlices>>();
 
         m_shared_object = nullptr;
 
@@ -1768,32 +1772,17 @@ void  PrintObject::copy_layers_from_shared_object()
         m_layers.clear();
         m_support_layers.clear();
 
-        firstLayerObjSliceByVolume.clear();
-        firstLayerObjSliceByGroups.clear();
-
         BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": this=%1%, copied layers from object %2%")%this%m_shared_object;
+        // The layers are owned by the shared object, they are referenced, not copied.
         m_layers = m_shared_object->layers();
         m_support_layers = m_shared_object->support_layers();
 
-        firstLayerObjSliceByVolume = m_shared_object->firstLayerObjSlice();
-        firstLayerObjSliceByGroups = m_shared_object->firstLayerObjGroups();
-    }
-}
-
-void  PrintObject::copy_layers_overhang_from_shared_object()
-{
-    if (m_shared_object) {
-        for (size_t index = 0; index <  m_layers.size() && index <  m_shared_object->m_layers.size(); index++)
-        {
-            Layer* layer_src = m_layers[index];
-            layer_src->loverhangs = m_shared_object->m_layers[index]->loverhangs;
-            layer_src->loverhangs_bbox = m_shared_object->m_layers[index]->loverhangs_bbox;
-        }
-        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": this=%1%, copied layer overhang from object %2%")%this%m_shared_object;
+        // Share the first layer slices as well, they are copied only if modified.
+        firstLayerObjSliceByVolume = m_shared_object->firstLayerObjSliceByVolume;
+        firstLayerObjSliceByGroups = m_shared_object->firstLayerObjSliceByGroups;
     }
 }
 
-
 // BBS
 BoundingBox PrintObject::get_first_layer_bbox(float& a, float& layer_height, std::string& name)
 {
@@ -1845,13 +1834,19 @@ std::map<ObjectID, unsigned int> getObjectExtruderMap(const Print& print) {
 
 // Slicing process, running at a background thread.
 void Print::process(long long *time_cost_with_cache, bool use_cache)
+{
+    // Outside of the arena of the execution context, to name and set the locale of all the threads of the TBB thread pool.
+    name_tbb_thread_pool_threads_set_locale();
+
+    execute_in_context(m_execution_context.get(), [this, time_cost_with_cache, use_cache]() { this->_process(time_cost_with_cache, use_cache); });
+}
+
+void Print::_process(long long *time_cost_with_cache, bool use_cache)
 {
     long long start_time = 0, end_time = 0;
     if (time_cost_with_cache)
         *time_cost_with_cache = 0;
 
-    name_tbb_thread_pool_threads_set_locale();
-
     //compute the PrintObject with the same geometries
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": this=%1%, enter, use_cache=%2%, object size=%3%")%this%use_cache%m_objects.size();
     if (m_objects.empty())
@@ -2054,7 +2049,6 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
     {
         if (need_slicing_objects.count(obj) == 0) {
             obj->copy_layers_from_shared_object();
-            obj->copy_layers_overhang_from_shared_object();
         }
     }
 
@@ -2230,7 +2224,7 @@ std::string Print::export_gcode(const std::string& path_template, GCodeProcessor
     //BBS: compute plate offset for gcode-generator
     const Vec3d origin = this->get_plate_origin();
     gcode.set_gcode_offset(origin(0), origin(1));
-    gcode.do_export(this, path.c_str(), result, thumbnail_cb);
+    execute_in_context(m_execution_context.get(), [this, &gcode, &path, result, &thumbnail_cb]() { gcode.do_export(this, path.c_str(), result, thumbnail_cb); });
 
     //BBS
     result->conflict_result = m_conflict_result;
@@ -25,6 +25,7 @@
 #include <set>
 
 #include "calib.hpp"
+#include "Execution/ExecutionContext.hpp"
 
 namespace Slic3r {
 
@@ -338,10 +339,12 @@ public:
 
     // BBS
     void generate_support_preview();
-    const std::vector<VolumeSlices>& firstLayerObjSlice() const { return firstLayerObjSliceByVolume; }
-    std::vector<VolumeSlices>& firstLayerObjSliceMod() { return firstLayerObjSliceByVolume; }
-    const std::vector<groupedVolumeSlices>& firstLayerObjGroups() const { return firstLayerObjSliceByGroups; }
-    std::vector<groupedVolumeSlices>& firstLayerObjGroupsMod() { return firstLayerObjSliceByGroups; }
+    // The first layer slices are shared with the PrintObjects sharing the layers of this one (see copy_layers_from_shared_object()),
+    // the Mod accessors detach a private copy before it is modified.
+    const std::vector<VolumeSlices>& firstLayerObjSlice() const { return *firstLayerObjSliceByVolume; }
+    std::vector<VolumeSlices>& firstLayerObjSliceMod() { return detach(firstLayerObjSliceByVolume); }
+    const std::vector<groupedVolumeSlices>& firstLayerObjGroups() const { return *firstLayerObjSliceByGroups; }
+    std::vector<groupedVolumeSlices>& firstLayerObjGroupsMod() { return detach(firstLayerObjSliceByGroups); }
 
     bool                         has_brim() const       {
         return ((this->config().brim_type != btNoBrim && this->config().brim_width.value > 0.) || this->config().brim_type == btAutoBrim
@@ -429,6 +432,8 @@ public:
 
     // Helpers to project custom facets on slices
     void project_and_append_custom_facets(bool seam, EnforcerBlockerType type, std::vector<Polygons>& expolys, std::vector<std::pair<Vec3f,Vec3f>>* vertical_points=nullptr) const;
+    // Project the support enforcers and blockers at once, the painting of each volume is deserialized once for both of them.
+    void project_and_append_custom_supports(std::vector<Polygons>& enforcers, std::vector<Polygons>& blockers, std::vector<std::pair<Vec3f,Vec3f>>* vertical_enforcer_points=nullptr) const;
 
     //BBS
     BoundingBox get_first_layer_bbox(float& area, float& layer_height, std::string& name);
@@ -438,7 +443,6 @@ public:
     void         set_shared_object(PrintObject *object);
     void         clear_shared_object();
     void         copy_layers_from_shared_object();
-    void         copy_layers_overhang_from_shared_object();
 
     // BBS: Boundingbox of the first layer
     BoundingBox                 firstLayerObjectBrimBoundingBox;
@@ -536,8 +540,15 @@ private:
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
     FillLightning::GeneratorPtr m_lightning_generator;
 
-    std::vector < VolumeSlices >            firstLayerObjSliceByVolume;
-    std::vector<groupedVolumeSlices>        firstLayerObjSliceByGroups;
+    // Copy on write, see firstLayerObjSliceMod() and firstLayerObjGroupsMod().
+    std::shared_ptr<std::vector<VolumeSlices>>        firstLayerObjSliceByVolume { std::make_shared<std::vector<VolumeSlices>>() };
+    std::shared_ptr<std::vector<groupedVolumeSlices>> firstLayerObjSliceByGroups { std::make_shared<std::vector<groupedVolumeSlices>>() };
+    template<typename T>
+    static T& detach(std::shared_ptr<T> &data) {
+        if (data.use_count() > 1)
+            data = std::make_shared<T>(*data);
+        return *data;
+    }
 
     // BBS: per object skirt
     ExtrusionEntityCollection               m_skirt;
@@ -840,6 +851,10 @@ public:
     ApplyStatus         apply(const Model &model, DynamicPrintConfig config) override;
 
     void                process(long long *time_cost_with_cache = nullptr, bool use_cache = false) override;
+    // process() and export_gcode() run in the TBB arena of the execution context, if set.
+    // The context may be shared by several prints, null to run in the global TBB arena.
+    void                set_execution_context(ExecutionContextPtr context) { m_execution_context = std::move(context); }
+    const ExecutionContext* execution_context() const { return m_execution_context.get(); }
     // Exports G-code into a file name based on the path_template, returns the file path of the generated G-code file.
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
     std::string         export_gcode(const std::string& path_template, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
@@ -1001,6 +1016,7 @@ private:
 
     bool                invalidate_state_by_config_options(const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys);
 
+    void                _process(long long *time_cost_with_cache, bool use_cache);
     void                _make_skirt();
     void                _make_wipe_tower();
     void                finalize_first_layer_convex_hull();
@@ -1049,6 +1065,8 @@ private:
     //SoftFever: calibration
     Calib_Params m_calib_params;
 
+    ExecutionContextPtr m_execution_context;
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
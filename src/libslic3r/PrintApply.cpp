@@ -225,14 +225,10 @@ static t_config_option_keys print_config_diffs(
     const std::vector<std::string> &extruder_retract_keys = print_config_def.extruder_retract_keys();
     const std::string               filament_prefix       = "filament_";
     t_config_option_keys            print_diff;
-    for (const t_config_option_key &opt_key : current_config.keys()) {
-        const ConfigOption *opt_old = current_config.option(opt_key);
-        assert(opt_old != nullptr);
-        const ConfigOption *opt_new = new_full_config.option(opt_key);
-        // assert(opt_new != nullptr);
-        if (opt_new == nullptr)
-            //FIXME This may happen when executing some test cases.
-            continue;
+    // Walk current_config and new_full_config in a lockstep. Options missing in new_full_config are skipped.
+    //FIXME This may happen when executing some test cases.
+    current_config.iterate_common(new_full_config, [&](const t_config_option_key &opt_key, const ConfigOption *opt_old, const ConfigOption *opt_new) {
+        assert(opt_old != nullptr && opt_new != nullptr);
         const ConfigOption *opt_new_filament = std::binary_search(extruder_retract_keys.begin(), extruder_retract_keys.end(), opt_key) ? new_full_config.option(filament_prefix + opt_key) : nullptr;
         if (opt_new_filament != nullptr && ! opt_new_filament->is_nil()) {
             // An extruder retract override is available at some of the filament presets.
@@ -248,7 +244,7 @@ static t_config_option_keys print_config_diffs(
                 if (changed || overriden) {
                     if ((opt_key == "long_retractions_when_cut" || opt_key == "retraction_distances_when_cut")
                         && new_full_config.option<ConfigOptionInt>("enable_long_retraction_when_cut")->value != LongRectrationLevel::EnableFilament)
-                        continue;
+                        return;
                     // filament_overrides will be applied to the placeholder parser, which layers these parameters over full_print_config.
                     filament_overrides.set_key_value(opt_key, opt_copy);
                 } else
@@ -272,7 +268,7 @@ static t_config_option_keys print_config_diffs(
             else
                 print_diff.emplace_back(opt_key);
         }
-    }
+    });
 
     return print_diff;
 }
@@ -282,9 +278,14 @@ static t_config_option_keys print_config_diffs(
 static t_config_option_keys full_print_config_diffs(const DynamicPrintConfig &current_full_config, const DynamicPrintConfig &new_full_config, int plate_index)
 {
     t_config_option_keys full_config_diff;
-    for (const t_config_option_key &opt_key : new_full_config.keys()) {
-        const ConfigOption *opt_old = current_full_config.option(opt_key);
-        const ConfigOption *opt_new = new_full_config.option(opt_key);
+    // Both configs are sorted by key, walk them in a lockstep instead of looking up each key of new_full_config.
+    auto it_old = current_full_config.cbegin();
+    for (auto it_new = new_full_config.cbegin(); it_new != new_full_config.cend(); ++ it_new) {
+        const t_config_option_key &opt_key = it_new->first;
+        while (it_old != current_full_config.cend() && it_old->first < opt_key)
+            ++ it_old;
+        const ConfigOption *opt_old = (it_old != current_full_config.cend() && it_old->first == opt_key) ? it_old->second.get() : nullptr;
+        const ConfigOption *opt_new = it_new->second.get();
         if (opt_old == nullptr || *opt_new != *opt_old) {
             //BBS: add plate_index logic for wipe_tower_x/wipe_tower_y
             if (opt_old && (!opt_key.compare("wipe_tower_x") || !opt_key.compare("wipe_tower_y"))) {
@@ -1431,6 +1432,10 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
             for (const PrintObjectStatus &pos : print_object_status_db)
                 if (pos.status == PrintObjectStatus::Unknown || pos.status == PrintObjectStatus::Deleted) {
                     update_apply_status(pos.print_object->invalidate_all_steps());
+                    // BBS: the objects sharing the layers of the deleted object shall not reference them anymore.
+                    for (PrintObject *object : m_objects)
+                        if (object->get_shared_object() == pos.print_object)
+                            object->clear_shared_object();
                     delete pos.print_object;
 					deleted_objects = true;
                 }
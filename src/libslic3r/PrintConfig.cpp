@@ -4147,6 +4147,13 @@ void PrintConfigDef::init_fff_params()
     def->mode = comAdvanced;
     def->set_default_value(new ConfigOptionBool(false));
 
+    def = this->add("binary_gcode", coBool);
+    def->label = L("Binary G-code");
+    def->tooltip = L("Export the G-code in a compact binary format with the metadata and the thumbnails stored in separate blocks. "
+                     "The printer or the print host has to support the binary G-code.");
+    def->mode = comAdvanced;
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("seam_position", coEnum);
     def->label = L("Seam position");
     def->category = L("Quality");
@@ -7414,6 +7421,14 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->tooltip = L("Send progress to pipe.");
     def->cli_params = "pipename";
     def->set_default_value(new ConfigOptionString());
+
+    def = this->add("daemon", coString);
+    def->label = L("Daemon mode");
+    def->tooltip = L("Keep running and slice the jobs received as JSON lines {\"id\": ..., \"args\": [...]} "
+                     "either from stdin (\"-\") or from connections to the given UNIX socket. "
+                     "A running job is canceled by {\"cancel\": id}. The parsed setting files are reused by the next jobs.");
+    def->cli_params = "socket";
+    def->set_default_value(new ConfigOptionString());
 }
 
 //BBS: remove unused command currently
@@ -7652,6 +7667,59 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->cli_params = "level";
     def->set_default_value(new ConfigOptionInt(1));
 
+    def = this->add("gcode_memory_limit", coInt);
+    def->label = L("G-code export memory limit");
+    def->tooltip = L("Limits the G-code which was generated, but not yet written into the output file, to this many megabytes. "
+                     "Large layers are then exported with less parallelism. "
+                     "The plates sliced in parallel are limited each on its own. "
+                     "In daemon mode, the value given to the daemon is the default of its jobs. 0 for no limit.");
+    def->min = 0;
+    def->cli_params = "MB";
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("parallel_plates", coInt);
+    def->label = L("Parallel plates");
+    def->tooltip = L("Number of plates sliced at the same time when slicing all plates. Each plate is sliced by its own print, "
+                     "the results are reported in the plate order. 1 slices the plates one by one.");
+    def->min = 1;
+    def->cli_params = "count";
+    def->set_default_value(new ConfigOptionInt(1));
+
+    def = this->add("threads", coInt);
+    def->label = L("Maximum number of threads");
+    def->tooltip = L("Limits the number of threads slicing and exporting the plates of a job, including the plates sliced in parallel. "
+                     "In daemon mode, the value given to the daemon is the default of its jobs. 0 for no limit.");
+    def->min = 0;
+    def->cli_params = "count";
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("numa_node", coInt);
+    def->label = L("NUMA node");
+    def->tooltip = L("Run the slicing threads of a job on the given NUMA node. Ignored if the NUMA topology is not available. "
+                     "In daemon mode, the value given to the daemon is the default of its jobs. -1 for no preference.");
+    def->min = -1;
+    def->cli_params = "node";
+    def->set_default_value(new ConfigOptionInt(-1));
+
+    def = this->add("gcode_pipeline_tokens", coInt);
+    def->label = L("G-code export pipeline tokens");
+    def->tooltip = L("Maximum number of layers processed at the same time by the G-code export. "
+                     "In daemon mode, the value given to the daemon is the default of its jobs. 0 for the default.");
+    def->min = 0;
+    def->cli_params = "count";
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("max_extruders_exact", coInt);
+    def->label = L("Maximum extruders ordered exactly");
+    def->tooltip = L("The filaments of a layer are ordered to minimize the flush volume. Up to this many filaments, including the "
+                     "filament loaded before the layer, the order is optimal; more filaments are ordered by a faster heuristic. "
+                     "The time of the optimal order doubles with every filament. "
+                     "In daemon mode, the value given to the daemon is the default of its jobs. 0 for the default (16).");
+    def->min = 0;
+    def->max = 20;
+    def->cli_params = "count";
+    def->set_default_value(new ConfigOptionInt(0));
+
     def = this->add("enable_timelapse", coBool);
     def->label = L("Enable timelapse for print");
     def->tooltip = L("If enabled, this slicing will be considered using timelapse");
@@ -610,6 +610,28 @@ protected:
         const std::vector<std::string>& keys()      const { return m_keys; }
         const T&                        defaults()  const { return *m_defaults; }
 
+        // Call fn(key, owner_option, other_option) for each option present both in owner and in other.
+        // Both m_keys and the options of a DynamicConfig are sorted by key, thus the two configs are walked in a lockstep
+        // and the options of owner are addressed by their offsets: No key lookup is performed, no key list is allocated.
+        template<typename Fn>
+        void                iterate_common(const T *owner, const DynamicConfig &other, Fn &&fn) const
+        {
+            auto it_other = other.cbegin();
+            for (size_t i = 0; i < m_keys.size() && it_other != other.cend();) {
+                const std::string &key = m_keys[i];
+                int cmp = key.compare(it_other->first);
+                if (cmp < 0)
+                    ++ i;
+                else if (cmp > 0)
+                    ++ it_other;
+                else {
+                    fn(key, reinterpret_cast<const ConfigOption*>((const char*)owner + m_offsets[i]), it_other->second.get());
+                    ++ i;
+                    ++ it_other;
+                }
+            }
+        }
+
         // To be called during the StaticCache setup.
         // Collect option keys from m_map_name_to_offset,
         // assign default values to m_defaults.
@@ -619,6 +641,8 @@ protected:
             m_defaults = defaults;
             m_keys.clear();
             m_keys.reserve(m_map_name_to_offset.size());
+            m_offsets.clear();
+            m_offsets.reserve(m_map_name_to_offset.size());
             for (const auto &kvp : defs->options) {
                 // Find the option given the option name kvp.first by an offset from (char*)m_defaults.
                 ConfigOption *opt = this->optptr(kvp.first, m_defaults);
@@ -626,6 +650,7 @@ protected:
                     // This option is not defined by the ConfigBase of type T.
                     continue;
                 m_keys.emplace_back(kvp.first);
+                m_offsets.emplace_back((const char*)opt - (const char*)m_defaults);
                 const ConfigOptionDef *def = defs->get(kvp.first);
                 assert(def != nullptr);
                 if (def->default_value)
@@ -635,7 +660,10 @@ protected:
 
     private:
         T                                  *m_defaults;
+        // Sorted, as ConfigDef::options is sorted.
         std::vector<std::string>            m_keys;
+        // Offsets of the options named by m_keys.
+        std::vector<ptrdiff_t>              m_offsets;
     };
 };
 
@@ -650,6 +678,20 @@ public: \
     /* Overrides ConfigBase::keys(). Collect names of all configuration values maintained by this configuration store. */ \
     t_config_option_keys     keys() const override { return s_cache_##CLASS_NAME.keys(); } \
     const t_config_option_keys& keys_ref() const override { return s_cache_##CLASS_NAME.keys(); } \
+    /* Call fn(key, this_option, other_option) for each option present in both configs, walking both configs in a lockstep. */ \
+    template<typename Fn> \
+    void                     iterate_common(const DynamicConfig &other, Fn &&fn) const \
+        { s_cache_##CLASS_NAME.iterate_common(this, other, std::forward<Fn>(fn)); } \
+    /* Returns options differing in the two configs, ignoring options not present in both configs. */ \
+    /* Faster than ConfigBase::diff(), which looks up each key of this config in the other config. */ \
+    t_config_option_keys     diff(const DynamicConfig &other) const \
+    { \
+        t_config_option_keys out; \
+        this->iterate_common(other, [&out](const t_config_option_key &key, const ConfigOption *l, const ConfigOption *r) \
+            { if (*l != *r) out.emplace_back(key); }); \
+        return out; \
+    } \
+    using ConfigBase::diff; \
     static const CLASS_NAME& defaults() { assert(s_cache_##CLASS_NAME.initialized()); return s_cache_##CLASS_NAME.defaults(); } \
 private: \
     friend int print_config_static_initializer(); \
@@ -1175,6 +1217,7 @@ PRINT_CONFIG_CLASS_DEFINE(
     ((ConfigOptionFloatOrPercent,      initial_layer_travel_speed))
     ((ConfigOptionBool,                bbl_calib_mark_logo))
     ((ConfigOptionBool,                disable_m73))
+    ((ConfigOptionBool,                binary_gcode))
 
     // Orca: mmu
     ((ConfigOptionFloat,               cooling_tube_retraction))
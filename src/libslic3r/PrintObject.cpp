@@ -4151,33 +4151,51 @@ static void project_triangles_to_slabs(ConstLayerPtrsAdaptor layers, const index
     }
 }
 
+// Project custom facets of a single volume, either the seam facets onto the slabs or the support facets
+// upwards to their respective slicing planes.
+static void project_and_append_volume_facets(
+        const PrintObject &print_object, const ModelVolume &mv, bool seam, const indexed_triangle_set &custom_facets,
+        std::vector<Polygons>& out, std::vector<std::pair<Vec3f, Vec3f>>* vertical_points)
+{
+    if (custom_facets.indices.empty())
+        return;
+    if (seam)
+        project_triangles_to_slabs(print_object.layers(), custom_facets,
+            (print_object.trafo_centered() * mv.get_matrix()).cast<float>(),
+            seam, out);
+    else {
+        std::vector<Polygons> projected;
+        // Support blockers or enforcers. Project downward facing painted areas upwards to their respective slicing plane.
+        slice_mesh_slabs(custom_facets, zs_from_layers(print_object.layers()), print_object.trafo_centered() * mv.get_matrix(), nullptr, &projected, vertical_points, [](){});
+        // Merge these projections with the output, layer by layer.
+        assert(! projected.empty());
+        assert(out.empty() || out.size() == projected.size());
+        if (out.empty())
+            out = std::move(projected);
+        else
+            for (size_t i = 0; i < out.size(); ++ i)
+                append(out[i], std::move(projected[i]));
+    }
+}
+
 void PrintObject::project_and_append_custom_facets(
         bool seam, EnforcerBlockerType type, std::vector<Polygons>& out, std::vector<std::pair<Vec3f, Vec3f>>* vertical_points) const
 {
     for (const ModelVolume* mv : this->model_object()->volumes)
-        if (mv->is_model_part()) {
-            const indexed_triangle_set custom_facets = seam
-                    ? mv->seam_facets.get_facets_strict(*mv, type)
-                    : mv->supported_facets.get_facets_strict(*mv, type);
-            if (! custom_facets.indices.empty()) {
-                if (seam)
-                    project_triangles_to_slabs(this->layers(), custom_facets,
-                        (this->trafo_centered() * mv->get_matrix()).cast<float>(),
-                        seam, out);
-                else {
-                    std::vector<Polygons> projected;
-                    // Support blockers or enforcers. Project downward facing painted areas upwards to their respective slicing plane.
-                    slice_mesh_slabs(custom_facets, zs_from_layers(this->layers()), this->trafo_centered() * mv->get_matrix(), nullptr, &projected, vertical_points, [](){});
-                    // Merge these projections with the output, layer by layer.
-                    assert(! projected.empty());
-                    assert(out.empty() || out.size() == projected.size());
-                    if (out.empty())
-                        out = std::move(projected);
-                    else
-                        for (size_t i = 0; i < out.size(); ++ i)
-                            append(out[i], std::move(projected[i]));
-                }
-            }
+        if (mv->is_model_part())
+            project_and_append_volume_facets(*this, *mv, seam,
+                seam ? mv->seam_facets.get_facets_strict(*mv, type) : mv->supported_facets.get_facets_strict(*mv, type),
+                out, vertical_points);
+}
+
+void PrintObject::project_and_append_custom_supports(
+        std::vector<Polygons>& enforcers, std::vector<Polygons>& blockers, std::vector<std::pair<Vec3f, Vec3f>>* vertical_enforcer_points) const
+{
+    for (const ModelVolume* mv : this->model_object()->volumes)
+        if (mv->is_model_part() && ! mv->supported_facets.empty()) {
+            const TriangleSelector::FacetsPerState facets = mv->supported_facets.get_facets_per_state(*mv, true);
+            project_and_append_volume_facets(*this, *mv, false, facets.facets(EnforcerBlockerType::ENFORCER), enforcers, vertical_enforcer_points);
+            project_and_append_volume_facets(*this, *mv, false, facets.facets(EnforcerBlockerType::BLOCKER), blockers, nullptr);
         }
 }
 
@@ -1011,7 +1011,8 @@ void PrintObject::slice_volumes()
     //firstLayerObjSliceByVolume = findPartVolumes(objSliceByVolume, this->model_object()->volumes);
     //groupingVolumes(objSliceByVolumeParts, firstLayerObjSliceByGroups, scaled_resolution);
     //applyNegtiveVolumes(this->model_object()->volumes, objSliceByVolume, firstLayerObjSliceByGroups, scaled_resolution);
-    firstLayerObjSliceByVolume = objSliceByVolume;
+    // A new vector, the previous one may still be referenced by the objects sharing the layers of this one.
+    firstLayerObjSliceByVolume = std::make_shared<std::vector<VolumeSlices>>(objSliceByVolume);
 
     std::vector<std::vector<ExPolygons>> region_slices =
         slices_to_regions(print->config(), *this, this->model_object()->volumes, *m_shared_regions, slice_zs,
@@ -31,33 +31,26 @@ template<class Color> struct Colors {
 template<class Color> const Color Colors<Color>::White = Color{255};
 template<class Color> const Color Colors<Color>::Black = Color{0};
 
-template<class PixelRenderer,
-         template<class /*agg::renderer_base<PixelRenderer>*/> class Renderer,
-         class Rasterizer = agg::rasterizer_scanline_aa<>,
-         class Scanline   = agg::scanline_p8>
-class AGGRaster: public RasterBase {
-public:
-    using TColor = typename PixelRenderer::color_type;
-    using TValue = typename TColor::value_type;
-    using TPixel = typename PixelRenderer::pixel_type;
-    using TRawBuffer = agg::rendering_buffer;
-
+// Conversion of polygons in scaled coordinates into AGG paths in the pixel
+// coordinates of a raster with the given resolution and transformation.
+class AGGPathConverter {
 protected:
-    
     Resolution m_resolution;
     PixelDim m_pxdim_scaled;    // used for scaled coordinate polygons
+    RasterBase::Trafo m_trafo;
     
-    std::vector<TPixel> m_buf;
-    agg::rendering_buffer m_rbuf;
-    
-    PixelRenderer m_pixrenderer;
-    
-    agg::renderer_base<PixelRenderer> m_raw_renderer;
-    Renderer<agg::renderer_base<PixelRenderer>> m_renderer;
-    
-    Trafo m_trafo;
-    Scanline m_scanlines;
-    Rasterizer m_rasterizer;
+    AGGPathConverter(const Resolution &res, const PixelDim &pd, const RasterBase::Trafo &trafo)
+        : m_resolution(res)
+        , m_pxdim_scaled(SCALING_FACTOR, SCALING_FACTOR)
+        , m_trafo(trafo)
+    {
+        // Visual Studio compiler gives warnings about possible division by zero.
+        assert(pd.w_mm != 0 && pd.h_mm != 0);
+        if (pd.w_mm != 0 && pd.h_mm != 0) {
+            m_pxdim_scaled.w_mm /= pd.w_mm;
+            m_pxdim_scaled.h_mm /= pd.h_mm;
+        }
+    }
     
     void flipy(agg::path_storage &path) const
     {
@@ -110,6 +103,39 @@ protected:
         return path;
     }
     
+public:
+    Resolution resolution() const { return m_resolution; }
+    PixelDim   pixel_dimensions() const
+    {
+        return {SCALING_FACTOR / m_pxdim_scaled.w_mm,
+                SCALING_FACTOR / m_pxdim_scaled.h_mm};
+    }
+};
+
+template<class PixelRenderer,
+         template<class /*agg::renderer_base<PixelRenderer>*/> class Renderer,
+         class Rasterizer = agg::rasterizer_scanline_aa<>,
+         class Scanline   = agg::scanline_p8>
+class AGGRaster: public RasterBase, public AGGPathConverter {
+public:
+    using TColor = typename PixelRenderer::color_type;
+    using TValue = typename TColor::value_type;
+    using TPixel = typename PixelRenderer::pixel_type;
+    using TRawBuffer = agg::rendering_buffer;
+
+protected:
+    
+    std::vector<TPixel> m_buf;
+    agg::rendering_buffer m_rbuf;
+    
+    PixelRenderer m_pixrenderer;
+    
+    agg::renderer_base<PixelRenderer> m_raw_renderer;
+    Renderer<agg::renderer_base<PixelRenderer>> m_renderer;
+    
+    Scanline m_scanlines;
+    Rasterizer m_rasterizer;
+    
     template<class P> void _draw(const P &poly)
     {
         m_rasterizer.reset();
@@ -128,8 +154,7 @@ public:
               const TColor &    foreground,
               const TColor &    background,
               GammaFn &&        gammafn)
-        : m_resolution(res)
-        , m_pxdim_scaled(SCALING_FACTOR, SCALING_FACTOR)
+        : AGGPathConverter(res, pd, trafo)
         , m_buf(res.pixels())
         , m_rbuf(reinterpret_cast<TValue *>(m_buf.data()),
                  unsigned(res.width_px),
@@ -138,14 +163,7 @@ public:
         , m_pixrenderer(m_rbuf)
         , m_raw_renderer(m_pixrenderer)
         , m_renderer(m_raw_renderer)
-        , m_trafo(trafo)
     {
-        // Visual Studio compiler gives warnings about possible division by zero.
-        assert(pd.w_mm != 0 && pd.h_mm != 0);
-        if (pd.w_mm != 0 && pd.h_mm != 0) {
-            m_pxdim_scaled.w_mm /= pd.w_mm;
-            m_pxdim_scaled.h_mm /= pd.h_mm;
-        }
         m_renderer.color(foreground);
         clear(background);
         
@@ -153,12 +171,6 @@ public:
     }
     
     Trafo trafo() const override { return m_trafo; }
-    Resolution resolution() const { return m_resolution; }
-    PixelDim   pixel_dimensions() const
-    {
-        return {SCALING_FACTOR / m_pxdim_scaled.w_mm,
-                SCALING_FACTOR / m_pxdim_scaled.h_mm};
-    }
     
     void draw(const ExPolygon &poly) override { _draw(poly); }
     
@@ -220,6 +232,177 @@ public:
     {}
 };
 
+/*
+ * Grayscale canvas which stores only the horizontal extent of each row that
+ * was actually drawn into. Rows without any content don't allocate memory.
+ * Implements the subset of the AGG pixel format interface which is used by
+ * agg::renderer_base and agg::renderer_scanline_aa_solid, blending exactly
+ * like agg::pixfmt_gray8 does.
+ */
+class SparseGray8Canvas {
+public:
+    using color_type = agg::gray8;
+    using value_type = color_type::value_type;
+    using row_data   = agg::const_row_info<value_type>;
+    using blender_type = agg::blender_gray<color_type>;
+
+    explicit SparseGray8Canvas(const Resolution &res)
+        : m_width(res.width_px), m_rows(res.height_px)
+    {}
+
+    unsigned width() const { return unsigned(m_width); }
+    unsigned height() const { return unsigned(m_rows.size()); }
+
+    void blend_hline(int x, int y, unsigned len, const color_type &c, agg::int8u cover)
+    {
+        if (c.is_transparent()) return;
+
+        value_type *p = span(x, y, len);
+        if (c.is_opaque() && cover == agg::cover_mask)
+            std::fill(p, p + len, c.v);
+        else
+            for (unsigned i = 0; i < len; ++i)
+                blender_type::blend_pix(p + i, c.v, c.a, cover);
+    }
+
+    void blend_solid_hspan(int x, int y, unsigned len, const color_type &c, const agg::int8u *covers)
+    {
+        if (c.is_transparent()) return;
+
+        value_type *p = span(x, y, len);
+        for (unsigned i = 0; i < len; ++i) {
+            if (c.is_opaque() && covers[i] == agg::cover_mask)
+                p[i] = c.v;
+            else
+                blender_type::blend_pix(p + i, c.v, c.a, covers[i]);
+        }
+    }
+
+    value_type pixel(size_t col, size_t row) const
+    {
+        const Row &r = m_rows[row];
+        return (col >= r.x0 && col < r.x0 + r.px.size()) ? r.px[col - r.x0] : value_type(0);
+    }
+
+    // Write the full width row into dst, which has to hold width() values.
+    void read_row(size_t row, value_type *dst) const
+    {
+        const Row &r = m_rows[row];
+        std::fill(dst, dst + m_width, value_type(0));
+        std::copy(r.px.begin(), r.px.end(), dst + r.x0);
+    }
+
+    // Number of bytes allocated for the pixels.
+    size_t memory_usage() const
+    {
+        size_t sz = 0;
+        for (const Row &r : m_rows) sz += r.px.capacity();
+        return sz;
+    }
+
+    void clear() { for (Row &r : m_rows) r = {}; }
+
+private:
+    struct Row {
+        size_t                  x0 = 0;
+        std::vector<value_type> px;
+    };
+
+    // Return pointer to the pixel x of row y, growing the stored extent of
+    // the row to cover [x, x + len). New pixels are black (background).
+    value_type *span(int x, int y, unsigned len)
+    {
+        Row &r = m_rows[size_t(y)];
+        const size_t x0 = size_t(x), x1 = x0 + len;
+        if (r.px.empty()) {
+            r.x0 = x0;
+            r.px.assign(len, value_type(0));
+        } else {
+            if (x0 < r.x0) {
+                r.px.insert(r.px.begin(), r.x0 - x0, value_type(0));
+                r.x0 = x0;
+            }
+            if (x1 > r.x0 + r.px.size())
+                r.px.resize(x1 - r.x0, value_type(0));
+        }
+
+        return r.px.data() + (x0 - r.x0);
+    }
+
+    size_t           m_width;
+    std::vector<Row> m_rows;
+};
+
+/*
+ * Anti-aliased monochrome raster with white fill on black background, same as
+ * RasterGrayscaleAA, but backed by a SparseGray8Canvas. Its memory usage is
+ * proportional to the drawn content instead of the full display resolution.
+ * PNG encoding reads the canvas row by row without materializing the image.
+ */
+class RasterGrayscaleAASparse : public RasterBase, public AGGPathConverter {
+    using Canvas = SparseGray8Canvas;
+    using TColor = Canvas::color_type;
+
+    Canvas                                                             m_canvas;
+    agg::renderer_base<Canvas>                                         m_raw_renderer;
+    agg::renderer_scanline_aa_solid<agg::renderer_base<Canvas>>        m_renderer;
+    agg::scanline_p8                                                   m_scanlines;
+    agg::rasterizer_scanline_aa<>                                      m_rasterizer;
+
+public:
+    template<class GammaFn>
+    RasterGrayscaleAASparse(const Resolution        &res,
+                            const PixelDim          &pd,
+                            const RasterBase::Trafo &trafo,
+                            GammaFn                &&fn)
+        : AGGPathConverter(res, pd, trafo)
+        , m_canvas(res)
+        , m_raw_renderer(m_canvas)
+        , m_renderer(m_raw_renderer)
+    {
+        m_renderer.color(Colors<TColor>::White);
+        m_rasterizer.gamma(std::forward<GammaFn>(fn));
+    }
+
+    Trafo trafo() const override { return m_trafo; }
+
+    void draw(const ExPolygon &poly) override
+    {
+        m_rasterizer.reset();
+
+        m_rasterizer.add_path(to_path(contour(poly)));
+        for(auto& h : holes(poly)) m_rasterizer.add_path(to_path(h));
+
+        agg::render_scanlines(m_rasterizer, m_scanlines, m_renderer);
+    }
+
+    EncodedRaster encode(RasterEncoder encoder) const override
+    {
+        const size_t w = m_resolution.width_px, h = m_resolution.height_px;
+
+        if (encoder.target<PNGRasterEncoder>() != nullptr) {
+            std::vector<uint8_t> row(w);
+            return encode_png_rows(w, h, 1, [this, &row](size_t r) {
+                m_canvas.read_row(r, row.data());
+                return row.data();
+            });
+        }
+
+        // Other encoders need the whole image at once.
+        std::vector<uint8_t> buf(w * h);
+        for (size_t r = 0; r < h; ++r)
+            m_canvas.read_row(r, buf.data() + r * w);
+
+        return encoder(buf.data(), w, h, 1);
+    }
+
+    uint8_t read_pixel(size_t col, size_t row) const { return m_canvas.pixel(col, row); }
+
+    size_t memory_usage() const { return m_canvas.memory_usage(); }
+
+    void clear() { m_canvas.clear(); }
+};
+
 }} // namespace Slic3r::sla
 
 #endif // AGGRASTER_HPP
@@ -14,7 +14,6 @@ namespace Slic3r { namespace sla {
 EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
                                            size_t      num_components)
 {
-    std::vector<uint8_t> buf;
     size_t s = 0;
     
     void *rawdata = tdefl_write_image_to_png_file_in_memory(
@@ -26,13 +25,79 @@ EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     
     auto pptr = static_cast<std::uint8_t*>(rawdata);
     
-    buf.reserve(s);
-    std::copy(pptr, pptr + s, std::back_inserter(buf));
+    std::vector<uint8_t> buf(pptr, pptr + s);
     
     MZ_FREE(rawdata);
     return EncodedRaster(std::move(buf), "png");
 }
 
+EncodedRaster encode_png_rows(size_t w, size_t h, size_t num_components,
+                              const std::function<const uint8_t *(size_t row)> &rowfn)
+{
+    // Mirrors tdefl_write_image_to_png_file_in_memory() with its default
+    // level, only the image rows are fed to the compressor one by one.
+    static constexpr size_t HeaderSize = 41;
+
+    std::vector<uint8_t> buf;
+    buf.reserve(HeaderSize + (1 + w * num_components) * h / 8);
+    buf.resize(HeaderSize); // placeholder for the header
+
+    auto putter = [](const void *data, int len, void *user) -> mz_bool {
+        auto &out = *static_cast<std::vector<uint8_t> *>(user);
+        auto  ptr = static_cast<const uint8_t *>(data);
+        out.insert(out.end(), ptr, ptr + len);
+        return MZ_TRUE;
+    };
+
+    std::unique_ptr<tdefl_compressor, void (*)(tdefl_compressor *)>
+        comp(tdefl_compressor_alloc(), tdefl_compressor_free);
+    if (!comp) return EncodedRaster({}, "png");
+
+    tdefl_init(comp.get(), putter, &buf, TDEFL_DEFAULT_MAX_PROBES | TDEFL_WRITE_ZLIB_HEADER);
+
+    const size_t  bpl    = w * num_components;
+    const uint8_t filter = 0;
+    for (size_t y = 0; y < h; ++y) {
+        tdefl_compress_buffer(comp.get(), &filter, 1, TDEFL_NO_FLUSH);
+        tdefl_compress_buffer(comp.get(), rowfn(y), bpl, TDEFL_NO_FLUSH);
+    }
+
+    if (tdefl_compress_buffer(comp.get(), nullptr, 0, TDEFL_FINISH) != TDEFL_STATUS_DONE)
+        return EncodedRaster({}, "png");
+
+    const size_t idat_len = buf.size() - HeaderSize;
+
+    static const uint8_t chans[] = {0x00, 0x00, 0x04, 0x02, 0x06};
+    uint8_t hdr[HeaderSize] = {0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00,
+                               0x00, 0x0d, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x00,
+                               0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+                               0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x49, 0x44, 0x41,
+                               0x54};
+    hdr[18] = uint8_t(w >> 8);
+    hdr[19] = uint8_t(w);
+    hdr[22] = uint8_t(h >> 8);
+    hdr[23] = uint8_t(h);
+    hdr[25] = chans[num_components];
+    hdr[33] = uint8_t(idat_len >> 24);
+    hdr[34] = uint8_t(idat_len >> 16);
+    hdr[35] = uint8_t(idat_len >> 8);
+    hdr[36] = uint8_t(idat_len);
+    mz_uint32 c = mz_uint32(mz_crc32(MZ_CRC32_INIT, hdr + 12, 17));
+    for (int i = 0; i < 4; ++i, c <<= 8)
+        hdr[29 + i] = uint8_t(c >> 24);
+    std::copy(hdr, hdr + HeaderSize, buf.begin());
+
+    // IDAT CRC-32 (filled below), followed by the IEND chunk.
+    static const uint8_t footer[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                     0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82};
+    buf.insert(buf.end(), std::begin(footer), std::end(footer));
+    c = mz_uint32(mz_crc32(MZ_CRC32_INIT, buf.data() + HeaderSize - 4, idat_len + 4));
+    for (int i = 0; i < 4; ++i, c <<= 8)
+        buf[buf.size() - 16 + i] = uint8_t(c >> 24);
+
+    return EncodedRaster(std::move(buf), "png");
+}
+
 std::ostream &operator<<(std::ostream &stream, const EncodedRaster &bytes)
 {
     stream.write(reinterpret_cast<const char *>(bytes.data()),
@@ -80,6 +145,22 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     return rst;
 }
 
+std::unique_ptr<RasterBase> create_raster_grayscale_aa_sparse(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma,
+    const RasterBase::Trafo &tr)
+{
+    std::unique_ptr<RasterBase> rst;
+    
+    if (gamma > 0)
+        rst = std::make_unique<RasterGrayscaleAASparse>(res, pxdim, tr, agg::gamma_power(gamma));
+    else
+        rst = std::make_unique<RasterGrayscaleAASparse>(res, pxdim, tr, agg::gamma_threshold(.5));
+    
+    return rst;
+}
+
 } // namespace sla
 } // namespace Slic3r
 
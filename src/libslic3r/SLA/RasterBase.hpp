@@ -7,6 +7,7 @@
 #include <array>
 #include <utility>
 #include <cstdint>
+#include <functional>
 
 #include <libslic3r/ExPolygon.hpp>
 
@@ -100,6 +101,13 @@ struct PNGRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
 };
 
+// Encode an 8 bit per channel image into PNG, requesting one row of
+// w * num_components bytes at a time from rowfn. The pointer returned by
+// rowfn has to stay valid until the next call. The result is the same as
+// PNGRasterEncoder would give for the equivalent continuous buffer.
+EncodedRaster encode_png_rows(size_t w, size_t h, size_t num_components,
+                              const std::function<const uint8_t *(size_t row)> &rowfn);
+
 struct PPMRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
 };
@@ -113,6 +121,14 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     double                   gamma = 1.0,
     const RasterBase::Trafo &tr    = {});
 
+// Same as create_raster_grayscale_aa, but the raster only allocates memory
+// for the parts of the rows which are drawn into.
+std::unique_ptr<RasterBase> create_raster_grayscale_aa_sparse(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma = 1.0,
+    const RasterBase::Trafo &tr    = {});
+
 }} // namespace Slic3r::sla
 
 #endif // SLARASTERBASE_HPP
@@ -1329,8 +1329,7 @@ struct SupportAnnotations
         buildplate_covered(buildplate_covered)
     {
         // Append custom supports.
-        object.project_and_append_custom_facets(false, EnforcerBlockerType::ENFORCER, enforcers_layers);
-        object.project_and_append_custom_facets(false, EnforcerBlockerType::BLOCKER, blockers_layers);
+        object.project_and_append_custom_supports(enforcers_layers, blockers_layers);
 
         // Expand the blocker a bit. Custom blockers produce strips
         // spanning just the projection between the two slices.
@@ -970,8 +970,7 @@ void TreeSupport::detect_overhangs(bool check_support_necessity/* = false*/)
     auto enforcers = m_object->slice_support_enforcers();
     auto blockers  = m_object->slice_support_blockers();
     m_vertical_enforcer_points.clear();
-    m_object->project_and_append_custom_facets(false, EnforcerBlockerType::ENFORCER, enforcers, &m_vertical_enforcer_points);
-    m_object->project_and_append_custom_facets(false, EnforcerBlockerType::BLOCKER, blockers);
+    m_object->project_and_append_custom_supports(enforcers, blockers, &m_vertical_enforcer_points);
 
     if (is_auto(stype) && config_remove_small_overhangs) {
         // remove small overhangs
@@ -4,6 +4,9 @@
 #include <boost/container/small_vector.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #ifndef NDEBUG
 //    #define EXPENSIVE_DEBUG_CHECKS
 #endif // NDEBUG
@@ -1430,26 +1433,9 @@ void TriangleSelector::get_facets(std::vector<indexed_triangle_set>& facets_per_
 {
     facets_per_type.clear();
 
-    for (int type = (int)EnforcerBlockerType::NONE; type <= (int)EnforcerBlockerType::ExtruderMax; type++) {
-        facets_per_type.emplace_back();
-        indexed_triangle_set& its = facets_per_type.back();
-        std::vector<int> vertex_map(m_vertices.size(), -1);
-
-        for (const Triangle& tr : m_triangles) {
-            if (tr.valid() && !tr.is_split() && tr.get_state() == (EnforcerBlockerType)type) {
-                stl_triangle_vertex_indices indices;
-                for (int i = 0; i < 3; ++i) {
-                    int j = tr.verts_idxs[i];
-                    if (vertex_map[j] == -1) {
-                        vertex_map[j] = int(its.vertices.size());
-                        its.vertices.emplace_back(m_vertices[j].v);
-                    }
-                    indices[i] = vertex_map[j];
-                }
-                its.indices.emplace_back(indices);
-            }
-        }
-    }
+    const FacetsPerState facets = this->get_facets_per_state(false);
+    for (int type = (int)EnforcerBlockerType::NONE; type <= (int)EnforcerBlockerType::ExtruderMax; type++)
+        facets_per_type.emplace_back(facets.facets(EnforcerBlockerType(type)));
 }
 
 indexed_triangle_set TriangleSelector::get_facets_strict(EnforcerBlockerType state) const
@@ -1494,6 +1480,100 @@ void TriangleSelector::get_facets_strict_recursive(
         this->get_facets_split_by_tjoints({tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]}, neighbors, out_triangles);
 }
 
+void TriangleSelector::get_facets_per_state_recursive(
+    const Triangle                                        &tr,
+    const Vec3i32                                         &neighbors,
+    std::vector<std::vector<stl_triangle_vertex_indices>> &out_triangles_per_state) const
+{
+    if (tr.is_split()) {
+        for (int i = 0; i <= tr.number_of_split_sides(); ++ i)
+            this->get_facets_per_state_recursive(
+                m_triangles[tr.children[i]],
+                this->child_neighbors(tr, neighbors, i),
+                out_triangles_per_state);
+    } else
+        this->get_facets_split_by_tjoints({tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]}, neighbors, out_triangles_per_state[size_t(tr.get_state())]);
+}
+
+TriangleSelector::FacetsPerState TriangleSelector::get_facets_per_state(bool strict) const
+{
+    static constexpr const size_t num_states = size_t(EnforcerBlockerType::ExtruderMax) + 1;
+
+    // Leaf triangles bucketed by state, per chunk of the original triangles. The chunks are traversed in parallel
+    // and concatenated in order, thus the output does not depend on the number of threads.
+    static constexpr const size_t chunk_size = 4096;
+    const size_t num_triangles = strict ? size_t(m_orig_size_indices) : m_triangles.size();
+    const size_t num_chunks    = std::max<size_t>(1, (num_triangles + chunk_size - 1) / chunk_size);
+    std::vector<std::vector<std::vector<stl_triangle_vertex_indices>>> chunks(num_chunks, std::vector<std::vector<stl_triangle_vertex_indices>>(num_states));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks), [this, strict, num_triangles, &chunks](const tbb::blocked_range<size_t> &range) {
+        for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx) {
+            std::vector<std::vector<stl_triangle_vertex_indices>> &out = chunks[chunk_idx];
+            for (size_t itriangle = chunk_idx * chunk_size; itriangle < std::min(num_triangles, (chunk_idx + 1) * chunk_size); ++ itriangle)
+                if (strict)
+                    this->get_facets_per_state_recursive(m_triangles[itriangle], m_neighbors[itriangle], out);
+                else if (const Triangle &tr = m_triangles[itriangle]; tr.valid() && ! tr.is_split())
+                    out[size_t(tr.get_state())].emplace_back(tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]);
+        }
+    }); // end of parallel_for
+
+    FacetsPerState out;
+    out.first_triangle.assign(num_states + 1, 0);
+    for (size_t state = 0; state < num_states; ++ state) {
+        size_t num_facets = 0;
+        for (const std::vector<std::vector<stl_triangle_vertex_indices>> &chunk : chunks)
+            num_facets += chunk[state].size();
+        out.first_triangle[state + 1] = out.first_triangle[state] + num_facets;
+    }
+    out.indices.reserve(out.first_triangle.back());
+    for (size_t state = 0; state < num_states; ++ state)
+        for (const std::vector<std::vector<stl_triangle_vertex_indices>> &chunk : chunks)
+            out.indices.insert(out.indices.end(), chunk[state].begin(), chunk[state].end());
+
+    // Compact the vertices referenced by the facets.
+    std::vector<int> vertex_map(m_vertices.size(), -1);
+    for (stl_triangle_vertex_indices &triangle : out.indices)
+        for (int i = 0; i < 3; ++ i) {
+            int &j = vertex_map[triangle(i)];
+            if (j == -1) {
+                j = int(out.vertices.size());
+                out.vertices.emplace_back(m_vertices[triangle(i)].v);
+            }
+            triangle(i) = j;
+        }
+    return out;
+}
+
+size_t TriangleSelector::FacetsPerState::num_facets(EnforcerBlockerType state) const
+{
+    const size_t idx = size_t(state);
+    return idx + 1 < this->first_triangle.size() ? this->first_triangle[idx + 1] - this->first_triangle[idx] : 0;
+}
+
+indexed_triangle_set TriangleSelector::FacetsPerState::facets(EnforcerBlockerType state) const
+{
+    indexed_triangle_set out;
+    if (this->num_facets(state) == 0)
+        return out;
+
+    const auto begin = this->indices.begin() + this->first_triangle[size_t(state)];
+    const auto end   = this->indices.begin() + this->first_triangle[size_t(state) + 1];
+    out.indices.reserve(end - begin);
+    std::vector<int> vertex_map(this->vertices.size(), -1);
+    for (auto it = begin; it != end; ++ it) {
+        stl_triangle_vertex_indices indices;
+        for (int i = 0; i < 3; ++ i) {
+            int &j = vertex_map[(*it)(i)];
+            if (j == -1) {
+                j = int(out.vertices.size());
+                out.vertices.emplace_back(this->vertices[(*it)(i)]);
+            }
+            indices(i) = j;
+        }
+        out.indices.emplace_back(indices);
+    }
+    return out;
+}
+
 void TriangleSelector::get_facets_split_by_tjoints(const Vec3i32 &vertices, const Vec3i32 &neighbors, std::vector<stl_triangle_vertex_indices> &out_triangles) const
 {
 // Export this triangle, but first collect the T-joint vertices along its edges.
@@ -333,6 +333,21 @@ public:
     // BBS
     void get_facets(std::vector<indexed_triangle_set>& facets_per_type) const;
 
+    // Facets of all the states, extracted by a single traversal of the division trees.
+    // The facets are bucketed by state: the triangles of state s are indices[first_triangle[s], first_triangle[s + 1]),
+    // all the states reference the shared vertices.
+    struct FacetsPerState {
+        std::vector<Vec3f>                       vertices;
+        std::vector<stl_triangle_vertex_indices> indices;
+        std::vector<size_t>                      first_triangle;
+
+        size_t               num_facets(EnforcerBlockerType state) const;
+        // Facets of a single state, only the vertices referenced by the state are copied.
+        indexed_triangle_set facets(EnforcerBlockerType state) const;
+    };
+    // Get facets at all the states. Triangulate T-joints if strict, the same as get_facets_strict() does.
+    FacetsPerState get_facets_per_state(bool strict) const;
+
     // Set facet of the mesh to a given state. Only works for original triangles.
     void set_facet(int facet_idx, EnforcerBlockerType state);
 
@@ -498,6 +513,10 @@ private:
         EnforcerBlockerType                          state,
         std::vector<stl_triangle_vertex_indices>    &out_triangles) const;
     void get_facets_split_by_tjoints(const Vec3i32 &vertices, const Vec3i32 &neighbors, std::vector<stl_triangle_vertex_indices> &out_triangles) const;
+    void get_facets_per_state_recursive(
+        const Triangle                                        &tr,
+        const Vec3i32                                         &neighbors,
+        std::vector<std::vector<stl_triangle_vertex_indices>> &out_triangles_per_state) const;
 
     void get_seed_fill_contour_recursive(int facet_idx, const Vec3i32 &neighbors, const Vec3i32 &neighbors_propagated, std::vector<Vec2i32> &edges_out) const;
 
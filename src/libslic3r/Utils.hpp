@@ -68,6 +68,7 @@
 
 #define CLI_SLICING_ERROR                  -100
 #define CLI_GCODE_PATH_CONFLICTS           -101
+#define CLI_SLICING_CANCELED               -102
 
 
 namespace boost { namespace filesystem { class directory_entry; }}
@@ -93,12 +93,18 @@ void Zipper::add_entry(const std::string &name)
 }
 
 void Zipper::add_entry(const std::string &name, const void *data, size_t l)
+{
+    add_entry(name, data, l, m_compression);
+}
+
+void Zipper::add_entry(const std::string &name, const void *data, size_t l,
+                       e_compression compression)
 {
     if(!m_impl->is_alive()) return;
 
     finish_entry();
     mz_uint cmpr = MZ_NO_COMPRESSION;
-    switch (m_compression) {
+    switch (compression) {
     case NO_COMPRESSION: cmpr = MZ_NO_COMPRESSION; break;
     case FAST_COMPRESSION: cmpr = MZ_BEST_SPEED; break;
     case TIGHT_COMPRESSION: cmpr = MZ_BEST_COMPRESSION; break;
@@ -51,6 +51,12 @@ public:
     /// This method throws exactly like finish_entry() does.
     void add_entry(const std::string& name, const void* data, size_t bytes);
 
+    /// Same as above but with an explicit compression level for this entry
+    /// only. Use NO_COMPRESSION for data which is already compressed (e.g.
+    /// PNG images), deflating it again only costs time.
+    void add_entry(const std::string& name, const void* data, size_t bytes,
+                   e_compression compression);
+
     // Writing data to the archive works like with standard streams. The target
     // within the zip file is the entry created with the add_entry method.
 
@@ -798,8 +798,10 @@ void BackgroundSlicingProcess::finalize_gcode()
 	// is calculated for the unprocessed G-code and it references lines in the memory mapped G-code file by line numbers.
 	// export_path may be changed by the post-processing script as well if the post processing script decides so, see GH #6042.
 	bool post_processed = run_post_process_scripts(output_path, true, "File", export_path, m_fff_print->full_print_config());
-	auto remove_post_processed_temp_file = [post_processed, &output_path]() {
-		if (post_processed)
+	// Converted before copying, so that the binary G-code is verified after it is copied. A post processed temp file is converted in place.
+	bool converted = gcode_convert_to_binary(output_path, !post_processed, export_path, m_fff_print->full_print_config(), m_fff_print->print_statistics().config());
+	auto remove_post_processed_temp_file = [post_processed, converted, &output_path]() {
+		if (post_processed || converted)
 			try {
 				boost::filesystem::remove(output_path);
 			} catch (const std::exception &ex) {
@@ -855,6 +857,17 @@ void BackgroundSlicingProcess::export_gcode()
 	// Perform the final post-processing of the export path by applying the print statistics over the file name.
 	std::string export_path = m_fff_print->print_statistics().finalize_output_path(m_export_path);
 	std::string output_path = m_temp_output_path;
+	// Converted into a copy of the temporary G-code, which is memory mapped by the G-code viewer, before copying,
+	// so that the binary G-code is verified after it is copied. The line numbers are added before the conversion.
+	const bool converted = gcode_convert_to_binary(output_path, true, export_path, m_fff_print->full_print_config(), m_fff_print->print_statistics().config(), true);
+	auto remove_converted_temp_file = [converted, &output_path]() {
+		if (converted)
+			try {
+				boost::filesystem::remove(output_path);
+			} catch (const std::exception &ex) {
+				BOOST_LOG_TRIVIAL(error) << "Failed to remove temp file " << output_path << ": " << ex.what();
+			}
+	};
 
 	//FIXME localize the messages
 	std::string error_message;
@@ -862,9 +875,11 @@ void BackgroundSlicingProcess::export_gcode()
 	try
 	{
 		copy_ret_val = copy_file(output_path, export_path, error_message, m_export_path_on_removable_media);
+		remove_converted_temp_file();
 	}
 	catch (...)
 	{
+		remove_converted_temp_file();
 		throw Slic3r::ExportError(_utf8(L("Unknown error when export G-code.")));
 	}
 	switch (copy_ret_val) {
@@ -891,15 +906,15 @@ void BackgroundSlicingProcess::export_gcode()
 		break;
 	}
 
-	// BBS
+	// BBS: to be checked. Whether use export_path or output_path.
+	if (! converted)
+		gcode_add_line_number(export_path, m_fff_print->full_print_config());
+
+	// BBS: the exported file is final now.
 	auto evt = new wxCommandEvent(m_event_export_finished_id, GUI::wxGetApp().mainframe->m_plater->GetId());
 	wxString output_gcode_str = wxString::FromUTF8(export_path.c_str(), export_path.length());
 	evt->SetString(output_gcode_str);
 	wxQueueEvent(GUI::wxGetApp().mainframe->m_plater, evt);
-
-	// BBS: to be checked. Whether use export_path or output_path.
-	gcode_add_line_number(export_path, m_fff_print->full_print_config());
-
 }
 
 // A print host upload job has been scheduled, enqueue it to the printhost job queue
@@ -930,6 +945,11 @@ void BackgroundSlicingProcess::prepare_upload()
                                              m_fff_print->full_print_config()))
 			    m_upload_job.upload_data.upload_path = output_name_str;
 			}
+			// The source is a private copy of the temporary G-code, convert it in place.
+			std::string source_path_str = source_path.string();
+			std::string output_name_str = m_upload_job.upload_data.upload_path.string();
+			if (gcode_convert_to_binary(source_path_str, false, output_name_str, m_fff_print->full_print_config(), m_fff_print->print_statistics().config()))
+				m_upload_job.upload_data.upload_path = output_name_str;
 		}
     } else {
         m_upload_job.upload_data.upload_path = m_sla_print->print_statistics().finalize_output_path(m_upload_job.upload_data.upload_path.string());
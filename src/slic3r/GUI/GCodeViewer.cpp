@@ -11,6 +11,8 @@
 #include "libslic3r/PresetBundle.hpp"
 //BBS: add convex hull logic for toolpath check
 #include "libslic3r/Geometry/ConvexHull.hpp"
+#include "libslic3r/GCode/BinaryGCode.hpp"
+#include "libslic3r/GCode/ToolpathGeometry.hpp"
 
 #include "GUI_App.hpp"
 #include "MainFrame.hpp"
@@ -218,6 +220,57 @@ void GCodeViewer::TBuffer::reset()
     model.reset();
 }
 
+void GCodeViewer::ReusableVBuffers::detach(std::vector<TBuffer>& buffers, const std::vector<GCodeProcessorResult::LayerHash>& new_layer_hashes)
+{
+    release();
+    vbos.assign(buffers.size(), std::vector<unsigned int>());
+    sizes.assign(buffers.size(), std::vector<size_t>());
+    const size_t common_moves = GCodeProcessorResult::common_moves_prefix(layer_hashes, new_layer_hashes);
+    if (common_moves == 0 || first_moves.size() != buffers.size())
+        return;
+
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        VBuffer& vertices = buffers[i].vertices;
+        // a vertex buffer is reused if the next one was started by a common move as well,
+        // the smoothing of the corners of the toolpaths looks one move ahead
+        size_t count = 0;
+        while (count + 1 < first_moves[i].size() && first_moves[i][count + 1] + 1 < common_moves)
+            ++count;
+        count = std::min(count, std::min(vertices.vbos.size(), vertices.sizes.size()));
+        vbos[i].assign(vertices.vbos.begin(), vertices.vbos.begin() + count);
+        sizes[i].assign(vertices.sizes.begin(), vertices.sizes.begin() + count);
+        vertices.vbos.erase(vertices.vbos.begin(), vertices.vbos.begin() + count);
+        vertices.sizes.erase(vertices.sizes.begin(), vertices.sizes.begin() + count);
+    }
+}
+
+void GCodeViewer::ReusableVBuffers::release(size_t buffer_id)
+{
+    if (buffer_id >= vbos.size())
+        return;
+
+    for (unsigned int id : vbos[buffer_id]) {
+        // release gpu memory
+        if (id > 0)
+            glsafe(::glDeleteBuffers(1, &id));
+    }
+    vbos[buffer_id].clear();
+    sizes[buffer_id].clear();
+}
+
+void GCodeViewer::ReusableVBuffers::release()
+{
+    for (std::vector<unsigned int>& buffer_vbos : vbos) {
+        for (unsigned int id : buffer_vbos) {
+            // release gpu memory
+            if (id > 0)
+                glsafe(::glDeleteBuffers(1, &id));
+        }
+    }
+    vbos.clear();
+    sizes.clear();
+}
+
 void GCodeViewer::TBuffer::add_path(const GCodeProcessorResult::MoveVertex& move, unsigned int b_id, size_t i_id, size_t s_id)
 {
     Path::Endpoint endpoint = { b_id, i_id, s_id, move.position };
@@ -492,6 +545,13 @@ void GCodeViewer::SequentialView::GCodeWindow::load_gcode(const std::string& fil
     m_selected_line_id = 0;
     m_last_lines_size = 0;
 
+    // lines_ends index the ASCII G-code, the binary G-code cannot be mapped.
+    if (BinaryGCode::is_binary_gcode_file(m_filename)) {
+        BOOST_LOG_TRIVIAL(info) << "Binary G-code " << m_filename << ". Cannot show G-code window.";
+        reset();
+        return;
+    }
+
     try
     {
         m_file.open(boost::filesystem::path(m_filename));
@@ -942,6 +1002,11 @@ void GCodeViewer::load(const GCodeProcessorResult& gcode_result, const Print& pr
     //BBS: add logs
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": gcode result %1%, new id %2%, gcode file %3% ") % (&gcode_result) % m_last_result_id % gcode_result.filename;
 
+    //BBS: keep the vertex buffers of the leading layers not changed since the previous load, they are reused by load_toolpaths()
+    gcode_result.lock();
+    m_reusable_vbuffers.detach(m_buffers, gcode_result.layer_hashes);
+    gcode_result.unlock();
+
     // release gpu memory, if used
     reset();
 
@@ -951,6 +1016,7 @@ void GCodeViewer::load(const GCodeProcessorResult& gcode_result, const Print& pr
     if (gcode_result.moves.size() == 0) {
         //result cleaned before slicing ,should return here
         BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": gcode result reset before, return directly!");
+        m_reusable_vbuffers.release();
         gcode_result.unlock();
         return;
     }
@@ -970,6 +1036,7 @@ void GCodeViewer::load(const GCodeProcessorResult& gcode_result, const Print& pr
     m_max_print_height = gcode_result.printable_height;
 
     load_toolpaths(gcode_result, build_volume, exclude_bounding_box);
+    m_reusable_vbuffers.release();
 
     //BBS: add mutex for protection of gcode result
     if (m_layers.empty()) {
@@ -1129,7 +1196,7 @@ void GCodeViewer::refresh(const GCodeProcessorResult& gcode_result, const std::v
 
     // update ranges for coloring / legend
     m_extrusions.reset_ranges();
-    for (size_t i = 0; i < m_moves_count; ++i) {
+    for (size_t i = 0; i < gcode_result.moves.size(); ++i) {
         // skip first vertex
         if (i == 0)
             continue;
@@ -1210,6 +1277,9 @@ void GCodeViewer::reset()
     m_only_gcode_in_preview = false;
 
     m_moves_count = 0;
+    m_toolpath_moves = nullptr;
+    m_lod_moves = GCodeProcessorResult::MoveVertexStore();
+    m_reusable_vbuffers.invalidate();
     m_ssid_to_moveid_map.clear();
     m_ssid_to_moveid_map.shrink_to_fit();
     for (TBuffer& buffer : m_buffers) {
@@ -1785,15 +1855,16 @@ void GCodeViewer::update_layers_slider_mode()
 }
 
 void GCodeViewer::update_marker_curr_move() {
-    if ((int)m_last_result_id != -1) {
-        auto it = std::find_if(m_gcode_result->moves.begin(), m_gcode_result->moves.end(), [this](auto move) {
+    if ((int)m_last_result_id != -1 && m_toolpath_moves != nullptr) {
+        const std::vector<unsigned int>& gcode_ids = m_toolpath_moves->gcode_id;
+        auto it = std::find_if(gcode_ids.begin(), gcode_ids.end(), [this](unsigned int gcode_id) {
                 if (m_sequential_view.current.last < m_sequential_view.gcode_ids.size() && m_sequential_view.current.last >= 0) {
-                    return move.gcode_id == static_cast<uint64_t>(m_sequential_view.gcode_ids[m_sequential_view.current.last]);
+                    return gcode_id == static_cast<uint64_t>(m_sequential_view.gcode_ids[m_sequential_view.current.last]);
                 }
                 return false;
             });
-        if (it != m_gcode_result->moves.end())
-            m_sequential_view.marker.update_curr_move(*it);
+        if (it != gcode_ids.end())
+            m_sequential_view.marker.update_curr_move((*m_toolpath_moves)[it - gcode_ids.begin()]);
     }
 }
 
@@ -2016,7 +2087,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     // max index buffer size, in bytes
     static const size_t IBUFFER_THRESHOLD_BYTES = 64 * 1024 * 1024;
 
-    //BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(",build_volume center{%1%, %2%}, moves count %3%\n")%build_volume.bed_center().x() % build_volume.bed_center().y() %gcode_result.moves.size();
+    //BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(",build_volume center{%1%, %2%}, moves count %3%\n")%build_volume.bed_center().x() % build_volume.bed_center().y() %moves.size();
     auto log_memory_usage = [this](const std::string& label, const std::vector<MultiVertexBuffer>& vertices, const std::vector<MultiIndexBuffer>& indices) {
         int64_t vertices_size = 0;
         for (const MultiVertexBuffer& buffers : vertices) {
@@ -2035,26 +2106,6 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         log_memory_used(label, vertices_size + indices_size);
     };
 
-    // format data into the buffers to be rendered as lines
-    auto add_vertices_as_line = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, VertexBuffer& vertices) {
-        auto add_vertex = [&vertices](const Vec3f& position) {
-            // add position
-            vertices.push_back(position.x());
-            vertices.push_back(position.y());
-            vertices.push_back(position.z());
-        };
-        // x component of the normal to the current segment (the normal is parallel to the XY plane)
-        //BBS: Has modified a lot for this function to support arc move
-        size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
-        for (size_t i = 0; i < loop_num + 1; i++) {
-            const Vec3f &previous = (i == 0? prev.position : curr.interpolation_points[i-1]);
-            const Vec3f &current = (i == loop_num? curr.position : curr.interpolation_points[i]);
-            // add previous vertex
-            add_vertex(previous);
-            // add current vertex
-            add_vertex(current);
-        }
-    };
     //BBS: modify a lot to support arc travel
     auto add_indices_as_line = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer,
         size_t& vbuffer_size, unsigned int ibuffer_id, IndexBuffer& indices, size_t move_id) {
@@ -2076,60 +2127,24 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             last_path.sub_paths.back().last = { ibuffer_id, indices.size() - 1, move_id, curr.position };
     };
 
-    // format data into the buffers to be rendered as solid.
-    auto add_vertices_as_solid = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer, unsigned int vbuffer_id, VertexBuffer& vertices, size_t move_id) {
-        auto store_vertex = [](VertexBuffer& vertices, const Vec3f& position, const Vec3f& normal) {
-            // append position
-            vertices.push_back(position.x());
-            vertices.push_back(position.y());
-            vertices.push_back(position.z());
-            // append normal
-            vertices.push_back(normal.x());
-            vertices.push_back(normal.y());
-            vertices.push_back(normal.z());
-        };
-
+    // reserve room in the buffers for the vertices to be rendered as solid, the vertices are generated later by ToolpathGeometry.
+    auto add_vertices_as_solid = [this](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer, unsigned int vbuffer_id, VertexBuffer& vertices, size_t move_id, size_t i, std::vector<ToolpathGeometry::VertexJob>& jobs) {
         if (buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr)) {
             buffer.add_path(curr, vbuffer_id, vertices.size(), move_id - 1);
             buffer.paths.back().sub_paths.back().first.position = prev.position;
         }
 
         Path& last_path = buffer.paths.back();
-        //BBS: Has modified a lot for this function to support arc move
-        size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
-        for (size_t i = 0; i < loop_num + 1; i++) {
-            const Vec3f &prev_position = (i == 0? prev.position : curr.interpolation_points[i-1]);
-            const Vec3f &curr_position = (i == loop_num? curr.position : curr.interpolation_points[i]);
-
-            const Vec3f dir = (curr_position - prev_position).normalized();
-            const Vec3f right = Vec3f(dir.y(), -dir.x(), 0.0f).normalized();
-            const Vec3f left = -right;
-            const Vec3f up = right.cross(dir);
-            const Vec3f down = -up;
-            const float half_width = 0.5f * last_path.width;
-            const float half_height = 0.5f * last_path.height;
-            const Vec3f prev_pos = prev_position - half_height * up;
-            const Vec3f curr_pos = curr_position - half_height * up;
-            const Vec3f d_up = half_height * up;
-            const Vec3f d_down = -half_height * up;
-            const Vec3f d_right = half_width * right;
-            const Vec3f d_left = -half_width * right;
-
-            if ((last_path.vertices_count() == 1 || vertices.empty()) && i == 0) {
-                store_vertex(vertices, prev_pos + d_up, up);
-                store_vertex(vertices, prev_pos + d_right, right);
-                store_vertex(vertices, prev_pos + d_down, down);
-                store_vertex(vertices, prev_pos + d_left, left);
-            } else {
-                store_vertex(vertices, prev_pos + d_right, right);
-                store_vertex(vertices, prev_pos + d_left, left);
-            }
-
-            store_vertex(vertices, curr_pos + d_up, up);
-            store_vertex(vertices, curr_pos + d_right, right);
-            store_vertex(vertices, curr_pos + d_down, down);
-            store_vertex(vertices, curr_pos + d_left, left);
-        }
+        ToolpathGeometry::VertexJob job;
+        job.type          = ToolpathGeometry::VertexJob::EType::Solid;
+        job.first_segment = last_path.vertices_count() == 1 || vertices.empty();
+        job.move_id       = i;
+        job.width         = last_path.width;
+        job.height        = last_path.height;
+        job.buffer        = &vertices;
+        job.offset        = vertices.size();
+        vertices.resize(vertices.size() + ToolpathGeometry::solid_vertices_size(*m_toolpath_moves, i, job.first_segment));
+        jobs.emplace_back(job);
 
         last_path.sub_paths.back().last = { vbuffer_id, vertices.size(), move_id, curr.position };
     };
@@ -2329,14 +2344,30 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessorResult::MoveVertex);
+    m_statistics.results_size = gcode_result.moves.memsize();
     m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
-    m_moves_count = gcode_result.moves.size();
-    if (m_moves_count == 0)
+    if (gcode_result.moves.empty())
         return;
 
+    // Level of detail: huge prints are previewed from a simplified copy of the moves, all the move ids of the preview
+    // (sequential view, layers, G-code ids) refer to the simplified copy then.
+    const size_t layers_count = gcode_result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].layers_times.size();
+    const ToolpathGeometry::LODParams lod = ToolpathGeometry::select_lod(gcode_result.moves.size(), layers_count, wxGetApp().plater()->get_camera().get_zoom());
+    std::vector<size_t> lod_kept_ids;
+    if (lod.enabled()) {
+        m_lod_moves = ToolpathGeometry::simplify(gcode_result.moves, lod, &lod_kept_ids);
+        m_toolpath_moves = &m_lod_moves;
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": level of detail reduced the moves from %1% to %2%") % gcode_result.moves.size() % m_lod_moves.size();
+        // the vertex buffers of the previous load were not built from the simplified moves
+        m_reusable_vbuffers.release();
+    } else
+        m_toolpath_moves = &gcode_result.moves;
+    const GCodeProcessorResult::MoveVertexStore& moves = *m_toolpath_moves;
+
+    m_moves_count = moves.size();
+
     m_extruders_count = gcode_result.extruders_count;
 
     unsigned int progress_count = 0;
@@ -2353,37 +2384,41 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
     // extract approximate paths bounding box from result
     //BBS: add only gcode mode
-    for (const GCodeProcessorResult::MoveVertex& move : gcode_result.moves) {
+    // Only the columns of the moves needed for the bounding box are read, from all the moves, not only the ones kept by the level of detail.
+    const GCodeProcessorResult::MoveVertexStore& all_moves = gcode_result.moves;
+    for (size_t i = 0; i < all_moves.size(); ++i) {
         //if (wxGetApp().is_gcode_viewer()) {
         //if (m_only_gcode_in_preview) {
             // for the gcode viewer we need to take in account all moves to correctly size the printbed
-        //    m_paths_bounding_box.merge(move.position.cast<double>());
+        //    m_paths_bounding_box.merge(all_moves.position[i].cast<double>());
         //}
         //else {
-            if (move.type == EMoveType::Extrude && move.extrusion_role != erCustom && move.width != 0.0f && move.height != 0.0f) {
-                m_paths_bounding_box.merge(move.position.cast<double>());
+            if (all_moves.type[i] == EMoveType::Extrude && all_moves.extrusion_role[i] != erCustom && all_moves.width[i] != 0.0f && all_moves.height[i] != 0.0f) {
+                m_paths_bounding_box.merge(all_moves.position[i].cast<double>());
                 //BBS: use convex_hull for toolpath outside check
-                pts.emplace_back(Point(scale_(move.position.x()), scale_(move.position.y())));
+                pts.emplace_back(Point(scale_(all_moves.position[i].x()), scale_(all_moves.position[i].y())));
             }
         //}
     }
 
     // BBS: also merge the point on arc to bounding box
-    for (const GCodeProcessorResult::MoveVertex& move : gcode_result.moves) {
+    for (size_t move_id = 0; move_id < all_moves.size(); ++move_id) {
         // continue if not arc path
-        if (!move.is_arc_move_with_interpolation_points())
+        if (all_moves.interpolation_points_count[move_id] == 0 ||
+            (all_moves.move_path_type[move_id] != EMovePathType::Arc_move_ccw && all_moves.move_path_type[move_id] != EMovePathType::Arc_move_cw))
             continue;
 
+        const GCodeProcessorResult::PointsView interpolation_points = all_moves.interpolation_points(move_id);
         //if (wxGetApp().is_gcode_viewer())
         //if (m_only_gcode_in_preview)
-        //    for (int i = 0; i < move.interpolation_points.size(); i++)
-        //        m_paths_bounding_box.merge(move.interpolation_points[i].cast<double>());
+        //    for (int i = 0; i < interpolation_points.size(); i++)
+        //        m_paths_bounding_box.merge(interpolation_points[i].cast<double>());
         //else {
-            if (move.type == EMoveType::Extrude && move.width != 0.0f && move.height != 0.0f)
-                for (int i = 0; i < move.interpolation_points.size(); i++) {
-                    m_paths_bounding_box.merge(move.interpolation_points[i].cast<double>());
+            if (all_moves.type[move_id] == EMoveType::Extrude && all_moves.width[move_id] != 0.0f && all_moves.height[move_id] != 0.0f)
+                for (int i = 0; i < interpolation_points.size(); i++) {
+                    m_paths_bounding_box.merge(interpolation_points[i].cast<double>());
                     //BBS: use convex_hull for toolpath outside check
-                    pts.emplace_back(Point(scale_(move.interpolation_points[i].x()), scale_(move.interpolation_points[i].y())));
+                    pts.emplace_back(Point(scale_(interpolation_points[i].x()), scale_(interpolation_points[i].y())));
                 }
         //}
     }
@@ -2422,14 +2457,18 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     }
 
     m_sequential_view.gcode_ids.clear();
-    for (size_t i = 0; i < gcode_result.moves.size(); ++i) {
-        const GCodeProcessorResult::MoveVertex& move = gcode_result.moves[i];
-        if (move.type != EMoveType::Seam)
-            m_sequential_view.gcode_ids.push_back(move.gcode_id);
+    for (size_t i = 0; i < moves.size(); ++i) {
+        if (moves.type[i] != EMoveType::Seam)
+            m_sequential_view.gcode_ids.push_back(moves.gcode_id[i]);
     }
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(",m_contained_in_bed %1%\n")%m_contained_in_bed;
 
     std::vector<MultiVertexBuffer> vertices(m_buffers.size());
+    // index of the first move written into each vertex buffer
+    std::vector<std::vector<size_t>> vertices_first_moves(m_buffers.size());
+    // vertex jobs not run as their vertex buffer reuses a vbo, with the index of the vertex buffer,
+    // run after all if the vertex buffer does not match the size of the vbo
+    std::vector<std::vector<std::pair<size_t, ToolpathGeometry::VertexJob>>> reused_vertex_jobs(m_buffers.size());
     std::vector<MultiIndexBuffer> indices(m_buffers.size());
     std::vector<InstanceBuffer> instances(m_buffers.size());
     std::vector<InstanceIdBuffer> instances_ids(m_buffers.size());
@@ -2439,9 +2478,20 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     size_t seams_count = 0;
     std::vector<size_t> biased_seams_ids;
 
+    // The layout of the vertex buffers is decided serially here, the line and solid vertices are generated
+    // in parallel in batches of vertex_jobs. A batch is flushed before a vertex buffer is added to a non empty multibuffer,
+    // as adding a vertex buffer may move the vertex buffers referenced by the jobs.
+    static const size_t vertex_jobs_batch_size = 256 * 1024;
+    std::vector<ToolpathGeometry::VertexJob> vertex_jobs;
+    vertex_jobs.reserve(std::min<size_t>(m_moves_count, vertex_jobs_batch_size));
+    auto flush_vertex_jobs = [&moves, &vertex_jobs]() {
+        ToolpathGeometry::generate_vertices(moves, vertex_jobs);
+        vertex_jobs.clear();
+    };
+
     // toolpaths data -> extract vertices from result
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+        const GCodeProcessorResult::MoveVertex& curr = moves[i];
         if (curr.type == EMoveType::Seam) {
             ++seams_count;
             biased_seams_ids.push_back(i - biased_seams_ids.size() - 1);
@@ -2453,7 +2503,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
+        const GCodeProcessorResult::MoveVertex& prev = moves[i - 1];
 
         // update progress dialog
         ++progress_count;
@@ -2477,8 +2527,10 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         }*/
 
         // ensure there is at least one vertex buffer
-        if (v_multibuffer.empty())
+        if (v_multibuffer.empty()) {
             v_multibuffer.push_back(VertexBuffer());
+            vertices_first_moves[id].push_back(i);
+        }
 
         // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
         // add another vertex buffer
@@ -2486,7 +2538,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         size_t points_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() + 1 : 1;
         size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : points_num * t_buffer.max_vertices_per_segment_size_bytes();
         if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
+            flush_vertex_jobs();
             v_multibuffer.push_back(VertexBuffer());
+            vertices_first_moves[id].push_back(i);
             if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
                 Path& last_path = t_buffer.paths.back();
                 if (prev.type == curr.type && last_path.matches(curr))
@@ -2495,11 +2549,22 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         }
 
         VertexBuffer& v_buffer = v_multibuffer.back();
+        const size_t vertex_jobs_count = vertex_jobs.size();
 
         switch (t_buffer.render_primitive_type)
         {
-        case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(prev, curr, v_buffer); break; }
-        case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, move_id); break; }
+        case TBuffer::ERenderPrimitiveType::Line:
+        {
+            ToolpathGeometry::VertexJob job;
+            job.type    = ToolpathGeometry::VertexJob::EType::Line;
+            job.move_id = i;
+            job.buffer  = &v_buffer;
+            job.offset  = v_buffer.size();
+            v_buffer.resize(v_buffer.size() + ToolpathGeometry::line_vertices_size(moves, i));
+            vertex_jobs.emplace_back(job);
+            break;
+        }
+        case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, move_id, i, vertex_jobs); break; }
         case TBuffer::ERenderPrimitiveType::InstancedModel:
         {
             add_model_instance(curr, inst_buffer, inst_id_buffer, move_id);
@@ -2520,14 +2585,44 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         }
         }
 
+        // the vertices of a reused vbo are not generated, but for the last one, which is read while smoothing the corners
+        // of the toolpaths continuing into the next vertex buffer
+        if (v_multibuffer.size() < m_reusable_vbuffers.reused_count(id)) {
+            for (size_t j = vertex_jobs_count; j < vertex_jobs.size(); ++j)
+                reused_vertex_jobs[id].emplace_back(v_multibuffer.size() - 1, vertex_jobs[j]);
+            vertex_jobs.resize(vertex_jobs_count);
+        }
+
         // collect options zs for later use
         if (curr.type == EMoveType::Pause_Print || curr.type == EMoveType::Custom_GCode) {
             const float* const last_z = options_zs.empty() ? nullptr : &options_zs.back();
             if (last_z == nullptr || curr.position[2] < *last_z - EPSILON || *last_z + EPSILON < curr.position[2])
                 options_zs.emplace_back(curr.position[2]);
         }
+
+        if (vertex_jobs.size() >= vertex_jobs_batch_size)
+            flush_vertex_jobs();
     }
 
+    // the vbos are reused only if the vertex buffers got the same sizes as in the previous load,
+    // otherwise all the vertex buffers of the TBuffer are generated and uploaded again
+    for (size_t i = 0; i < m_buffers.size(); ++i) {
+        const size_t reused_count = m_reusable_vbuffers.reused_count(i);
+        bool sizes_match = vertices[i].size() >= reused_count;
+        for (size_t j = 0; sizes_match && j < reused_count; ++j)
+            sizes_match = m_reusable_vbuffers.sizes[i][j] == vertices[i][j].size() * sizeof(float);
+        if (!sizes_match) {
+            BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": vertex buffers of toolpaths %1% do not match the previous load, uploading them again") % i;
+            m_reusable_vbuffers.release(i);
+            for (auto& [vbuffer_id, job] : reused_vertex_jobs[i]) {
+                job.buffer = &vertices[i][vbuffer_id];
+                vertex_jobs.emplace_back(job);
+            }
+        }
+    }
+    std::vector<std::vector<std::pair<size_t, ToolpathGeometry::VertexJob>>>().swap(reused_vertex_jobs);
+    flush_vertex_jobs();
+
     /*for (size_t b = 0; b < vertices.size(); ++b) {
         MultiVertexBuffer& v_multibuffer = vertices[b];
         BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":b=%1%, vertex buffer count %2%\n")
@@ -2553,7 +2648,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         m_ssid_to_moveid_map.push_back(extract_move_id(i));
 
     //BBS: smooth toolpaths corners for the given TBuffer using triangles
-    auto smooth_triangle_toolpaths_corners = [&gcode_result, this](const TBuffer& t_buffer, MultiVertexBuffer& v_multibuffer) {
+    auto smooth_triangle_toolpaths_corners = [&moves, this](const TBuffer& t_buffer, MultiVertexBuffer& v_multibuffer) {
         auto extract_position_at = [](const VertexBuffer& vertices, size_t offset) {
             return Vec3f(vertices[offset + 0], vertices[offset + 1], vertices[offset + 2]);
         };
@@ -2570,11 +2665,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 size_t temp_offset = prev_sub_path.last.s_id - curr_s_id;
                 for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--) {
                     size_t move_id = m_ssid_to_moveid_map[i];
-                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points.size() : 0);
+                    temp_offset += (moves.is_arc_move(move_id) ? moves.interpolation_points_count[move_id] : 0);
                 }
                 if (is_internal_point) {
                     size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                    temp_offset += (gcode_result.moves[move_id].interpolation_points.size() - interpolation_point_id);
+                    temp_offset += (moves.interpolation_points_count[move_id] - interpolation_point_id);
                 }
                 const size_t next_1st_offset = temp_offset * 6 * vertex_size_floats;
                 // offset into the vertex buffer of the right vertex of the previous segment
@@ -2612,11 +2707,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 size_t temp_offset = prev_sub_path.last.s_id - curr_s_id;
                 for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--) {
                     size_t move_id = m_ssid_to_moveid_map[i];
-                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points.size() : 0);
+                    temp_offset += (moves.is_arc_move(move_id) ? moves.interpolation_points_count[move_id] : 0);
                 }
                 if (is_internal_point) {
                     size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                    temp_offset += (gcode_result.moves[move_id].interpolation_points.size() - interpolation_point_id);
+                    temp_offset += (moves.interpolation_points_count[move_id] - interpolation_point_id);
                 }
                 const size_t next_1st_offset = temp_offset * 6 * vertex_size_floats;
                 // offset into the vertex buffer of the left vertex of the previous segment
@@ -2658,14 +2753,14 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             for (size_t j = 1; j < path_vertices_count; ++j) {
                 size_t curr_s_id = path.sub_paths.front().first.s_id + j;
                 size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                int interpolation_points_num = gcode_result.moves[move_id].is_arc_move_with_interpolation_points()?
-                                                    gcode_result.moves[move_id].interpolation_points.size() : 0;
+                int interpolation_points_num = moves.is_arc_move_with_interpolation_points(move_id)?
+                                                    moves.interpolation_points_count[move_id] : 0;
                 int loop_num = interpolation_points_num;
                 //BBS: select the subpaths which contains the previous/next segments
                 if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
                     ++prev_sub_path_id;
                 if (j == path_vertices_count - 1) {
-                    if (!gcode_result.moves[move_id].is_arc_move_with_interpolation_points())
+                    if (!moves.is_arc_move_with_interpolation_points(move_id))
                         break;   // BBS: the last move has no internal point.
                     loop_num--;  //BBS: don't need to handle the endpoint of the last arc move of path
                     next_sub_path_id = prev_sub_path_id;
@@ -2677,19 +2772,20 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 const Path::Sub_Path& next_sub_path = path.sub_paths[next_sub_path_id];
 
                 // BBS: smooth triangle toolpaths corners including arc move which has internal interpolation point
+                const GCodeProcessorResult::PointsView interpolation_points = moves.interpolation_points(move_id);
                 for (int k = 0; k <= loop_num; k++) {
                     const Vec3f& prev = k==0?
-                                        gcode_result.moves[move_id - 1].position :
-                                        gcode_result.moves[move_id].interpolation_points[k-1];
+                                        moves.position[move_id - 1] :
+                                        interpolation_points[k-1];
                     const Vec3f& curr = k==interpolation_points_num?
-                                        gcode_result.moves[move_id].position :
-                                        gcode_result.moves[move_id].interpolation_points[k];
+                                        moves.position[move_id] :
+                                        interpolation_points[k];
                     const Vec3f& next = k < interpolation_points_num - 1?
-                                        gcode_result.moves[move_id].interpolation_points[k+1]:
-                                        (k == interpolation_points_num - 1? gcode_result.moves[move_id].position :
-                                        (gcode_result.moves[move_id + 1].is_arc_move_with_interpolation_points()?
-                                        gcode_result.moves[move_id + 1].interpolation_points[0] :
-                                        gcode_result.moves[move_id + 1].position));
+                                        interpolation_points[k+1]:
+                                        (k == interpolation_points_num - 1? moves.position[move_id] :
+                                        (moves.is_arc_move_with_interpolation_points(move_id + 1)?
+                                        moves.interpolation_points(move_id + 1)[0] :
+                                        moves.position[move_id + 1]));
 
                     const Vec3f prev_dir = (curr - prev).normalized();
                     const Vec3f prev_right = Vec3f(prev_dir.y(), -prev_dir.x(), 0.0f).normalized();
@@ -2788,7 +2884,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 }
             }
             const MultiVertexBuffer& v_multibuffer = vertices[i];
-            for (const VertexBuffer& v_buffer : v_multibuffer) {
+            for (size_t j = 0; j < v_multibuffer.size(); ++j) {
+                const VertexBuffer& v_buffer = v_multibuffer[j];
                 const size_t size_elements = v_buffer.size();
                 const size_t size_bytes = size_elements * sizeof(float);
                 const size_t vertices_count = size_elements / t_buffer.vertices.vertex_size_floats();
@@ -2801,10 +2898,18 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
                 GLuint id = 0;
-                glsafe(::glGenBuffers(1, &id));
-                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, id));
-                glsafe(::glBufferData(GL_ARRAY_BUFFER, size_bytes, v_buffer.data(), GL_STATIC_DRAW));
-                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+                if (j < m_reusable_vbuffers.reused_count(i)) {
+                    // the vbo of the previous load contains the same vertices
+                    assert(m_reusable_vbuffers.sizes[i][j] == size_bytes);
+                    id = m_reusable_vbuffers.vbos[i][j];
+                    m_reusable_vbuffers.vbos[i][j] = 0;
+                }
+                else {
+                    glsafe(::glGenBuffers(1, &id));
+                    glsafe(::glBindBuffer(GL_ARRAY_BUFFER, id));
+                    glsafe(::glBufferData(GL_ARRAY_BUFFER, size_bytes, v_buffer.data(), GL_STATIC_DRAW));
+                    glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+                }
 
                 t_buffer.vertices.vbos.push_back(static_cast<unsigned int>(id));
                 t_buffer.vertices.sizes.push_back(size_bytes);
@@ -2818,6 +2923,13 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
     log_memory_usage("Loaded G-code generated vertex buffers ", vertices, indices);
 
+    // remember the layout of the vertex buffers for the next load
+    m_reusable_vbuffers.release();
+    if (!lod.enabled()) {
+        m_reusable_vbuffers.layer_hashes = gcode_result.layer_hashes;
+        m_reusable_vbuffers.first_moves = std::move(vertices_first_moves);
+    }
+
     // dismiss vertices data, no more needed
     std::vector<MultiVertexBuffer>().swap(vertices);
     std::vector<InstanceBuffer>().swap(instances);
@@ -2841,7 +2953,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     seams_count = 0;
 
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+        const GCodeProcessorResult::MoveVertex& curr = moves[i];
         if (curr.type == EMoveType::Seam)
             ++seams_count;
 
@@ -2851,10 +2963,14 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
+        const GCodeProcessorResult::MoveVertex& prev = moves[i - 1];
+        // The moves are stored in columns, the next move is assembled into a local copy.
+        GCodeProcessorResult::MoveVertex next_move;
         const GCodeProcessorResult::MoveVertex* next = nullptr;
-        if (i < m_moves_count - 1)
-            next = &gcode_result.moves[i + 1];
+        if (i < m_moves_count - 1) {
+            next_move = moves[i + 1];
+            next = &next_move;
+        }
 
         ++progress_count;
         if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
@@ -3004,7 +3120,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     size_t last_travel_s_id = 0;
     seams_count = 0;
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& move = gcode_result.moves[i];
+        const GCodeProcessorResult::MoveVertex& move = moves[i];
         if (move.type == EMoveType::Seam)
             ++seams_count;
 
@@ -3051,7 +3167,14 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     if (!gcode_result.spiral_vase_layers.empty()) {
         m_layers.reset();
         for (const auto& layer : gcode_result.spiral_vase_layers) {
-            m_layers.append(layer.first, { layer.second.first, layer.second.second });
+            if (lod_kept_ids.empty())
+                m_layers.append(layer.first, { layer.second.first, layer.second.second });
+            else {
+                // map the ids of the moves to the simplified moves
+                const size_t first = std::lower_bound(lod_kept_ids.begin(), lod_kept_ids.end(), layer.second.first) - lod_kept_ids.begin();
+                const size_t last  = std::upper_bound(lod_kept_ids.begin(), lod_kept_ids.end(), layer.second.second) - lod_kept_ids.begin();
+                m_layers.append(layer.first, { first, std::max(first, last > 0 ? last - 1 : 0) });
+            }
         }
     }
 
@@ -3404,9 +3527,8 @@ m_no_render_path = false;
                             if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Line) {
                                 for (size_t i = sub_path.first.s_id + 1; i < m_sequential_view.current.last + 1; i++) {
                                     size_t move_id = m_ssid_to_moveid_map[i];
-                                    const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
-                                    if (curr.is_arc_move()) {
-                                        offset += curr.interpolation_points.size();
+                                    if (m_toolpath_moves->is_arc_move(move_id)) {
+                                        offset += m_toolpath_moves->interpolation_points_count[move_id];
                                     }
                                 }
                                 offset = 2 * offset - 1;
@@ -3416,9 +3538,8 @@ m_no_render_path = false;
                                 // BBS: modify to support moves which has internal point
                                 for (size_t i = sub_path.first.s_id + 1; i < m_sequential_view.current.last + 1; i++) {
                                     size_t move_id = m_ssid_to_moveid_map[i];
-                                    const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
-                                    if (curr.is_arc_move()) {
-                                        offset += curr.interpolation_points.size();
+                                    if (m_toolpath_moves->is_arc_move(move_id)) {
+                                        offset += m_toolpath_moves->interpolation_points_count[move_id];
                                     }
                                 }
                                 offset = indices_count * (offset - 1) + (indices_count - 2);
@@ -3514,9 +3635,8 @@ m_no_render_path = false;
             unsigned int segments_count = max_s_id - min_s_id;
             for (size_t i = min_s_id + 1; i < max_s_id + 1; i++) {
                 size_t move_id = m_ssid_to_moveid_map[i];
-                const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
-                if (curr.is_arc_move()) {
-                    segments_count += curr.interpolation_points.size();
+                if (m_toolpath_moves->is_arc_move(move_id)) {
+                    segments_count += m_toolpath_moves->interpolation_points_count[move_id];
                 }
             }
             size_in_indices = buffer.indices_per_segment() * segments_count;
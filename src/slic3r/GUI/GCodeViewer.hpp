@@ -735,6 +735,31 @@ private:
     size_t m_moves_count{ 0 };
     //BBS: save m_gcode_result as well
     const GCodeProcessorResult* m_gcode_result;
+    // Moves the toolpaths are built from: m_gcode_result->moves, or their simplified copy m_lod_moves for huge prints.
+    const GCodeProcessorResult::MoveVertexStore* m_toolpath_moves{ nullptr };
+    GCodeProcessorResult::MoveVertexStore m_lod_moves;
+    // Vertex buffers of the previously loaded toolpaths. The next load reuses the vbos filled by the moves of the leading layers
+    // with unchanged content hashes only, as the layout of the vertex buffers is decided from the first move on.
+    struct ReusableVBuffers
+    {
+        std::vector<GCodeProcessorResult::LayerHash> layer_hashes;
+        // for each TBuffer, the index of the first move written into each of its vertex buffers
+        std::vector<std::vector<size_t>> first_moves;
+        // for each TBuffer, the vbos detached from it to be reused, with their sizes in bytes
+        std::vector<std::vector<unsigned int>> vbos;
+        std::vector<std::vector<size_t>> sizes;
+
+        // detach the reusable vbos from buffers before these are reset
+        void detach(std::vector<TBuffer>& buffers, const std::vector<GCodeProcessorResult::LayerHash>& new_layer_hashes);
+        // release the detached vbos not reused
+        void release();
+        // release the detached vbos of a single TBuffer, its vertex buffers are uploaded again
+        void release(size_t buffer_id);
+        // forget the previous load, the detached vbos are kept
+        void invalidate() { layer_hashes.clear(); first_moves.clear(); }
+        size_t reused_count(size_t buffer_id) const { return buffer_id < vbos.size() ? vbos[buffer_id].size() : 0; }
+    };
+    ReusableVBuffers m_reusable_vbuffers;
     //BBS: add only gcode mode
     bool m_only_gcode_in_preview {false};
     std::vector<size_t> m_ssid_to_moveid_map;
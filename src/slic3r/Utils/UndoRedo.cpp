@@ -22,6 +22,7 @@
 #include <libslic3r/Utils.hpp>
 
 #include "slic3r/GUI/3DScene.hpp"
+#include "UndoRedoDataPool.hpp"
 #include <boost/foreach.hpp>
 
 #ifndef NDEBUG
@@ -338,34 +339,15 @@ private:
 struct MutableHistoryInterval
 {
 private:
-	struct Data
-	{
-		// Reference counter of this data chunk. We may have used shared_ptr, but the shared_ptr is thread safe
-		// with the associated cost of CPU cache invalidation on refcount change.
-		size_t		refcnt;
-		size_t		size;
-		char 		data[1];
-
-		// The serialized data matches the data stored here.
-		bool 		matches(const std::string& rhs) { return this->size == rhs.size() && memcmp(this->data, rhs.data(), this->size) == 0; }
-
-		// The timestamp matches the timestamp serialized in the data stored here.
-		bool 		matches_timestamp(uint64_t timestamp) { assert(timestamp > 0);  assert(this->size > 8); return memcmp(this->data, &timestamp, 8) == 0; }
-	};
-
-	Interval    m_interval;
-	Data	   *m_data;
+	Interval     m_interval;
+	MutableData *m_data;
 
 public:
-	MutableHistoryInterval(const Interval &interval, const std::string &input_data) : m_interval(interval), m_data(nullptr) {
-		m_data = (Data*)new char[offsetof(Data, data) + input_data.size()];
-		m_data->refcnt = 1;
-		m_data->size = input_data.size();
-		memcpy(m_data->data, input_data.data(), input_data.size());
-	}
+	// Takes over the reference of data acquired from a MutableDataPool.
+	MutableHistoryInterval(const Interval &interval, MutableData *data) : m_interval(interval), m_data(data) {}
 
 	MutableHistoryInterval(const Interval &interval, MutableHistoryInterval &other) : m_interval(interval), m_data(other.m_data) {
-		++ m_data->refcnt;
+		m_data->pool->add_ref(m_data);
 	}
 
 	// as a key for std::lower_bound
@@ -375,8 +357,8 @@ public:
 	MutableHistoryInterval& operator=(MutableHistoryInterval&& rhs) { m_interval = rhs.m_interval; m_data = rhs.m_data; rhs.m_data = nullptr; return *this; }
 
 	~MutableHistoryInterval() {
-		if (m_data != nullptr && -- m_data->refcnt == 0)
-			delete[] (char*)m_data;
+		if (m_data != nullptr)
+			m_data->pool->release(m_data);
 	}
 
 	const Interval& interval() const { return m_interval; }
@@ -390,17 +372,21 @@ public:
 	bool		operator<(const MutableHistoryInterval& rhs) const { return m_interval < rhs.m_interval; }
 	bool 		operator==(const MutableHistoryInterval& rhs) const { return m_interval == rhs.m_interval; }
 
-	const char* data() const { return m_data->data; }
+	const MutableData* shared_data() const { return m_data; }
+	std::string load() const { return m_data->load(); }
 	size_t  	size() const { return m_data->size; }
 	size_t		refcnt() const { return m_data->refcnt; }
-	bool		matches(const std::string& data) { return m_data->matches(data); }
+	bool		matches(const std::string& data, size_t hash) { return m_data->matches(data, hash); }
 	bool		matches_timestamp(uint64_t timestamp) { return m_data->matches_timestamp(timestamp); }
 	size_t 		memsize() const {
-		return m_data->refcnt == 1 ?
+		// Data folded into data of the same content holds a single reference to the shared data.
+		const MutableData &shared = m_data->folded_into ? *m_data->folded_into : *m_data;
+		const size_t 	   refcnt = m_data->folded_into ? m_data->refcnt * shared.refcnt : m_data->refcnt;
+		return refcnt == 1 ?
 			// Count just the size of the snapshot data.
-			m_data->size :
+			shared.data.size() :
 			// Count the size of the snapshot data divided by the number of references, rounded up.
-			(m_data->size + m_data->refcnt - 1) / m_data->refcnt;
+			(shared.data.size() + refcnt - 1) / refcnt;
 	}
 
 private:
@@ -455,27 +441,38 @@ public:
 		return false;
 	}
 
-	void save(size_t active_snapshot_time, size_t current_time, const std::string &data) {
+	void save(MutableDataPool &pool, size_t active_snapshot_time, size_t current_time, const std::string &data) {
 		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
+		const size_t hash = MutableData::hash_of(data);
 		if (m_history.empty() || m_history.back().end() < active_snapshot_time) {
-			if (! m_history.empty() && m_history.back().matches(data))
+			if (! m_history.empty() && m_history.back().matches(data, hash))
 				// Share the previous data by reference counting.
 				m_history.emplace_back(Interval(current_time, current_time + 1), m_history.back());
 			else
-				// Allocate new data.
-				m_history.emplace_back(Interval(current_time, current_time + 1), data);
+				// Allocate new data or share the data of the same content.
+				m_history.emplace_back(Interval(current_time, current_time + 1), pool.acquire(data, hash));
 		} else {
 			assert(! m_history.empty());
 			assert(m_history.back().end() == active_snapshot_time);
-			if (m_history.back().matches(data))
+			if (m_history.back().matches(data, hash))
 				// Just extend the last interval using the old data.
 				m_history.back().extend_end(current_time + 1);
 			else
 				// Allocate new data time continuous with the previous data.
-				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
+				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), pool.acquire(data, hash));
 		}
 	}
 
+	// Save data being serialized in the background. Its timestamp did not match the last data, thus the data is considered different.
+	void save_pending(size_t active_snapshot_time, size_t current_time, MutableData *data) {
+		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
+		if (m_history.empty() || m_history.back().end() < active_snapshot_time)
+			m_history.emplace_back(Interval(current_time, current_time + 1), data);
+		else
+			// Allocate new data time continuous with the previous data.
+			m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
+	}
+
 	std::string load(size_t timestamp) const {
 		assert(! m_history.empty());
 		auto it = std::lower_bound(m_history.begin(), m_history.end(), MutableHistoryInterval(timestamp, timestamp));
@@ -485,7 +482,7 @@ public:
 				--it;
 		}
 		//assert(timestamp >= it->begin() && timestamp < it->end());
-		return std::string(it->data(), it->data() + it->size());
+		return it->load();
 	}
 
 	// Currently all mutable snapshots are mandatory.
@@ -497,7 +494,7 @@ public:
 	std::string format() override {
 		std::string out = typeid(T).name();
 		for (const MutableHistoryInterval &interval : m_history)
-			out += std::string(", ptr:") + ptr_to_string(interval.data()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
+			out += std::string(", ptr:") + ptr_to_string(interval.shared_data()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
 		return out;
 	}
 #endif /* SLIC3R_UNDOREDO_DEBUG */
@@ -527,16 +524,17 @@ bool MutableObjectHistory<T>::valid()
 {
 	// Verify that the history intervals are sorted and do not overlap, and that the data reference counters are correct.
 	if (! m_history.empty()) {
-		std::map<const char*, size_t> refcntrs;
-		assert(m_history.front().data() != nullptr);
-		++ refcntrs[m_history.front().data()];
+		std::map<const MutableData*, size_t> refcntrs;
+		assert(m_history.front().shared_data() != nullptr);
+		++ refcntrs[m_history.front().shared_data()];
 		for (size_t i = 1; i < m_history.size(); ++ i) {
 			assert(m_history[i - 1].interval().strictly_before(m_history[i].interval()));
-			++ refcntrs[m_history[i].data()];
+			++ refcntrs[m_history[i].shared_data()];
 		}
 		for (const auto &hi : m_history) {
-			assert(hi.data() != nullptr);
-			assert(refcntrs[hi.data()] == hi.refcnt());
+			assert(hi.shared_data() != nullptr);
+			// The data may be shared with the other objects as well.
+			assert(refcntrs[hi.shared_data()] <= hi.refcnt());
 		}
 	}
 	return true;
@@ -577,16 +575,17 @@ public:
 	}
 
     // Store the current application state onto the Undo / Redo stack, remove all snapshots after m_active_snapshot_time.
-	void take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection& selection, const Slic3r::GUI::GLGizmosManager& gizmos, const Slic3r::GUI::PartPlateList& plate_list, const SnapshotData& snapshot_data);
+	// Without the selection, the gizmos and the plates only the Model is stored, see Stack::take_snapshot().
+	void take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection* selection, const Slic3r::GUI::GLGizmosManager* gizmos, const Slic3r::GUI::PartPlateList* plate_list, const SnapshotData& snapshot_data);
     void take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection& selection, const Slic3r::GUI::GLGizmosManager& gizmos, const SnapshotData &snapshot_data);
     void reduce_noisy_snapshots(const std::string& new_name);
-    void load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos, Slic3r::GUI::PartPlateList& plate_list);
+    void load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GUI::GLGizmosManager* gizmos, Slic3r::GUI::PartPlateList* plate_list);
 
 	bool has_undo_snapshot() const;
 	bool has_undo_snapshot(size_t time_to_load) const;
 	bool has_redo_snapshot() const;
-    bool undo(Slic3r::Model &model, const Slic3r::GUI::Selection &selection, Slic3r::GUI::GLGizmosManager &gizmos, Slic3r::GUI::PartPlateList& plate_list, const SnapshotData &snapshot_data, size_t jump_to_time);
-    bool redo(Slic3r::Model &model, Slic3r::GUI::GLGizmosManager &gizmos, Slic3r::GUI::PartPlateList& plate_list, size_t jump_to_time);
+    bool undo(Slic3r::Model &model, const Slic3r::GUI::Selection *selection, Slic3r::GUI::GLGizmosManager *gizmos, Slic3r::GUI::PartPlateList* plate_list, const SnapshotData &snapshot_data, size_t jump_to_time);
+    bool redo(Slic3r::Model &model, Slic3r::GUI::GLGizmosManager *gizmos, Slic3r::GUI::PartPlateList* plate_list, size_t jump_to_time);
 	void release_least_recently_used();
 
 	// Snapshot history (names with timestamps).
@@ -679,6 +678,8 @@ private:
 	// Maximum memory allowed to be occupied by the Undo / Redo stack. If the limit is exceeded,
 	// least recently used snapshots will be released.
 	size_t 													m_memory_limit;
+	// Serialized data of the mutable objects, shared by their histories. Declared before m_objects to be destroyed after them.
+	MutableDataPool 										m_data_pool;
 	// Each individual object (Model, ModelObject, ModelInstance, ModelVolume, Selection, TriangleMesh)
 	// is stored with its own history, referenced by the ObjectID. Immutable objects do not provide
 	// their own IDs, therefore there are temporary IDs generated for them and stored to m_shared_ptr_to_object_id.
@@ -814,6 +815,11 @@ namespace cereal
 namespace Slic3r {
 namespace UndoRedo {
 
+// Mutable objects with a reliable timestamp, large serialized data and not referencing other objects tracked by the Undo / Redo stack.
+// These are copied by take_snapshot() and serialized in the background.
+template<typename T> struct serialize_in_background : std::false_type {};
+template<> struct serialize_in_background<FacetsAnnotation> : std::true_type {};
+
 template<typename T> std::shared_ptr<const T>& 	ImmutableObjectHistory<T>::shared_ptr(StackImpl &stack)
 {
 	if (m_shared_object.get() == nullptr && ! m_serialized.empty()) {
@@ -838,12 +844,26 @@ template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 		it_object_history = m_objects.insert(it_object_history, std::make_pair(object.id(), std::unique_ptr<MutableObjectHistory<T>>(new MutableObjectHistory<T>())));
 	auto *object_history = static_cast<MutableObjectHistory<T>*>(it_object_history->second.get());
 	bool  needs_to_save  = true;
-	{
-		// If the timestamp returned is non zero, then it is considered reliable.
-		// The caller is supposed to serialize the timestamp first.
-		uint64_t timestamp = object.timestamp();
-		if (timestamp > 0)
-			needs_to_save = ! object_history->try_save_timestamp(m_active_snapshot_time, m_current_time, timestamp);
+	// If the timestamp returned is non zero, then it is considered reliable.
+	// The caller is supposed to serialize the timestamp first.
+	uint64_t timestamp = object.timestamp();
+	if (timestamp > 0)
+		needs_to_save = ! object_history->try_save_timestamp(m_active_snapshot_time, m_current_time, timestamp);
+	if constexpr (serialize_in_background<T>::value) {
+		if (needs_to_save && timestamp > 0) {
+			// Copying is much cheaper than serializing, serialize the copy in the background.
+			std::shared_ptr<T> copy(new T(object));
+			MutableData *data = m_data_pool.acquire_pending(timestamp, [this, copy]() {
+				std::ostringstream oss;
+				{
+					Slic3r::UndoRedo::OutputArchive archive(*this, oss);
+					archive(*copy);
+				}
+				return oss.str();
+			});
+			object_history->save_pending(m_active_snapshot_time, m_current_time, data);
+			needs_to_save = false;
+		}
 	}
 	if (needs_to_save) {
 		// Serialize the object into a string.
@@ -852,7 +872,7 @@ template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 			Slic3r::UndoRedo::OutputArchive archive(*this, oss);
 			archive(object);
 		}
-		object_history->save(m_active_snapshot_time, m_current_time, oss.str());
+		object_history->save(m_data_pool, m_active_snapshot_time, m_current_time, oss.str());
 	}
 	return object.id();
 }
@@ -918,13 +938,13 @@ void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Mo
 {
 	Slic3r::GUI::PartPlateList& plate_list = GUI::wxGetApp().plater()->get_partplate_list();
 
-	take_snapshot(snapshot_name, model, selection, gizmos, plate_list, snapshot_data);
+	take_snapshot(snapshot_name, model, &selection, &gizmos, &plate_list, snapshot_data);
 
 	return;
 }
 
 // Store the current application state onto the Undo / Redo stack, remove all snapshots after m_active_snapshot_time.
-void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection& selection, const Slic3r::GUI::GLGizmosManager& gizmos, const Slic3r::GUI::PartPlateList& plate_list, const SnapshotData& snapshot_data)
+void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection* selection, const Slic3r::GUI::GLGizmosManager* gizmos, const Slic3r::GUI::PartPlateList* plate_list, const SnapshotData& snapshot_data)
 {
 	// Release old snapshot data.
 	assert(m_active_snapshot_time <= m_current_time);
@@ -939,16 +959,20 @@ void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Mo
 	}
 	// Take new snapshots.
 	this->save_mutable_object<Slic3r::Model>(model);
-	m_selection.volumes_and_instances.clear();
-	m_selection.volumes_and_instances.reserve(selection.get_volume_idxs().size());
-	m_selection.mode = selection.get_mode();
-	for (unsigned int volume_idx : selection.get_volume_idxs())
-		m_selection.volumes_and_instances.emplace_back(selection.get_volume(volume_idx)->geometry_id);
+	m_selection.clear();
+	if (selection) {
+		m_selection.volumes_and_instances.reserve(selection->get_volume_idxs().size());
+		m_selection.mode = selection->get_mode();
+		for (unsigned int volume_idx : selection->get_volume_idxs())
+			m_selection.volumes_and_instances.emplace_back(selection->get_volume(volume_idx)->geometry_id);
+	}
 	this->save_mutable_object<Selection>(m_selection);
-    this->save_mutable_object<Slic3r::GUI::GLGizmosManager>(gizmos);
+	if (gizmos)
+		this->save_mutable_object<Slic3r::GUI::GLGizmosManager>(*gizmos);
 
 	//BBS:save the partplater related data
-	this->save_mutable_object<Slic3r::GUI::PartPlateList>(plate_list);
+	if (plate_list)
+		this->save_mutable_object<Slic3r::GUI::PartPlateList>(*plate_list);
 
     // Save the snapshot info.
 	m_snapshots.emplace_back(snapshot_name, m_current_time, model.id().id, snapshot_data);
@@ -967,7 +991,8 @@ void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Mo
 	this->print();
 #endif /* SLIC3R_UNDOREDO_DEBUG */
 	BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << boost::format("snapshot name %1%") % snapshot_name;
-	plate_list.print();
+	if (plate_list)
+		plate_list->print();
 }
 
 void StackImpl::reduce_noisy_snapshots(const std::string& new_name)
@@ -996,7 +1021,7 @@ void StackImpl::reduce_noisy_snapshots(const std::string& new_name)
 	}
 }
 
-void StackImpl::load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos, Slic3r::GUI::PartPlateList& plate_list)
+void StackImpl::load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GUI::GLGizmosManager* gizmos, Slic3r::GUI::PartPlateList* plate_list)
 {
 	// Find the snapshot by time. It must exist.
 	const auto it_snapshot = std::lower_bound(m_snapshots.begin(), m_snapshots.end(), Snapshot(timestamp));
@@ -1013,21 +1038,22 @@ void StackImpl::load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GU
 	m_selection.volumes_and_instances.clear();
 	this->load_mutable_object<Selection>(m_selection.id(), m_selection);
     //gizmos.reset_all_states(); FIXME: is this really necessary? It is quite unpleasant for the gizmo undo/redo substack
-    this->load_mutable_object<Slic3r::GUI::GLGizmosManager>(gizmos.id(), gizmos);
+    if (gizmos)
+        this->load_mutable_object<Slic3r::GUI::GLGizmosManager>(gizmos->id(), *gizmos);
     // Sort the volumes so that we may use binary search.
 	std::sort(m_selection.volumes_and_instances.begin(), m_selection.volumes_and_instances.end());
 	m_active_snapshot_time = timestamp;
 
 	//BBS:load the partplater related data
-	{
+	if (plate_list) {
 		//Slic3r::GUI::PartPlateList& plate_list = GUI::wxGetApp().plater()->get_partplate_list();
 		std::vector<bool> previous_slice_result;
 		std::vector<std::string> previous_gcode_paths;
-		plate_list.get_sliced_result(previous_slice_result, previous_gcode_paths);
+		plate_list->get_sliced_result(previous_slice_result, previous_gcode_paths);
 
-		plate_list.reset(false);
-		this->load_mutable_object<Slic3r::GUI::PartPlateList>(plate_list.id(), plate_list);
-		plate_list.rebuild_plates_after_deserialize(previous_slice_result, previous_gcode_paths);
+		plate_list->reset(false);
+		this->load_mutable_object<Slic3r::GUI::PartPlateList>(plate_list->id(), *plate_list);
+		plate_list->rebuild_plates_after_deserialize(previous_slice_result, previous_gcode_paths);
 	}
 	this->m_active_snapshot_time = timestamp;
 	assert(this->valid());
@@ -1039,7 +1065,8 @@ void StackImpl::load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GU
 	m_reusable_objects.clear();
 
 	BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << boost::format("snapshot name %1%") % it_snapshot->name;
-	plate_list.print();
+	if (plate_list)
+		plate_list->print();
 }
 
 bool StackImpl::has_undo_snapshot() const
@@ -1078,7 +1105,7 @@ bool StackImpl::has_redo_snapshot() const
 	return false;
 }
 
-bool StackImpl::undo(Slic3r::Model &model, const Slic3r::GUI::Selection &selection, Slic3r::GUI::GLGizmosManager &gizmos, Slic3r::GUI::PartPlateList& plate_list, const SnapshotData &snapshot_data, size_t time_to_load)
+bool StackImpl::undo(Slic3r::Model &model, const Slic3r::GUI::Selection *selection, Slic3r::GUI::GLGizmosManager *gizmos, Slic3r::GUI::PartPlateList* plate_list, const SnapshotData &snapshot_data, size_t time_to_load)
 {
 	BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << boost::format(":time_to_load %1%") % time_to_load;
 	assert(this->valid());
@@ -1119,7 +1146,7 @@ bool StackImpl::undo(Slic3r::Model &model, const Slic3r::GUI::Selection &selecti
 	return true;
 }
 
-bool StackImpl::redo(Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos, Slic3r::GUI::PartPlateList& plate_list, size_t time_to_load)
+bool StackImpl::redo(Slic3r::Model& model, Slic3r::GUI::GLGizmosManager* gizmos, Slic3r::GUI::PartPlateList* plate_list, size_t time_to_load)
 {
 	BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << boost::format(":time_to_load %1%") % time_to_load;
 	assert(this->valid());
@@ -1185,7 +1212,18 @@ void StackImpl::collect_garbage()
 void StackImpl::release_least_recently_used()
 {
 	assert(this->valid());
+	// Take over the snapshot data serialized or compressed in the background since the last call.
+	m_data_pool.collect(false);
 	size_t current_memsize = this->memsize();
+	if (current_memsize > m_memory_limit / 2) {
+		// Compress the large snapshot data in the background before the memory limit is reached.
+		m_data_pool.compress_in_background();
+		if (current_memsize > m_memory_limit) {
+			// Rather wait for the compression than releasing the optional data or the snapshots.
+			m_data_pool.collect(true);
+			current_memsize = this->memsize();
+		}
+	}
 #ifdef SLIC3R_UNDOREDO_DEBUG
 	bool released = false;
 #endif
@@ -1366,14 +1404,19 @@ void Stack::release_least_recently_used() { pimpl->release_least_recently_used()
 void Stack::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection& selection, const Slic3r::GUI::GLGizmosManager& gizmos, const SnapshotData &snapshot_data)
 	{ pimpl->take_snapshot(snapshot_name, model, selection, gizmos, snapshot_data); }
 void Stack::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection& selection, const Slic3r::GUI::GLGizmosManager& gizmos, const Slic3r::GUI::PartPlateList& plate_list, const SnapshotData& snapshot_data)
-	{ pimpl->take_snapshot(snapshot_name, model, selection, gizmos, plate_list, snapshot_data); }
+	{ pimpl->take_snapshot(snapshot_name, model, &selection, &gizmos, &plate_list, snapshot_data); }
+void Stack::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const SnapshotData& snapshot_data)
+	{ pimpl->take_snapshot(snapshot_name, model, nullptr, nullptr, nullptr, snapshot_data); }
 void Stack::reduce_noisy_snapshots(const std::string& new_name) { pimpl->reduce_noisy_snapshots(new_name); }
 bool Stack::has_undo_snapshot() const { return pimpl->has_undo_snapshot(); }
 bool Stack::has_undo_snapshot(size_t time_to_load) const { return pimpl->has_undo_snapshot(time_to_load); }
 bool Stack::has_redo_snapshot() const { return pimpl->has_redo_snapshot(); }
 bool Stack::undo(Slic3r::Model& model, const Slic3r::GUI::Selection& selection, Slic3r::GUI::GLGizmosManager& gizmos, Slic3r::GUI::PartPlateList& plate_list, const SnapshotData &snapshot_data, size_t time_to_load)
-	{ return pimpl->undo(model, selection, gizmos, plate_list, snapshot_data, time_to_load); }
-bool Stack::redo(Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos, Slic3r::GUI::PartPlateList& plate_list, size_t time_to_load) { return pimpl->redo(model, gizmos, plate_list, time_to_load); }
+	{ return pimpl->undo(model, &selection, &gizmos, &plate_list, snapshot_data, time_to_load); }
+bool Stack::undo(Slic3r::Model& model, const SnapshotData &snapshot_data, size_t time_to_load)
+	{ return pimpl->undo(model, nullptr, nullptr, nullptr, snapshot_data, time_to_load); }
+bool Stack::redo(Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos, Slic3r::GUI::PartPlateList& plate_list, size_t time_to_load) { return pimpl->redo(model, &gizmos, &plate_list, time_to_load); }
+bool Stack::redo(Slic3r::Model& model, size_t time_to_load) { return pimpl->redo(model, nullptr, nullptr, time_to_load); }
 const Selection& Stack::selection_deserialized() const { return pimpl->selection_deserialized(); }
 
 const std::vector<Snapshot>& Stack::snapshots() const { return pimpl->snapshots(); }
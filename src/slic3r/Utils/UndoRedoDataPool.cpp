@@ -0,0 +1,185 @@
+#include "UndoRedoDataPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <miniz.h>
+
+#include <libslic3r/Exception.hpp>
+
+namespace Slic3r {
+namespace UndoRedo {
+
+std::string MutableData::load() const
+{
+	this->pool->wait_for(this);
+	if (this->folded_into)
+		return this->folded_into->load();
+	if (! this->compressed)
+		return this->data;
+	std::string out(this->size, 0);
+	mz_ulong size = mz_ulong(this->size);
+	if (mz_uncompress(reinterpret_cast<unsigned char*>(out.data()), &size, reinterpret_cast<const unsigned char*>(this->data.data()), mz_ulong(this->data.size())) != MZ_OK ||
+		size != this->size)
+		throw Slic3r::RuntimeError("Undo / Redo stack: Failed to inflate a snapshot");
+	return out;
+}
+
+// Copy of the first 8 bytes of the data, zero padded.
+static inline uint64_t head_of(const std::string &data)
+{
+	uint64_t head = 0;
+	memcpy(&head, data.data(), std::min<size_t>(data.size(), sizeof(head)));
+	return head;
+}
+
+bool MutableData::matches(const std::string &rhs, size_t rhs_hash) const
+{
+	this->pool->wait_for(this);
+	if (this->folded_into)
+		return this->folded_into->matches(rhs, rhs_hash);
+	// Reject by the hash, the size and the leading bytes first, the compressed data is only inflated if all of them match.
+	if (this->hash != rhs_hash || this->size != rhs.size() || this->head != head_of(rhs))
+		return false;
+	return this->compressed ? this->load() == rhs : memcmp(this->data.data(), rhs.data(), this->size) == 0;
+}
+
+MutableData* MutableDataPool::acquire(const std::string &data, size_t hash)
+{
+	auto range = m_data.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++ it)
+		if (it->second->matches(data, hash)) {
+			++ it->second->refcnt;
+			return it->second;
+		}
+	MutableData *out = new MutableData();
+	out->refcnt = 1;
+	out->pool	= this;
+	out->hash	= hash;
+	out->size	= data.size();
+	out->head	= head_of(data);
+	out->timestamp = out->head;
+	out->data	= data;
+	m_data.emplace(hash, out);
+	return out;
+}
+
+MutableData* MutableDataPool::acquire_pending(uint64_t timestamp, std::function<std::string()> serialize)
+{
+	MutableData *out = new MutableData();
+	out->refcnt    = 1;
+	out->pool	   = this;
+	out->timestamp = timestamp;
+	out->pending   = true;
+	this->run(out, std::move(serialize));
+	return out;
+}
+
+void MutableDataPool::release(MutableData *data)
+{
+	assert(data->refcnt > 0);
+	if (-- data->refcnt > 0)
+		return;
+	if (MutableData *folded_into = data->folded_into; folded_into) {
+		delete data;
+		this->release(folded_into);
+		return;
+	}
+	if (! data->pending) {
+		auto range = m_data.equal_range(data->hash);
+		for (auto it = range.first; it != range.second; ++ it)
+			if (it->second == data) {
+				m_data.erase(it);
+				break;
+			}
+	}
+	if (data->pending || data->compressing)
+		// Released by collect() once the background task finishes.
+		data->cancelled = true;
+	else
+		delete data;
+}
+
+void MutableDataPool::run(MutableData *data, std::function<std::string()> work)
+{
+	m_jobs.emplace_back();
+	Job &job = m_jobs.back();
+	job.data = data;
+	job.work = std::move(work);
+	m_tasks.run([&job]() {
+		if (! job.data->cancelled)
+			job.result = job.work();
+		job.done = true;
+	});
+}
+
+void MutableDataPool::compress_in_background()
+{
+	for (auto &kvp : m_data) {
+		MutableData *data = kvp.second;
+		// Compressed, being compressed or incompressible.
+		if (data->compression_tried || data->size < compression_threshold)
+			continue;
+		data->compression_tried = true;
+		data->compressing		= true;
+		this->run(data, [data]() {
+			const std::string &src = data->data;
+			mz_ulong compressed_size = mz_compressBound(mz_ulong(src.size()));
+			std::string compressed(compressed_size, 0);
+			if (mz_compress2(reinterpret_cast<unsigned char*>(compressed.data()), &compressed_size,
+					reinterpret_cast<const unsigned char*>(src.data()), mz_ulong(src.size()), MZ_BEST_SPEED) == MZ_OK &&
+				compressed_size < src.size())
+				compressed.resize(compressed_size);
+			else
+				// Keep incompressible data as is.
+				compressed.clear();
+			return compressed;
+		});
+	}
+}
+
+void MutableDataPool::collect(bool wait)
+{
+	if (wait)
+		m_tasks.wait();
+	for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+		if (! it->done) {
+			++ it;
+			continue;
+		}
+		MutableData *data = it->data;
+		if (data->cancelled)
+			// Released while being serialized or compressed.
+			delete data;
+		else if (data->pending) {
+			data->pending = false;
+			data->size	  = it->result.size();
+			data->hash	  = MutableData::hash_of(it->result);
+			data->head	  = head_of(it->result);
+			// An object restored by undo and saved again serializes to the data of its older snapshot, share it.
+			MutableData *same = nullptr;
+			auto range = m_data.equal_range(data->hash);
+			for (auto it_same = range.first; it_same != range.second && same == nullptr; ++ it_same)
+				if (it_same->second->matches(it->result, data->hash))
+					same = it_same->second;
+			if (same) {
+				++ same->refcnt;
+				data->folded_into = same;
+			} else {
+				data->data = std::move(it->result);
+				m_data.emplace(data->hash, data);
+			}
+		} else {
+			data->compressing = false;
+			if (! it->result.empty()) {
+				data->data		 = std::move(it->result);
+				data->data.shrink_to_fit();
+				data->compressed = true;
+			}
+		}
+		it = m_jobs.erase(it);
+	}
+}
+
+} // namespace UndoRedo
+} // namespace Slic3r
@@ -0,0 +1,116 @@
+#ifndef slic3r_Utils_UndoRedoDataPool_hpp_
+#define slic3r_Utils_UndoRedoDataPool_hpp_
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <tbb/task_group.h>
+
+namespace Slic3r {
+namespace UndoRedo {
+
+class MutableDataPool;
+
+// Serialized data of a mutable object. The data is shared by all the history intervals of all the objects serializing to the same content,
+// see MutableDataPool. Large objects may be serialized and large data may be compressed in the background.
+struct MutableData
+{
+	// Reference counter of this data chunk. We may have used shared_ptr, but the shared_ptr is thread safe
+	// with the associated cost of CPU cache invalidation on refcount change.
+	size_t			 refcnt { 0 };
+	MutableDataPool *pool { nullptr };
+	size_t			 hash { 0 };
+	// Size of the serialized data.
+	size_t			 size { 0 };
+	// First 8 bytes of the serialized data, where the objects with a reliable timestamp store their timestamp.
+	uint64_t		 timestamp { 0 };
+	// First 8 bytes of the serialized data, compared before the compressed data is inflated.
+	uint64_t		 head { 0 };
+	// Serialized data, deflated if compressed.
+	std::string		 data;
+	bool			 compressed { false };
+	// Compression was tried already, the data is not compressed again if it did not deflate.
+	bool			 compression_tried { false };
+	// The object is being serialized in the background, data is empty until the task finishes.
+	bool			 pending { false };
+	// A background task is reading data to compress it. The data is not modified and not released until the task finishes.
+	bool			 compressing { false };
+	// Released while being serialized or compressed, the result of the background task is not needed.
+	std::atomic<bool> cancelled { false };
+	// Serialized in the background to the same content as this data, which is shared instead. This data keeps a reference to it
+	// and it is not stored in the pool, it only stands for the shared data in the history intervals which acquired it.
+	MutableData 	*folded_into { nullptr };
+
+	static size_t	 hash_of(const std::string &data) { return std::hash<std::string_view>()(std::string_view(data)); }
+
+	// Copy of the serialized data, inflated if compressed.
+	std::string		 load() const;
+	// The serialized data matches the data stored here.
+	bool			 matches(const std::string &rhs, size_t rhs_hash) const;
+	// The timestamp matches the timestamp serialized in the data stored here.
+	bool			 matches_timestamp(uint64_t timestamp) const { assert(timestamp > 0); assert(this->pending || this->size > 8); return this->timestamp == timestamp; }
+};
+
+// Content addressed store of the MutableData: An object saving the same data as another object or as an older snapshot of itself
+// shares the data. Large data are compressed by background tasks if the Undo / Redo stack grows over a half of its memory limit,
+// so that more snapshots fit into the memory limit.
+// Large objects with a reliable timestamp (the painted facets) are copied by take_snapshot() and serialized in the background.
+// Their data is waited for when needed, for example by undo.
+class MutableDataPool
+{
+public:
+	// Data smaller than this is never compressed.
+	static constexpr size_t compression_threshold = 4096;
+
+	MutableDataPool() = default;
+	~MutableDataPool() { this->collect(true); assert(m_data.empty()); }
+
+	// Find the data of the same content or allocate a new one, the reference counter of the returned data is incremented.
+	MutableData*	acquire(const std::string &data, size_t hash);
+	// Allocate a data to be serialized by serialize() in the background. timestamp is the timestamp of the object being serialized.
+	// The reference counter of the returned data is one. Once serialized, the data is folded into data of the same content if there is any.
+	MutableData*	acquire_pending(uint64_t timestamp, std::function<std::string()> serialize);
+	void 			add_ref(MutableData *data) { ++ data->refcnt; }
+	// Decrement the reference counter, release the data if not referenced anymore.
+	void 			release(MutableData *data);
+
+	// Start compressing all the uncompressed data larger than compression_threshold by background tasks.
+	// Data which did not deflate before is not compressed again.
+	void 			compress_in_background();
+	// Take over the results of the finished background tasks. If wait, wait for all the tasks to finish.
+	void 			collect(bool wait);
+	// Wait for the data to be serialized.
+	void 			wait_for(const MutableData *data) { if (data->pending) this->collect(true); }
+
+	// Number of the distinct data chunks, not counting the data being serialized.
+	size_t 			size() const { return m_data.size(); }
+	// No background task was started since the last collect().
+	bool 			idle() const { return m_jobs.empty(); }
+
+private:
+	struct Job
+	{
+		MutableData 				*data;
+		// Serializes or compresses data.
+		std::function<std::string()> work;
+		std::string 				 result;
+		std::atomic<bool> 			 done { false };
+	};
+	void 			run(MutableData *data, std::function<std::string()> work);
+
+	std::unordered_multimap<size_t, MutableData*> 	m_data;
+	// std::list for the jobs to keep their addresses while being processed.
+	std::list<Job> 									m_jobs;
+	tbb::task_group 								m_tasks;
+};
+
+} // namespace UndoRedo
+} // namespace Slic3r
+
+#endif /* slic3r_Utils_UndoRedoDataPool_hpp_ */
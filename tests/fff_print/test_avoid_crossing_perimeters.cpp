@@ -0,0 +1,148 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/GCode/AvoidCrossingPerimeters.hpp"
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+// Travel end points on a regular grid over the layer and around it, crossing the holes and the gaps between the islands.
+static Points travel_points(const Layer &layer, int num_steps = 5)
+{
+    BoundingBox bbox = get_extents(layer.lslices);
+    bbox.offset(scale_(1.));
+    const Point size = bbox.size();
+    Points      out;
+    for (int i = 0; i <= num_steps; ++ i)
+        for (int j = 0; j <= num_steps; ++ j)
+            out.emplace_back(bbox.min.x() + coord_t(int64_t(size.x()) * i / num_steps), bbox.min.y() + coord_t(int64_t(size.y()) * j / num_steps));
+    return out;
+}
+
+// Travels between all the pairs of points, in the coordinate system of the object.
+static std::vector<Polyline> plan_travels(AvoidCrossingPerimeters &avoid_crossing_perimeters, const Layer &layer, const Points &points)
+{
+    std::vector<Polyline> out;
+    for (const Point &start : points)
+        for (const Point &end : points)
+            if (start != end) {
+                Polyline travel;
+                avoid_crossing_perimeters.plan_travel(layer, start, end, false, travel);
+                out.emplace_back(std::move(travel));
+            }
+    return out;
+}
+
+static bool bboxes_equal(const std::vector<BoundingBox> &lhs, const std::vector<BoundingBox> &rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const BoundingBox &l, const BoundingBox &r) { return l.min == r.min && l.max == r.max; });
+}
+
+static void require_boundaries_equal(const AvoidCrossingPerimeters::Boundary &lhs, const AvoidCrossingPerimeters::Boundary &rhs)
+{
+    REQUIRE(lhs.boundaries == rhs.boundaries);
+    REQUIRE(lhs.bbox.min == rhs.bbox.min);
+    REQUIRE(lhs.bbox.max == rhs.bbox.max);
+    REQUIRE(lhs.boundaries_params == rhs.boundaries_params);
+    REQUIRE(lhs.boundaries_offset == rhs.boundaries_offset);
+    REQUIRE(lhs.boundaries_offset_first_vertex == rhs.boundaries_offset_first_vertex);
+    REQUIRE(lhs.grid.bbox().min == rhs.grid.bbox().min);
+    REQUIRE(lhs.grid.bbox().max == rhs.grid.bbox().max);
+}
+
+// Sliced layers of objects with holes and with several islands.
+static void process_print(Print &print, Model &model)
+{
+    init_print({ TestMesh::cube_with_hole, TestMesh::two_hollow_squares }, print, model, {
+        { "reduce_crossing_wall", true }
+    });
+    print.process();
+}
+
+TEST_CASE("Precomputed avoid crossing perimeters boundaries equal the lazily computed ones", "[AvoidCrossingPerimeters]") {
+    Print print;
+    Model model;
+    process_print(print, model);
+
+    for (const PrintObject *object : print.objects()) {
+        const std::vector<const Layer*> layers = object->layers().vector();
+        REQUIRE(! layers.empty());
+        AvoidCrossingPerimeters precomputed;
+        precomputed.precompute_layers(layers);
+        for (const Layer *layer : { layers.front(), layers[layers.size() / 2], layers.back() }) {
+            AvoidCrossingPerimeters lazy;
+            lazy.init_layer(*layer);
+            precomputed.init_layer(*layer);
+            const AvoidCrossingPerimeters::LayerBoundaries &lazy_boundaries        = lazy.current_layer_boundaries();
+            const AvoidCrossingPerimeters::LayerBoundaries &precomputed_boundaries = precomputed.current_layer_boundaries();
+            REQUIRE(lazy_boundaries.lslices_offset == precomputed_boundaries.lslices_offset);
+            REQUIRE(bboxes_equal(lazy_boundaries.lslices_offset_bboxes, precomputed_boundaries.lslices_offset_bboxes));
+            REQUIRE(lazy_boundaries.grid_lslices_offset.bbox().min == precomputed_boundaries.grid_lslices_offset.bbox().min);
+            REQUIRE(lazy_boundaries.grid_lslices_offset.bbox().max == precomputed_boundaries.grid_lslices_offset.bbox().max);
+            // The internal boundary is computed by the first travel leaving the islands, unless precomputed.
+            REQUIRE(lazy_boundaries.internal.boundaries.empty());
+            REQUIRE(! precomputed_boundaries.internal.boundaries.empty());
+
+            const Points points = travel_points(*layer);
+            REQUIRE(plan_travels(lazy, *layer, points) == plan_travels(precomputed, *layer, points));
+            require_boundaries_equal(lazy_boundaries.internal, precomputed_boundaries.internal);
+            // The external boundary is only computed on demand.
+            REQUIRE(lazy_boundaries.external.boundaries.empty());
+            REQUIRE(precomputed_boundaries.external.boundaries.empty());
+        }
+    }
+}
+
+TEST_CASE("Travels planned with the avoid crossing perimeters caches match the travels planned from scratch", "[AvoidCrossingPerimeters]") {
+    Print print;
+    Model model;
+    process_print(print, model);
+
+    for (const PrintObject *object : print.objects()) {
+        const std::vector<const Layer*> layers = object->layers().vector();
+        for (const Layer *layer : { layers.front(), layers[layers.size() / 2], layers.back() }) {
+            const Points points = travel_points(*layer, 4);
+            // Each travel is planned by a new instance, with empty visibility graph and planned travels.
+            std::vector<Polyline> cold;
+            for (const Point &start : points)
+                for (const Point &end : points)
+                    if (start != end) {
+                        AvoidCrossingPerimeters avoid_crossing_perimeters;
+                        avoid_crossing_perimeters.init_layer(*layer);
+                        Polyline travel;
+                        avoid_crossing_perimeters.plan_travel(*layer, start, end, false, travel);
+                        cold.emplace_back(std::move(travel));
+                    }
+
+            {
+                // Warm caches.
+                AvoidCrossingPerimeters avoid_crossing_perimeters;
+                avoid_crossing_perimeters.init_layer(*layer);
+                // The first pass fills the caches, the second pass takes all the travels from them.
+                REQUIRE(plan_travels(avoid_crossing_perimeters, *layer, points) == cold);
+                const AvoidCrossingPerimeters::Boundary &internal = avoid_crossing_perimeters.current_layer_boundaries().internal;
+                const size_t num_planned = internal.planned_travels.size();
+                REQUIRE(num_planned > 0);
+                REQUIRE(plan_travels(avoid_crossing_perimeters, *layer, points) == cold);
+                REQUIRE(internal.planned_travels.size() == num_planned);
+            }
+            {
+                // Planned travels evicted over the cap.
+                AvoidCrossingPerimeters avoid_crossing_perimeters;
+                avoid_crossing_perimeters.set_max_planned_travels(16);
+                avoid_crossing_perimeters.init_layer(*layer);
+                // Travels over the cap are planned again with the visibility graph filled by the previous travels.
+                REQUIRE(plan_travels(avoid_crossing_perimeters, *layer, points) == cold);
+                REQUIRE(plan_travels(avoid_crossing_perimeters, *layer, points) == cold);
+                REQUIRE(avoid_crossing_perimeters.current_layer_boundaries().internal.planned_travels.size() <= 16);
+            }
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <memory>
+
+#include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/CoolingBuffer.hpp"
+
+using namespace Slic3r;
+
+// A single extruder layer with a 100mm extrusion at 50mm/s, thus taking 2 seconds, followed by the given lines.
+static std::string cooling_layer(const std::string &tail)
+{
+    return "G1 F3000;_EXTRUDE_SET_SPEED\n"
+           "G1 X100 Y0 E1\n"
+           ";_EXTRUDE_END\n" + tail;
+}
+
+static std::unique_ptr<CoolingBuffer> make_cooling_buffer(GCode &gcodegen)
+{
+    PrintConfig config;
+    config.set_deserialize_strict({
+        { "use_relative_e_distances",     "0" },
+        { "slow_down_for_layer_cooling",  "1" },
+        { "slow_down_layer_time",         "5" },
+        { "slow_down_min_speed",          "10" },
+        { "dont_slow_down_outer_wall",    "0" },
+        // The fan runs at the same speed for all the layers.
+        { "fan_min_speed",                "100" },
+        { "fan_max_speed",                "100" },
+        { "fan_cooling_layer_time",       "5" },
+        { "reduce_fan_stop_start_freq",   "1" },
+        { "close_fan_the_first_x_layers", "0" },
+        { "full_fan_speed_layer",         "0" }
+    });
+    gcodegen.apply_print_config(config);
+    gcodegen.writer().set_extruders({ 0 });
+    gcodegen.writer().set_extruder(0);
+    return std::make_unique<CoolingBuffer>(gcodegen);
+}
+
+// Feedrate of the extrusion in mm/min, as written by the cooling buffer.
+static int extrusion_feedrate(const std::string &gcode)
+{
+    size_t pos = gcode.find("G1 F");
+    REQUIRE(pos != std::string::npos);
+    return atoi(gcode.c_str() + pos + 4);
+}
+
+SCENARIO("Cooling buffer slows down the short layers", "[CoolingBuffer]") {
+    GCode gcodegen;
+    std::unique_ptr<CoolingBuffer> cooling_buffer = make_cooling_buffer(gcodegen);
+    const std::string fan_on = GCodeWriter::set_fan(gcodegen.config().gcode_flavor, 100);
+
+    GIVEN("A layer printed faster than slow_down_layer_time") {
+        std::string gcode = cooling_buffer->process_layer(cooling_layer(""), 5, true);
+        THEN("The extrusion is slowed down to reach the minimum layer time") {
+            REQUIRE(extrusion_feedrate(gcode) == Approx(60. * 100. / 5.005).epsilon(0.01));
+            REQUIRE(gcode.find(";_EXTRUDE_SET_SPEED") == std::string::npos);
+            REQUIRE(gcode.find(";_EXTRUDE_END") == std::string::npos);
+        }
+    }
+    GIVEN("A layer with a dwell long enough to reach the minimum layer time") {
+        WHEN("The dwell is given in seconds") {
+            std::string gcode = cooling_buffer->process_layer(cooling_layer("G4 S4\n"), 5, true);
+            THEN("The layer is not modified besides the cooling markers") {
+                REQUIRE(gcode == fan_on + "G1 F3000\nG1 X100 Y0 E1\nG4 S4\n");
+            }
+        }
+        WHEN("The dwell is given in milliseconds") {
+            std::string gcode = cooling_buffer->process_layer(cooling_layer("G4 P4000\n"), 5, true);
+            THEN("The dwell is counted into the layer time as well") {
+                REQUIRE(gcode == fan_on + "G1 F3000\nG1 X100 Y0 E1\nG4 P4000\n");
+            }
+        }
+    }
+    GIVEN("A layer with a short dwell in milliseconds") {
+        std::string gcode = cooling_buffer->process_layer(cooling_layer("G4 P1000\n"), 5, true);
+        THEN("The extrusion is only slowed down by the time missing after the dwell") {
+            REQUIRE(extrusion_feedrate(gcode) == Approx(60. * 100. / 4.005).epsilon(0.01));
+            REQUIRE(gcode.find("G4 P1000\n") != std::string::npos);
+        }
+    }
+}
@@ -1,8 +1,15 @@
 #include <catch2/catch.hpp>
 
 #include <memory>
+#include <sstream>
+#include <thread>
 
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/GCode/ToolpathGeometry.hpp"
+#include "libslic3r/Execution/ExecutionContext.hpp"
+
+#include "test_data.hpp"
 
 using namespace Slic3r;
 
@@ -20,3 +27,240 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+SCENARIO("Columnar storage of the G-code moves", "[GCode]") {
+    GIVEN("A store with a linear move and an arc move") {
+        GCodeProcessorResult::MoveVertexStore moves;
+        moves.push_back(GCodeProcessorResult::MoveVertex());
+        const std::vector<Vec3f> arc_points { Vec3f(1.f, 2.f, 0.2f), Vec3f(2.f, 3.f, 0.2f) };
+        GCodeProcessorResult::MoveVertex arc;
+        arc.gcode_id             = 10;
+        arc.type                 = EMoveType::Extrude;
+        arc.position             = Vec3f(3.f, 3.f, 0.2f);
+        arc.move_path_type       = EMovePathType::Arc_move_ccw;
+        arc.interpolation_points = arc_points;
+        moves.push_back(arc);
+        WHEN("A move is read back") {
+            const GCodeProcessorResult::MoveVertex move = moves[1];
+            THEN("All its fields and the interpolation points are restored") {
+                REQUIRE(moves.size() == 2);
+                REQUIRE(move.gcode_id == 10);
+                REQUIRE(move.position == Vec3f(3.f, 3.f, 0.2f));
+                REQUIRE(move.is_arc_move_with_interpolation_points());
+                REQUIRE(move.interpolation_points.size() == 2);
+                REQUIRE(move.interpolation_points[1] == arc_points[1]);
+                REQUIRE(! moves[0].is_arc_move_with_interpolation_points());
+            }
+        }
+        WHEN("The arc move is moved to the front and the linear move to the back") {
+            moves.move_to_back(0);
+            THEN("The interpolation points follow their move") {
+                REQUIRE(moves.front().gcode_id == 10);
+                REQUIRE(moves.front().interpolation_points[0] == arc_points[0]);
+                REQUIRE(moves.back().interpolation_points.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Layer hashes of the G-code moves", "[GCode]") {
+    // Three layers of four moves, the second layer shifted along X by dx.
+    auto make_moves = [](float dx, unsigned int first_gcode_id) {
+        GCodeProcessorResult::MoveVertexStore moves;
+        GCodeProcessorResult::MoveVertex move;
+        move.type = EMoveType::Extrude;
+        for (size_t i = 0; i < 12; ++ i) {
+            const size_t layer = i / 4;
+            move.gcode_id       = first_gcode_id + unsigned(i);
+            move.time           = float(first_gcode_id);
+            move.layer_duration = float(layer + 1);
+            move.position       = Vec3f(float(i % 4) + (layer == 1 ? dx : 0.f), 0.f, 0.2f * float(layer + 1));
+            moves.push_back(move);
+        }
+        return moves;
+    };
+    auto layer_hashes = [](const GCodeProcessorResult::MoveVertexStore &moves) {
+        std::vector<GCodeProcessorResult::LayerHash> out;
+        for (size_t first_move = 0; first_move < moves.size(); first_move += 4)
+            out.push_back({ first_move, 4, moves.hash(first_move, first_move + 4) });
+        return out;
+    };
+    GIVEN("The hashes of the layers of a result") {
+        const std::vector<GCodeProcessorResult::LayerHash> hashes = layer_hashes(make_moves(0.f, 1));
+        THEN("The hashes do not depend on the G-code line ids and the times") {
+            REQUIRE(GCodeProcessorResult::common_moves_prefix(hashes, layer_hashes(make_moves(0.f, 100))) == 12);
+        }
+        THEN("The moves drawn the same end at the first changed layer") {
+            REQUIRE(GCodeProcessorResult::common_moves_prefix(hashes, layer_hashes(make_moves(1.f, 1))) == 4);
+        }
+        THEN("A result with more layers shares all the layers of the shorter one") {
+            std::vector<GCodeProcessorResult::LayerHash> longer = hashes;
+            longer.push_back({ 12, 4, 0 });
+            REQUIRE(GCodeProcessorResult::common_moves_prefix(hashes, longer) == 12);
+            REQUIRE(GCodeProcessorResult::common_moves_prefix({}, hashes) == 0);
+        }
+    }
+}
+
+SCENARIO("Toolpath vertices generated headless", "[GCode]") {
+    GIVEN("A straight extrusion along X followed by arcs") {
+        GCodeProcessorResult::MoveVertexStore moves;
+        GCodeProcessorResult::MoveVertex move;
+        move.position = Vec3f(0.f, 0.f, 0.2f);
+        moves.push_back(move);
+        move.type     = EMoveType::Extrude;
+        move.position = Vec3f(10.f, 0.f, 0.2f);
+        moves.push_back(move);
+        const std::vector<Vec3f> arc_points { Vec3f(11.f, 1.f, 0.2f), Vec3f(12.f, 3.f, 0.2f) };
+        for (size_t i = 0; i < 1000; ++ i) {
+            move.position             = Vec3f(10.f + float(i % 7), float(i % 5), 0.2f);
+            move.move_path_type       = (i % 3 == 0) ? EMovePathType::Arc_move_cw : EMovePathType::Linear_move;
+            move.interpolation_points = (i % 3 == 0) ? GCodeProcessorResult::PointsView(arc_points) : GCodeProcessorResult::PointsView();
+            moves.push_back(move);
+        }
+        WHEN("The vertices of the straight solid segment are generated") {
+            std::vector<float> vertices(ToolpathGeometry::solid_vertices_size(moves, 1, true));
+            ToolpathGeometry::VertexJob job;
+            job.type          = ToolpathGeometry::VertexJob::EType::Solid;
+            job.first_segment = true;
+            job.move_id       = 1;
+            job.width         = 0.4f;
+            job.height        = 0.2f;
+            job.buffer        = &vertices;
+            ToolpathGeometry::generate_vertices(moves, job);
+            THEN("Eight vertices with normals are emitted, the first one on top of the starting point") {
+                REQUIRE(vertices.size() == 8 * 6);
+                REQUIRE(vertices[0] == Approx(0.f));
+                REQUIRE(vertices[1] == Approx(0.f));
+                REQUIRE(vertices[2] == Approx(0.2f));
+                REQUIRE(vertices[5] == Approx(1.f));
+            }
+        }
+        WHEN("The vertices of all the segments are generated in parallel") {
+            std::vector<float> serial, parallel;
+            std::vector<ToolpathGeometry::VertexJob> jobs;
+            for (size_t i = 1; i < moves.size(); ++ i) {
+                ToolpathGeometry::VertexJob job;
+                job.type          = (i % 2) ? ToolpathGeometry::VertexJob::EType::Solid : ToolpathGeometry::VertexJob::EType::Line;
+                job.first_segment = i % 4 == 1;
+                job.move_id       = i;
+                job.width         = 0.45f;
+                job.height        = 0.2f;
+                job.buffer        = &parallel;
+                job.offset        = parallel.size();
+                parallel.resize(parallel.size() + (job.type == ToolpathGeometry::VertexJob::EType::Solid ?
+                    ToolpathGeometry::solid_vertices_size(moves, i, job.first_segment) : ToolpathGeometry::line_vertices_size(moves, i)));
+                jobs.emplace_back(job);
+            }
+            serial.assign(parallel.size(), 0.f);
+            ToolpathGeometry::generate_vertices(moves, jobs);
+            for (ToolpathGeometry::VertexJob job : jobs) {
+                job.buffer = &serial;
+                ToolpathGeometry::generate_vertices(moves, job);
+            }
+            THEN("The result matches the serial generation") {
+                REQUIRE(parallel == serial);
+            }
+        }
+    }
+}
+
+SCENARIO("Level of detail of the toolpaths", "[GCode]") {
+    GIVEN("Collinear extrusions, a corner, a width change and travels") {
+        GCodeProcessorResult::MoveVertexStore moves;
+        GCodeProcessorResult::MoveVertex move;
+        moves.push_back(move);
+        move.type     = EMoveType::Extrude;
+        move.width    = 0.45f;
+        move.height   = 0.2f;
+        // 0: the start, 1..5: collinear extrusions along X, the inner ones 2..4 are merged
+        for (int i = 0; i <= 4; ++ i) {
+            move.position = Vec3f(float(i), 0.f, 0.2f);
+            moves.push_back(move);
+        }
+        // 6: turning at the corner 5
+        move.position = Vec3f(4.f, 5.f, 0.2f);
+        moves.push_back(move);
+        // 7: different width
+        move.width    = 0.5f;
+        move.position = Vec3f(4.f, 6.f, 0.2f);
+        moves.push_back(move);
+        // 8..10: travels in a plane, the inner ones 8, 9 are merged, 11: travel to the next layer
+        move.type = EMoveType::Travel;
+        for (const Vec3f &pt : { Vec3f(10.f, 3.f, 0.2f), Vec3f(12.f, 9.f, 0.2f), Vec3f(20.f, 20.f, 0.2f), Vec3f(20.f, 20.f, 0.4f) }) {
+            move.position = pt;
+            moves.push_back(move);
+        }
+        WHEN("The moves are simplified") {
+            ToolpathGeometry::LODParams params;
+            params.collinear_tolerance = 0.01f;
+            params.min_segment_length  = 0.05f;
+            params.aggregate_travels   = true;
+            std::vector<size_t> kept;
+            GCodeProcessorResult::MoveVertexStore simplified = ToolpathGeometry::simplify(moves, params, &kept);
+            THEN("The collinear extrusions and the inner travels are merged") {
+                REQUIRE(kept == std::vector<size_t>{ 0, 1, 5, 6, 7, 10, 11 });
+                REQUIRE(simplified.size() == kept.size());
+                REQUIRE(simplified[2].position == moves[5].position);
+            }
+        }
+        WHEN("The level of detail is selected for a small print") {
+            THEN("The full detail is kept") {
+                REQUIRE(! ToolpathGeometry::select_lod(moves.size(), 1000, 10.).enabled());
+                REQUIRE(ToolpathGeometry::select_lod(ToolpathGeometry::LODMinMoves, ToolpathGeometry::LODMinLayers, 10.).enabled());
+            }
+        }
+    }
+}
+
+// G-code of a 20mm cube exported in the given execution context, without the time stamp.
+static std::string export_cube(std::initializer_list<ConfigBase::SetDeserializeItem> config_items, ExecutionContextPtr context)
+{
+    Print print;
+    Model model;
+    Test::init_print({ Test::TestMesh::cube_20x20x20 }, print, model, config_items);
+    print.set_execution_context(std::move(context));
+    std::istringstream in(Test::gcode(print));
+    std::string        out, line;
+    while (std::getline(in, line))
+        if (line.rfind("; generated by ", 0) != 0)
+            out += line + "\n";
+    return out;
+}
+
+static ExecutionContextPtr memory_limited_context(size_t threads)
+{
+    ExecutionParams params;
+    params.threads = threads;
+    // Each layer exceeds the limit, the export pipeline is paused and restarted after each layer.
+    params.gcode_memory_limit = 1;
+    return std::make_shared<ExecutionContext>(params);
+}
+
+SCENARIO("G-code export pipeline with a memory limit", "[GCode]") {
+    const std::initializer_list<ConfigBase::SetDeserializeItem> layer_by_layer     { { "layer_height", 0.4 } };
+    const std::initializer_list<ConfigBase::SetDeserializeItem> pressure_equalizer { { "layer_height", 0.4 }, { "max_volumetric_extrusion_rate_slope", 2. } };
+    const std::initializer_list<ConfigBase::SetDeserializeItem> by_object          { { "layer_height", 0.4 }, { "print_sequence", "by object" } };
+    for (const std::initializer_list<ConfigBase::SetDeserializeItem> &config_items : { layer_by_layer, pressure_equalizer, by_object }) {
+        const std::string reference = export_cube(config_items, nullptr);
+        REQUIRE(! reference.empty());
+        // The pipeline paused by the memory limit resumes with the next layer, the stages keep their state.
+        CHECK(export_cube(config_items, memory_limited_context(1)) == reference);
+        CHECK(export_cube(config_items, memory_limited_context(2)) == reference);
+    }
+}
+
+SCENARIO("Plates exported in parallel share an execution context with a memory limit", "[GCode]") {
+    const std::initializer_list<ConfigBase::SetDeserializeItem> config_items { { "layer_height", 0.4 } };
+    const std::string   reference = export_cube(config_items, nullptr);
+    // Like the plates sliced by --parallel_plates 2 --threads 2 --gcode_memory_limit: More pipelines than the arena
+    // has threads to spare, none of their stages may block a worker.
+    ExecutionContextPtr context   = memory_limited_context(2);
+    std::string         plate1, plate2;
+    std::thread         thread1([&]() { plate1 = export_cube(config_items, context); });
+    std::thread         thread2([&]() { plate2 = export_cube(config_items, context); });
+    thread1.join();
+    thread2.join();
+    CHECK(plate1 == reference);
+    CHECK(plate2 == reference);
+}
@@ -0,0 +1,111 @@
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/PressureEqualizer.hpp"
+
+using namespace Slic3r;
+
+// Two layers of relative extrusions, 0.04mm of filament per 1mm of the path, with the markers emitted by GCode::_extrude().
+static const char *pressure_equalizer_layers[] = {
+    // Slow perimeter, fast solid infill, slow perimeter again.
+    "G1 Z0.2 F720\n"
+    ";_EXTRUSION_ROLE:1\n"
+    "G1 F1200;_EXTRUDE_SET_SPEED\n"
+    "G1 X10 Y0 E0.4\n"
+    "G1 X20 Y0 E0.4\n"
+    ";_EXTRUDE_END\n"
+    ";_EXTRUSION_ROLE:5\n"
+    "G1 F6000;_EXTRUDE_SET_SPEED\n"
+    "G1 X30 Y0 E0.4\n"
+    "G1 X40 Y0 E0.4\n"
+    ";_EXTRUDE_END\n"
+    ";_EXTRUSION_ROLE:1\n"
+    "G1 F1200;_EXTRUDE_SET_SPEED\n"
+    "G1 X50 Y0 E0.4\n"
+    ";_EXTRUDE_END\n",
+    // Slow external perimeter, then fast sparse infill after a short travel.
+    "G1 Z0.4 F720\n"
+    ";_EXTRUSION_ROLE:2\n"
+    "G1 F900;_EXTRUDE_SET_SPEED;_EXTERNAL_PERIMETER\n"
+    "G1 X50 Y10 E0.4\n"
+    ";_EXTRUDE_END\n"
+    "G1 X51 Y10 F12000\n"
+    ";_EXTRUSION_ROLE:4\n"
+    "G1 F7200;_EXTRUDE_SET_SPEED\n"
+    "G1 X61 Y10 E0.4\n"
+    "G1 X71 Y10 E0.4\n"
+    ";_EXTRUDE_END\n",
+};
+
+static std::string equalize(const GCodeConfig &config)
+{
+    PressureEqualizer pressure_equalizer(config);
+    std::string       out;
+    size_t            layer_id = 0;
+    for (const char *gcode : pressure_equalizer_layers) {
+        LayerResult layer { gcode, layer_id ++ };
+        // The output lags one layer behind the input.
+        out += pressure_equalizer.process_layer(std::move(layer)).gcode;
+    }
+    out += pressure_equalizer.process_layer(LayerResult::make_nop_layer_result()).gcode;
+    return out;
+}
+
+// Feedrates of the extrusions in mm/min, in the order of the G-code.
+static std::vector<double> extrusion_feedrates(const std::string &gcode)
+{
+    std::vector<double> out;
+    std::istringstream  lines(gcode);
+    for (std::string line; std::getline(lines, line);)
+        if (line.rfind("G1 F", 0) == 0)
+            out.emplace_back(atof(line.c_str() + 4));
+    return out;
+}
+
+static double extruded_length(const std::string &gcode)
+{
+    double             out = 0.;
+    std::istringstream lines(gcode);
+    for (std::string line; std::getline(lines, line);)
+        if (size_t pos = line.find(" E"); pos != std::string::npos)
+            out += atof(line.c_str() + pos + 2);
+    return out;
+}
+
+SCENARIO("Pressure equalizer limits the changes of the volumetric extrusion rate", "[PressureEqualizer]") {
+    GCodeConfig config;
+    config.use_relative_e_distances.value                           = true;
+    config.filament_diameter.values                                 = { 1.75 };
+    config.max_volumetric_extrusion_rate_slope.value                = 2.;
+    config.max_volumetric_extrusion_rate_slope_segment_length.value = 1.;
+    config.extrusion_rate_smoothing_external_perimeter_only.value   = false;
+
+    GIVEN("Layers with slow perimeters and fast infills") {
+        const std::string gcode = equalize(config);
+        THEN("The transitions are split into 1mm segments with the feedrates ramping up and down") {
+            // 1mm of the path extrudes 0.0962mm^3, at 20mm/s the slope of 2mm^3/s^2 changes the feedrate by about 60mm/min per segment.
+            // The fast infills never reach their own feedrate, they only get as fast as the ramps from the slow perimeters allow.
+            const std::vector<double> expected {
+                // Layer 1: the first perimeter, the ramp up over its end and the infill, the ramp down over the second perimeter
+                // towards the external perimeter of layer 2.
+                1200, 1200, 1260, 1320, 1380, 1440, 1500, 1560, 1560, 1620, 1740, 1680, 1620, 1560, 1560, 1500, 1440, 1380, 1320, 1260,
+                1200, 1200, 1140, 1140, 1080, 1080, 1020, 1020, 960, 960, 900,
+                // Layer 2: the external perimeter is printed as it is, the infill ramps up from it, the ramp is carried over the travel.
+                900, 960, 1020, 1080, 1140, 1200, 1260, 1320, 1380, 1440, 1500
+            };
+            const std::vector<double> feedrates = extrusion_feedrates(gcode);
+            REQUIRE(feedrates.size() == expected.size());
+            for (size_t i = 0; i < expected.size(); ++ i) {
+                INFO("Extrusion " << i);
+                REQUIRE(feedrates[i] == Approx(expected[i]).margin(0.001));
+            }
+        }
+        THEN("The split extrusions extrude the same amount of filament") {
+            REQUIRE(extruded_length(gcode) == Approx(3.2));
+        }
+    }
+}
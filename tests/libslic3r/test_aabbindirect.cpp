@@ -1,6 +1,10 @@
 #include <catch2/catch.hpp>
 #include <test_utils.hpp>
 
+#include <random>
+
+#include <tbb/task_arena.h>
+
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
 
@@ -58,3 +62,58 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Approx(0.5));
     REQUIRE(closest_point.z() == Approx(1.));
 }
+
+TEST_CASE("Parallel build and ray packets over a large mesh", "[AABBIndirect]")
+{
+    indexed_triangle_set its = its_make_sphere(10., 2. * PI / 400.);
+    REQUIRE(its.indices.size() > 2 * 16384);
+
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    decltype(tree) tree_serial;
+    tbb::task_arena(1).execute([&its, &tree_serial]() {
+        tree_serial = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    });
+    REQUIRE(tree.nodes().size() == tree_serial.nodes().size());
+    for (size_t i = 0; i < tree.nodes().size(); ++ i) {
+        REQUIRE(tree.node(i).idx == tree_serial.node(i).idx);
+        if (tree.node(i).is_valid())
+            REQUIRE(tree.node(i).bbox.isApprox(tree_serial.node(i).bbox));
+    }
+
+    // Rays cast from a common origin inside and outside the sphere, the last packet is incomplete.
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+    for (const Vec3d origin : { Vec3d(0., 0., 0.), Vec3d(1., 2., 3.), Vec3d(0., 0., -20.) }) {
+        std::vector<Vec3d> origins, dirs;
+        for (size_t i = 0; i < 1001; ++ i) {
+            origins.emplace_back(origin);
+            dirs.emplace_back(i % 7 == 0 ? Vec3d(0., 0., 1.) : Vec3d(Vec3d(dist(rng), dist(rng), dist(rng)).normalized()));
+        }
+        std::vector<igl::Hit> hits;
+        AABBTreeIndirect::intersect_rays_first_hit(its.vertices, its.indices, tree, origins, dirs, hits);
+        REQUIRE(hits.size() == origins.size());
+        for (size_t i = 0; i < origins.size(); ++ i) {
+            igl::Hit hit;
+            const bool intersected = AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, origins[i], dirs[i], hit);
+            REQUIRE(intersected == (hits[i].id != -1));
+            if (intersected) {
+                REQUIRE(hits[i].id == hit.id);
+                REQUIRE(hits[i].t == hit.t);
+            }
+        }
+    }
+
+    // Rays hitting the shared edges of the triangles of a cube, the same triangle is reported by both queries.
+    TriangleMesh cube = make_cube(1., 1., 1.);
+    auto cube_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(cube.its.vertices, cube.its.indices);
+    std::vector<Vec3d> origins { Vec3d(0.5, 0.5, -5.), Vec3d(0.5, 0.5, 6.), Vec3d(-5., 0.5, 0.5), Vec3d(0.5, -5., 0.5), Vec3d(0.25, 0.25, -5.) };
+    std::vector<Vec3d> dirs    { Vec3d(0., 0., 1.),    Vec3d(0., 0., -1.),  Vec3d(1., 0., 0.),    Vec3d(0., 1., 0.),    Vec3d(0., 0., 1.) };
+    std::vector<igl::Hit> hits;
+    AABBTreeIndirect::intersect_rays_first_hit(cube.its.vertices, cube.its.indices, cube_tree, origins, dirs, hits);
+    for (size_t i = 0; i < origins.size(); ++ i) {
+        igl::Hit hit;
+        REQUIRE(AABBTreeIndirect::intersect_ray_first_hit(cube.its.vertices, cube.its.indices, cube_tree, origins[i], dirs[i], hit));
+        REQUIRE(hits[i].id == hit.id);
+        REQUIRE(hits[i].t == Approx(5.));
+    }
+}
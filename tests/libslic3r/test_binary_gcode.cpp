@@ -0,0 +1,107 @@
+#include <catch2/catch.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "libslic3r/GCode/BinaryGCode.hpp"
+#include "libslic3r/GCode/PostProcessor.hpp"
+#include "libslic3r/PrintConfig.hpp"
+
+using namespace Slic3r;
+
+static std::string read_file(const std::string &path)
+{
+    std::ifstream f(path, std::ios::binary);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+SCENARIO("Binary G-code round trip", "[BinaryGCode]") {
+    GIVEN("ASCII G-code with a thumbnail and a configuration block") {
+        std::string gcode =
+            "; HEADER_BLOCK_START\n; HEADER_BLOCK_END\n"
+            "; thumbnail begin 2x2 8\n; aGVsbG8h\n; thumbnail end\n";
+        for (int i = 0; i < 20000; ++ i)
+            gcode += "G1 X" + std::to_string(i % 200) + " Y" + std::to_string(i % 150) + " E0.0123\n";
+        gcode += "; CONFIG_BLOCK_START\n; layer_height = 0.2\n; nozzle_diameter = 0.4\n; CONFIG_BLOCK_END\n";
+
+        const boost::filesystem::path dir = boost::filesystem::temp_directory_path();
+        const std::string ascii  = (dir / boost::filesystem::unique_path("%%%%-%%%%.gcode")).string();
+        const std::string binary = (dir / boost::filesystem::unique_path("%%%%-%%%%.bgcode")).string();
+        const std::string back   = (dir / boost::filesystem::unique_path("%%%%-%%%%.gcode")).string();
+        std::ofstream(ascii, std::ios::binary) << gcode;
+
+        WHEN("converted to binary and back") {
+            BinaryGCode::convert_ascii_to_binary(ascii, binary, { { "printer_model", "test" } }, { { "total_layers", "10" } });
+            BinaryGCode::convert_binary_to_ascii(binary, back);
+            THEN("the binary file is recognized and smaller") {
+                REQUIRE(BinaryGCode::is_binary_gcode_file(binary));
+                REQUIRE(! BinaryGCode::is_binary_gcode_file(ascii));
+                REQUIRE(boost::filesystem::file_size(binary) < gcode.size());
+            }
+            THEN("the ASCII G-code is restored byte for byte") {
+                REQUIRE(read_file(back) == gcode);
+            }
+            THEN("metadata and thumbnail are stored in their own blocks") {
+                BinaryGCode::Metadata md;
+                REQUIRE(BinaryGCode::read_metadata(binary, BinaryGCode::EBlockType::SlicerMetadata, md));
+                REQUIRE(md == BinaryGCode::Metadata{ { "layer_height", "0.2" }, { "nozzle_diameter", "0.4" } });
+                REQUIRE(BinaryGCode::read_metadata(binary, BinaryGCode::EBlockType::PrinterMetadata, md));
+                REQUIRE(md == BinaryGCode::Metadata{ { "printer_model", "test" } });
+                BinaryGCode::Reader reader(binary);
+                BinaryGCode::Reader::Block block;
+                size_t thumbnails = 0;
+                while (reader.next_block(block))
+                    if (block.type == BinaryGCode::EBlockType::Thumbnail) {
+                        ++ thumbnails;
+                        REQUIRE(block.data == "hello!");
+                    }
+                REQUIRE(thumbnails == 1);
+            }
+        }
+        boost::filesystem::remove(ascii);
+        boost::filesystem::remove(binary);
+        boost::filesystem::remove(back);
+    }
+}
+
+TEST_CASE("Exported G-code is converted before it is copied", "[BinaryGCode]") {
+    const std::string gcode = "G1 X1 Y1 E0.1\nG1 X2 Y2 E0.2\n";
+    const boost::filesystem::path dir = boost::filesystem::temp_directory_path();
+    const std::string ascii = (dir / boost::filesystem::unique_path("%%%%-%%%%.gcode")).string();
+    std::ofstream(ascii, std::ios::binary) << gcode;
+
+    DynamicPrintConfig config;
+    config.set_key_value("binary_gcode", new ConfigOptionBool(false));
+    config.set_key_value("gcode_add_line_number", new ConfigOptionBool(true));
+    DynamicConfig print_statistics;
+    std::string src_path    = ascii;
+    std::string output_name = "plate_1.gcode";
+    REQUIRE(! gcode_convert_to_binary(src_path, true, output_name, config, print_statistics, true));
+    REQUIRE(src_path == ascii);
+    REQUIRE(output_name == "plate_1.gcode");
+
+    config.set_key_value("binary_gcode", new ConfigOptionBool(true));
+    SECTION("into a copy") {
+        REQUIRE(gcode_convert_to_binary(src_path, true, output_name, config, print_statistics, true));
+        REQUIRE(src_path != ascii);
+        REQUIRE(output_name == "plate_1.bgcode");
+        // The source, which may be mapped by the G-code viewer, is left intact.
+        REQUIRE(read_file(ascii) == gcode);
+        REQUIRE(BinaryGCode::is_binary_gcode_file(src_path));
+        const std::string back = (dir / boost::filesystem::unique_path("%%%%-%%%%.gcode")).string();
+        BinaryGCode::convert_binary_to_ascii(src_path, back);
+        REQUIRE(read_file(back) == "N1 G1 X1 Y1 E0.1\nN2 G1 X2 Y2 E0.2\n");
+        boost::filesystem::remove(back);
+        boost::filesystem::remove(src_path);
+    }
+    SECTION("in place") {
+        REQUIRE(gcode_convert_to_binary(src_path, false, output_name, config, print_statistics));
+        REQUIRE(src_path == ascii);
+        REQUIRE(BinaryGCode::is_binary_gcode_file(ascii));
+    }
+    boost::filesystem::remove(ascii);
+}
@@ -237,3 +237,25 @@ SCENARIO("DynamicPrintConfig serialization", "[Config]") {
         }
     }
 }
+
+SCENARIO("Static config diff against a DynamicPrintConfig", "[Config]") {
+    GIVEN("A PrintObjectConfig and a full DynamicPrintConfig with a few options modified") {
+        PrintObjectConfig  object_config;
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set("layer_height", 0.123);
+        config.set("wall_loops", 7);
+        config.set("gcode_comments", true);
+        config.erase("raft_layers");
+        WHEN("The configs are compared") {
+            t_config_option_keys diff = object_config.diff(config);
+            THEN("The lockstep diff matches the generic ConfigBase::diff()") {
+                REQUIRE(diff == object_config.ConfigBase::diff(config));
+            }
+            THEN("Only the modified options of PrintObjectConfig are reported") {
+                REQUIRE(std::find(diff.begin(), diff.end(), "layer_height") != diff.end());
+                REQUIRE(std::find(diff.begin(), diff.end(), "gcode_comments") == diff.end());
+                REQUIRE(std::find(diff.begin(), diff.end(), "raft_layers") == diff.end());
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <stdexcept>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "libslic3r/Execution/ExecutionContext.hpp"
+
+using namespace Slic3r;
+
+TEST_CASE("Execution context limits the threads of a job", "[ExecutionContext]") {
+    ExecutionParams params;
+    params.threads = 2;
+    ExecutionContext context(params);
+    REQUIRE(context.max_concurrency() <= 2);
+    REQUIRE(context.gcode_pipeline_tokens() == ExecutionContext::DefaultGCodePipelineTokens);
+
+    // The parallel loops started inside the arena do not see more threads than the arena has.
+    int concurrency = context.execute([]() { return tbb::this_task_arena::max_concurrency(); });
+    CHECK(concurrency == context.max_concurrency());
+
+    std::atomic<size_t> sum { 0 };
+    context.execute([&sum]() {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, 1000), [&sum](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                sum += i;
+        });
+    });
+    CHECK(sum == 999 * 1000 / 2);
+
+    CHECK_THROWS_AS(context.execute([]() { throw std::runtime_error("canceled"); }), std::runtime_error);
+}
+
+TEST_CASE("Default execution context runs in the global arena", "[ExecutionContext]") {
+    ExecutionParams params;
+    params.gcode_pipeline_tokens = 4;
+    params.gcode_memory_limit    = 64 * 1024 * 1024;
+    REQUIRE(params.is_default_arena());
+    REQUIRE(! params.is_default());
+    ExecutionContext context(params);
+    CHECK(context.max_concurrency() == tbb::this_task_arena::max_concurrency());
+    CHECK(context.gcode_pipeline_tokens() == 4);
+    CHECK(context.params().gcode_memory_limit == 64 * 1024 * 1024);
+    CHECK(execute_in_context(nullptr, []() { return 42; }) == 42);
+    CHECK(execute_in_context(&context, []() { return 42; }) == 42);
+}
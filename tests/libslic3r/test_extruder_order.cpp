@@ -0,0 +1,115 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#include "libslic3r/Print.hpp"
+
+using namespace Slic3r;
+
+static std::vector<std::vector<float>> random_wipe_volumes(size_t num_extruders, std::mt19937 &rng)
+{
+    // Asymmetric flush volumes, the order of the extruders matters.
+    std::uniform_int_distribution<int> volume(10, 800);
+    std::vector<std::vector<float>> wipe_volumes(num_extruders, std::vector<float>(num_extruders, 0.f));
+    for (size_t i = 0; i < num_extruders; ++ i)
+        for (size_t j = 0; j < num_extruders; ++ j)
+            if (i != j)
+                wipe_volumes[i][j] = float(volume(rng));
+    return wipe_volumes;
+}
+
+// Minimum flush volume of the paths starting with extruders.front(), by trying all of them.
+static float brute_force_cost(const std::vector<std::vector<float>> &wipe_volumes, std::vector<unsigned int> extruders)
+{
+    float best = std::numeric_limits<float>::max();
+    std::sort(extruders.begin() + 1, extruders.end());
+    do {
+        float cost = 0.f;
+        for (size_t i = 1; i < extruders.size(); ++ i)
+            cost += wipe_volumes[extruders[i - 1]][extruders[i]];
+        best = std::min(best, cost);
+    } while (std::next_permutation(extruders.begin() + 1, extruders.end()));
+    return best;
+}
+
+static bool is_path_of(const std::vector<unsigned int> &path, const std::vector<unsigned int> &extruders)
+{
+    return ! path.empty() && path.front() == extruders.front() && std::is_permutation(path.begin(), path.end(), extruders.begin(), extruders.end());
+}
+
+TEST_CASE("Extruder order matches the brute force order", "[ToolOrdering]") {
+    const size_t num_extruders = 10;
+    std::mt19937 rng(43);
+    for (size_t round = 0; round < 20; ++ round) {
+        std::vector<std::vector<float>> wipe_volumes = random_wipe_volumes(num_extruders, rng);
+        ExtruderOrderSolver solver(wipe_volumes);
+        for (size_t n = 1; n <= 7; ++ n) {
+            std::vector<unsigned int> extruders(num_extruders);
+            std::iota(extruders.begin(), extruders.end(), 0);
+            std::shuffle(extruders.begin(), extruders.end(), rng);
+            extruders.resize(n);
+            const float optimum = brute_force_cost(wipe_volumes, extruders);
+
+            std::vector<unsigned int> exact = solver.solve_exact(extruders);
+            REQUIRE(is_path_of(exact, extruders));
+            CHECK(solver.path_cost(exact) == Approx(optimum));
+
+            // The heuristic is not optimal in general, but it never beats the optimum and it is optimal for up to 3 extruders.
+            std::vector<unsigned int> heuristic = solver.solve_heuristic(extruders);
+            REQUIRE(is_path_of(heuristic, extruders));
+            CHECK(solver.path_cost(heuristic) >= Approx(optimum));
+            if (n <= 3)
+                CHECK(solver.path_cost(heuristic) == Approx(optimum));
+        }
+    }
+}
+
+TEST_CASE("Extruder order of a layer", "[ToolOrdering]") {
+    std::mt19937 rng(7);
+    std::vector<std::vector<float>> wipe_volumes = random_wipe_volumes(8, rng);
+    const std::vector<unsigned int> extruders { 3, 5, 1, 6 };
+
+    SECTION("without a start extruder the path starts with the first extruder") {
+        ExtruderOrderSolver solver(wipe_volumes);
+        std::vector<unsigned int> path = solver.solve(extruders, std::nullopt);
+        REQUIRE(is_path_of(path, extruders));
+        CHECK(solver.path_cost(path) == Approx(brute_force_cost(wipe_volumes, extruders)));
+    }
+    SECTION("the start extruder of the layer is moved to the front") {
+        ExtruderOrderSolver solver(wipe_volumes);
+        std::vector<unsigned int> path = solver.solve(extruders, 6);
+        REQUIRE(is_path_of(path, { 6, 3, 5, 1 }));
+        CHECK(solver.path_cost(path) == Approx(brute_force_cost(wipe_volumes, { 6, 3, 5, 1 })));
+    }
+    SECTION("a start extruder not printing the layer is not part of the path") {
+        ExtruderOrderSolver solver(wipe_volumes);
+        std::vector<unsigned int> path = solver.solve(extruders, 0);
+        REQUIRE(std::is_permutation(path.begin(), path.end(), extruders.begin(), extruders.end()));
+        std::vector<unsigned int> with_start { 0 };
+        with_start.insert(with_start.end(), path.begin(), path.end());
+        CHECK(solver.path_cost(with_start) == Approx(brute_force_cost(wipe_volumes, { 0, 3, 5, 1, 6 })));
+    }
+    SECTION("above the exact limit the heuristic is used") {
+        ExtruderOrderSolver solver(wipe_volumes, 3);
+        CHECK(solver.solve(extruders, std::nullopt) == solver.solve_heuristic(extruders));
+        CHECK(solver.solve({ 3, 5, 1 }, std::nullopt) == solver.solve_exact({ 3, 5, 1 }));
+    }
+}
+
+TEST_CASE("Extruder order of up to 16 extruders is exact by default", "[ToolOrdering]") {
+    const size_t num_extruders = 16;
+    std::mt19937 rng(16);
+    std::vector<std::vector<float>> wipe_volumes = random_wipe_volumes(num_extruders, rng);
+    ExtruderOrderSolver solver(wipe_volumes);
+    for (size_t n = 13; n <= num_extruders; ++ n) {
+        std::vector<unsigned int> extruders(n);
+        std::iota(extruders.begin(), extruders.end(), 0);
+        std::shuffle(extruders.begin(), extruders.end(), rng);
+        std::vector<unsigned int> path = solver.solve(extruders, std::nullopt);
+        REQUIRE(is_path_of(path, extruders));
+        CHECK(path == solver.solve_exact(extruders));
+    }
+}
@@ -0,0 +1,59 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleSelector.hpp"
+
+using namespace Slic3r;
+
+// Sum of the triangle centroids weighted by their areas, it does not depend on the order of the triangles and vertices.
+static Vec3d area_weighted_centroid(const indexed_triangle_set &its)
+{
+    Vec3d out = Vec3d::Zero();
+    for (size_t i = 0; i < its.indices.size(); ++ i) {
+        const its_triangle triangle = its_triangle_vertices(its, i);
+        const Vec3d        a        = triangle[0].cast<double>();
+        const Vec3d        b        = triangle[1].cast<double>();
+        const Vec3d        c        = triangle[2].cast<double>();
+        out += 0.5 * (b - a).cross(c - a).norm() * (a + b + c) / 3.;
+    }
+    return out;
+}
+
+TEST_CASE("Facets of all the states are extracted at once", "[TriangleSelector]") {
+    TriangleMesh mesh(its_make_cube(10., 10., 10.));
+    TriangleSelector selector(mesh);
+    selector.set_facet(0, EnforcerBlockerType::ENFORCER);
+    selector.set_facet(1, EnforcerBlockerType::ENFORCER);
+    selector.set_facet(4, EnforcerBlockerType::BLOCKER);
+    selector.set_facet(7, EnforcerBlockerType::Extruder5);
+
+    // Restore the painting the same way FacetsAnnotation does.
+    TriangleSelector restored(mesh);
+    restored.deserialize(selector.serialize(), false);
+
+    for (bool strict : { false, true }) {
+        const TriangleSelector::FacetsPerState facets = restored.get_facets_per_state(strict);
+        REQUIRE(facets.first_triangle.size() == size_t(EnforcerBlockerType::ExtruderMax) + 2);
+        REQUIRE(facets.indices.size() == mesh.its.indices.size());
+        REQUIRE(facets.vertices.size() == mesh.its.vertices.size());
+        for (int state = 0; state <= int(EnforcerBlockerType::ExtruderMax); ++ state) {
+            const indexed_triangle_set expected = strict ? selector.get_facets_strict(EnforcerBlockerType(state)) : selector.get_facets(EnforcerBlockerType(state));
+            const indexed_triangle_set its      = facets.facets(EnforcerBlockerType(state));
+            REQUIRE(facets.num_facets(EnforcerBlockerType(state)) == expected.indices.size());
+            REQUIRE(its.indices.size() == expected.indices.size());
+            REQUIRE((area_weighted_centroid(its) - area_weighted_centroid(expected)).norm() == Approx(0.).margin(EPSILON));
+            for (const stl_triangle_vertex_indices &triangle : its.indices)
+                for (int i = 0; i < 3; ++ i)
+                    REQUIRE(triangle(i) < int(its.vertices.size()));
+        }
+    }
+
+    std::vector<indexed_triangle_set> facets_per_type;
+    restored.get_facets(facets_per_type);
+    REQUIRE(facets_per_type.size() == size_t(EnforcerBlockerType::ExtruderMax) + 1);
+    CHECK(facets_per_type[size_t(EnforcerBlockerType::NONE)].indices.size() == mesh.its.indices.size() - 4);
+    CHECK(facets_per_type[size_t(EnforcerBlockerType::ENFORCER)].indices.size() == 2);
+    CHECK(facets_per_type[size_t(EnforcerBlockerType::BLOCKER)].indices.size() == 1);
+    CHECK(facets_per_type[size_t(EnforcerBlockerType::Extruder5)].indices.size() == 1);
+    CHECK(facets_per_type[size_t(EnforcerBlockerType::Extruder5)].vertices.size() == 3);
+}
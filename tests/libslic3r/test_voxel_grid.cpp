@@ -0,0 +1,84 @@
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <set>
+
+#include "libslic3r/Interlocking/VoxelUtils.hpp"
+
+using namespace Slic3r;
+
+using CellSet = std::set<std::tuple<coord_t, coord_t, coord_t>>;
+
+static CellSet to_cell_set(const VoxelGrid& grid)
+{
+    CellSet out;
+    for (coord_t z = grid.min().z(); z <= grid.max().z(); ++ z)
+        grid.forEachInSlab(z, [&out](const GridPoint3& p) { out.emplace(p.x(), p.y(), p.z()); });
+    return out;
+}
+
+TEST_CASE("Dilation of a voxel grid matches the dilation of the single voxels", "[VoxelGrid]") {
+    // The box is wider than 64 voxels along x to cross the words of a row.
+    const GridPoint3 min(-70, -5, -3);
+    const GridPoint3 max(90, 6, 8);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<coord_t> rx(min.x(), max.x()), ry(min.y(), max.y()), rz(min.z(), max.z());
+
+    VoxelGrid grid(min, max);
+    std::vector<GridPoint3> cells;
+    for (size_t i = 0; i < 150; ++ i) {
+        cells.emplace_back(rx(rng), ry(rng), rz(rng));
+        grid.set(cells.back());
+    }
+    // Voxels at the border of the box and at the word boundaries.
+    for (const GridPoint3& p : { min, max, GridPoint3(min.x() + 63, 0, 0), GridPoint3(min.x() + 64, 0, 0), GridPoint3(min.x() + 127, max.y(), min.z()) }) {
+        cells.emplace_back(p);
+        grid.set(p);
+    }
+
+    for (DilationKernel::Type type : { DilationKernel::Type::CUBE, DilationKernel::Type::DIAMOND, DilationKernel::Type::PRISM })
+        for (coord_t size : { 1, 2, 3, 4 }) {
+            const DilationKernel kernel(GridPoint3(size, size, size), type);
+            CellSet expected;
+            for (const GridPoint3& p : cells)
+                for (const GridPoint3& rel : kernel.relative_cells_) {
+                    const GridPoint3 q = p + rel;
+                    if (grid.contains(q))
+                        expected.emplace(q.x(), q.y(), q.z());
+                }
+            const VoxelGrid dilated = grid.dilated(kernel);
+            REQUIRE(to_cell_set(dilated) == expected);
+            for (const GridPoint3& p : cells)
+                REQUIRE(dilated.get(p));
+        }
+}
+
+TEST_CASE("Set operations of voxel grids", "[VoxelGrid]") {
+    const GridPoint3 min(0, 0, -2);
+    const GridPoint3 max(100, 3, 3);
+    VoxelGrid a(min, max), b(min, max);
+    a.set(GridPoint3(1, 1, 1));
+    a.set(GridPoint3(70, 2, 2));
+    a.set(GridPoint3(5, 0, -1));
+    b.set(GridPoint3(70, 2, 2));
+    b.set(GridPoint3(99, 3, 3));
+
+    VoxelGrid both = a;
+    both.intersect(b);
+    CHECK(to_cell_set(both) == CellSet{ { 70, 2, 2 } });
+
+    VoxelGrid any = a;
+    any.unite(b);
+    CHECK(to_cell_set(any).size() == 4);
+
+    VoxelGrid only_a = a;
+    only_a.subtract(b);
+    CHECK(to_cell_set(only_a) == CellSet{ { 1, 1, 1 }, { 5, 0, -1 } });
+
+    only_a.clearBelowZ(0);
+    CHECK(to_cell_set(only_a) == CellSet{ { 1, 1, 1 } });
+
+    only_a.subtract(a);
+    CHECK(only_a.empty());
+    CHECK(! a.empty());
+}
@@ -1,14 +1,22 @@
+#include <algorithm>
 #include <unordered_set>
 #include <unordered_map>
 #include <random>
 #include <numeric>
 #include <cstdint>
+#include <cstring>
 
 #include "sla_test_utils.hpp"
 
 #include <libslic3r/TriangleMeshSlicer.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
 #include <libslic3r/SLA/Concurrency.hpp>
+#include <libslic3r/Execution/ExecutionSeq.hpp>
+#include <libslic3r/Format/SL1.hpp>
+#include <libslic3r/Zipper.hpp>
+#include <libslic3r/miniz_extension.hpp>
+
+#include <boost/filesystem/operations.hpp>
 
 namespace {
 
@@ -223,6 +231,127 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
 }
 
 
+TEST_CASE("SparseRasterShouldMatchDenseRaster", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::Resolution res{2560, 1440};
+    sla::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+    auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+
+    sla::RasterBase::Trafo trafo{sla::RasterBase::roPortrait, sla::RasterBase::MirrorX};
+    sla::RasterGrayscaleAAGammaPower dense(res, pixdim, trafo, 1.);
+    sla::RasterGrayscaleAASparse sparse(res, pixdim, trafo, agg::gamma_power(1.));
+
+    // Overlapping polygons exercise blending into already drawn rows.
+    for (double v : {10., 20., 35.}) {
+        ExPolygon poly = square_with_hole(v);
+        poly.translate(bb.center().x() + scaled(v / 4.), bb.center().y());
+        dense.draw(poly);
+        sparse.draw(poly);
+    }
+
+    // Compare the whole rasters at once, a mismatch is reported by its first pixel.
+    std::vector<uint8_t> dense_px, sparse_px;
+    dense_px.reserve(res.pixels());
+    sparse_px.reserve(res.pixels());
+    for (size_t row = 0; row < res.height_px; ++row)
+        for (size_t col = 0; col < res.width_px; ++col) {
+            dense_px.emplace_back(dense.read_pixel(col, row));
+            sparse_px.emplace_back(sparse.read_pixel(col, row));
+        }
+    auto mismatch = std::mismatch(sparse_px.begin(), sparse_px.end(), dense_px.begin());
+    size_t first_mismatch = mismatch.first - sparse_px.begin();
+    std::string mismatch_info;
+    if (first_mismatch < res.pixels())
+        mismatch_info = "First mismatch at column " + std::to_string(first_mismatch % res.width_px) + ", row " + std::to_string(first_mismatch / res.width_px) +
+                        ": sparse " + std::to_string(int(*mismatch.first)) + ", dense " + std::to_string(int(*mismatch.second));
+    INFO(mismatch_info);
+    REQUIRE(first_mismatch == res.pixels());
+
+    sla::EncodedRaster dense_png  = dense.encode(sla::PNGRasterEncoder());
+    sla::EncodedRaster sparse_png = sparse.encode(sla::PNGRasterEncoder());
+    REQUIRE(sparse_png.size() == dense_png.size());
+    REQUIRE(std::memcmp(sparse_png.data(), dense_png.data(), dense_png.size()) == 0);
+
+    REQUIRE(sparse.memory_usage() < res.pixels());
+}
+
+namespace {
+
+// Exposes the encoded layers of the archive.
+class TestSL1Archive : public SL1Archive {
+public:
+    using SL1Archive::SL1Archive;
+    const std::vector<sla::EncodedRaster> &layers() const { return m_layers; }
+};
+
+std::vector<uint8_t> encoded_bytes(const sla::EncodedRaster &rst)
+{
+    auto ptr = static_cast<const uint8_t *>(rst.data());
+    return {ptr, ptr + rst.size()};
+}
+
+// Writes the layers the way SL1Archive::export_print() does and reads them back.
+std::vector<std::vector<uint8_t>> zip_roundtrip(const std::vector<sla::EncodedRaster> &layers, Zipper::e_compression compression)
+{
+    const std::string zipfname = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.sl1")).string();
+    {
+        Zipper zipper(zipfname);
+        for (size_t i = 0; i < layers.size(); ++i)
+            zipper.add_entry("layer" + std::to_string(i) + ".png", layers[i].data(), layers[i].size(), compression);
+        zipper.finalize();
+    }
+
+    std::vector<std::vector<uint8_t>> out;
+    mz_zip_archive zip;
+    mz_zip_zero_struct(&zip);
+    REQUIRE(open_zip_reader(&zip, zipfname));
+    for (size_t i = 0; i < layers.size(); ++i) {
+        size_t size = 0;
+        void  *data = mz_zip_reader_extract_file_to_heap(&zip, ("layer" + std::to_string(i) + ".png").c_str(), &size, 0);
+        REQUIRE(data != nullptr);
+        out.emplace_back(static_cast<uint8_t *>(data), static_cast<uint8_t *>(data) + size);
+        mz_free(data);
+    }
+    close_zip_reader(&zip);
+    boost::filesystem::remove(zipfname);
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("Parallel SLA archive output matches the serial output", "[SLARasterOutput]") {
+    SLAPrinterConfig cfg;
+    const size_t num_layers = 16;
+    auto drawfn = [&cfg](sla::RasterBase &raster, size_t idx) {
+        // Layers of different sizes, with the odd ones left empty.
+        if (idx % 2)
+            return;
+        ExPolygon poly = square_with_hole(10. + double(idx));
+        poly.translate(scaled(cfg.display_width.getFloat() / 2.), scaled(cfg.display_height.getFloat() / 2.));
+        raster.draw(poly);
+    };
+
+    TestSL1Archive serial(cfg), parallel(cfg);
+    serial.draw_layers(num_layers, drawfn, []() { return false; }, ex_seq);
+    parallel.draw_layers(num_layers, drawfn, []() { return false; }, ex_tbb);
+    REQUIRE(serial.layers().size() == num_layers);
+    REQUIRE(parallel.layers().size() == num_layers);
+
+    std::vector<std::vector<uint8_t>> serial_png;
+    for (size_t i = 0; i < num_layers; ++i) {
+        INFO("layer " << i);
+        serial_png.emplace_back(encoded_bytes(serial.layers()[i]));
+        REQUIRE(! serial_png.back().empty());
+        REQUIRE(encoded_bytes(parallel.layers()[i]) == serial_png.back());
+    }
+    // The drawn layers differ from the empty ones.
+    REQUIRE(serial_png[0] != serial_png[1]);
+
+    // The layer images are stored into the archive as they are, deflating them again does not change the extracted files.
+    REQUIRE(zip_roundtrip(parallel.layers(), Zipper::NO_COMPRESSION) == serial_png);
+    REQUIRE(zip_roundtrip(parallel.layers(), Zipper::FAST_COMPRESSION) == serial_png);
+}
+
 TEST_CASE("halfcone test", "[halfcone]") {
     sla::DiffBridge br{Vec3d{1., 1., 1.}, Vec3d{10., 10., 10.}, 0.25, 0.5};
 
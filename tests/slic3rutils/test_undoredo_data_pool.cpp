@@ -0,0 +1,231 @@
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <string>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/TriangleSelector.hpp"
+#include "slic3r/Utils/UndoRedo.hpp"
+#include "slic3r/Utils/UndoRedoDataPool.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::UndoRedo;
+
+// Serialized data large enough to be compressed, deflating well.
+static std::string compressible_data(size_t size, char seed)
+{
+    std::string out(size, 0);
+    for (size_t i = 0; i < size; ++ i)
+        out[i] = char(seed + (i / 64) % 7);
+    return out;
+}
+
+static std::string random_data(size_t size)
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::string out(size, 0);
+    for (char &c : out)
+        c = char(byte(rng));
+    return out;
+}
+
+static MutableData* acquire(MutableDataPool &pool, const std::string &data)
+{
+    return pool.acquire(data, MutableData::hash_of(data));
+}
+
+TEST_CASE("Undo / Redo data of the same content is shared", "[UndoRedo]") {
+    MutableDataPool pool;
+    const std::string a = compressible_data(100, 'a');
+    const std::string b = compressible_data(100, 'b');
+
+    MutableData *data_a = acquire(pool, a);
+    MutableData *data_a2 = acquire(pool, std::string(a));
+    MutableData *data_b = acquire(pool, b);
+    REQUIRE(data_a == data_a2);
+    REQUIRE(data_a != data_b);
+    REQUIRE(data_a->refcnt == 2);
+    REQUIRE(pool.size() == 2);
+
+    SECTION("data is released with its last reference") {
+        pool.release(data_a);
+        REQUIRE(pool.size() == 2);
+        REQUIRE(data_a2->load() == a);
+        pool.release(data_a2);
+        REQUIRE(pool.size() == 1);
+        pool.release(data_b);
+        REQUIRE(pool.size() == 0);
+    }
+    SECTION("data of the same hash and size, but of a different content is not shared") {
+        MutableData *data_c = pool.acquire(b, data_a->hash);
+        REQUIRE(data_c != data_a);
+        REQUIRE(data_c->load() == b);
+        pool.release(data_c);
+        pool.release(data_a);
+        pool.release(data_a2);
+        pool.release(data_b);
+    }
+}
+
+TEST_CASE("Compressed Undo / Redo data", "[UndoRedo]") {
+    MutableDataPool pool;
+    const std::string large = compressible_data(64 * 1024, 'a');
+    const std::string small = compressible_data(MutableDataPool::compression_threshold - 1, 'a');
+    MutableData *data_large = acquire(pool, large);
+    MutableData *data_small = acquire(pool, small);
+
+    pool.compress_in_background();
+    pool.collect(true);
+    REQUIRE(pool.idle());
+
+    SECTION("large data is compressed and inflated back") {
+        REQUIRE(data_large->compressed);
+        REQUIRE(data_large->data.size() < large.size());
+        REQUIRE(data_large->load() == large);
+        REQUIRE(! data_small->compressed);
+        // Sharing works with the compressed data.
+        MutableData *data_large2 = acquire(pool, large);
+        REQUIRE(data_large2 == data_large);
+        std::string other = large;
+        other.back() = 'x';
+        MutableData *data_other = acquire(pool, other);
+        REQUIRE(data_other != data_large);
+        pool.release(data_large2);
+        pool.release(data_other);
+    }
+    SECTION("compressed data is not compressed again") {
+        pool.compress_in_background();
+        REQUIRE(pool.idle());
+    }
+    pool.release(data_large);
+    pool.release(data_small);
+}
+
+TEST_CASE("Incompressible Undo / Redo data is compressed once only", "[UndoRedo]") {
+    MutableDataPool pool;
+    const std::string noise = random_data(16 * 1024);
+    MutableData *data = acquire(pool, noise);
+
+    pool.compress_in_background();
+    REQUIRE(! pool.idle());
+    pool.collect(true);
+    REQUIRE(! data->compressed);
+    REQUIRE(data->compression_tried);
+    REQUIRE(data->load() == noise);
+
+    pool.compress_in_background();
+    REQUIRE(pool.idle());
+    pool.release(data);
+}
+
+TEST_CASE("Undo / Redo data released while being compressed", "[UndoRedo]") {
+    MutableDataPool pool;
+    MutableData *data = acquire(pool, compressible_data(64 * 1024, 'a'));
+    pool.compress_in_background();
+    pool.release(data);
+    REQUIRE(pool.size() == 0);
+    pool.collect(true);
+    REQUIRE(pool.idle());
+}
+
+TEST_CASE("Undo / Redo data serialized in the background to the same content is shared", "[UndoRedo]") {
+    MutableDataPool pool;
+    const std::string a = compressible_data(100, 'a');
+    MutableData *data_a = acquire(pool, a);
+    // Same timestamp as data_a, for example an object restored by undo and saved again by a later snapshot.
+    MutableData *pending = pool.acquire_pending(data_a->timestamp, [a]() { return a; });
+    pool.collect(true);
+    REQUIRE(! pending->pending);
+    REQUIRE(pending->folded_into == data_a);
+    REQUIRE(data_a->refcnt == 2);
+    REQUIRE(pool.size() == 1);
+    REQUIRE(pending->load() == a);
+    REQUIRE(pending->matches(a, MutableData::hash_of(a)));
+
+    SECTION("the shared data is released with the folded data") {
+        pool.release(data_a);
+        REQUIRE(pool.size() == 1);
+        REQUIRE(pending->load() == a);
+        pool.release(pending);
+        REQUIRE(pool.size() == 0);
+    }
+    SECTION("the folded data is released before the shared data") {
+        pool.release(pending);
+        REQUIRE(data_a->refcnt == 1);
+        REQUIRE(pool.size() == 1);
+        pool.release(data_a);
+        REQUIRE(pool.size() == 0);
+    }
+}
+
+// The painted facets of the first volume of a model.
+static FacetsAnnotation& painted_facets(Model &model)
+{
+    return model.objects.front()->volumes.front()->supported_facets;
+}
+
+static void paint(Model &model, std::initializer_list<int> facets, EnforcerBlockerType state)
+{
+    ModelVolume     *volume = model.objects.front()->volumes.front();
+    TriangleSelector selector(volume->mesh());
+    selector.deserialize(volume->supported_facets.get_data());
+    for (int facet_idx : facets)
+        selector.set_facet(facet_idx, state);
+    REQUIRE(volume->supported_facets.set(selector));
+}
+
+TEST_CASE("Painted facets serialized in the background are restored by undo / redo", "[UndoRedo]") {
+    Model model;
+    model.add_object()->add_volume(make_cube(10., 10., 10.));
+    const SnapshotData snapshot_data { SnapshotType::Action };
+    // The take_snapshot() copies the painted facets and serializes the copy in the background,
+    // undo() / redo() wait for the data to be serialized before loading it.
+    Stack stack;
+    stack.take_snapshot("New Project", model, snapshot_data);
+
+    paint(model, { 0, 1, 2 }, EnforcerBlockerType::ENFORCER);
+    const TriangleSelector::TriangleSplittingData state_a     = painted_facets(model).get_data();
+    const uint64_t                                timestamp_a = painted_facets(model).timestamp();
+    stack.take_snapshot("Paint A", model, snapshot_data);
+
+    paint(model, { 3, 4 }, EnforcerBlockerType::BLOCKER);
+    const TriangleSelector::TriangleSplittingData state_b     = painted_facets(model).get_data();
+    const uint64_t                                timestamp_b = painted_facets(model).timestamp();
+    REQUIRE(timestamp_b != timestamp_a);
+    stack.take_snapshot("Paint B", model, snapshot_data);
+
+    // The current state is captured by the first undo.
+    paint(model, { 5 }, EnforcerBlockerType::ENFORCER);
+    const TriangleSelector::TriangleSplittingData state_c     = painted_facets(model).get_data();
+    const uint64_t                                timestamp_c = painted_facets(model).timestamp();
+
+    REQUIRE(stack.undo(model, snapshot_data));
+    REQUIRE(painted_facets(model).get_data() == state_b);
+    REQUIRE(painted_facets(model).timestamp() == timestamp_b);
+    REQUIRE(stack.undo(model, snapshot_data));
+    REQUIRE(painted_facets(model).get_data() == state_a);
+    REQUIRE(painted_facets(model).timestamp() == timestamp_a);
+
+    SECTION("redo up to the captured current state") {
+        REQUIRE(stack.redo(model));
+        REQUIRE(painted_facets(model).get_data() == state_b);
+        REQUIRE(painted_facets(model).timestamp() == timestamp_b);
+        REQUIRE(stack.redo(model));
+        REQUIRE(painted_facets(model).get_data() == state_c);
+        REQUIRE(painted_facets(model).timestamp() == timestamp_c);
+        REQUIRE(! stack.redo(model));
+    }
+    SECTION("snapshots released by a new snapshot, possibly before being serialized, are dropped") {
+        paint(model, { 6 }, EnforcerBlockerType::BLOCKER);
+        const TriangleSelector::TriangleSplittingData state_d = painted_facets(model).get_data();
+        stack.take_snapshot("Paint D", model, snapshot_data);
+        stack.release_least_recently_used();
+        // "New Project", "Paint D" and the current state.
+        REQUIRE(stack.snapshots().size() == 3);
+        REQUIRE(! stack.redo(model));
+        REQUIRE(stack.undo(model, snapshot_data));
+        REQUIRE(painted_facets(model).get_data() == state_d);
+        REQUIRE(! stack.undo(model, snapshot_data));
+    }
+}